@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// NXP Kinetis K66 (MK66F18): description of the GPIO hardware for the Kinetis GPIO driver.
+
+#ifndef GPIO_MK66F18_H_
+#define GPIO_MK66F18_H_
+
+#include <MK66F18.h>
+
+// Ports: index, name, PORT and GPIO modules, interrupt vector, SIM_SCGC5 clock gate,
+// implemented pins (144-pin package), pins with high drive strength (DSE),
+// pins with digital filter (DFER).
+#define ARM_GPIO_DEVICE_PORTS(X)                                                                                   \
+    X(0, a, PORTA_BASE_PTR, PTA_BASE_PTR, INT_PORTA, SIM_SCGC5_PORTA_MASK, 0x3F0FFFFFu, 0x3F0FFFFFu, 0x00000000u)  \
+    X(1, b, PORTB_BASE_PTR, PTB_BASE_PTR, INT_PORTB, SIM_SCGC5_PORTB_MASK, 0x00FF0FFFu, 0x00FF0FFFu, 0x00000000u)  \
+    X(2, c, PORTC_BASE_PTR, PTC_BASE_PTR, INT_PORTC, SIM_SCGC5_PORTC_MASK, 0x000FFFFFu, 0x000FFFFFu, 0x00000000u)  \
+    X(3, d, PORTD_BASE_PTR, PTD_BASE_PTR, INT_PORTD, SIM_SCGC5_PORTD_MASK, 0x0000FFFFu, 0x0000FFFFu, 0x0000FFFFu)  \
+    X(4, e, PORTE_BASE_PTR, PTE_BASE_PTR, INT_PORTE, SIM_SCGC5_PORTE_MASK, 0x1F001FFFu, 0x1F001FFFu, 0x00000000u)
+
+#define ARM_GPIO_DEVICE_PORT_COUNT          5
+
+// Implemented bits of NVIC interrupt priority.
+#define ARM_GPIO_DEVICE_NVIC_PRIO_BITS      4
+
+// PORTx_PCRn features. Code of a missing feature is not compiled,
+// requests for it return ARM_DRIVER_ERROR_UNSUPPORTED.
+#define ARM_GPIO_DEVICE_PULL                1       // PE, PS
+#define ARM_GPIO_DEVICE_SLEW_RATE           1       // SRE
+#define ARM_GPIO_DEVICE_OPEN_DRAIN          1       // ODE
+#define ARM_GPIO_DEVICE_DRIVE_STRENGTH      1       // DSE
+
+// LLWU_Pn inputs: see "LLWU pin assignment" in K66 Sub-Family Reference Manual.
+#define ARM_GPIO_DEVICE_LLWU_PIN_COUNT      32
+#define ARM_GPIO_DEVICE_LLWU_PINS                                                   \
+    LLWU_PIN(E,  1), LLWU_PIN(E,  2), LLWU_PIN(E,  4), LLWU_PIN(A,  4),     /* P0..P3   */ \
+    LLWU_PIN(A, 13), LLWU_PIN(B,  0), LLWU_PIN(C,  1), LLWU_PIN(C,  3),     /* P4..P7   */ \
+    LLWU_PIN(C,  4), LLWU_PIN(C,  5), LLWU_PIN(C,  6), LLWU_PIN(C, 11),     /* P8..P11  */ \
+    LLWU_PIN(D,  0), LLWU_PIN(D,  2), LLWU_PIN(D,  4), LLWU_PIN(D,  6),     /* P12..P15 */ \
+    LLWU_PIN(E,  6), LLWU_PIN(E,  9), LLWU_PIN(E, 10), LLWU_PIN(E, 17),     /* P16..P19 */ \
+    LLWU_PIN(E, 18), LLWU_PIN(E, 25), LLWU_PIN(A, 10), LLWU_PIN(A, 11),     /* P20..P23 */ \
+    LLWU_PIN(D,  8), LLWU_PIN(D, 11), LLWU_PIN(E, 27), LLWU_PIN(E, 28),     /* P24..P27 */ \
+    LLWU_PIN(A, 29), LLWU_PIN_NONE,   LLWU_PIN_NONE,   LLWU_PIN_NONE        /* P28..P31 */
+
+#define ARM_GPIO_DEVICE_LLWU_PE             &LLWU_PE1, &LLWU_PE2, &LLWU_PE3, &LLWU_PE4, &LLWU_PE5, &LLWU_PE6, &LLWU_PE7, &LLWU_PE8
+#define ARM_GPIO_DEVICE_LLWU_PF             &LLWU_PF1, &LLWU_PF2, &LLWU_PF3, &LLWU_PF4
+
+#endif /* GPIO_MK66F18_H_ */
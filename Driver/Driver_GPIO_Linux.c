@@ -0,0 +1,700 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_Linux.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+#define ARM_GPIO_DRV_VERSION    ARM_DRIVER_VERSION_MAJOR_MINOR(0, 0)  /* driver version */
+
+/* Driver Version */
+static const ARM_DRIVER_VERSION DriverVersion = {
+    ARM_GPIO_API_VERSION,
+    ARM_GPIO_DRV_VERSION
+};
+
+/* Driver Capabilities */
+static const ARM_GPIO_CAPABILITIES DriverCapabilities = {
+    1, /* supports rising edge interrupts */
+    1, /* supports falling edge interrupts */
+    1, /* supports both edges interrupts */
+    0, /* supports level-1 sensitive interrupts */
+    0, /* supports level-0 sensitive interrupts */
+    1, /* supports pull-up register on a pin */
+    1, /* supports pull-down register on a pin */
+    0, /* supports configuration of speed */
+    1, /* supports open-drain on a pin */
+    0  /* supports configuration of drive strength on a pin */
+};
+
+// The event thread and the application's threads share a port: signal,
+// values and events are accessed with atomics.
+typedef struct
+{
+    const char*             path;
+    ARM_GPIO_SignalEvent_t  signal;
+    ARM_POWER_STATE         power;
+
+    int                     chip_fd;
+    int                     line_fd;        ///< Request of all enabled pins; -1: none
+    int                     wake_fd;        ///< Stops the event thread
+
+    uint32_t                cfg[32];        ///< ARM_GPIO_PIN_CFG of every pin
+    uint32_t                lines;          ///< Pins of the request
+    uint32_t                outputs;        ///< Output pins of the request
+    uint32_t                values;         ///< Output levels, also of inputs (as PDOR)
+    uint32_t                locked;
+    uint32_t                events;         ///< Events collected while the interrupt is disabled
+
+    uint8_t                 irq;            ///< ARM_GPIO_CONTROL_IRQ
+    uint8_t                 thread_running;
+    pthread_t               thread;
+} ARM_GPIO_LINUX_PORT;
+
+//
+//   Functions
+//
+
+static ARM_DRIVER_VERSION    ARM_GPIO_GetVersion(void)      { return DriverVersion; }
+static ARM_GPIO_CAPABILITIES ARM_GPIO_GetCapabilities(void) { return DriverCapabilities; }
+
+static int32_t linux_status(int error)
+{
+    switch (error)
+    {
+        case EBUSY:  return ARM_DRIVER_ERROR_BUSY;
+        case EINVAL: return ARM_DRIVER_ERROR_PARAMETER;
+        default:     return ARM_DRIVER_ERROR;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Bit i of request masks is the i-th pin of the request (pins ascending).
+static uint64_t linux_pack(uint32_t lines, uint32_t value)
+{
+    uint64_t bits = 0;
+    uint64_t bit  = 1;
+    for (; lines; lines &= lines - 1, bit <<= 1)
+    {
+        if (value & lines & -lines)
+            bits |= bit;
+    }
+    return bits;
+}
+
+static uint32_t linux_unpack(uint32_t lines, uint64_t bits)
+{
+    uint32_t value = 0;
+    for (; lines; lines &= lines - 1, bits >>= 1)
+    {
+        if (bits & 1)
+            value |= lines & -lines;
+    }
+    return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Event thread
+////////////////////////////////////////////////////////////////////////////////
+
+static void* linux_event_thread(void* arg)
+{
+    ARM_GPIO_LINUX_PORT* port = arg;
+    struct gpio_v2_line_event event[ARM_GPIO_LINUX_EVENT_BATCH];
+
+    struct pollfd fds[2] = {
+        { .fd = port->line_fd, .events = POLLIN },
+        { .fd = port->wake_fd, .events = POLLIN },
+    };
+
+    for (;;)
+    {
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        if (fds[1].revents)
+            break;
+
+        const ssize_t size = read(port->line_fd, event, sizeof(event));
+        if (size <= 0)
+        {
+            if (size < 0 && (errno == EINTR || errno == EAGAIN))
+                continue;
+            break;
+        }
+
+        // One callback per batch, as one interrupt for all pending pins.
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < (uint32_t)size / sizeof(event[0]); i++)
+            mask |= (1u << event[i].offset);
+
+        const ARM_GPIO_SignalEvent_t signal = __atomic_load_n(&port->signal, __ATOMIC_ACQUIRE);
+        if (signal)
+            signal(mask);
+    }
+
+    return 0;
+}
+
+static int32_t linux_thread_start(ARM_GPIO_LINUX_PORT* port)
+{
+    if (port->thread_running || port->line_fd < 0)
+        return ARM_DRIVER_OK;
+
+    if (port->wake_fd < 0)
+    {
+        port->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (port->wake_fd < 0)
+            return ARM_DRIVER_ERROR;
+    }
+
+    if (pthread_create(&port->thread, 0, linux_event_thread, port) != 0)
+        return ARM_DRIVER_ERROR;
+
+    port->thread_running = 1;
+    return ARM_DRIVER_OK;
+}
+
+static void linux_thread_stop(ARM_GPIO_LINUX_PORT* port)
+{
+    if (!port->thread_running)
+        return;
+
+    uint64_t value = 1;
+    (void)!write(port->wake_fd, &value, sizeof(value));
+    pthread_join(port->thread, 0);
+    (void)!read(port->wake_fd, &value, sizeof(value));
+
+    port->thread_running = 0;
+}
+
+// Events queued in the kernel while the thread doesn't run.
+static void linux_collect_events(ARM_GPIO_LINUX_PORT* port)
+{
+    if (port->thread_running || port->line_fd < 0)
+        return;
+
+    struct gpio_v2_line_event event[ARM_GPIO_LINUX_EVENT_BATCH];
+    ssize_t size;
+    while ((size = read(port->line_fd, event, sizeof(event))) > 0)
+    {
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < (uint32_t)size / sizeof(event[0]); i++)
+            mask |= (1u << event[i].offset);
+        __atomic_fetch_or(&port->events, mask, __ATOMIC_RELAXED);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Line request
+////////////////////////////////////////////////////////////////////////////////
+
+static int32_t linux_encode_flags(uint32_t cfg, uint64_t* flags)
+{
+    uint64_t value;
+
+    if (cfg & ARM_GPIO_PIN_CFG_OUTPUT)
+    {
+        value = GPIO_V2_LINE_FLAG_OUTPUT;
+        if (cfg & ARM_GPIO_PIN_CFG_OPEN_DRAIN)
+            value |= GPIO_V2_LINE_FLAG_OPEN_DRAIN;
+    }
+    else
+    {
+        // Open drain of an input is ignored, as by the PORT module.
+        value = GPIO_V2_LINE_FLAG_INPUT;
+    }
+
+    switch ((cfg & ARM_GPIO_PIN_CFG_PULL_Msk) >> ARM_GPIO_PIN_CFG_PULL_Pos)
+    {
+        case ARM_GPIO_PIN_PULL_NONE: value |= GPIO_V2_LINE_FLAG_BIAS_DISABLED;  break;
+        case ARM_GPIO_PIN_PULL_UP:   value |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;   break;
+        case ARM_GPIO_PIN_PULL_DOWN: value |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN; break;
+
+        default: return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    // Kernel detects edges of inputs only.
+    switch ((cfg & ARM_GPIO_PIN_CFG_IRQ_Msk) >> ARM_GPIO_PIN_CFG_IRQ_Pos)
+    {
+        case ARM_GPIO_PIN_IRQ_NONE:    break;
+        case ARM_GPIO_PIN_IRQ_RISING:  value |= GPIO_V2_LINE_FLAG_EDGE_RISING;  break;
+        case ARM_GPIO_PIN_IRQ_FALLING: value |= GPIO_V2_LINE_FLAG_EDGE_FALLING; break;
+        case ARM_GPIO_PIN_IRQ_BOTH:    value |= GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING; break;
+
+        case ARM_GPIO_PIN_IRQ_LEVEL_HIGH:
+        case ARM_GPIO_PIN_IRQ_LEVEL_LOW:
+            return ARM_DRIVER_ERROR_UNSUPPORTED;
+
+        default: return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    if ((value & GPIO_V2_LINE_FLAG_OUTPUT) && (value & (GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING)))
+        return ARM_DRIVER_ERROR_UNSUPPORTED;
+
+    if (cfg & (ARM_GPIO_PIN_CFG_SPEED_Msk | ARM_GPIO_PIN_CFG_DRIVE_STRENGTH_Msk))
+        return ARM_DRIVER_ERROR_UNSUPPORTED;
+
+    *flags = value;
+    return ARM_DRIVER_OK;
+}
+
+// Line config of the pins: default flags are those of the lowest pin,
+// one attribute per other distinct set of flags, one for output levels.
+static int32_t linux_encode_config(const ARM_GPIO_LINUX_PORT* port, const uint32_t* cfg,
+                                   uint32_t lines, uint32_t outputs, struct gpio_v2_line_config* config)
+{
+    memset(config, 0, sizeof(*config));
+
+    uint32_t left = lines;
+    for (uint32_t first = 1; left; first = 0)
+    {
+        uint64_t flags;
+        int32_t status = linux_encode_flags(cfg[__builtin_ctz(left)], &flags);
+        if (status != ARM_DRIVER_OK)
+            return status;
+
+        uint32_t group = 0;
+        for (uint32_t rest = left; rest; rest &= rest - 1)
+        {
+            const uint32_t pin = __builtin_ctz(rest);
+            uint64_t pin_flags;
+            status = linux_encode_flags(cfg[pin], &pin_flags);
+            if (status != ARM_DRIVER_OK)
+                return status;
+            if (pin_flags == flags)
+                group |= (1u << pin);
+        }
+        left &= ~group;
+
+        if (first)
+        {
+            config->flags = flags;
+            continue;
+        }
+
+        // Last attribute is reserved for output levels.
+        if (config->num_attrs >= GPIO_V2_LINE_NUM_ATTRS_MAX - 1)
+            return ARM_DRIVER_ERROR_UNSUPPORTED;
+
+        struct gpio_v2_line_config_attribute* attr = &config->attrs[config->num_attrs++];
+        attr->attr.id    = GPIO_V2_LINE_ATTR_ID_FLAGS;
+        attr->attr.flags = flags;
+        attr->mask       = linux_pack(lines, group);
+    }
+
+    if (outputs)
+    {
+        struct gpio_v2_line_config_attribute* attr = &config->attrs[config->num_attrs++];
+        attr->attr.id     = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        attr->attr.values = linux_pack(lines, __atomic_load_n(&port->values, __ATOMIC_RELAXED));
+        attr->mask        = linux_pack(lines, outputs);
+    }
+
+    return ARM_DRIVER_OK;
+}
+
+static int32_t linux_request(ARM_GPIO_LINUX_PORT* port, uint32_t lines, const struct gpio_v2_line_config* config)
+{
+    if (!lines)
+        return ARM_DRIVER_OK;
+
+    struct gpio_v2_line_request request;
+    memset(&request, 0, sizeof(request));
+
+    for (; lines; lines &= lines - 1)
+        request.offsets[request.num_lines++] = __builtin_ctz(lines);
+    strncpy(request.consumer, ARM_GPIO_LINUX_CONSUMER, sizeof(request.consumer) - 1);
+    request.config = *config;
+
+    if (ioctl(port->chip_fd, GPIO_V2_GET_LINE_IOCTL, &request) < 0)
+        return linux_status(errno);
+
+    port->line_fd = request.fd;
+    fcntl(port->line_fd, F_SETFL, O_NONBLOCK);
+    return ARM_DRIVER_OK;
+}
+
+// Applies configuration of all pins in one ioctl; cfg[] is kept only if it succeeds.
+// Set of enabled pins can't change from the callback: the event thread is restarted.
+static int32_t linux_apply(ARM_GPIO_LINUX_PORT* port, const uint32_t* cfg)
+{
+    uint32_t lines   = 0;
+    uint32_t outputs = 0;
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        if (!(cfg[pin] & ARM_GPIO_PIN_CFG_ENABLED))
+            continue;
+        lines |= (1u << pin);
+        if (cfg[pin] & ARM_GPIO_PIN_CFG_OUTPUT)
+            outputs |= (1u << pin);
+    }
+
+    struct gpio_v2_line_config config;
+    int32_t status = linux_encode_config(port, cfg, lines, outputs, &config);
+    if (status != ARM_DRIVER_OK)
+        return status;
+
+    if (lines == port->lines && port->line_fd >= 0)
+    {
+        if (ioctl(port->line_fd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) < 0)
+            return linux_status(errno);
+    }
+    else
+    {
+        if (port->thread_running && pthread_equal(pthread_self(), port->thread))
+            return ARM_DRIVER_ERROR_BUSY;
+
+        // Lines are released before they are requested again:
+        // an enabled pin may float for the time of the ioctl.
+        linux_thread_stop(port);
+        linux_collect_events(port);
+        if (port->line_fd >= 0)
+        {
+            close(port->line_fd);
+            port->line_fd = -1;
+        }
+
+        status = linux_request(port, lines, &config);
+        if (status != ARM_DRIVER_OK)
+        {
+            // Take back the lines of the previous configuration. If that
+            // fails too, the port holds no lines: pin operations do nothing
+            // until the next configuration requests them again.
+            if (linux_encode_config(port, port->cfg, port->lines, port->outputs, &config) != ARM_DRIVER_OK ||
+                linux_request(port, port->lines, &config) != ARM_DRIVER_OK)
+            {
+                port->lines   = 0;
+                port->outputs = 0;
+                return ARM_DRIVER_ERROR;
+            }
+        }
+        else
+        {
+            port->lines   = lines;
+            port->outputs = outputs;
+        }
+
+        // Also the first request after the interrupt was enabled.
+        if (port->irq)
+            linux_thread_start(port);
+        if (status != ARM_DRIVER_OK)
+            return status;
+    }
+
+    port->lines   = lines;
+    port->outputs = outputs;
+    memcpy(port->cfg, cfg, sizeof(port->cfg));
+    return ARM_DRIVER_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Port access: one ioctl each
+////////////////////////////////////////////////////////////////////////////////
+
+static void linux_set_values(const ARM_GPIO_LINUX_PORT* port, uint32_t mask, uint32_t values)
+{
+    mask &= port->outputs;
+    if (!mask)
+        return;
+
+    struct gpio_v2_line_values request = {
+        .bits = linux_pack(port->lines, values),
+        .mask = linux_pack(port->lines, mask),
+    };
+    ioctl(port->line_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &request);
+}
+
+static void ARM_GPIO_SetPort_Shared(uint32_t mask, ARM_GPIO_LINUX_PORT* port)
+{
+    __atomic_fetch_or(&port->values, mask, __ATOMIC_RELAXED);
+    linux_set_values(port, mask, 0xFFFFFFFFu);
+}
+
+static void ARM_GPIO_ClearPort_Shared(uint32_t mask, ARM_GPIO_LINUX_PORT* port)
+{
+    __atomic_fetch_and(&port->values, ~mask, __ATOMIC_RELAXED);
+    linux_set_values(port, mask, 0);
+}
+
+static void ARM_GPIO_TogglePort_Shared(uint32_t mask, ARM_GPIO_LINUX_PORT* port)
+{
+    const uint32_t values = __atomic_xor_fetch(&port->values, mask, __ATOMIC_RELAXED);
+    linux_set_values(port, mask, values);
+}
+
+static void ARM_GPIO_WritePort_Shared(uint32_t values, ARM_GPIO_LINUX_PORT* port)
+{
+    __atomic_store_n(&port->values, values, __ATOMIC_RELAXED);
+    linux_set_values(port, 0xFFFFFFFFu, values);
+}
+
+static uint32_t ARM_GPIO_ReadPort_Shared(ARM_GPIO_LINUX_PORT* port)
+{
+    if (!port->lines)
+        return 0;
+
+    struct gpio_v2_line_values request = {
+        .bits = 0,
+        .mask = linux_pack(port->lines, 0xFFFFFFFFu),
+    };
+    if (ioctl(port->line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &request) < 0)
+        return 0;
+
+    return linux_unpack(port->lines, request.bits);
+}
+
+static uint32_t ARM_GPIO_GetPortEvents_Shared(ARM_GPIO_LINUX_PORT* port)
+{
+    linux_collect_events(port);
+    return __atomic_load_n(&port->events, __ATOMIC_RELAXED);
+}
+
+static void ARM_GPIO_ClearPortEvents_Shared(uint32_t mask, ARM_GPIO_LINUX_PORT* port)
+{
+    linux_collect_events(port);
+    __atomic_fetch_and(&port->events, ~mask, __ATOMIC_RELAXED);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Control
+////////////////////////////////////////////////////////////////////////////////
+
+static int32_t ARM_GPIO_PowerControl_Shared(ARM_POWER_STATE state, ARM_GPIO_LINUX_PORT* port)
+{
+    switch (state)
+    {
+        case ARM_POWER_OFF:
+            if (port->power == ARM_POWER_OFF)
+                break;
+
+            // Lines are released to the kernel; configuration is kept.
+            linux_thread_stop(port);
+            if (port->line_fd >= 0)
+                close(port->line_fd);
+            close(port->chip_fd);
+            port->line_fd = -1;
+            port->chip_fd = -1;
+            port->lines   = 0;
+            port->outputs = 0;
+            __atomic_store_n(&port->events, 0, __ATOMIC_RELAXED);
+            break;
+
+        case ARM_POWER_FULL:
+        {
+            if (port->power == ARM_POWER_FULL)
+                break;
+
+            port->chip_fd = open(port->path, O_RDWR | O_CLOEXEC);
+            if (port->chip_fd < 0)
+                return ARM_DRIVER_ERROR;
+
+            port->power = ARM_POWER_FULL;
+
+            uint32_t cfg[32];
+            memcpy(cfg, port->cfg, sizeof(cfg));
+            const int32_t status = linux_apply(port, cfg);
+            if (status != ARM_DRIVER_OK)
+            {
+                ARM_GPIO_PowerControl_Shared(ARM_POWER_OFF, port);
+                return status;
+            }
+
+            if (port->irq)
+                return linux_thread_start(port);
+            return ARM_DRIVER_OK;
+        }
+
+        default: return ARM_DRIVER_ERROR_UNSUPPORTED;
+    }
+
+    port->power = state;
+    return ARM_DRIVER_OK;
+}
+
+static int32_t ARM_GPIO_Initialize_Shared(ARM_GPIO_SignalEvent_t cb_event, ARM_GPIO_LINUX_PORT* port)
+{
+    if (port->power != ARM_POWER_OFF)
+        return ARM_DRIVER_OK;
+
+    __atomic_store_n(&port->signal, cb_event, __ATOMIC_RELEASE);
+    return ARM_DRIVER_OK;
+}
+
+static int32_t ARM_GPIO_Uninitialize_Shared(ARM_GPIO_LINUX_PORT* port)
+{
+    ARM_GPIO_PowerControl_Shared(ARM_POWER_OFF, port);
+
+    if (port->wake_fd >= 0)
+        close(port->wake_fd);
+    port->wake_fd = -1;
+    __atomic_store_n(&port->signal, NULL, __ATOMIC_RELEASE);
+    return ARM_DRIVER_OK;
+}
+
+static int32_t ARM_GPIO_Control_Shared(uint32_t control, uint32_t arg, ARM_GPIO_LINUX_PORT* port)
+{
+    uint32_t cfg[32];
+
+    switch (control)
+    {
+        case ARM_GPIO_CONTROL_IRQ:
+            port->irq = (arg != 0);
+            if (port->power == ARM_POWER_OFF)
+                return ARM_DRIVER_OK;
+            if (!arg)
+            {
+                // The callback may disable the port interrupt: the thread can't join itself.
+                if (port->thread_running && pthread_equal(pthread_self(), port->thread))
+                    return ARM_DRIVER_ERROR_BUSY;
+                linux_thread_stop(port);
+                return ARM_DRIVER_OK;
+            }
+            return linux_thread_start(port);
+
+        case ARM_GPIO_CONTROL_LOCK:
+            port->locked |= arg;
+            return ARM_DRIVER_OK;
+
+        case ARM_GPIO_CONTROL_DEFAULT_CFG:
+            if (port->power == ARM_POWER_OFF)
+                return ARM_DRIVER_ERROR;
+            for (uint32_t pin = 0; pin < 32; pin++)
+                cfg[pin] = (port->locked & (1u << pin)) ? port->cfg[pin] : arg;
+            return linux_apply(port, cfg);
+
+        case ARM_GPIO_CONTROL_CLEAR_EVENTS:
+            if (port->power == ARM_POWER_OFF)
+                return ARM_DRIVER_ERROR;
+            linux_collect_events(port);
+            __atomic_store_n(&port->events, 0, __ATOMIC_RELAXED);
+            return ARM_DRIVER_OK;
+
+        default: return ARM_DRIVER_ERROR_UNSUPPORTED;
+    }
+}
+
+static int32_t ARM_GPIO_ControlPin_Shared(uint32_t pin, uint32_t control, uint32_t arg, ARM_GPIO_LINUX_PORT* port)
+{
+    if (pin >= 32)
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    if (port->power == ARM_POWER_OFF)
+        return ARM_DRIVER_ERROR;
+
+    if (port->locked & (1u << pin))
+        return ARM_DRIVER_ERROR;
+
+    uint32_t field, pos;
+    switch (control)
+    {
+        case ARM_GPIO_PIN_CFG:            field = ARM_GPIO_PIN_CFG_Msk;                pos = ARM_GPIO_PIN_CFG_Pos;                break;
+        case ARM_GPIO_PIN_STATE:          field = ARM_GPIO_PIN_CFG_ENABLED_Msk;        pos = ARM_GPIO_PIN_CFG_ENABLED_Pos;        break;
+        case ARM_GPIO_PIN_DIRECTION:      field = ARM_GPIO_PIN_CFG_OUTPUT_Msk;         pos = ARM_GPIO_PIN_CFG_OUTPUT_Pos;         break;
+        case ARM_GPIO_PIN_IRQ:            field = ARM_GPIO_PIN_CFG_IRQ_Msk;            pos = ARM_GPIO_PIN_CFG_IRQ_Pos;            break;
+        case ARM_GPIO_PIN_PULL:           field = ARM_GPIO_PIN_CFG_PULL_Msk;           pos = ARM_GPIO_PIN_CFG_PULL_Pos;           break;
+        case ARM_GPIO_PIN_OPEN_DRAIN:     field = ARM_GPIO_PIN_CFG_OPEN_DRAIN_Msk;     pos = ARM_GPIO_PIN_CFG_OPEN_DRAIN_Pos;     break;
+
+        default: return ARM_DRIVER_ERROR_UNSUPPORTED;
+    }
+
+    // Every control sets one field of the pin's ARM_GPIO_PIN_CFG word.
+    if (arg & ~(field >> pos))
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    uint32_t cfg[32];
+    memcpy(cfg, port->cfg, sizeof(cfg));
+    cfg[pin] = (cfg[pin] & ~field) | (arg << pos);
+    return linux_apply(port, cfg);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//   Driver instances
+////////////////////////////////////////////////////////////////////////////////
+
+#define ARM_GPIO_LINUX_DEFINE_PORT(n, path_)                                    \
+                                                                                \
+static ARM_GPIO_LINUX_PORT gpio_linux_##n = {                                   \
+    .path    = path_,                                                           \
+    .power   = ARM_POWER_OFF,                                                   \
+    .chip_fd = -1,                                                              \
+    .line_fd = -1,                                                              \
+    .wake_fd = -1,                                                              \
+};                                                                              \
+                                                                                \
+static int32_t ARM_GPIO_Initialize_##n(ARM_GPIO_SignalEvent_t cb_event) { return ARM_GPIO_Initialize_Shared(cb_event, &gpio_linux_##n); } \
+static int32_t ARM_GPIO_Uninitialize_##n(void) { return ARM_GPIO_Uninitialize_Shared(&gpio_linux_##n); } \
+static int32_t ARM_GPIO_PowerControl_##n(ARM_POWER_STATE state) { return ARM_GPIO_PowerControl_Shared(state, &gpio_linux_##n); } \
+static int32_t ARM_GPIO_Control_##n(uint32_t control, uint32_t arg) { return ARM_GPIO_Control_Shared(control, arg, &gpio_linux_##n); } \
+static ARM_GPIO_STATUS ARM_GPIO_GetStatus_##n(void) { ARM_GPIO_STATUS status = { 0 }; return status; } \
+                                                                                \
+static void     ARM_GPIO_SetPort_##n(uint32_t mask) { ARM_GPIO_SetPort_Shared(mask, &gpio_linux_##n); } \
+static void     ARM_GPIO_ClearPort_##n(uint32_t mask) { ARM_GPIO_ClearPort_Shared(mask, &gpio_linux_##n); } \
+static void     ARM_GPIO_TogglePort_##n(uint32_t mask) { ARM_GPIO_TogglePort_Shared(mask, &gpio_linux_##n); } \
+static void     ARM_GPIO_WritePort_##n(uint32_t values) { ARM_GPIO_WritePort_Shared(values, &gpio_linux_##n); } \
+static uint32_t ARM_GPIO_ReadPort_##n() { return ARM_GPIO_ReadPort_Shared(&gpio_linux_##n); } \
+static uint32_t ARM_GPIO_GetPortEvents_##n() { return ARM_GPIO_GetPortEvents_Shared(&gpio_linux_##n); } \
+static void     ARM_GPIO_ClearPortEvents_##n(uint32_t mask) { ARM_GPIO_ClearPortEvents_Shared(mask, &gpio_linux_##n); } \
+                                                                                \
+static int32_t  ARM_GPIO_ControlPin_##n(uint32_t pin, uint32_t control, uint32_t arg) { return ARM_GPIO_ControlPin_Shared(pin, control, arg, &gpio_linux_##n); } \
+static void     ARM_GPIO_SetPin_##n(uint32_t pin) { ARM_GPIO_SetPort_Shared((1u << pin), &gpio_linux_##n); } \
+static void     ARM_GPIO_ClearPin_##n(uint32_t pin) { ARM_GPIO_ClearPort_Shared((1u << pin), &gpio_linux_##n); } \
+static void     ARM_GPIO_TogglePin_##n(uint32_t pin) { ARM_GPIO_TogglePort_Shared((1u << pin), &gpio_linux_##n); } \
+static void     ARM_GPIO_WritePin_##n(uint32_t pin, uint32_t value) { (value ? ARM_GPIO_SetPort_Shared : ARM_GPIO_ClearPort_Shared)((1u << pin), &gpio_linux_##n); } \
+static uint32_t ARM_GPIO_ReadPin_##n(uint32_t pin) { return (ARM_GPIO_ReadPort_Shared(&gpio_linux_##n) & (1u << pin)) ? 1u : 0; } \
+                                                                                \
+ARM_DRIVER_GPIO Driver_GPIO##n = {                                              \
+    ARM_GPIO_GetVersion,                                                        \
+    ARM_GPIO_GetCapabilities,                                                   \
+                                                                                \
+    ARM_GPIO_Initialize_##n,                                                    \
+    ARM_GPIO_Uninitialize_##n,                                                  \
+    ARM_GPIO_PowerControl_##n,                                                  \
+    ARM_GPIO_Control_##n,                                                       \
+    ARM_GPIO_GetStatus_##n,                                                     \
+                                                                                \
+    ARM_GPIO_SetPort_##n,                                                       \
+    ARM_GPIO_ClearPort_##n,                                                     \
+    ARM_GPIO_TogglePort_##n,                                                    \
+    ARM_GPIO_WritePort_##n,                                                     \
+    ARM_GPIO_ReadPort_##n,                                                      \
+    ARM_GPIO_GetPortEvents_##n,                                                 \
+    ARM_GPIO_ClearPortEvents_##n,                                               \
+                                                                                \
+    ARM_GPIO_ControlPin_##n,                                                    \
+    ARM_GPIO_SetPin_##n,                                                        \
+    ARM_GPIO_ClearPin_##n,                                                      \
+    ARM_GPIO_TogglePin_##n,                                                     \
+    ARM_GPIO_WritePin_##n,                                                      \
+    ARM_GPIO_ReadPin_##n                                                        \
+};
+
+ARM_GPIO_LINUX_CHIPS(ARM_GPIO_LINUX_DEFINE_PORT)
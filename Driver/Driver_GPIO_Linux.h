@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// GPIO driver on Linux, over the GPIO character device (uAPI v2, kernel 5.10+).
+//
+// Driver_GPIOn drives lines 0..31 of one gpiochip. All enabled pins of the
+// port are held by a single line request, so every port operation is one
+// ioctl on it, whatever the number of pins. Changing configuration of
+// enabled pins updates the request in place (no glitch); enabling or
+// disabling a pin requests the lines again.
+//
+// Edge events are read by a thread of the port, in batches, while the port
+// interrupt is enabled (ARM_GPIO_CONTROL_IRQ); the callback runs on that
+// thread. While it is disabled, events stay queued in the kernel and are
+// collected by GetPortEvents.
+//
+// Not supported: level interrupts, speed, drive strength, ARM_POWER_LOW,
+// interrupt priority.
+
+#ifndef DRIVER_GPIO_LINUX_H_
+#define DRIVER_GPIO_LINUX_H_
+
+#include "Driver_GPIO.h"
+
+// Ports: X(n, path) defines Driver_GPIOn on the gpiochip at path.
+#ifndef ARM_GPIO_LINUX_CHIPS
+#define ARM_GPIO_LINUX_CHIPS(X)     \
+    X(0, "/dev/gpiochip0")
+#endif
+
+// Consumer name of the requested lines, as shown by gpioinfo.
+#ifndef ARM_GPIO_LINUX_CONSUMER
+#define ARM_GPIO_LINUX_CONSUMER     "ARM_GPIO"
+#endif
+
+// Edge events read by one read() of the event thread.
+#ifndef ARM_GPIO_LINUX_EVENT_BATCH
+#define ARM_GPIO_LINUX_EVENT_BATCH  16
+#endif
+
+#endif /* DRIVER_GPIO_LINUX_H_ */
@@ -16,9 +16,15 @@
  * limitations under the License.
  */
 
-#include "Driver_GPIO.h"
+#include "Driver_GPIO_NXP_K66.h"
+#include "Driver_PORT_Clock_NXP_K66.h"
+#if ARM_GPIO_RECORD
+#include "Driver_GPIO_NXP_K66_Record.h"
+#endif
+#if ARM_GPIO_WAIT
+#include "Driver_GPIO_NXP_K66_Wait.h"
+#endif
 
-#include <MK66F18.h>
 #include <intrinsics.h>
 
 #define ARM_GPIO_DRV_VERSION    ARM_DRIVER_VERSION_MAJOR_MINOR(0, 0)  /* driver version */
@@ -36,11 +42,11 @@ static const ARM_GPIO_CAPABILITIES DriverCapabilities = {
     1, /* supports both edges interrupts */
     1, /* supports level-1 sensitive interrupts */
     1, /* supports level-0 sensitive interrupts */
-    1, /* supports pull-up register on a pin */
-    1, /* supports pull-down register on a pin */
-    1, /* supports configuration of speed */
-    1, /* supports open-drain on a pin */
-    1  /* supports configuration of drive strength on a pin */
+    ARM_GPIO_DEVICE_PULL,           /* supports pull-up register on a pin */
+    ARM_GPIO_DEVICE_PULL,           /* supports pull-down register on a pin */
+    ARM_GPIO_DEVICE_SLEW_RATE,      /* supports configuration of speed */
+    ARM_GPIO_DEVICE_OPEN_DRAIN,     /* supports open-drain on a pin */
+    ARM_GPIO_DEVICE_DRIVE_STRENGTH  /* supports configuration of drive strength on a pin */
 };
 
 //
@@ -48,308 +54,743 @@ static const ARM_GPIO_CAPABILITIES DriverCapabilities = {
 //
 
 ////////////////////////////////////////////////////////////////////////////////
-ARM_DRIVER_VERSION 	ARM_GPIO_GetVersion_Shared(void) { return DriverVersion; }
-
-ARM_DRIVER_VERSION 	ARM_GPIO_GetVersion_0(void) { return ARM_GPIO_GetVersion_Shared(); }
-ARM_DRIVER_VERSION 	ARM_GPIO_GetVersion_1(void) { return ARM_GPIO_GetVersion_Shared(); }
-ARM_DRIVER_VERSION 	ARM_GPIO_GetVersion_2(void) { return ARM_GPIO_GetVersion_Shared(); }
-ARM_DRIVER_VERSION 	ARM_GPIO_GetVersion_3(void) { return ARM_GPIO_GetVersion_Shared(); }
-ARM_DRIVER_VERSION 	ARM_GPIO_GetVersion_4(void) { return ARM_GPIO_GetVersion_Shared(); }
+// Same for all ports: shared by all driver instances.
+static ARM_DRIVER_VERSION    ARM_GPIO_GetVersion(void)      { return DriverVersion; }
+static ARM_GPIO_CAPABILITIES ARM_GPIO_GetCapabilities(void) { return DriverCapabilities; }
 
 ////////////////////////////////////////////////////////////////////////////////
-ARM_GPIO_CAPABILITIES 	ARM_GPIO_GetCapabilities_Shared(void) { return DriverCapabilities; }
 
-ARM_GPIO_CAPABILITIES 	ARM_GPIO_GetCapabilities_0(void) { return ARM_GPIO_GetCapabilities_Shared(); }
-ARM_GPIO_CAPABILITIES 	ARM_GPIO_GetCapabilities_1(void) { return ARM_GPIO_GetCapabilities_Shared(); }
-ARM_GPIO_CAPABILITIES 	ARM_GPIO_GetCapabilities_2(void) { return ARM_GPIO_GetCapabilities_Shared(); }
-ARM_GPIO_CAPABILITIES 	ARM_GPIO_GetCapabilities_3(void) { return ARM_GPIO_GetCapabilities_Shared(); }
-ARM_GPIO_CAPABILITIES 	ARM_GPIO_GetCapabilities_4(void) { return ARM_GPIO_GetCapabilities_Shared(); }
+#if ARM_GPIO_ISR_STATS
+static inline uint32_t bit_count(uint32_t mask)
+{
+    uint32_t n = 0;
+    for (; mask; mask &= mask - 1)
+        n++;
+    return n;
+}
 
-////////////////////////////////////////////////////////////////////////////////
+// Runs in the port interrupt: other code only reads with interrupts masked.
+static void ARM_GPIO_UpdateIsrStatistics(ARM_GPIO_ISR_STATISTICS* isr, uint32_t isfr, uint32_t again, uint32_t cycles)
+{
+    isr->calls++;
+    if (!isfr)
+        isr->spurious++;
+    isr->events   += bit_count(isfr);
+    isr->overruns += bit_count(again);
+    isr->cycles   += cycles;
+    if (cycles > isr->cycles_max)
+        isr->cycles_max = cycles;
+}
 
-typedef void (*ISR)();
+int32_t ARM_GPIO_GetIsrStatistics(uint32_t port, ARM_GPIO_ISR_STATISTICS* stats, uint32_t reset)
+{
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    ARM_GPIO_ISR_STATISTICS* isr = &gpio_ports[port]->state->isr;
+    
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+    
+    *stats = *isr;
+    if (reset)
+    {
+        *isr = (ARM_GPIO_ISR_STATISTICS){ 0 };
+        isr->start = DWT_CYCCNT;
+    }
+    
+    __set_interrupt_state(istate);
+    
+    return ARM_DRIVER_OK;
+}
+#endif
 
-// placed in ROM
-typedef struct
+#if ARM_GPIO_ISR_HISTOGRAM
+// The handler fills histogram[histogram_active]; switching the index retires
+// the other one. The port handler runs to completion with respect to the
+// caller, so after the switch the retired histogram is not written anymore.
+int32_t ARM_GPIO_GetIsrHistogram(uint32_t port, ARM_GPIO_HISTOGRAM* histogram)
 {
-    const PORT_MemMapPtr    port;
-    const GPIO_MemMapPtr    gpio;
-    const uint32_t          irq_vector;
-    const ISR               irq_handler;
-} ARM_GPIO_CONFIG;
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    ARM_GPIO_STATE* state = gpio_ports[port]->state;
+    
+    const uint32_t retired = state->histogram_active;
+    state->histogram_active = retired ^ 1;
+    __DSB();
+    
+    *histogram = state->histogram[retired];
+    state->histogram[retired] = (ARM_GPIO_HISTOGRAM){ 0 };
+    
+    return ARM_DRIVER_OK;
+}
+#endif
 
-// placed in RAM
-typedef struct
+// Delivers port events: interrupt handler, LLWU wake-up, polling and replay of a record.
+void ARM_GPIO_DispatchEvents(const ARM_GPIO_CONFIG* cfg, uint32_t mask)
 {
-    ARM_GPIO_SignalEvent_t     signal;
-    ARM_GPIO_STATUS            status;
-} ARM_GPIO_STATE;
+#if ARM_GPIO_WAIT
+    // Edge of the event per IRQC: the level read now may have changed since.
+    ARM_GPIO_Wait_Signal(cfg->index, mask,
+                         ARM_GPIO_IrqcPins(cfg, mask, ARM_GPIO_IRQC_RISING),
+                         ARM_GPIO_IrqcPins(cfg, mask, ARM_GPIO_IRQC_FALLING));
+#endif
+    
+    // Call user handler, if it is configured.
+    // Argument = bitmask of active interrupts.
+    const ARM_GPIO_SignalEvent_t signal = cfg->state->signal;
+    if (signal)
+        (*signal)(mask);
+}
 
 // Will be called from IRQ handler.
-void gpio_shared_handler(const ARM_GPIO_CONFIG* cfg, ARM_GPIO_SignalEvent_t signal)
+void gpio_shared_handler(const ARM_GPIO_CONFIG* cfg)
 {
+#if ARM_GPIO_ISR_STATS || ARM_GPIO_ISR_HISTOGRAM
+    const uint32_t start = DWT_CYCCNT;
+#endif
+    
     // Clear interrupts.
     const uint32_t isfr = cfg->port->ISFR;
     cfg->port->ISFR = isfr;
     
-    // Call user handler, if it is configured.
-    // Argument = bitmask of active interrupts.
-    if (signal)
-        (*signal)(isfr);
+    ARM_GPIO_TRACE_EVENT(IRQ, cfg->index, isfr);
+    
+#if ARM_GPIO_RECORD
+    ARM_GPIO_Record_Event(cfg->index, isfr);
+#endif
+    
+    ARM_GPIO_DispatchEvents(cfg, isfr);
+    
+#if ARM_GPIO_ISR_STATS || ARM_GPIO_ISR_HISTOGRAM
+    const uint32_t cycles = DWT_CYCCNT - start;
+#endif
+#if ARM_GPIO_ISR_STATS
+    // Pins flagged again meanwhile: one more edge and the event is lost.
+    ARM_GPIO_UpdateIsrStatistics(&cfg->state->isr, isfr, cfg->port->ISFR & isfr, cycles);
+#endif
+#if ARM_GPIO_ISR_HISTOGRAM
+    ARM_GPIO_Histogram_Add(&cfg->state->histogram[cfg->state->histogram_active], cycles);
+#endif
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//   Register access: with ARM_GPIO_SHADOW_REGS configuration registers are
+//   read from RAM, hardware is only written.
+//
+//   Without shadow registers read-modify-write of PDDR and PCR masks
+//   interrupts: LDREX/STREX are for Normal memory, the exclusive monitor
+//   doesn't cover peripheral registers.
+//
+//   With shadow registers the new value is computed on the shadow with
+//   LDREX/STREX: exception entry and return clear the exclusive monitor, so
+//   STREX fails if an interrupt came between LDREX and STREX, and the update
+//   is redone on fresh value. The hardware is written after the STREX, by one
+//   context at a time (busy flag of the port), which copies the shadow until
+//   it saw no change: hardware values follow the order of the shadow and the
+//   last one is the current shadow. A context, which finds the flag taken,
+//   doesn't wait: the holder writes its change too, when it resumes.
 ////////////////////////////////////////////////////////////////////////////////
 
-void gpio_a_handler();
-void gpio_b_handler();
-void gpio_c_handler();
-void gpio_d_handler();
-void gpio_e_handler();
+// Single-parameter PCR helpers modify the value in place.
+typedef int32_t (*ARM_GPIO_PCR_MODIFIER)(uint32_t* pcr, uint32_t arg);
 
+uint32_t ARM_GPIO_IrqcPins(const ARM_GPIO_CONFIG* cfg, uint32_t mask, uint32_t irqc)
+{
+    uint32_t pins = 0;
+    for (uint32_t rest = mask & cfg->pins; rest; rest &= rest - 1)
+    {
+        const uint32_t pin = __CLZ(__RBIT(rest));
+        if (((ARM_GPIO_GetPCR(cfg, pin) & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT) == irqc)
+            pins |= (1u << pin);
+    }
+    
+    return pins;
+}
 
-const ARM_GPIO_CONFIG gpio_a = {
-    .port           = PORTA_BASE_PTR,
-    .gpio           = PTA_BASE_PTR,
-    .irq_vector     = INT_PORTE,
-    .irq_handler    = gpio_a_handler
-};
+#if ARM_GPIO_SHADOW_REGS
+// Busy flag of the hardware writer; 0: another context holds it.
+static inline uint32_t ARM_GPIO_TryAcquire(volatile uint32_t* busy)
+{
+    do
+    {
+        if (ARM_GPIO_LDREX(busy))
+            return __CLREX(), 0;
+    } while (ARM_GPIO_STREX(1, busy));
+    
+    __DMB();
+    return 1;
+}
 
-const ARM_GPIO_CONFIG gpio_b = {
-    .port           = PORTB_BASE_PTR,
-    .gpio           = PTB_BASE_PTR,
-    .irq_vector     = INT_PORTB,
-    .irq_handler    = gpio_b_handler
-};
+static inline void ARM_GPIO_ReleaseBusy(volatile uint32_t* busy)
+{
+    __DMB();
+    *busy = 0;
+    __DMB();
+}
 
-const ARM_GPIO_CONFIG gpio_c = {
-    .port           = PORTC_BASE_PTR,
-    .gpio           = PTC_BASE_PTR,
-    .irq_vector     = INT_PORTC,
-    .irq_handler    = gpio_c_handler
-};
+static void ARM_GPIO_PublishPDDR(const ARM_GPIO_CONFIG* cfg)
+{
+    ARM_GPIO_STATE* const state = cfg->state;
+    uint32_t pddr;
+    do
+    {
+        if (!ARM_GPIO_TryAcquire(&state->pddr_busy))
+            return;
+        
+        do
+        {
+            pddr = state->pddr;
+            cfg->gpio->PDDR = pddr;
+        } while (pddr != state->pddr);
+        
+        ARM_GPIO_ReleaseBusy(&state->pddr_busy);
+        // Changed after the check, before the release: its context found the flag taken.
+    } while (pddr != state->pddr);
+}
 
-const ARM_GPIO_CONFIG gpio_d = {
-    .port           = PORTD_BASE_PTR,
-    .gpio           = PTD_BASE_PTR,
-    .irq_vector     = INT_PORTD,
-    .irq_handler    = gpio_d_handler
-};
+// Marks the pins for the writer and writes all marked pins, each with its
+// current shadow.
+static void ARM_GPIO_PublishPCRs(const ARM_GPIO_CONFIG* cfg, uint32_t pins)
+{
+    ARM_GPIO_STATE* const state = cfg->state;
+    uint32_t dirty;
+    do
+    {
+        dirty = ARM_GPIO_LDREX(&state->pcr_dirty);
+    } while (ARM_GPIO_STREX(dirty | pins, &state->pcr_dirty));
+    
+    do
+    {
+        if (!ARM_GPIO_TryAcquire(&state->pcr_busy))
+            return;
+        
+        for (;;)
+        {
+            do
+            {
+                dirty = ARM_GPIO_LDREX(&state->pcr_dirty);
+            } while (ARM_GPIO_STREX(0, &state->pcr_dirty));
+            
+            if (!dirty)
+                break;
+            
+            for (; dirty; dirty &= dirty - 1)
+            {
+                const uint32_t pin = __CLZ(__RBIT(dirty));
+                cfg->port->PCR[pin] = state->pcr[pin];
+            }
+        }
+        
+        ARM_GPIO_ReleaseBusy(&state->pcr_busy);
+    } while (state->pcr_dirty);
+}
+#endif
 
-const ARM_GPIO_CONFIG gpio_e = {
-    .port           = PORTE_BASE_PTR,
-    .gpio           = PTE_BASE_PTR,
-    .irq_vector     = INT_PORTE,
-    .irq_handler    = gpio_e_handler
-};
+static inline void ARM_GPIO_SetPCR(const ARM_GPIO_CONFIG* cfg, uint32_t pin, uint32_t pcr)
+{
+#if ARM_GPIO_SHADOW_REGS
+    // A plain store breaks the reservation of a preempted LDREX/STREX as well.
+    cfg->state->pcr[pin] = pcr;
+    ARM_GPIO_PublishPCRs(cfg, 1u << pin);
+#else
+    cfg->port->PCR[pin] = pcr;
+#endif
+}
 
+// ISF is never written back: it is write-1-to-clear.
+// Locked pin ignores writes: ARM_DRIVER_ERROR.
+static int32_t ARM_GPIO_ModifyPCR(const ARM_GPIO_CONFIG* cfg, uint32_t pin, ARM_GPIO_PCR_MODIFIER modify, uint32_t arg)
+{
+#if ARM_GPIO_SHADOW_REGS
+    volatile uint32_t* const shadow = &cfg->state->pcr[pin];
+    uint32_t pcr;
+    do
+    {
+        pcr = ARM_GPIO_LDREX(shadow);
+        
+        if (pcr & PORT_PCR_LK_MASK)
+            return __CLREX(), ARM_DRIVER_ERROR;
+        
+        const int32_t status = modify(&pcr, arg);
+        if (status != ARM_DRIVER_OK)
+            return __CLREX(), status;
+    } while (ARM_GPIO_STREX(pcr, shadow));
+    
+    ARM_GPIO_PublishPCRs(cfg, 1u << pin);
+    return ARM_DRIVER_OK;
+#else
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+    
+    uint32_t pcr = cfg->port->PCR[pin] & ~PORT_PCR_ISF_MASK;
+    const int32_t status = (pcr & PORT_PCR_LK_MASK) ? ARM_DRIVER_ERROR : modify(&pcr, arg);
+    if (status == ARM_DRIVER_OK)
+        cfg->port->PCR[pin] = pcr;
+    
+    __set_interrupt_state(istate);
+    return status;
+#endif
+}
 
-ARM_GPIO_STATE state_a = { .signal = 0, .status = 0 };
-ARM_GPIO_STATE state_b = { .signal = 0, .status = 0 };
-ARM_GPIO_STATE state_c = { .signal = 0, .status = 0 };
-ARM_GPIO_STATE state_d = { .signal = 0, .status = 0 };
-ARM_GPIO_STATE state_e = { .signal = 0, .status = 0 };
+// PCR[15:0] of the pins := value, locked pins aside. Without shadow registers
+// one GPCLR/GPCHR store per port half, with them each pin is published.
+void ARM_GPIO_WritePCRGroup(const ARM_GPIO_CONFIG* cfg, uint32_t pins, uint32_t value)
+{
+#if ARM_GPIO_SHADOW_REGS
+    uint32_t written = 0;
+    for (uint32_t left = pins; left; left &= left - 1)
+    {
+        const uint32_t pin = __CLZ(__RBIT(left));
+        volatile uint32_t* const shadow = &cfg->state->pcr[pin];
+        uint32_t pcr;
+        do
+        {
+            pcr = ARM_GPIO_LDREX(shadow);
+            if (pcr & PORT_PCR_LK_MASK)
+            {
+                __CLREX();
+                break;
+            }
+            pcr = (pcr & 0xFFFF0000u) | value;
+        } while (ARM_GPIO_STREX(pcr, shadow));
+        
+        if (!(pcr & PORT_PCR_LK_MASK))
+            written |= (1u << pin);
+    }
+    ARM_GPIO_PublishPCRs(cfg, written);
+#else
+    if (pins & 0xFFFFu)
+        cfg->port->GPCLR = PORT_GPCLR_GPWE(pins & 0xFFFFu) | PORT_GPCLR_GPWD(value);
+    if (pins >> 16)
+        cfg->port->GPCHR = PORT_GPCHR_GPWE(pins >> 16) | PORT_GPCHR_GPWD(value);
+#endif
+}
 
-void gpio_a_handler() { gpio_shared_handler(&gpio_a, state_a.signal); }
-void gpio_b_handler() { gpio_shared_handler(&gpio_b, state_b.signal); }
-void gpio_c_handler() { gpio_shared_handler(&gpio_c, state_c.signal); }
-void gpio_d_handler() { gpio_shared_handler(&gpio_d, state_d.signal); }
-void gpio_e_handler() { gpio_shared_handler(&gpio_e, state_e.signal); }
+static inline uint32_t ARM_GPIO_GetPDDR(const ARM_GPIO_CONFIG* cfg)
+{
+#if ARM_GPIO_SHADOW_REGS
+    return cfg->state->pddr;
+#else
+    return cfg->gpio->PDDR;
+#endif
+}
+
+// PDDR = (PDDR & ~clear) | set
+void ARM_GPIO_ModifyPDDR(const ARM_GPIO_CONFIG* cfg, uint32_t clear, uint32_t set)
+{
+#if ARM_GPIO_SHADOW_REGS
+    volatile uint32_t* const shadow = &cfg->state->pddr;
+    uint32_t pddr;
+    do
+    {
+        pddr = (ARM_GPIO_LDREX(shadow) & ~clear) | set;
+    } while (ARM_GPIO_STREX(pddr, shadow));
+    
+    ARM_GPIO_PublishPDDR(cfg);
+#else
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+    
+    cfg->gpio->PDDR = (cfg->gpio->PDDR & ~clear) | set;
+    
+    __set_interrupt_state(istate);
+#endif
+}
+
+// Fill shadow registers from hardware. Port clock must be enabled.
+void ARM_GPIO_LoadShadow(const ARM_GPIO_CONFIG* cfg)
+{
+#if ARM_GPIO_SHADOW_REGS
+    for (uint32_t pin = 0; pin < 32; pin++)
+        cfg->state->pcr[pin] = cfg->port->PCR[pin] & ~PORT_PCR_ISF_MASK;
+    
+    cfg->state->pddr = cfg->gpio->PDDR;
+#endif
+}
 
 ////////////////////////////////////////////////////////////////////////////////
+int32_t ARM_GPIO_PowerControl_Shared(ARM_POWER_STATE state, const ARM_GPIO_CONFIG* cfg, uint32_t port);
+
+// The port is powered from Initialize to Uninitialize, as before the clock
+// was reference-counted: code, which never calls PowerControl, still works.
 int32_t ARM_GPIO_Initialize_Shared(const ARM_GPIO_CONFIG* port)
 {
-    ((uint32_t*)(SCB_VTOR))[port->irq_vector] = (uint32_t)port->irq_handler;
+    ((uintptr_t*)(SCB_VTOR))[port->irq_vector] = (uintptr_t)port->irq_handler;
     __DSB();
-    return ARM_DRIVER_OK;
+    
+#if ARM_GPIO_ISR_STATS || ARM_GPIO_ISR_HISTOGRAM
+    ARM_GPIO_CycleCounterStart();
+#endif
+#if ARM_GPIO_ISR_STATS
+    port->state->isr.start = DWT_CYCCNT;
+#endif
+    return ARM_GPIO_PowerControl_Shared(ARM_POWER_FULL, port, port->index);
 }
 
-int32_t ARM_GPIO_Initialize_0(ARM_GPIO_SignalEvent_t cb_event) { return state_a.signal = cb_event, ARM_GPIO_Initialize_Shared(&gpio_a); }
-int32_t ARM_GPIO_Initialize_1(ARM_GPIO_SignalEvent_t cb_event) { return state_b.signal = cb_event, ARM_GPIO_Initialize_Shared(&gpio_b); }
-int32_t ARM_GPIO_Initialize_2(ARM_GPIO_SignalEvent_t cb_event) { return state_c.signal = cb_event, ARM_GPIO_Initialize_Shared(&gpio_c); }
-int32_t ARM_GPIO_Initialize_3(ARM_GPIO_SignalEvent_t cb_event) { return state_d.signal = cb_event, ARM_GPIO_Initialize_Shared(&gpio_d); }
-int32_t ARM_GPIO_Initialize_4(ARM_GPIO_SignalEvent_t cb_event) { return state_e.signal = cb_event, ARM_GPIO_Initialize_Shared(&gpio_e); }
 
 ////////////////////////////////////////////////////////////////////////////////
 int32_t ARM_GPIO_Uninitialize_Shared(const ARM_GPIO_CONFIG* cfg)
 {
-    return ARM_DRIVER_OK;
+    return ARM_GPIO_PowerControl_Shared(ARM_POWER_OFF, cfg, cfg->index);
 }
 
-int32_t ARM_GPIO_Uninitialize_0(void) { return ARM_GPIO_Uninitialize_Shared(&gpio_a); }
-int32_t ARM_GPIO_Uninitialize_1(void) { return ARM_GPIO_Uninitialize_Shared(&gpio_b); }
-int32_t ARM_GPIO_Uninitialize_2(void) { return ARM_GPIO_Uninitialize_Shared(&gpio_c); }
-int32_t ARM_GPIO_Uninitialize_3(void) { return ARM_GPIO_Uninitialize_Shared(&gpio_d); }
-int32_t ARM_GPIO_Uninitialize_4(void) { return ARM_GPIO_Uninitialize_Shared(&gpio_e); }
 
 ////////////////////////////////////////////////////////////////////////////////
-int32_t ARM_GPIO_PowerControl_Shared(ARM_POWER_STATE state, const ARM_GPIO_CONFIG* cfg, uint32_t sim_scgc5_mask)
+//   Low power: in LLS/VLLS port interrupts don't work, edges of the pins
+//   are detected by LLWU. On wake-up the event is passed to the port's
+//   ARM_GPIO_SignalEvent_t as if it came from the port interrupt.
+////////////////////////////////////////////////////////////////////////////////
+
+#define LLWU_PIN(port, pin)     (((ARM_GPIO_PORT_##port) << 5) | (pin))
+#define LLWU_PIN_NONE           0xFF
+
+static const uint8_t llwu_pins[ARM_GPIO_DEVICE_LLWU_PIN_COUNT] = {
+    ARM_GPIO_DEVICE_LLWU_PINS
+};
+
+static volatile uint8_t* const llwu_pe[] = { ARM_GPIO_DEVICE_LLWU_PE };
+static volatile uint8_t* const llwu_pf[] = { ARM_GPIO_DEVICE_LLWU_PF };
+
+// LLWU_PEn field values.
+#define LLWU_PE_DISABLED        0x0
+#define LLWU_PE_RISING          0x1
+#define LLWU_PE_FALLING         0x2
+#define LLWU_PE_ANY             0x3
+
+void gpio_llwu_handler()
 {
-    switch (state)
+    uint32_t flags = 0;
+    for (uint32_t i = 0; i < sizeof(llwu_pf) / sizeof(llwu_pf[0]); i++)
     {
-	// Most often ports should be always enabled because of other peripherals.
-	case ARM_POWER_OFF : /*SIM_SCGC5 &= ~sim_scgc5_mask;*/ break;
-	case ARM_POWER_FULL: /*SIM_SCGC5 |=  sim_scgc5_mask;*/ break;
-	
-	// POWER_LOW is unsupported
-	default: return ARM_DRIVER_ERROR_UNSUPPORTED;
+        const uint32_t pf = *llwu_pf[i];
+        *llwu_pf[i] = pf;
+        flags |= (pf << (i * 8));
+    }
+    
+    uint32_t events[ARM_GPIO_PORT_COUNT] = { 0 };
+    for (; flags; flags &= flags - 1)
+    {
+        const uint32_t llwu = llwu_pins[__CLZ(__RBIT(flags))];
+        if (llwu != LLWU_PIN_NONE)
+            events[llwu >> 5] |= (1u << (llwu & 31));
+    }
+    
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        if (!events[port])
+            continue;
+        
+        // The port may have latched the same edge after wake-up.
+        const ARM_GPIO_CONFIG* cfg = gpio_ports[port];
+        cfg->port->ISFR = events[port];
+        
+#if ARM_GPIO_RECORD
+        ARM_GPIO_Record_Event(port, events[port]);
+#endif
+        
+        ARM_GPIO_DispatchEvents(cfg, events[port]);
     }
-    return ARM_DRIVER_OK;
 }
 
-int32_t ARM_GPIO_PowerControl_0(ARM_POWER_STATE state) { return ARM_GPIO_PowerControl_Shared(state, &gpio_a, SIM_SCGC5_PORTA_MASK); }
-int32_t ARM_GPIO_PowerControl_1(ARM_POWER_STATE state) { return ARM_GPIO_PowerControl_Shared(state, &gpio_b, SIM_SCGC5_PORTB_MASK); }
-int32_t ARM_GPIO_PowerControl_2(ARM_POWER_STATE state) { return ARM_GPIO_PowerControl_Shared(state, &gpio_c, SIM_SCGC5_PORTC_MASK); }
-int32_t ARM_GPIO_PowerControl_3(ARM_POWER_STATE state) { return ARM_GPIO_PowerControl_Shared(state, &gpio_d, SIM_SCGC5_PORTD_MASK); }
-int32_t ARM_GPIO_PowerControl_4(ARM_POWER_STATE state) { return ARM_GPIO_PowerControl_Shared(state, &gpio_e, SIM_SCGC5_PORTE_MASK); }
-
-////////////////////////////////////////////////////////////////////////////////
-int32_t ARM_GPIO_Control_Shared(uint32_t control, uint32_t arg, const ARM_GPIO_CONFIG* cfg)
+// Route pins of the port with edge interrupts to LLWU.
+void ARM_GPIO_WakeupEnable(const ARM_GPIO_CONFIG* cfg)
 {
-    switch (control)
+    uint32_t wakeup = 0;
+    
+    for (uint32_t i = 0; i < ARM_GPIO_DEVICE_LLWU_PIN_COUNT; i++)
     {
-        default: return ARM_DRIVER_ERROR_UNSUPPORTED;
+        const uint32_t llwu = llwu_pins[i];
+        if (llwu == LLWU_PIN_NONE || gpio_ports[llwu >> 5] != cfg)
+            continue;
+        
+        uint32_t pe;
+        switch ((ARM_GPIO_GetPCR(cfg, llwu & 31) & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT)
+        {
+            case ARM_GPIO_IRQC_RISING:  pe = LLWU_PE_RISING;  break;
+            case ARM_GPIO_IRQC_FALLING: pe = LLWU_PE_FALLING; break;
+            case ARM_GPIO_IRQC_EITHER:  pe = LLWU_PE_ANY;     break;
+            
+            // Level interrupts and DMA requests can't wake up the core;
+            // a pin routed before must not stay enabled.
+            default:  pe = LLWU_PE_DISABLED; break;
+        }
+        
+        const uint32_t shift = (i & 3) * 2;
+        *llwu_pe[i >> 2] = (*llwu_pe[i >> 2] & ~(0x3u << shift)) | (pe << shift);
+        if (pe != LLWU_PE_DISABLED)
+            wakeup |= (1u << (llwu & 31));
+    }
+    
+    if (wakeup)
+    {
+        ((uintptr_t*)(SCB_VTOR))[INT_LLWU] = (uintptr_t)gpio_llwu_handler;
+        __DSB();
+        NVIC_ISER((INT_LLWU - 16) >> 5) = (1 << ((INT_LLWU - 16) & 0x1F));
     }
-//    return ARM_DRIVER_OK;
+    
+    cfg->state->wakeup = wakeup;
 }
 
-int32_t ARM_GPIO_Control_0(uint32_t control, uint32_t arg) { return ARM_GPIO_Control_Shared(control, arg, &gpio_a); }
-int32_t ARM_GPIO_Control_1(uint32_t control, uint32_t arg) { return ARM_GPIO_Control_Shared(control, arg, &gpio_b); }
-int32_t ARM_GPIO_Control_2(uint32_t control, uint32_t arg) { return ARM_GPIO_Control_Shared(control, arg, &gpio_c); }
-int32_t ARM_GPIO_Control_3(uint32_t control, uint32_t arg) { return ARM_GPIO_Control_Shared(control, arg, &gpio_d); }
-int32_t ARM_GPIO_Control_4(uint32_t control, uint32_t arg) { return ARM_GPIO_Control_Shared(control, arg, &gpio_e); }
+void ARM_GPIO_WakeupDisable(const ARM_GPIO_CONFIG* cfg)
+{
+    if (!cfg->state->wakeup)
+        return;
+    
+    for (uint32_t i = 0; i < ARM_GPIO_DEVICE_LLWU_PIN_COUNT; i++)
+    {
+        const uint32_t llwu = llwu_pins[i];
+        if (llwu == LLWU_PIN_NONE || gpio_ports[llwu >> 5] != cfg)
+            continue;
+        
+        *llwu_pe[i >> 2] &= ~(0x3u << ((i & 3) * 2));
+    }
+    
+    cfg->state->wakeup = 0;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
-ARM_GPIO_STATUS ARM_GPIO_GetStatus_0(void) { return state_a.status; }
-ARM_GPIO_STATUS ARM_GPIO_GetStatus_1(void) { return state_b.status; }
-ARM_GPIO_STATUS ARM_GPIO_GetStatus_2(void) { return state_c.status; }
-ARM_GPIO_STATUS ARM_GPIO_GetStatus_3(void) { return state_d.status; }
-ARM_GPIO_STATUS ARM_GPIO_GetStatus_4(void) { return state_e.status; }
+// ARM_POWER_LOW only prepares wake-up sources and keeps pin state;
+// entering LLS/VLLS (SMC) is up to the application.
+// Port clock is shared with other peripherals: the driver holds one reference
+// to it while it is not in ARM_POWER_OFF (Initialize powers the port).
+int32_t ARM_GPIO_PowerControl_Shared(ARM_POWER_STATE state, const ARM_GPIO_CONFIG* cfg, uint32_t port)
+{
+    const ARM_POWER_STATE prev = cfg->state->power;
+    
+    switch (state)
+    {
+        case ARM_POWER_OFF:
+            if (prev == ARM_POWER_OFF)
+                break;
+            ARM_GPIO_WakeupDisable(cfg);
+            ARM_PORT_ClockRelease(port);
+            break;
+        
+        case ARM_POWER_FULL:
+            if (prev == ARM_POWER_OFF)
+            {
+                if (ARM_PORT_ClockAcquire(port) != ARM_DRIVER_OK)
+                    return ARM_DRIVER_ERROR;
+                
+                // Registers are retained in ARM_POWER_LOW.
+                ARM_GPIO_LoadShadow(cfg);
+            }
+            ARM_GPIO_WakeupDisable(cfg);
+            break;
+        
+        case ARM_POWER_LOW:
+            if (prev == ARM_POWER_OFF)
+                return ARM_DRIVER_ERROR;
+            ARM_GPIO_WakeupEnable(cfg);
+            break;
+        
+        default: return ARM_DRIVER_ERROR_UNSUPPORTED;
+    }
+    
+    cfg->state->power = state;
+    return ARM_DRIVER_OK;
+}
 
+#if ARM_GPIO_OWNERSHIP
 ////////////////////////////////////////////////////////////////////////////////
+//   Pin ownership
+//
+//   The bitmap is updated by LDREX/STREX (compare-and-swap), owner ids are
+//   written by the claimer only: after its claim succeeded and before its
+//   release clears the bits. A pin being claimed or released reads as owned
+//   by nobody (0), so no other caller passes the check meanwhile.
 ////////////////////////////////////////////////////////////////////////////////
-void ARM_GPIO_SetPort_0(uint32_t mask) { gpio_a.gpio->PSOR = mask; }
-void ARM_GPIO_SetPort_1(uint32_t mask) { gpio_b.gpio->PSOR = mask; }
-void ARM_GPIO_SetPort_2(uint32_t mask) { gpio_c.gpio->PSOR = mask; }
-void ARM_GPIO_SetPort_3(uint32_t mask) { gpio_d.gpio->PSOR = mask; }
-void ARM_GPIO_SetPort_4(uint32_t mask) { gpio_e.gpio->PSOR = mask; }
-////////////////////////////////////////////////////////////////////////////////
-void ARM_GPIO_ClearPort_0(uint32_t mask) { gpio_a.gpio->PCOR = mask; }
-void ARM_GPIO_ClearPort_1(uint32_t mask) { gpio_b.gpio->PCOR = mask; }
-void ARM_GPIO_ClearPort_2(uint32_t mask) { gpio_c.gpio->PCOR = mask; }
-void ARM_GPIO_ClearPort_3(uint32_t mask) { gpio_d.gpio->PCOR = mask; }
-void ARM_GPIO_ClearPort_4(uint32_t mask) { gpio_e.gpio->PCOR = mask; }
-////////////////////////////////////////////////////////////////////////////////
-void ARM_GPIO_TogglePort_0(uint32_t mask) { gpio_a.gpio->PTOR = mask; }
-void ARM_GPIO_TogglePort_1(uint32_t mask) { gpio_b.gpio->PTOR = mask; }
-void ARM_GPIO_TogglePort_2(uint32_t mask) { gpio_c.gpio->PTOR = mask; }
-void ARM_GPIO_TogglePort_3(uint32_t mask) { gpio_d.gpio->PTOR = mask; }
-void ARM_GPIO_TogglePort_4(uint32_t mask) { gpio_e.gpio->PTOR = mask; }
-////////////////////////////////////////////////////////////////////////////////
-void ARM_GPIO_WritePort_0(uint32_t values) { gpio_a.gpio->PDOR = values; }
-void ARM_GPIO_WritePort_1(uint32_t values) { gpio_b.gpio->PDOR = values; }
-void ARM_GPIO_WritePort_2(uint32_t values) { gpio_c.gpio->PDOR = values; }
-void ARM_GPIO_WritePort_3(uint32_t values) { gpio_d.gpio->PDOR = values; }
-void ARM_GPIO_WritePort_4(uint32_t values) { gpio_e.gpio->PDOR = values; }
-////////////////////////////////////////////////////////////////////////////////
-uint32_t ARM_GPIO_ReadPort_0() { return gpio_a.gpio->PDIR; }
-uint32_t ARM_GPIO_ReadPort_1() { return gpio_b.gpio->PDIR; }
-uint32_t ARM_GPIO_ReadPort_2() { return gpio_c.gpio->PDIR; }
-uint32_t ARM_GPIO_ReadPort_3() { return gpio_d.gpio->PDIR; }
-uint32_t ARM_GPIO_ReadPort_4() { return gpio_e.gpio->PDIR; }
-////////////////////////////////////////////////////////////////////////////////
-uint32_t ARM_GPIO_GetPortEvents_0() { return gpio_a.port->ISFR; }
-uint32_t ARM_GPIO_GetPortEvents_1() { return gpio_b.port->ISFR; }
-uint32_t ARM_GPIO_GetPortEvents_2() { return gpio_c.port->ISFR; }
-uint32_t ARM_GPIO_GetPortEvents_3() { return gpio_d.port->ISFR; }
-uint32_t ARM_GPIO_GetPortEvents_4() { return gpio_e.port->ISFR; }
-////////////////////////////////////////////////////////////////////////////////
-void ARM_GPIO_ClearPortEvents_0(uint32_t mask) { gpio_a.port->ISFR = mask; }
-void ARM_GPIO_ClearPortEvents_1(uint32_t mask) { gpio_b.port->ISFR = mask; }
-void ARM_GPIO_ClearPortEvents_2(uint32_t mask) { gpio_c.port->ISFR = mask; }
-void ARM_GPIO_ClearPortEvents_3(uint32_t mask) { gpio_d.port->ISFR = mask; }
-void ARM_GPIO_ClearPortEvents_4(uint32_t mask) { gpio_e.port->ISFR = mask; }
-////////////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////////////
-int32_t ARM_GPIO_ControlPin_Config(const ARM_GPIO_CONFIG* cfg, uint32_t pin, uint32_t arg)
+
+int32_t ARM_GPIO_Claim(uint32_t port, uint32_t mask)
 {
-    uint32_t pcr = 0;
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
     
-    if (arg & ARM_GPIO_PIN_CFG_ENABLED)
-        pcr |= PORT_PCR_MUX(1);
-	
-    uint32_t tmp = (arg & ARM_GPIO_PIN_CFG_IRQ_Msk) >> ARM_GPIO_PIN_CFG_IRQ_Pos;
-    switch (tmp)
+    ARM_GPIO_STATE* state = gpio_ports[port]->state;
+    const uint32_t owner = ARM_GPIO_OWNER_CURRENT();
+    
+    volatile uint32_t* const owned = &state->owned;
+    uint32_t value;
+    do
     {
-        case ARM_GPIO_PIN_IRQ_NONE:        tmp = 0x0; break;
-        case ARM_GPIO_PIN_IRQ_RISING:      tmp = 0x9; break;
-        case ARM_GPIO_PIN_IRQ_FALLING:     tmp = 0xA; break;
-        case ARM_GPIO_PIN_IRQ_BOTH:        tmp = 0xB; break;
-        case ARM_GPIO_PIN_IRQ_LEVEL_HIGH:  tmp = 0xC; break;
-        case ARM_GPIO_PIN_IRQ_LEVEL_LOW:   tmp = 0x8; break;
-        
-        default: return ARM_DRIVER_ERROR_PARAMETER;
-    }
-    pcr |= PORT_PCR_IRQC(tmp);
+        value = ARM_GPIO_LDREX(owned);
+        if (value & mask)
+        {
+            __CLREX();
+            return ARM_DRIVER_ERROR_BUSY;
+        }
+    } while (ARM_GPIO_STREX(value | mask, owned));
     
-    tmp = (arg & ARM_GPIO_PIN_CFG_PULL_Msk) >> ARM_GPIO_PIN_CFG_PULL_Pos;
-    switch (tmp)
+    for (; mask; mask &= mask - 1)
+        state->owner[__CLZ(__RBIT(mask))] = owner;
+    
+    return ARM_DRIVER_OK;
+}
+
+int32_t ARM_GPIO_Release(uint32_t port, uint32_t mask)
+{
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    ARM_GPIO_STATE* state = gpio_ports[port]->state;
+    const uint32_t owner = ARM_GPIO_OWNER_CURRENT();
+    
+    if ((state->owned & mask) != mask)
+        return ARM_DRIVER_ERROR;
+    for (uint32_t left = mask; left; left &= left - 1)
     {
-        case ARM_GPIO_PIN_PULL_NONE: break;
-        case ARM_GPIO_PIN_PULL_UP:   pcr |= (PORT_PCR_PE_MASK | PORT_PCR_PS_MASK); break;
-        case ARM_GPIO_PIN_PULL_DOWN: pcr |= PORT_PCR_PE_MASK; break;
-        
-        default: return ARM_DRIVER_ERROR_PARAMETER;
+        if (state->owner[__CLZ(__RBIT(left))] != owner)
+            return ARM_DRIVER_ERROR;
     }
     
-    tmp = (arg & ARM_GPIO_PIN_CFG_SPEED_Msk) >> ARM_GPIO_PIN_CFG_SPEED_Pos;
-    switch (tmp)
+    for (uint32_t left = mask; left; left &= left - 1)
+        state->owner[__CLZ(__RBIT(left))] = 0;
+    
+    volatile uint32_t* const owned = &state->owned;
+    uint32_t value;
+    do
     {
-        case ARM_GPIO_PIN_SPEED_LOW:
-        case ARM_GPIO_PIN_SPEED_MEDIUM:
-            pcr |= PORT_PCR_SRE_MASK;
-            break;
-        
-        case ARM_GPIO_PIN_SPEED_HIGH:
-        case ARM_GPIO_PIN_SPEED_VERY_HIGH:
-            break;
-        
-        default: return ARM_DRIVER_ERROR_PARAMETER;
+        value = ARM_GPIO_LDREX(owned);
+    } while (ARM_GPIO_STREX(value & ~mask, owned));
+    
+    return ARM_DRIVER_OK;
+}
+
+uint32_t ARM_GPIO_IsOwner(const ARM_GPIO_CONFIG* cfg, uint32_t mask)
+{
+    const uint32_t owner = ARM_GPIO_OWNER_CURRENT();
+    
+    for (uint32_t claimed = mask & cfg->state->owned; claimed; claimed &= claimed - 1)
+    {
+        if (cfg->state->owner[__CLZ(__RBIT(claimed))] != owner)
+            return 0;
     }
+    return 1;
+}
+
+void ARM_GPIO_OwnershipFault(uint32_t port, uint32_t mask)
+{
+    for (;;);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+void    ARM_GPIO_WritePCRs(const ARM_GPIO_CONFIG* cfg, const uint32_t* pcr, uint32_t mask);
+
+int32_t ARM_GPIO_Control_Lock(uint32_t* pcr, uint32_t arg)
+{
+    *pcr |= PORT_PCR_LK_MASK;
+    return ARM_DRIVER_OK;
+}
+
+int32_t ARM_GPIO_Control_DefaultConfig(const ARM_GPIO_CONFIG* cfg, uint32_t arg)
+{
+    uint32_t value;
+    const int32_t status = ARM_GPIO_EncodeConfig(arg, &value);
+    if (status != ARM_DRIVER_OK)
+        return status;
     
-    if (arg & ARM_GPIO_PIN_CFG_OPEN_DRAIN)
-        pcr |= PORT_PCR_ODE_MASK;
+    // Pins without high drive keep DSE clear, as the hardware does.
+    uint32_t pcr[32];
+    uint32_t unlocked = 0;
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        pcr[pin] = (cfg->high_drive & (1u << pin)) ? value : value & ~PORT_PCR_DSE_MASK;
+        if ((cfg->pins & (1u << pin)) && !(ARM_GPIO_GetPCR(cfg, pin) & PORT_PCR_LK_MASK))
+            unlocked |= (1u << pin);
+    }
     
-    if (arg & ARM_GPIO_PIN_CFG_DRIVE_STRENGTH)
-        pcr |= PORT_PCR_DSE_MASK;
+#if ARM_GPIO_OWNERSHIP
+    // Pins of other owners are left as they are.
+    for (uint32_t claimed = unlocked & cfg->state->owned; claimed; claimed &= claimed - 1)
+    {
+        const uint32_t bit = claimed & -claimed;
+        if (!ARM_GPIO_IsOwner(cfg, bit))
+            unlocked &= ~bit;
+    }
+#endif
     
-    cfg->port->PCR[pin] = pcr;
+    ARM_GPIO_WritePCRs(cfg, pcr, unlocked);
     
-    // Set direction.
     if (arg & ARM_GPIO_PIN_CFG_OUTPUT)
-        cfg->gpio->PDDR |=  (1u << pin);
+        ARM_GPIO_ModifyPDDR(cfg, 0, unlocked);
     else
-        cfg->gpio->PDDR &= ~(1u << pin);
+        ARM_GPIO_ModifyPDDR(cfg, unlocked, 0);
     
     return ARM_DRIVER_OK;
 }
 
-int32_t ARM_GPIO_ControlPin_State(volatile uint32_t* pcr, uint32_t arg)
+int32_t ARM_GPIO_Control_Shared(uint32_t control, uint32_t arg, const ARM_GPIO_CONFIG* cfg)
 {
-    switch (arg)
+    // NVIC numbering of the port's interrupt.
+    const uint32_t irq = cfg->irq_vector - 16;
+    
+    switch (control)
     {
-        case ARM_GPIO_PIN_STATE_DISABLE: *pcr &= ~PORT_PCR_MUX_MASK;                           return ARM_DRIVER_OK;
-        case ARM_GPIO_PIN_STATE_ENABLE:  *pcr = (*pcr & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1); return ARM_DRIVER_OK;
+        case ARM_GPIO_CONTROL_IRQ:
+            if (arg)
+            {
+                NVIC_ISER(irq >> 5) = (1u << (irq & 0x1F));
+            }
+            else
+            {
+                NVIC_ICER(irq >> 5) = (1u << (irq & 0x1F));
+                __DSB();
+                __ISB();
+            }
+            return ARM_DRIVER_OK;
+        
+        case ARM_GPIO_CONTROL_IRQ_PRIORITY:
+            if (arg >= (1u << ARM_GPIO_DEVICE_NVIC_PRIO_BITS))
+                return ARM_DRIVER_ERROR_PARAMETER;
+            NVIC_IP(irq) = arg << (8 - ARM_GPIO_DEVICE_NVIC_PRIO_BITS);
+            return ARM_DRIVER_OK;
+        
+        case ARM_GPIO_CONTROL_LOCK:
+        case ARM_GPIO_CONTROL_DEFAULT_CFG:
+        case ARM_GPIO_CONTROL_CLEAR_EVENTS:
+            break;
+        
+        default: return ARM_DRIVER_ERROR_PARAMETER;
+    }
+    
+    // Commands below access the port: its clock may be gated.
+    if (cfg->state->power == ARM_POWER_OFF)
+        return ARM_DRIVER_ERROR;
+    
+    switch (control)
+    {
+        case ARM_GPIO_CONTROL_LOCK:
+#if ARM_GPIO_OWNERSHIP
+            if (!ARM_GPIO_IsOwner(cfg, arg))
+                return ARM_DRIVER_ERROR_BUSY;
+#endif
+            // Already locked pins are skipped.
+            for (arg &= cfg->pins; arg; arg &= arg - 1)
+                ARM_GPIO_ModifyPCR(cfg, __CLZ(__RBIT(arg)), ARM_GPIO_Control_Lock, 0);
+            return ARM_DRIVER_OK;
+        
+        case ARM_GPIO_CONTROL_DEFAULT_CFG:
+            return ARM_GPIO_Control_DefaultConfig(cfg, arg);
+        
+        case ARM_GPIO_CONTROL_CLEAR_EVENTS:
+            cfg->port->ISFR = 0xFFFFFFFFu;
+            return ARM_DRIVER_OK;
         
         default: return ARM_DRIVER_ERROR_PARAMETER;
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
 int32_t ARM_GPIO_ControlPin_Direction(const ARM_GPIO_CONFIG* cfg, uint32_t pin, uint32_t arg)
 {
     switch (arg)
     {
-        case ARM_GPIO_PIN_DIRECTION_INPUT:  cfg->gpio->PDDR &= ~(1u << pin); break;
-        case ARM_GPIO_PIN_DIRECTION_OUTPUT: cfg->gpio->PDDR |=  (1u << pin); break;
+        case ARM_GPIO_PIN_DIRECTION_INPUT:  ARM_GPIO_ModifyPDDR(cfg, (1u << pin), 0); break;
+        case ARM_GPIO_PIN_DIRECTION_OUTPUT: ARM_GPIO_ModifyPDDR(cfg, 0, (1u << pin)); break;
         
         default: return ARM_DRIVER_ERROR_PARAMETER;
     }
@@ -357,17 +798,28 @@ int32_t ARM_GPIO_ControlPin_Direction(const ARM_GPIO_CONFIG* cfg, uint32_t pin,
     return ARM_DRIVER_OK;
 }
 
-int32_t ARM_GPIO_ControlPin_IRQ(volatile uint32_t* pcr, uint32_t arg)
+int32_t ARM_GPIO_ControlPin_State(uint32_t* pcr, uint32_t arg)
+{
+    switch (arg)
+    {
+        case ARM_GPIO_PIN_STATE_DISABLE: *pcr &= ~PORT_PCR_MUX_MASK;                           return ARM_DRIVER_OK;
+        case ARM_GPIO_PIN_STATE_ENABLE:  *pcr = (*pcr & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1); return ARM_DRIVER_OK;
+        
+        default: return ARM_DRIVER_ERROR_PARAMETER;
+    }
+}
+
+int32_t ARM_GPIO_ControlPin_IRQ(uint32_t* pcr, uint32_t arg)
 {
     uint32_t irq;
     switch (arg)
     {
-        case ARM_GPIO_PIN_IRQ_NONE:        irq = 0x0; break;
-        case ARM_GPIO_PIN_IRQ_RISING:      irq = 0x9; break;
-        case ARM_GPIO_PIN_IRQ_FALLING:     irq = 0xA; break;
-        case ARM_GPIO_PIN_IRQ_BOTH:        irq = 0xB; break;
-        case ARM_GPIO_PIN_IRQ_LEVEL_HIGH:  irq = 0xC; break;
-        case ARM_GPIO_PIN_IRQ_LEVEL_LOW:   irq = 0x8; break;
+        case ARM_GPIO_PIN_IRQ_NONE:        irq = ARM_GPIO_IRQC_NONE; break;
+        case ARM_GPIO_PIN_IRQ_RISING:      irq = ARM_GPIO_IRQC_RISING; break;
+        case ARM_GPIO_PIN_IRQ_FALLING:     irq = ARM_GPIO_IRQC_FALLING; break;
+        case ARM_GPIO_PIN_IRQ_BOTH:        irq = ARM_GPIO_IRQC_EITHER; break;
+        case ARM_GPIO_PIN_IRQ_LEVEL_HIGH:  irq = ARM_GPIO_IRQC_LEVEL_HIGH; break;
+        case ARM_GPIO_PIN_IRQ_LEVEL_LOW:   irq = ARM_GPIO_IRQC_LEVEL_LOW; break;
         
         default: return ARM_DRIVER_ERROR_PARAMETER;
     }
@@ -377,11 +829,12 @@ int32_t ARM_GPIO_ControlPin_IRQ(volatile uint32_t* pcr, uint32_t arg)
 }
 
 
-int32_t ARM_GPIO_ControlPin_Pull(volatile uint32_t* pcr, uint32_t arg)
+#if ARM_GPIO_DEVICE_PULL
+int32_t ARM_GPIO_ControlPin_Pull(uint32_t* pcr, uint32_t arg)
 {
     switch (arg)
     {
-        case ARM_GPIO_PIN_PULL_NONE: *pcr &= ~PORT_PCR_PE_MASK;                            break;
+        case ARM_GPIO_PIN_PULL_NONE: *pcr &= ~(PORT_PCR_PE_MASK | PORT_PCR_PS_MASK);       break;
         case ARM_GPIO_PIN_PULL_UP:   *pcr |= (PORT_PCR_PE_MASK | PORT_PCR_PS_MASK);        break;
         case ARM_GPIO_PIN_PULL_DOWN: *pcr = (*pcr & ~PORT_PCR_PS_MASK) | PORT_PCR_PE_MASK; break;
         
@@ -389,8 +842,10 @@ int32_t ARM_GPIO_ControlPin_Pull(volatile uint32_t* pcr, uint32_t arg)
     }
     return ARM_DRIVER_OK;
 }
+#endif
 
-int32_t ARM_GPIO_ControlPin_Speed(volatile uint32_t* pcr, uint32_t arg)
+#if ARM_GPIO_DEVICE_SLEW_RATE
+int32_t ARM_GPIO_ControlPin_Speed(uint32_t* pcr, uint32_t arg)
 {
     switch (arg)
     {
@@ -408,8 +863,10 @@ int32_t ARM_GPIO_ControlPin_Speed(volatile uint32_t* pcr, uint32_t arg)
     }
     return ARM_DRIVER_OK;
 }
+#endif
 
-int32_t ARM_GPIO_ControlPin_OpenDrain(volatile uint32_t* pcr, uint32_t arg)
+#if ARM_GPIO_DEVICE_OPEN_DRAIN
+int32_t ARM_GPIO_ControlPin_OpenDrain(uint32_t* pcr, uint32_t arg)
 {
     switch (arg)
     {
@@ -419,8 +876,10 @@ int32_t ARM_GPIO_ControlPin_OpenDrain(volatile uint32_t* pcr, uint32_t arg)
         default: return ARM_DRIVER_ERROR_PARAMETER;
     }
 }
+#endif
 
-int32_t ARM_GPIO_ControlPin_DriveStrength(volatile uint32_t* pcr, uint32_t arg)
+#if ARM_GPIO_DEVICE_DRIVE_STRENGTH
+int32_t ARM_GPIO_ControlPin_DriveStrength(uint32_t* pcr, uint32_t arg)
 {
     switch (arg)
     {
@@ -430,195 +889,381 @@ int32_t ARM_GPIO_ControlPin_DriveStrength(volatile uint32_t* pcr, uint32_t arg)
         default: return ARM_DRIVER_ERROR_PARAMETER;
     }
 }
+#endif
+
+// Built from the same field helpers as the single ControlPin commands,
+// so ARM_GPIO_PIN_CFG and a sequence of single commands give the same PCR.
+int32_t ARM_GPIO_EncodeConfig(uint32_t arg, uint32_t* value)
+{
+    if (arg & ~ARM_GPIO_PIN_CFG_Msk)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    uint32_t pcr = 0;
+    int32_t status;
+    
+#define ARM_GPIO_ENCODE_FIELD(helper, field)                                        \
+    if ((status = helper(&pcr, (arg & ARM_GPIO_PIN_CFG_##field##_Msk) >> ARM_GPIO_PIN_CFG_##field##_Pos)) != ARM_DRIVER_OK) \
+        return status;
+    
+// Field of a feature the device lacks must be left at 0.
+#define ARM_GPIO_ENCODE_NONE(field)                                                 \
+    if (arg & ARM_GPIO_PIN_CFG_##field##_Msk)                                       \
+        return ARM_DRIVER_ERROR_UNSUPPORTED;
+    
+    ARM_GPIO_ENCODE_FIELD(ARM_GPIO_ControlPin_State, ENABLED)
+    ARM_GPIO_ENCODE_FIELD(ARM_GPIO_ControlPin_IRQ,   IRQ)
+#if ARM_GPIO_DEVICE_PULL
+    ARM_GPIO_ENCODE_FIELD(ARM_GPIO_ControlPin_Pull,  PULL)
+#else
+    ARM_GPIO_ENCODE_NONE(PULL)
+#endif
+#if ARM_GPIO_DEVICE_SLEW_RATE
+    ARM_GPIO_ENCODE_FIELD(ARM_GPIO_ControlPin_Speed, SPEED)
+#else
+    ARM_GPIO_ENCODE_NONE(SPEED)
+#endif
+#if ARM_GPIO_DEVICE_OPEN_DRAIN
+    ARM_GPIO_ENCODE_FIELD(ARM_GPIO_ControlPin_OpenDrain, OPEN_DRAIN)
+#else
+    ARM_GPIO_ENCODE_NONE(OPEN_DRAIN)
+#endif
+#if ARM_GPIO_DEVICE_DRIVE_STRENGTH
+    ARM_GPIO_ENCODE_FIELD(ARM_GPIO_ControlPin_DriveStrength, DRIVE_STRENGTH)
+#else
+    ARM_GPIO_ENCODE_NONE(DRIVE_STRENGTH)
+#endif
+    
+#undef ARM_GPIO_ENCODE_FIELD
+#undef ARM_GPIO_ENCODE_NONE
+    
+    *value = pcr;
+    return ARM_DRIVER_OK;
+}
+
+int32_t ARM_GPIO_ControlPin_Config(const ARM_GPIO_CONFIG* cfg, uint32_t pin, uint32_t arg)
+{
+    uint32_t pcr;
+    const int32_t status = ARM_GPIO_EncodeConfig(arg, &pcr);
+    if (status != ARM_DRIVER_OK)
+        return status;
+    
+    if ((pcr & PORT_PCR_DSE_MASK) && !(cfg->high_drive & (1u << pin)))
+        return ARM_DRIVER_ERROR_UNSUPPORTED;
+    
+    // Locked pin ignores writes.
+    if (ARM_GPIO_GetPCR(cfg, pin) & PORT_PCR_LK_MASK)
+        return ARM_DRIVER_ERROR;
+    
+    ARM_GPIO_SetPCR(cfg, pin, pcr);
+    
+    // Set direction.
+    if (arg & ARM_GPIO_PIN_CFG_OUTPUT)
+        ARM_GPIO_ModifyPDDR(cfg, 0, (1u << pin));
+    else
+        ARM_GPIO_ModifyPDDR(cfg, (1u << pin), 0);
+    
+    return ARM_DRIVER_OK;
+}
 
 
 int32_t ARM_GPIO_ControlPin_Shared(uint32_t pin, uint32_t control, uint32_t arg, const ARM_GPIO_CONFIG* cfg)
 {
-    if (pin >= 32)
+    // Pins not bonded out on the package have no PCR.
+    if (pin >= 32 || !(cfg->pins & (1u << pin)))
         return ARM_DRIVER_ERROR_PARAMETER;
+    
+    // Port clock may be gated: any access would fault.
+    if (cfg->state->power == ARM_POWER_OFF)
+        return ARM_DRIVER_ERROR;
+    
+#if ARM_GPIO_OWNERSHIP
+    if (!ARM_GPIO_IsOwner(cfg, (1u << pin)))
+        return ARM_DRIVER_ERROR_BUSY;
+#endif
 	
+    ARM_GPIO_PCR_MODIFIER modify;
     switch (control)
     {
         case ARM_GPIO_PIN_CFG:            return ARM_GPIO_ControlPin_Config        (cfg, pin, arg);
-        case ARM_GPIO_PIN_STATE:          return ARM_GPIO_ControlPin_State         (&cfg->port->PCR[pin], arg);
         case ARM_GPIO_PIN_DIRECTION:      return ARM_GPIO_ControlPin_Direction     (cfg, pin, arg);
-        case ARM_GPIO_PIN_IRQ:            return ARM_GPIO_ControlPin_IRQ           (&cfg->port->PCR[pin], arg);
-        case ARM_GPIO_PIN_PULL:           return ARM_GPIO_ControlPin_Pull          (&cfg->port->PCR[pin], arg);
-        case ARM_GPIO_PIN_SPEED:          return ARM_GPIO_ControlPin_Speed         (&cfg->port->PCR[pin], arg);
-        case ARM_GPIO_PIN_OPEN_DRAIN:     return ARM_GPIO_ControlPin_OpenDrain     (&cfg->port->PCR[pin], arg);
-        case ARM_GPIO_PIN_DRIVE_STRENGTH: return ARM_GPIO_ControlPin_DriveStrength (&cfg->port->PCR[pin], arg);
+        
+        case ARM_GPIO_PIN_STATE:          modify = ARM_GPIO_ControlPin_State;         break;
+        case ARM_GPIO_PIN_IRQ:            modify = ARM_GPIO_ControlPin_IRQ;           break;
+#if ARM_GPIO_DEVICE_PULL
+        case ARM_GPIO_PIN_PULL:           modify = ARM_GPIO_ControlPin_Pull;          break;
+#endif
+#if ARM_GPIO_DEVICE_SLEW_RATE
+        case ARM_GPIO_PIN_SPEED:          modify = ARM_GPIO_ControlPin_Speed;         break;
+#endif
+#if ARM_GPIO_DEVICE_OPEN_DRAIN
+        case ARM_GPIO_PIN_OPEN_DRAIN:     modify = ARM_GPIO_ControlPin_OpenDrain;     break;
+#endif
+#if ARM_GPIO_DEVICE_DRIVE_STRENGTH
+        case ARM_GPIO_PIN_DRIVE_STRENGTH:
+            if (arg == ARM_GPIO_PIN_DRIVE_STRENGTH_HIGH && !(cfg->high_drive & (1u << pin)))
+                return ARM_DRIVER_ERROR_UNSUPPORTED;
+            modify = ARM_GPIO_ControlPin_DriveStrength;
+            break;
+#endif
         
         default: return ARM_DRIVER_ERROR_UNSUPPORTED;
     }
+    
+    return ARM_GPIO_ModifyPCR(cfg, pin, modify, arg);
 }
 
-int32_t ARM_GPIO_ControlPin_0(uint32_t pin, uint32_t control, uint32_t arg) { return ARM_GPIO_ControlPin_Shared(pin, control, arg, &gpio_a); }
-int32_t ARM_GPIO_ControlPin_1(uint32_t pin, uint32_t control, uint32_t arg) { return ARM_GPIO_ControlPin_Shared(pin, control, arg, &gpio_b); }
-int32_t ARM_GPIO_ControlPin_2(uint32_t pin, uint32_t control, uint32_t arg) { return ARM_GPIO_ControlPin_Shared(pin, control, arg, &gpio_c); }
-int32_t ARM_GPIO_ControlPin_3(uint32_t pin, uint32_t control, uint32_t arg) { return ARM_GPIO_ControlPin_Shared(pin, control, arg, &gpio_d); }
-int32_t ARM_GPIO_ControlPin_4(uint32_t pin, uint32_t control, uint32_t arg) { return ARM_GPIO_ControlPin_Shared(pin, control, arg, &gpio_e); }
-
 ////////////////////////////////////////////////////////////////////////////////
-void ARM_GPIO_SetPin_0(uint32_t pin) { gpio_a.gpio->PSOR = (1u << pin); }
-void ARM_GPIO_SetPin_1(uint32_t pin) { gpio_b.gpio->PSOR = (1u << pin); }
-void ARM_GPIO_SetPin_2(uint32_t pin) { gpio_c.gpio->PSOR = (1u << pin); }
-void ARM_GPIO_SetPin_3(uint32_t pin) { gpio_d.gpio->PSOR = (1u << pin); }
-void ARM_GPIO_SetPin_4(uint32_t pin) { gpio_e.gpio->PSOR = (1u << pin); }
+//   Port configuration snapshot
 ////////////////////////////////////////////////////////////////////////////////
-void ARM_GPIO_ClearPin_0(uint32_t pin) { gpio_a.gpio->PCOR = (1u << pin); }
-void ARM_GPIO_ClearPin_1(uint32_t pin) { gpio_b.gpio->PCOR = (1u << pin); }
-void ARM_GPIO_ClearPin_2(uint32_t pin) { gpio_c.gpio->PCOR = (1u << pin); }
-void ARM_GPIO_ClearPin_3(uint32_t pin) { gpio_d.gpio->PCOR = (1u << pin); }
-void ARM_GPIO_ClearPin_4(uint32_t pin) { gpio_e.gpio->PCOR = (1u << pin); }
+
+// Writes PCRs of the pins from mask, which differ from pcr[].
+// PCRs are compared, then written: the port must not be reconfigured from
+// an interrupt at the same time.
+void ARM_GPIO_WritePCRs(const ARM_GPIO_CONFIG* cfg, const uint32_t* pcr, uint32_t mask)
+{
+    uint32_t single = 0;    // IRQC differs: PCR must be written
+    uint32_t global = 0;    // only PCR[15:0] differs: GPCLR/GPCHR can be used
+    
+    mask &= cfg->pins;
+    
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        if (!(mask & (1u << pin)))
+            continue;
+        
+        const uint32_t cur = ARM_GPIO_GetPCR(cfg, pin);
+        if (cur & PORT_PCR_LK_MASK)
+            continue;
+        
+        // ISF is write-1-to-clear, it is not a part of configuration.
+        const uint32_t diff = cur ^ (pcr[pin] & ~PORT_PCR_ISF_MASK);
+        if (diff & 0xFFFF0000u)
+            single |= (1u << pin);
+        else if (diff)
+            global |= (1u << pin);
+    }
+    
+    while (single)
+    {
+        const uint32_t pin = __CLZ(__RBIT(single));
+        ARM_GPIO_SetPCR(cfg, pin, pcr[pin] & ~PORT_PCR_ISF_MASK);
+        single &= single - 1;
+    }
+    
+    // One GPCLR/GPCHR write per distinct value of PCR[15:0].
+    while (global)
+    {
+        const uint32_t value = pcr[__CLZ(__RBIT(global))] & 0xFFFFu;
+        
+        uint32_t group = 0;
+        for (uint32_t left = global; left; left &= left - 1)
+        {
+            const uint32_t pin = __CLZ(__RBIT(left));
+            if ((pcr[pin] & 0xFFFFu) == value)
+                group |= (1u << pin);
+        }
+        
+        ARM_GPIO_WritePCRGroup(cfg, group, value);
+        global &= ~group;
+    }
+}
+
+int32_t ARM_GPIO_SavePortConfig(uint32_t port, ARM_GPIO_PORT_SNAPSHOT* snapshot)
+{
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    const ARM_GPIO_CONFIG* cfg = gpio_ports[port];
+    if (cfg->state->power == ARM_POWER_OFF)
+        return ARM_DRIVER_ERROR;
+    
+    for (uint32_t pin = 0; pin < 32; pin++)
+        snapshot->pcr[pin] = ARM_GPIO_GetPCR(cfg, pin);
+    
+    snapshot->pddr = ARM_GPIO_GetPDDR(cfg);
+    snapshot->pdor = cfg->gpio->PDOR;
+    
+    return ARM_DRIVER_OK;
+}
+
+int32_t ARM_GPIO_ApplyPortConfig(uint32_t port, const ARM_GPIO_PORT_SNAPSHOT* snapshot, uint32_t mask)
+{
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    const ARM_GPIO_CONFIG* cfg = gpio_ports[port];
+    if (cfg->state->power == ARM_POWER_OFF)
+        return ARM_DRIVER_ERROR;
+    
+    // Output values go first: pins, which become outputs, must drive restored levels.
+    // Other pins of the port may be driven meanwhile: PSOR/PCOR don't touch them.
+    const uint32_t pdor = cfg->gpio->PDOR;
+    if (mask == 0xFFFFFFFFu)
+    {
+        if (pdor != snapshot->pdor)
+            cfg->gpio->PDOR = snapshot->pdor;
+    }
+    else
+    {
+        const uint32_t set   = snapshot->pdor & ~pdor & mask;
+        const uint32_t clear = pdor & ~snapshot->pdor & mask;
+        if (set)
+            cfg->gpio->PSOR = set;
+        if (clear)
+            cfg->gpio->PCOR = clear;
+    }
+    
+    ARM_GPIO_WritePCRs(cfg, snapshot->pcr, mask);
+    
+    const uint32_t pddr  = ARM_GPIO_GetPDDR(cfg);
+    const uint32_t set   = snapshot->pddr & ~pddr & mask;
+    const uint32_t clear = pddr & ~snapshot->pddr & mask;
+    if (set | clear)
+        ARM_GPIO_ModifyPDDR(cfg, clear, set);
+    
+    return ARM_DRIVER_OK;
+}
+
+int32_t ARM_GPIO_RestorePortConfig(uint32_t port, const ARM_GPIO_PORT_SNAPSHOT* snapshot)
+{
+    return ARM_GPIO_ApplyPortConfig(port, snapshot, 0xFFFFFFFFu);
+}
+
+#if ARM_GPIO_SHADOW_REGS
+uint32_t ARM_GPIO_VerifyShadow(uint32_t port)
+{
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return 0;
+    
+    const ARM_GPIO_CONFIG* cfg = gpio_ports[port];
+    
+    uint32_t diff = cfg->gpio->PDDR ^ cfg->state->pddr;
+    
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        if ((cfg->port->PCR[pin] & ~PORT_PCR_ISF_MASK) != cfg->state->pcr[pin])
+            diff |= (1u << pin);
+    }
+    
+    return diff;
+}
+#endif
+
+
 ////////////////////////////////////////////////////////////////////////////////
-void ARM_GPIO_TogglePin_0(uint32_t pin) { gpio_a.gpio->PTOR = (1u << pin); }
-void ARM_GPIO_TogglePin_1(uint32_t pin) { gpio_b.gpio->PTOR = (1u << pin); }
-void ARM_GPIO_TogglePin_2(uint32_t pin) { gpio_c.gpio->PTOR = (1u << pin); }
-void ARM_GPIO_TogglePin_3(uint32_t pin) { gpio_d.gpio->PTOR = (1u << pin); }
-void ARM_GPIO_TogglePin_4(uint32_t pin) { gpio_e.gpio->PTOR = (1u << pin); }
+//   Digital filter
 ////////////////////////////////////////////////////////////////////////////////
-void ARM_GPIO_WritePin_0(uint32_t pin, uint32_t value) { *(value ? &gpio_a.gpio->PSOR : &gpio_a.gpio->PCOR) = (1u << pin); }
-void ARM_GPIO_WritePin_1(uint32_t pin, uint32_t value) { *(value ? &gpio_b.gpio->PSOR : &gpio_b.gpio->PCOR) = (1u << pin); }
-void ARM_GPIO_WritePin_2(uint32_t pin, uint32_t value) { *(value ? &gpio_c.gpio->PSOR : &gpio_c.gpio->PCOR) = (1u << pin); }
-void ARM_GPIO_WritePin_3(uint32_t pin, uint32_t value) { *(value ? &gpio_d.gpio->PSOR : &gpio_d.gpio->PCOR) = (1u << pin); }
-void ARM_GPIO_WritePin_4(uint32_t pin, uint32_t value) { *(value ? &gpio_e.gpio->PSOR : &gpio_e.gpio->PCOR) = (1u << pin); }
+
+int32_t ARM_GPIO_SetDigitalFilter(uint32_t port, uint32_t mask, uint32_t clock, uint32_t width)
+{
+    if (port >= ARM_GPIO_PORT_COUNT || clock > ARM_GPIO_FILTER_CLOCK_LPO || width > PORT_DFWR_FILT_MASK)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    const ARM_GPIO_CONFIG* cfg = gpio_ports[port];
+    if (mask & ~cfg->filter)
+        return ARM_DRIVER_ERROR_UNSUPPORTED;
+    
+    if (cfg->state->power == ARM_POWER_OFF)
+        return ARM_DRIVER_ERROR;
+    
+#if ARM_GPIO_OWNERSHIP
+    if (!ARM_GPIO_IsOwner(cfg, mask))
+        return ARM_DRIVER_ERROR_BUSY;
+#endif
+    
+    // DFCR and DFWR may change only while all filters of the port are disabled.
+    cfg->port->DFER = 0;
+    cfg->port->DFCR = (clock == ARM_GPIO_FILTER_CLOCK_LPO) ? PORT_DFCR_CS_MASK : 0;
+    cfg->port->DFWR = PORT_DFWR_FILT(width);
+    cfg->port->DFER = mask;
+    
+    return ARM_DRIVER_OK;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
-uint32_t ARM_GPIO_ReadPin_0(uint32_t pin) { return (gpio_a.gpio->PDIR & (1u << pin)) ? 1u : 0; };
-uint32_t ARM_GPIO_ReadPin_1(uint32_t pin) { return (gpio_b.gpio->PDIR & (1u << pin)) ? 1u : 0; };
-uint32_t ARM_GPIO_ReadPin_2(uint32_t pin) { return (gpio_c.gpio->PDIR & (1u << pin)) ? 1u : 0; };
-uint32_t ARM_GPIO_ReadPin_3(uint32_t pin) { return (gpio_d.gpio->PDIR & (1u << pin)) ? 1u : 0; };
-uint32_t ARM_GPIO_ReadPin_4(uint32_t pin) { return (gpio_e.gpio->PDIR & (1u << pin)) ? 1u : 0; };
+//   Driver instances
 ////////////////////////////////////////////////////////////////////////////////
 
-
-// End GPIO Interface
-
-ARM_DRIVER_GPIO Driver_GPIO0 = {
-    ARM_GPIO_GetVersion_0,
-    ARM_GPIO_GetCapabilities_0,
-    
-    ARM_GPIO_Initialize_0,
-    ARM_GPIO_Uninitialize_0,
-    ARM_GPIO_PowerControl_0,
-    ARM_GPIO_Control_0,
-    ARM_GPIO_GetStatus_0,
-    
-    ARM_GPIO_SetPort_0,
-    ARM_GPIO_ClearPort_0,
-    ARM_GPIO_TogglePort_0,
-    ARM_GPIO_WritePort_0,
-    ARM_GPIO_ReadPort_0,
-    ARM_GPIO_GetPortEvents_0,
-    ARM_GPIO_ClearPortEvents_0,
-    
-    ARM_GPIO_ControlPin_0,
-    ARM_GPIO_SetPin_0,
-    ARM_GPIO_ClearPin_0,
-    ARM_GPIO_TogglePin_0,
-    ARM_GPIO_WritePin_0,
-    ARM_GPIO_ReadPin_0
+// Every ARM_DRIVER_GPIO function has no port argument, so each instance needs
+// its own entry points. Register accessors are single stores/loads to constant
+// addresses; everything longer is a tail call to the _Shared body.
+#define ARM_GPIO_DEFINE_PORT(n, x, PORT, GPIO, IRQ, CLOCK, PINS, HIGH_DRIVE, FILTER) \
+                                                                                \
+void gpio_##x##_handler();                                                      \
+                                                                                \
+ARM_GPIO_STATE state_##x = { .signal = 0, .status = 0 };                        \
+                                                                                \
+const ARM_GPIO_CONFIG gpio_##x = {                                              \
+    .port           = PORT,                                                     \
+    .gpio           = GPIO,                                                     \
+    .irq_vector     = IRQ,                                                      \
+    .irq_handler    = gpio_##x##_handler,                                       \
+    .state          = &state_##x,                                               \
+    .index          = n,                                                        \
+    .pins           = PINS,                                                     \
+    .high_drive     = HIGH_DRIVE,                                               \
+    .filter         = FILTER                                                    \
+};                                                                              \
+                                                                                \
+void gpio_##x##_handler() { gpio_shared_handler(&gpio_##x); }                  \
+                                                                                \
+static int32_t ARM_GPIO_Initialize_##n(ARM_GPIO_SignalEvent_t cb_event) { return state_##x.signal = cb_event, ARM_GPIO_Initialize_Shared(&gpio_##x); } \
+static int32_t ARM_GPIO_Uninitialize_##n(void) { return ARM_GPIO_Uninitialize_Shared(&gpio_##x); } \
+static int32_t ARM_GPIO_PowerControl_##n(ARM_POWER_STATE state) { return ARM_GPIO_PowerControl_Shared(state, &gpio_##x, n); } \
+static int32_t ARM_GPIO_Control_##n(uint32_t control, uint32_t arg) { return ARM_GPIO_Control_Shared(control, arg, &gpio_##x); } \
+static ARM_GPIO_STATUS ARM_GPIO_GetStatus_##n(void) { return state_##x.status; } \
+                                                                                \
+static void     ARM_GPIO_SetPort_##n(uint32_t mask) { ARM_GPIO_OWNERSHIP_CHECK(&gpio_##x, mask); GPIO->PSOR = mask; ARM_GPIO_TRACE_EVENT(SET, n, mask); } \
+static void     ARM_GPIO_ClearPort_##n(uint32_t mask) { ARM_GPIO_OWNERSHIP_CHECK(&gpio_##x, mask); GPIO->PCOR = mask; ARM_GPIO_TRACE_EVENT(CLEAR, n, mask); } \
+static void     ARM_GPIO_TogglePort_##n(uint32_t mask) { ARM_GPIO_OWNERSHIP_CHECK(&gpio_##x, mask); GPIO->PTOR = mask; ARM_GPIO_TRACE_EVENT(TOGGLE, n, mask); } \
+static void     ARM_GPIO_WritePort_##n(uint32_t values) { ARM_GPIO_OWNERSHIP_CHECK(&gpio_##x, 0xFFFFFFFFu); GPIO->PDOR = values; ARM_GPIO_TRACE_EVENT(WRITE, n, values); } \
+static uint32_t ARM_GPIO_ReadPort_##n() { return GPIO->PDIR; }                  \
+static uint32_t ARM_GPIO_GetPortEvents_##n() { return PORT->ISFR; }             \
+static void     ARM_GPIO_ClearPortEvents_##n(uint32_t mask) { PORT->ISFR = mask; } \
+                                                                                \
+static int32_t  ARM_GPIO_ControlPin_##n(uint32_t pin, uint32_t control, uint32_t arg) { ARM_GPIO_TRACE_EVENT(CONTROL_PIN, n, (arg << 16) | ((control & 0xFF) << 8) | (pin & 0xFF)); return ARM_GPIO_ControlPin_Shared(pin, control, arg, &gpio_##x); } \
+static void     ARM_GPIO_SetPin_##n(uint32_t pin) { ARM_GPIO_OWNERSHIP_CHECK(&gpio_##x, (1u << pin)); GPIO->PSOR = (1u << pin); ARM_GPIO_TRACE_EVENT(SET, n, (1u << pin)); } \
+static void     ARM_GPIO_ClearPin_##n(uint32_t pin) { ARM_GPIO_OWNERSHIP_CHECK(&gpio_##x, (1u << pin)); GPIO->PCOR = (1u << pin); ARM_GPIO_TRACE_EVENT(CLEAR, n, (1u << pin)); } \
+static void     ARM_GPIO_TogglePin_##n(uint32_t pin) { ARM_GPIO_OWNERSHIP_CHECK(&gpio_##x, (1u << pin)); GPIO->PTOR = (1u << pin); ARM_GPIO_TRACE_EVENT(TOGGLE, n, (1u << pin)); } \
+static void     ARM_GPIO_WritePin_##n(uint32_t pin, uint32_t value) { ARM_GPIO_OWNERSHIP_CHECK(&gpio_##x, (1u << pin)); *(value ? &GPIO->PSOR : &GPIO->PCOR) = (1u << pin); ARM_GPIO_TRACE_EVENT(CLEAR + (value != 0), n, (1u << pin)); } \
+static uint32_t ARM_GPIO_ReadPin_##n(uint32_t pin) { return (GPIO->PDIR & (1u << pin)) ? 1u : 0; } \
+                                                                                \
+ARM_DRIVER_GPIO Driver_GPIO##n = {                                              \
+    ARM_GPIO_GetVersion,                                                        \
+    ARM_GPIO_GetCapabilities,                                                   \
+                                                                                \
+    ARM_GPIO_Initialize_##n,                                                    \
+    ARM_GPIO_Uninitialize_##n,                                                  \
+    ARM_GPIO_PowerControl_##n,                                                  \
+    ARM_GPIO_Control_##n,                                                       \
+    ARM_GPIO_GetStatus_##n,                                                     \
+                                                                                \
+    ARM_GPIO_SetPort_##n,                                                       \
+    ARM_GPIO_ClearPort_##n,                                                     \
+    ARM_GPIO_TogglePort_##n,                                                    \
+    ARM_GPIO_WritePort_##n,                                                     \
+    ARM_GPIO_ReadPort_##n,                                                      \
+    ARM_GPIO_GetPortEvents_##n,                                                 \
+    ARM_GPIO_ClearPortEvents_##n,                                               \
+                                                                                \
+    ARM_GPIO_ControlPin_##n,                                                    \
+    ARM_GPIO_SetPin_##n,                                                        \
+    ARM_GPIO_ClearPin_##n,                                                      \
+    ARM_GPIO_TogglePin_##n,                                                     \
+    ARM_GPIO_WritePin_##n,                                                      \
+    ARM_GPIO_ReadPin_##n                                                        \
 };
 
-ARM_DRIVER_GPIO Driver_GPIO1 = {
-    ARM_GPIO_GetVersion_1,
-    ARM_GPIO_GetCapabilities_1,
-    
-    ARM_GPIO_Initialize_1,
-    ARM_GPIO_Uninitialize_1,
-    ARM_GPIO_PowerControl_1,
-    ARM_GPIO_Control_1,
-    ARM_GPIO_GetStatus_1,
-    
-    ARM_GPIO_SetPort_1,
-    ARM_GPIO_ClearPort_1,
-    ARM_GPIO_TogglePort_1,
-    ARM_GPIO_WritePort_1,
-    ARM_GPIO_ReadPort_1,
-    ARM_GPIO_GetPortEvents_1,
-    ARM_GPIO_ClearPortEvents_1,
-    
-    ARM_GPIO_ControlPin_1,
-    ARM_GPIO_SetPin_1,
-    ARM_GPIO_ClearPin_1,
-    ARM_GPIO_TogglePin_1,
-    ARM_GPIO_WritePin_1,
-    ARM_GPIO_ReadPin_1
-};
+ARM_GPIO_DEVICE_PORTS(ARM_GPIO_DEFINE_PORT)
 
-ARM_DRIVER_GPIO Driver_GPIO2 = {
-    ARM_GPIO_GetVersion_2,
-    ARM_GPIO_GetCapabilities_2,
-    
-    ARM_GPIO_Initialize_2,
-    ARM_GPIO_Uninitialize_2,
-    ARM_GPIO_PowerControl_2,
-    ARM_GPIO_Control_2,
-    ARM_GPIO_GetStatus_2,
-    
-    ARM_GPIO_SetPort_2,
-    ARM_GPIO_ClearPort_2,
-    ARM_GPIO_TogglePort_2,
-    ARM_GPIO_WritePort_2,
-    ARM_GPIO_ReadPort_2,
-    ARM_GPIO_GetPortEvents_2,
-    ARM_GPIO_ClearPortEvents_2,
-    
-    ARM_GPIO_ControlPin_2,
-    ARM_GPIO_SetPin_2,
-    ARM_GPIO_ClearPin_2,
-    ARM_GPIO_TogglePin_2,
-    ARM_GPIO_WritePin_2,
-    ARM_GPIO_ReadPin_2
-};
+#define ARM_GPIO_PORT_REF(n, x, PORT, GPIO, IRQ, CLOCK, PINS, HIGH_DRIVE, FILTER)     &gpio_##x,
 
-ARM_DRIVER_GPIO Driver_GPIO3 = {
-    ARM_GPIO_GetVersion_3,
-    ARM_GPIO_GetCapabilities_3,
-    
-    ARM_GPIO_Initialize_3,
-    ARM_GPIO_Uninitialize_3,
-    ARM_GPIO_PowerControl_3,
-    ARM_GPIO_Control_3,
-    ARM_GPIO_GetStatus_3,
-    
-    ARM_GPIO_SetPort_3,
-    ARM_GPIO_ClearPort_3,
-    ARM_GPIO_TogglePort_3,
-    ARM_GPIO_WritePort_3,
-    ARM_GPIO_ReadPort_3,
-    ARM_GPIO_GetPortEvents_3,
-    ARM_GPIO_ClearPortEvents_3,
-    
-    ARM_GPIO_ControlPin_3,
-    ARM_GPIO_SetPin_3,
-    ARM_GPIO_ClearPin_3,
-    ARM_GPIO_TogglePin_3,
-    ARM_GPIO_WritePin_3,
-    ARM_GPIO_ReadPin_3
+const ARM_GPIO_CONFIG* const gpio_ports[ARM_GPIO_PORT_COUNT] = {
+    ARM_GPIO_DEVICE_PORTS(ARM_GPIO_PORT_REF)
 };
 
-ARM_DRIVER_GPIO Driver_GPIO4 = {
-    ARM_GPIO_GetVersion_4,
-    ARM_GPIO_GetCapabilities_4,
-    
-    ARM_GPIO_Initialize_4,
-    ARM_GPIO_Uninitialize_4,
-    ARM_GPIO_PowerControl_4,
-    ARM_GPIO_Control_4,
-    ARM_GPIO_GetStatus_4,
-    
-    ARM_GPIO_SetPort_4,
-    ARM_GPIO_ClearPort_4,
-    ARM_GPIO_TogglePort_4,
-    ARM_GPIO_WritePort_4,
-    ARM_GPIO_ReadPort_4,
-    ARM_GPIO_GetPortEvents_4,
-    ARM_GPIO_ClearPortEvents_4,
-    
-    ARM_GPIO_ControlPin_4,
-    ARM_GPIO_SetPin_4,
-    ARM_GPIO_ClearPin_4,
-    ARM_GPIO_TogglePin_4,
-    ARM_GPIO_WritePin_4,
-    ARM_GPIO_ReadPin_4
+#define ARM_GPIO_DRIVER_REF(n, x, PORT, GPIO, IRQ, CLOCK, PINS, HIGH_DRIVE, FILTER)   &Driver_GPIO##n,
+
+ARM_DRIVER_GPIO* const gpio_drivers[ARM_GPIO_PORT_COUNT] = {
+    ARM_GPIO_DEVICE_PORTS(ARM_GPIO_DRIVER_REF)
 };
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Internal definitions of the NXP Kinetis K66 GPIO driver,
+// shared with the modules built on top of it (bus engine etc.).
+//
+// The driver also runs on other Kinetis parts with the same PORT/GPIO
+// modules: select the device with ARM_GPIO_DEVICE_<part> (default: MK66F18).
+
+#ifndef DRIVER_GPIO_NXP_K66_H_
+#define DRIVER_GPIO_NXP_K66_H_
+
+#include "Driver_GPIO.h"
+
+#include <intrinsics.h>
+
+#if   defined(ARM_GPIO_DEVICE_MK64F12)
+#include "Device/GPIO_MK64F12.h"
+#elif defined(ARM_GPIO_DEVICE_MK22F51212)
+#include "Device/GPIO_MK22F51212.h"
+#else
+#include "Device/GPIO_MK66F18.h"
+#endif
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+// Exclusive access to a 32-bit word: the intrinsics take unsigned long,
+// which is 32 bits on the target; a host build brings its own.
+#ifndef ARM_GPIO_LDREX
+#define ARM_GPIO_LDREX(word)            ((uint32_t)__LDREX((unsigned long*)(word)))
+#define ARM_GPIO_STREX(value, word)     __STREX((value), (unsigned long*)(word))
+#endif
+
+// Port indices: ARM_GPIO_PORT_x is driven by Driver_GPIOx.
+#define ARM_GPIO_PORT_A         0
+#define ARM_GPIO_PORT_B         1
+#define ARM_GPIO_PORT_C         2
+#define ARM_GPIO_PORT_D         3
+#define ARM_GPIO_PORT_E         4
+#define ARM_GPIO_PORT_COUNT     ARM_GPIO_DEVICE_PORT_COUNT
+
+// Keep copies of PDDR and PCRs in RAM (ARM_GPIO_STATE), so read-modify-write
+// of pin configuration doesn't read peripheral registers over the bridge.
+#ifndef ARM_GPIO_SHADOW_REGS
+#define ARM_GPIO_SHADOW_REGS    0
+#endif
+
+// Collect statistics of the port interrupt handlers (ARM_GPIO_GetIsrStatistics).
+// Time is measured by the DWT cycle counter, which is started by Initialize.
+#ifndef ARM_GPIO_ISR_STATS
+#define ARM_GPIO_ISR_STATS      0
+#endif
+
+// Histogram of the port interrupt handler duration (ARM_GPIO_GetIsrHistogram).
+#ifndef ARM_GPIO_ISR_HISTOGRAM
+#define ARM_GPIO_ISR_HISTOGRAM  0
+#endif
+
+#if ARM_GPIO_ISR_HISTOGRAM
+#include "Driver_GPIO_NXP_K66_Histogram.h"
+#endif
+
+// Record port events into a buffer (Driver_GPIO_NXP_K66_Record.h).
+#ifndef ARM_GPIO_RECORD
+#define ARM_GPIO_RECORD         0
+#endif
+
+// Wait lists of pin edges, resumed by the handler (Driver_GPIO_NXP_K66_Wait.h).
+#ifndef ARM_GPIO_WAIT
+#define ARM_GPIO_WAIT           0
+#endif
+
+// Pin ownership (ARM_GPIO_Claim/ARM_GPIO_Release): ControlPin and port Control
+// refuse pins claimed by another owner. ARM_GPIO_OWNER_CURRENT() identifies
+// the caller, nonzero (e.g. RTOS thread id, its header given by -include);
+// the default makes one owner.
+#ifndef ARM_GPIO_OWNERSHIP
+#define ARM_GPIO_OWNERSHIP      0
+#endif
+
+#ifndef ARM_GPIO_OWNER_CURRENT
+#define ARM_GPIO_OWNER_CURRENT()    1u
+#endif
+
+// Debug: check ownership also on every output write (Set/Clear/Toggle/Write).
+// A violating write calls ARM_GPIO_OWNERSHIP_FAULT(port, mask) and is not done.
+#ifndef ARM_GPIO_OWNERSHIP_WRITES
+#define ARM_GPIO_OWNERSHIP_WRITES   0
+#endif
+
+#ifndef ARM_GPIO_OWNERSHIP_FAULT
+#define ARM_GPIO_OWNERSHIP_FAULT(port, mask)    ARM_GPIO_OwnershipFault((port), (mask))
+#endif
+
+// Trace of driver operations (Driver_GPIO_NXP_K66_Trace.h).
+#ifndef ARM_GPIO_TRACE
+#define ARM_GPIO_TRACE          0
+#endif
+
+// Trace records, power of two.
+#ifndef ARM_GPIO_TRACE_SIZE
+#define ARM_GPIO_TRACE_SIZE     1024
+#endif
+
+// DWT cycle counter: time base of statistics and records.
+#ifndef ARM_GPIO_DEMCR
+#define ARM_GPIO_DEMCR          (*(volatile uint32_t*)0xE000EDFCu)
+#endif
+#define ARM_GPIO_DEMCR_TRCENA   (1u << 24)
+
+static inline void ARM_GPIO_CycleCounterStart(void)
+{
+    // Plain assignments: compound ones on volatile are deprecated in C++20.
+    ARM_GPIO_DEMCR = ARM_GPIO_DEMCR | ARM_GPIO_DEMCR_TRCENA;
+    DWT_CTRL = DWT_CTRL | DWT_CTRL_CYCCNTENA_MASK;
+}
+
+typedef void (*ISR)();
+
+#if ARM_GPIO_TRACE
+#include "Driver_GPIO_NXP_K66_Trace.h"
+
+extern ARM_GPIO_TRACE_RECORD gpio_trace[ARM_GPIO_TRACE_SIZE];
+extern volatile uint32_t     gpio_trace_head;   // [31:24] DWT_CYCCNT[31:24] of the last record, [23:0] record count
+
+// Adds the record; Set/Clear/Toggle grow from 1 store to about 10 instructions.
+static inline void ARM_GPIO_Trace(uint32_t op, uint32_t port, uint32_t mask)
+{
+    uint32_t head, now, sync;
+    do
+    {
+        head = ARM_GPIO_LDREX(&gpio_trace_head);
+        now  = DWT_CYCCNT;
+        sync = ((head ^ now) >> 24) != 0;
+    } while (ARM_GPIO_STREX((now & 0xFF000000u) | ((head + 1 + sync) & 0x00FFFFFFu), &gpio_trace_head));
+    
+    if (sync)
+    {
+        ARM_GPIO_TRACE_RECORD* record = &gpio_trace[head++ & (ARM_GPIO_TRACE_SIZE - 1)];
+        record->info = (now << 8) | (ARM_GPIO_TRACE_SYNC << 3);
+        record->mask = now;
+    }
+    
+    ARM_GPIO_TRACE_RECORD* record = &gpio_trace[head & (ARM_GPIO_TRACE_SIZE - 1)];
+    record->info = (now << 8) | (op << 3) | port;
+    record->mask = mask;
+}
+
+#define ARM_GPIO_TRACE_EVENT(op, port, mask)    ARM_GPIO_Trace(ARM_GPIO_TRACE_##op, (port), (mask))
+#else
+#define ARM_GPIO_TRACE_EVENT(op, port, mask)
+#endif
+
+// PORTx_PCRn[IRQC] values of the pin interrupts.
+#define ARM_GPIO_IRQC_NONE          0x0u
+#define ARM_GPIO_IRQC_LEVEL_LOW     0x8u
+#define ARM_GPIO_IRQC_RISING        0x9u
+#define ARM_GPIO_IRQC_FALLING       0xAu
+#define ARM_GPIO_IRQC_EITHER        0xBu
+#define ARM_GPIO_IRQC_LEVEL_HIGH    0xCu
+
+#if ARM_GPIO_ISR_STATS
+typedef struct
+{
+    uint32_t    calls;          ///< Handler invocations
+    uint32_t    spurious;       ///< Invocations without pending pin (ISFR = 0)
+    uint32_t    events;         ///< Pin events passed to ARM_GPIO_SignalEvent_t
+    uint32_t    overruns;       ///< Pins flagged again before the handler returned
+    uint64_t    cycles;         ///< Cycles spent in the handler, signal callback included
+    uint32_t    cycles_max;     ///< Longest invocation
+    uint32_t    start;          ///< DWT_CYCCNT at reset of the statistics
+} ARM_GPIO_ISR_STATISTICS;
+#endif
+
+// placed in RAM
+typedef struct
+{
+    ARM_GPIO_SignalEvent_t     signal;
+    ARM_GPIO_STATUS            status;
+    ARM_POWER_STATE            power;
+    uint32_t                   wakeup;      // pins routed to LLWU in ARM_POWER_LOW
+#if ARM_GPIO_SHADOW_REGS
+    volatile uint32_t          pddr;        // shadow of GPIOx_PDDR
+    volatile uint32_t          pcr[32];     // shadow of PORTx_PCRn, without ISF
+    volatile uint32_t          pcr_dirty;   // pins, which PCR the writer must copy
+    volatile uint32_t          pddr_busy;   // a context writes the shadow to hardware
+    volatile uint32_t          pcr_busy;
+#endif
+#if ARM_GPIO_ISR_STATS
+    ARM_GPIO_ISR_STATISTICS    isr;
+#endif
+#if ARM_GPIO_ISR_HISTOGRAM
+    ARM_GPIO_HISTOGRAM         histogram[2];        // filled by the handler / being read
+    volatile uint8_t           histogram_active;    // index filled by the handler
+#endif
+#if ARM_GPIO_OWNERSHIP
+    volatile uint32_t          owned;       // claimed pins
+    volatile uint32_t          owner[32];   // ARM_GPIO_OWNER_CURRENT() of the claimer, 0: none
+#endif
+} ARM_GPIO_STATE;
+
+// placed in ROM
+typedef struct
+{
+    const PORT_MemMapPtr    port;
+    const GPIO_MemMapPtr    gpio;
+    const uint32_t          irq_vector;
+    const ISR               irq_handler;
+    ARM_GPIO_STATE* const   state;
+    const uint8_t           index;      // ARM_GPIO_PORT_x
+    const uint32_t          pins;       // pins of the package
+    const uint32_t          high_drive; // pins with DSE
+    const uint32_t          filter;     // pins with digital filter
+} ARM_GPIO_CONFIG;
+
+// Configurations of all ports, indexed by ARM_GPIO_PORT_x.
+extern const ARM_GPIO_CONFIG* const gpio_ports[ARM_GPIO_PORT_COUNT];
+
+// Driver instances, indexed by ARM_GPIO_PORT_x.
+extern ARM_DRIVER_GPIO* const gpio_drivers[ARM_GPIO_PORT_COUNT];
+
+// Current PCR value, without ISF: the shadow with ARM_GPIO_SHADOW_REGS.
+static inline uint32_t ARM_GPIO_GetPCR(const ARM_GPIO_CONFIG* cfg, uint32_t pin)
+{
+#if ARM_GPIO_SHADOW_REGS
+    return cfg->state->pcr[pin];
+#else
+    return cfg->port->PCR[pin] & ~PORT_PCR_ISF_MASK;
+#endif
+}
+
+// Snapshot of the whole port configuration.
+typedef struct
+{
+    uint32_t    pcr[32];        ///< PORTx_PCRn (ISF is never saved)
+    uint32_t    pddr;           ///< GPIOx_PDDR
+    uint32_t    pdor;           ///< GPIOx_PDOR
+} ARM_GPIO_PORT_SNAPSHOT;
+
+/**
+  \fn          int32_t ARM_GPIO_SavePortConfig (uint32_t port, ARM_GPIO_PORT_SNAPSHOT* snapshot)
+  \brief       Capture configuration of all pins of the port.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[out]  snapshot  Configuration of the port
+  \return      \ref execution_status
+
+  \fn          int32_t ARM_GPIO_RestorePortConfig (uint32_t port, const ARM_GPIO_PORT_SNAPSHOT* snapshot)
+  \brief       Restore configuration of all pins of the port.
+               Only registers which differ from the snapshot are written;
+               pins sharing the same PCR value are written at once via GPCLR/GPCHR.
+               Locked pins (PCR LK) are skipped.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   snapshot  Configuration of the port
+  \return      \ref execution_status
+*/
+int32_t ARM_GPIO_SavePortConfig   (uint32_t port, ARM_GPIO_PORT_SNAPSHOT* snapshot);
+int32_t ARM_GPIO_RestorePortConfig(uint32_t port, const ARM_GPIO_PORT_SNAPSHOT* snapshot);
+
+/**
+  \fn          int32_t ARM_GPIO_ApplyPortConfig (uint32_t port, const ARM_GPIO_PORT_SNAPSHOT* snapshot, uint32_t mask)
+  \brief       Restore configuration of the selected pins of the port, as ARM_GPIO_RestorePortConfig.
+               Output values are written before PCRs and directions.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   snapshot  Configuration of the port; only entries of the selected pins are used
+  \param[in]   mask      Pins to configure
+  \return      \ref execution_status
+
+  \fn          int32_t ARM_GPIO_EncodeConfig (uint32_t arg, uint32_t* pcr)
+  \brief       Translate pin configuration into PORTx_PCRn value (MUX = GPIO, if enabled).
+  \param[in]   arg       Configuration, as for ARM_GPIO_PIN_CFG
+  \param[out]  pcr       Value of PCR
+  \return      \ref execution_status
+*/
+int32_t ARM_GPIO_ApplyPortConfig(uint32_t port, const ARM_GPIO_PORT_SNAPSHOT* snapshot, uint32_t mask);
+int32_t ARM_GPIO_EncodeConfig   (uint32_t arg, uint32_t* pcr);
+
+// Clock of the digital filter (PORTx_DFCR CS).
+#define ARM_GPIO_FILTER_CLOCK_BUS   0       ///< Bus clock
+#define ARM_GPIO_FILTER_CLOCK_LPO   1       ///< 1 kHz LPO, also runs in stop modes
+
+/**
+  \fn          int32_t ARM_GPIO_SetDigitalFilter (uint32_t port, uint32_t mask, uint32_t clock, uint32_t width)
+  \brief       Configure the digital input filter of the port (PORTx_DFER, DFCR, DFWR).
+               Filters of all pins are briefly disabled while clock and width change;
+               a pulse shorter than width filter clocks is ignored. Mask 0 disables the filter.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   mask      Pins to filter, the others are not filtered
+  \param[in]   clock     ARM_GPIO_FILTER_CLOCK_x
+  \param[in]   width     Filter length in filter clocks, 0..31
+  \return      \ref execution_status;
+               ARM_DRIVER_ERROR_UNSUPPORTED if a pin of mask has no digital filter
+*/
+int32_t ARM_GPIO_SetDigitalFilter(uint32_t port, uint32_t mask, uint32_t clock, uint32_t width);
+
+/**
+  \fn          void ARM_GPIO_ModifyPDDR (const ARM_GPIO_CONFIG* cfg, uint32_t clear, uint32_t set)
+  \brief       Change direction of several pins with a single PDDR store (interrupt-safe, keeps the shadow).
+               PDDR = (PDDR & ~clear) | set; locks and ownership are not checked.
+  \param[in]   cfg       Port
+  \param[in]   clear     Pins to become inputs
+  \param[in]   set       Pins to become outputs
+  \return      none
+
+  \fn          void ARM_GPIO_WritePCRGroup (const ARM_GPIO_CONFIG* cfg, uint32_t pins, uint32_t value)
+  \brief       Set PCR[15:0] of several pins (interrupt-safe, keeps the shadow); locked pins are skipped.
+               Without shadow registers one GPCLR/GPCHR store per port half.
+  \param[in]   cfg       Port
+  \param[in]   pins      Pins to write
+  \param[in]   value     PCR[15:0]
+  \return      none
+
+  \fn          void ARM_GPIO_DispatchEvents (const ARM_GPIO_CONFIG* cfg, uint32_t mask)
+  \brief       Deliver events of the port: waiters (ARM_GPIO_WAIT), then the signal callback.
+               The port handler calls it after reading and clearing ISFR, ARM_GPIO_Poll
+               with the events of a pass; called with interrupts masked by ARM_GPIO_Replay.
+  \param[in]   cfg       Port
+  \param[in]   mask      Pins, which events occurred
+  \return      none
+
+  \fn          uint32_t ARM_GPIO_IrqcPins (const ARM_GPIO_CONFIG* cfg, uint32_t mask, uint32_t irqc)
+  \brief       Select pins by their interrupt configuration.
+  \param[in]   cfg       Port
+  \param[in]   mask      Pins to look at
+  \param[in]   irqc      ARM_GPIO_IRQC_x
+  \return      Pins of mask, which PCR[IRQC] is irqc
+*/
+void    ARM_GPIO_ModifyPDDR     (const ARM_GPIO_CONFIG* cfg, uint32_t clear, uint32_t set);
+void    ARM_GPIO_WritePCRGroup  (const ARM_GPIO_CONFIG* cfg, uint32_t pins, uint32_t value);
+void    ARM_GPIO_DispatchEvents (const ARM_GPIO_CONFIG* cfg, uint32_t mask);
+uint32_t ARM_GPIO_IrqcPins      (const ARM_GPIO_CONFIG* cfg, uint32_t mask, uint32_t irqc);
+
+#if ARM_GPIO_SHADOW_REGS
+/**
+  \fn          uint32_t ARM_GPIO_VerifyShadow (uint32_t port)
+  \brief       Debug check: compare shadow registers with hardware.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \return      Mask of pins, which PCR or PDDR bit differs from its shadow.
+*/
+uint32_t ARM_GPIO_VerifyShadow(uint32_t port);
+#endif
+
+#if ARM_GPIO_ISR_STATS
+/**
+  \fn          int32_t ARM_GPIO_GetIsrStatistics (uint32_t port, ARM_GPIO_ISR_STATISTICS* stats, uint32_t reset)
+  \brief       Read statistics of the port interrupt handler.
+               Utilisation = cycles / (DWT_CYCCNT - start), valid while the
+               window is shorter than 2^32 cycles.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[out]  stats     Statistics since the last reset
+  \param[in]   reset     Nonzero: reset the statistics
+  \return      \ref execution_status
+*/
+int32_t ARM_GPIO_GetIsrStatistics(uint32_t port, ARM_GPIO_ISR_STATISTICS* stats, uint32_t reset);
+#endif
+
+#if ARM_GPIO_ISR_HISTOGRAM
+/**
+  \fn          int32_t ARM_GPIO_GetIsrHistogram (uint32_t port, ARM_GPIO_HISTOGRAM* histogram)
+  \brief       Take histogram of the port interrupt handler duration (cycles from
+               handler entry to return of the signal callback) and start a new one.
+               No event is lost or counted twice between the two histograms.
+               Must not be called from a handler of the same or higher priority than the port's.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[out]  histogram Histogram since the previous call
+  \return      \ref execution_status
+*/
+int32_t ARM_GPIO_GetIsrHistogram(uint32_t port, ARM_GPIO_HISTOGRAM* histogram);
+#endif
+
+#if ARM_GPIO_OWNERSHIP
+/**
+  \fn          int32_t ARM_GPIO_Claim (uint32_t port, uint32_t mask)
+  \brief       Claim the pins for the caller (ARM_GPIO_OWNER_CURRENT()): all or none.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   mask      Pins to claim
+  \return      \ref execution_status; ARM_DRIVER_ERROR_BUSY if a pin is claimed already
+
+  \fn          int32_t ARM_GPIO_Release (uint32_t port, uint32_t mask)
+  \brief       Release pins claimed by the caller.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   mask      Pins to release
+  \return      \ref execution_status; ARM_DRIVER_ERROR if a pin isn't claimed by the caller
+
+  \fn          uint32_t ARM_GPIO_IsOwner (const ARM_GPIO_CONFIG* cfg, uint32_t mask)
+  \brief       Check that none of the pins is claimed by another owner.
+  \param[in]   cfg       Port
+  \param[in]   mask      Pins
+  \return      1 if the caller may use all the pins, 0 otherwise
+
+  \fn          void ARM_GPIO_OwnershipFault (uint32_t port, uint32_t mask)
+  \brief       Default ARM_GPIO_OWNERSHIP_FAULT: stops in a loop for the debugger.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   mask      Pins written
+  \return      none
+*/
+int32_t  ARM_GPIO_Claim         (uint32_t port, uint32_t mask);
+int32_t  ARM_GPIO_Release       (uint32_t port, uint32_t mask);
+uint32_t ARM_GPIO_IsOwner       (const ARM_GPIO_CONFIG* cfg, uint32_t mask);
+void     ARM_GPIO_OwnershipFault(uint32_t port, uint32_t mask);
+#endif
+
+#if ARM_GPIO_OWNERSHIP && ARM_GPIO_OWNERSHIP_WRITES
+#define ARM_GPIO_OWNERSHIP_CHECK(cfg, mask)                                     \
+    if (!ARM_GPIO_IsOwner((cfg), (mask)))                                       \
+    {                                                                           \
+        ARM_GPIO_OWNERSHIP_FAULT((cfg)->index, (mask));                         \
+        return;                                                                 \
+    }
+#else
+#define ARM_GPIO_OWNERSHIP_CHECK(cfg, mask)
+#endif
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_H_ */
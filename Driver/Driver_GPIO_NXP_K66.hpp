@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Typed pins for C++ (C++14 or later).
+//
+// Port and pin are template arguments, so their ranges are checked at compile
+// time and register addresses are constants: Pin<>::set() etc. compile to the
+// same single store (PSOR/PCOR/PTOR) or load (PDIR) as hand-written register
+// code. Nothing is stored in RAM or ROM.
+//
+// Configuration goes through the C driver (locks, shadows, power state),
+// but the configuration word is validated at compile time:
+//
+//     typedef Pin<ARM_GPIO_PORT_E, 10> Led;
+//     Led::configure<ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT>();
+//     Led::set();
+//
+// A peripheral function is the second argument (PCR MUX), e.g. I2C data:
+//
+//     Pin<ARM_GPIO_PORT_E, 25>::configure<ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OPEN_DRAIN, 5>();
+
+#ifndef DRIVER_GPIO_NXP_K66_HPP_
+#define DRIVER_GPIO_NXP_K66_HPP_
+
+#include "Driver_GPIO_NXP_K66.h"
+
+#define ARM_GPIO_DRIVER_DECL(n, x, PORT, GPIO, IRQ, CLOCK, PINS, HIGH_DRIVE, FILTER) extern ARM_DRIVER_GPIO Driver_GPIO##n;
+extern "C"
+{
+ARM_GPIO_DEVICE_PORTS(ARM_GPIO_DRIVER_DECL)
+}
+#undef ARM_GPIO_DRIVER_DECL
+
+namespace arm_gpio
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Registers, driver and pins of the port; defined only for ports of the device.
+template <uint32_t Port>
+struct PortRegs;
+
+#define ARM_GPIO_PORT_REGS(n, x, PORT, GPIO, IRQ, CLOCK, PINS, HIGH_DRIVE, FILTER) \
+template <>                                                             \
+struct PortRegs<n>                                                      \
+{                                                                       \
+    static PORT_MemMapPtr   port()   { return PORT; }                   \
+    static GPIO_MemMapPtr   gpio()   { return GPIO; }                   \
+    static ARM_DRIVER_GPIO& driver() { return Driver_GPIO##n; }         \
+    static constexpr uint32_t pins       = PINS;                        \
+    static constexpr uint32_t high_drive = HIGH_DRIVE;                  \
+};
+ARM_GPIO_DEVICE_PORTS(ARM_GPIO_PORT_REGS)
+#undef ARM_GPIO_PORT_REGS
+
+////////////////////////////////////////////////////////////////////////////////
+// ARM_GPIO_PIN_CFG word of a pin with function Mux (PCR MUX, 1: GPIO),
+// checked for values the driver would reject. A peripheral function owns
+// the direction: open drain needs ARM_GPIO_PIN_CFG_OUTPUT only for GPIO.
+template <uint32_t Cfg, uint32_t Mux = 1>
+struct PinConfig
+{
+    static_assert(Mux <= 7, "invalid pin function");
+    static_assert((Cfg & ~ARM_GPIO_PIN_CFG_Msk) == 0,
+                  "unknown bits in pin configuration");
+    static_assert(((Cfg & ARM_GPIO_PIN_CFG_IRQ_Msk) >> ARM_GPIO_PIN_CFG_IRQ_Pos) <= ARM_GPIO_PIN_IRQ_LEVEL_LOW,
+                  "invalid interrupt mode");
+    static_assert(((Cfg & ARM_GPIO_PIN_CFG_PULL_Msk) >> ARM_GPIO_PIN_CFG_PULL_Pos) <= ARM_GPIO_PIN_PULL_DOWN,
+                  "invalid pull mode");
+    static_assert((Cfg & ARM_GPIO_PIN_CFG_ENABLED) || !(Cfg & ARM_GPIO_PIN_CFG_IRQ_Msk),
+                  "interrupt on a disabled pin");
+    static_assert(Mux != 1 || (Cfg & ARM_GPIO_PIN_CFG_OUTPUT) || !(Cfg & ARM_GPIO_PIN_CFG_OPEN_DRAIN),
+                  "open drain on a GPIO input pin");
+    static_assert(Mux == 1 || !(Cfg & ARM_GPIO_PIN_CFG_OUTPUT),
+                  "direction is set for a peripheral function");
+    static_assert(ARM_GPIO_DEVICE_PULL || !(Cfg & ARM_GPIO_PIN_CFG_PULL_Msk),
+                  "device has no pull resistors");
+    static_assert(ARM_GPIO_DEVICE_SLEW_RATE || !(Cfg & ARM_GPIO_PIN_CFG_SPEED_Msk),
+                  "device has no slew rate control");
+    static_assert(ARM_GPIO_DEVICE_OPEN_DRAIN || !(Cfg & ARM_GPIO_PIN_CFG_OPEN_DRAIN),
+                  "device has no open drain");
+    static_assert(ARM_GPIO_DEVICE_DRIVE_STRENGTH || !(Cfg & ARM_GPIO_PIN_CFG_DRIVE_STRENGTH),
+                  "device has no drive strength control");
+
+    static constexpr uint32_t value = Cfg;
+    static constexpr uint32_t mux   = Mux;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+template <uint32_t Port, uint32_t N>
+struct Pin
+{
+    static_assert(Port < ARM_GPIO_PORT_COUNT, "port doesn't exist on the device");
+    static_assert(N < 32, "pin index out of range");
+
+    typedef PortRegs<Port> Regs;
+
+    static_assert(N >= 32 || (Regs::pins >> N) & 1, "pin doesn't exist on the device");
+
+    static constexpr uint32_t port  = Port;
+    static constexpr uint32_t index = N;
+    static constexpr uint32_t mask  = (1u << N);
+
+    static void set()           { Regs::gpio()->PSOR = mask; }
+    static void clear()         { Regs::gpio()->PCOR = mask; }
+    static void toggle()        { Regs::gpio()->PTOR = mask; }
+    static void write(bool v)   { if (v) set(); else clear(); }
+    static bool read()          { return (Regs::gpio()->PDIR >> N) & 1; }
+
+    template <uint32_t Cfg, uint32_t Mux = 1>
+    static int32_t configure()
+    {
+        static_assert(!(Cfg & ARM_GPIO_PIN_CFG_DRIVE_STRENGTH) || (Regs::high_drive & mask),
+                      "pin has no high drive strength");
+        if (Mux == 1)
+            return Regs::driver().ControlPin(N, ARM_GPIO_PIN_CFG, PinConfig<Cfg, Mux>::value);
+        return configure_function(PinConfig<Cfg, Mux>::value, Mux);
+    }
+
+private:
+    // Peripheral function: ControlPin knows GPIO only, the port configuration
+    // path writes any PCR. The pin becomes an input of GPIO, PDOR is kept.
+    static int32_t configure_function(uint32_t cfg, uint32_t mux)
+    {
+        ARM_GPIO_PORT_SNAPSHOT config;
+        uint32_t pcr;
+        const int32_t status = ARM_GPIO_EncodeConfig(cfg, &pcr);
+        if (status != ARM_DRIVER_OK)
+            return status;
+        config.pcr[N] = (pcr & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(mux);
+        config.pddr   = 0;
+        config.pdor   = Regs::gpio()->PDOR;
+        return ARM_GPIO_ApplyPortConfig(Port, &config, mask);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Several pins of one port, accessed by a single store/load.
+// Values are in port layout: bit n = pin n.
+template <uint32_t Port, uint32_t... Pins>
+struct PinGroup;
+
+template <uint32_t Port>
+struct PinGroup<Port>
+{
+    static_assert(Port < ARM_GPIO_PORT_COUNT, "port doesn't exist on the device");
+
+    typedef PortRegs<Port> Regs;
+
+    static constexpr uint32_t port = Port;
+    static constexpr uint32_t mask = 0;
+
+    template <uint32_t Cfg, uint32_t Mux = 1>
+    static int32_t configure() { return ARM_DRIVER_OK; }
+};
+
+template <uint32_t Port, uint32_t First, uint32_t... Rest>
+struct PinGroup<Port, First, Rest...>
+{
+    static_assert(First < 32, "pin index out of range");
+    static_assert(!(PinGroup<Port, Rest...>::mask & (1u << First)), "pin listed twice");
+
+    typedef PortRegs<Port> Regs;
+
+    static_assert(First >= 32 || (Regs::pins >> First) & 1, "pin doesn't exist on the device");
+
+    static constexpr uint32_t port = Port;
+    static constexpr uint32_t mask = (1u << First) | PinGroup<Port, Rest...>::mask;
+
+    static void set()               { Regs::gpio()->PSOR = mask; }
+    static void clear()             { Regs::gpio()->PCOR = mask; }
+    static void toggle()            { Regs::gpio()->PTOR = mask; }
+    static uint32_t read()          { return Regs::gpio()->PDIR & mask; }
+
+    static void write(uint32_t values)
+    {
+        Regs::gpio()->PSOR = values & mask;
+        Regs::gpio()->PCOR = ~values & mask;
+    }
+
+    template <uint32_t Cfg, uint32_t Mux = 1>
+    static int32_t configure()
+    {
+        const int32_t status = Pin<Port, First>::template configure<Cfg, Mux>();
+        if (status != ARM_DRIVER_OK)
+            return status;
+        return PinGroup<Port, Rest...>::template configure<Cfg, Mux>();
+    }
+};
+
+} // namespace arm_gpio
+
+#endif /* DRIVER_GPIO_NXP_K66_HPP_ */
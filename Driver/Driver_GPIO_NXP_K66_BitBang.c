@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_NXP_K66_BitBang.h"
+
+#include <intrinsics.h>
+
+static inline void bitbang_delay(uint32_t n)
+{
+    while (n--)
+        __NOP();
+}
+
+static int32_t bitbang_check(ARM_GPIO_BUS_PIN pin)
+{
+    return (pin.port < ARM_GPIO_PORT_COUNT && pin.pin < 32) ? ARM_DRIVER_OK : ARM_DRIVER_ERROR_PARAMETER;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   SPI
+////////////////////////////////////////////////////////////////////////////////
+
+int32_t ARM_GPIO_SPI_Initialize(ARM_GPIO_SPI* spi, ARM_GPIO_BUS_PIN sck, ARM_GPIO_BUS_PIN mosi, ARM_GPIO_BUS_PIN miso, uint32_t mode, uint32_t delay)
+{
+    if (bitbang_check(sck) != ARM_DRIVER_OK)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    if (mosi.port != ARM_GPIO_BITBANG_PIN_NONE && bitbang_check(mosi) != ARM_DRIVER_OK)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    if (miso.port != ARM_GPIO_BITBANG_PIN_NONE && bitbang_check(miso) != ARM_DRIVER_OK)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    if (mode != ARM_GPIO_SPI_MODE_0 && mode != ARM_GPIO_SPI_MODE_3)
+        return ARM_DRIVER_ERROR_UNSUPPORTED;
+
+    spi->sck_gpio = gpio_ports[sck.port]->gpio;
+    spi->sck      = (1u << sck.pin);
+    spi->mode     = mode;
+    spi->delay    = delay;
+
+    // Without MOSI the data change is always empty and folds into the clock store.
+    if (mosi.port != ARM_GPIO_BITBANG_PIN_NONE)
+    {
+        spi->mosi_gpio = gpio_ports[mosi.port]->gpio;
+        spi->mosi      = (1u << mosi.pin);
+    }
+    else
+    {
+        spi->mosi_gpio = spi->sck_gpio;
+        spi->mosi      = 0;
+    }
+    spi->shared = (spi->mosi_gpio == spi->sck_gpio);
+
+    if (miso.port != ARM_GPIO_BITBANG_PIN_NONE)
+    {
+        spi->miso_gpio = gpio_ports[miso.port]->gpio;
+        spi->miso_pin  = miso.pin;
+    }
+    else
+    {
+        spi->miso_gpio = 0;
+        spi->miso_pin  = 0;
+    }
+
+    if (mode == ARM_GPIO_SPI_MODE_0)
+        spi->sck_gpio->PCOR = spi->sck;
+    else
+        spi->sck_gpio->PSOR = spi->sck;
+
+    return ARM_DRIVER_OK;
+}
+
+// Every bit: leading edge toggles SCK together with MOSI, if it changes
+// (in mode 0 the first leading edge is the data change only), then the
+// rising edge and MISO sample. Mode 0 ends with one more falling edge.
+//
+// Called with constant 'shared', so each variant is compiled without the test.
+static inline void spi_transfer(const ARM_GPIO_SPI* spi, const uint8_t* out, uint8_t* in, uint32_t length, const uint32_t shared)
+{
+    volatile uint32_t* const sck_ptor  = &spi->sck_gpio->PTOR;
+    volatile uint32_t* const mosi_ptor = &spi->mosi_gpio->PTOR;
+    volatile uint32_t* const pdir      = spi->miso_gpio ? &spi->miso_gpio->PDIR : &spi->sck_gpio->PDIR;
+
+    const uint32_t sck      = spi->sck;
+    const uint32_t mosi     = spi->mosi;
+    const uint32_t miso_pin = spi->miso_pin;
+    const uint32_t delay    = spi->delay;
+
+    uint32_t level = spi->mosi_gpio->PDOR & mosi;
+    uint32_t lead  = (spi->mode == ARM_GPIO_SPI_MODE_0) ? 0 : sck;
+
+#define SPI_BIT(n)                                                          \
+    {                                                                       \
+        const uint32_t want = ((data >> (n)) & 1) ? mosi : 0;               \
+        const uint32_t diff = want ^ level;                                 \
+        level = want;                                                       \
+        if (shared)                                                         \
+            *sck_ptor = lead | diff;                                        \
+        else                                                                \
+        {                                                                   \
+            *mosi_ptor = diff;                                              \
+            *sck_ptor  = lead;                                              \
+        }                                                                   \
+        lead = sck;                                                         \
+        bitbang_delay(delay);                                               \
+        *sck_ptor = sck;                                                    \
+        result = (result << 1) | ((*pdir >> miso_pin) & 1);                 \
+        bitbang_delay(delay);                                               \
+    }
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        const uint32_t data = out ? out[i] : 0xFF;
+        uint32_t result = 0;
+
+        SPI_BIT(7) SPI_BIT(6) SPI_BIT(5) SPI_BIT(4)
+        SPI_BIT(3) SPI_BIT(2) SPI_BIT(1) SPI_BIT(0)
+
+        if (in)
+            in[i] = (uint8_t)result;
+    }
+
+#undef SPI_BIT
+
+    if (length && spi->mode == ARM_GPIO_SPI_MODE_0)
+        *sck_ptor = sck;
+}
+
+void ARM_GPIO_SPI_Transfer(const ARM_GPIO_SPI* spi, const uint8_t* out, uint8_t* in, uint32_t length)
+{
+    if (!spi->miso_gpio)
+        in = 0;
+
+    if (spi->shared)
+        spi_transfer(spi, out, in, length, 1);
+    else
+        spi_transfer(spi, out, in, length, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   I2C: open drain, PSOR releases the line, PCOR pulls it low.
+////////////////////////////////////////////////////////////////////////////////
+
+#define SCL_LOW(i2c)        ((i2c)->scl_gpio->PCOR = (i2c)->scl)
+#define SDA_LOW(i2c)        ((i2c)->sda_gpio->PCOR = (i2c)->sda)
+#define SDA_RELEASE(i2c)    ((i2c)->sda_gpio->PSOR = (i2c)->sda)
+#define SDA_READ(i2c)       (((i2c)->sda_gpio->PDIR >> (i2c)->sda_pin) & 1)
+
+// Release SCL and wait until the slaves release it too.
+static int32_t i2c_scl_high(const ARM_GPIO_I2C* i2c)
+{
+    i2c->scl_gpio->PSOR = i2c->scl;
+
+    for (uint32_t n = i2c->timeout; !((i2c->scl_gpio->PDIR >> i2c->scl_pin) & 1); n--)
+    {
+        if (!n)
+            return ARM_DRIVER_ERROR_TIMEOUT;
+    }
+    return ARM_DRIVER_OK;
+}
+
+// From idle or from SCL low (repeated START).
+static int32_t i2c_start(const ARM_GPIO_I2C* i2c)
+{
+    SDA_RELEASE(i2c);
+    bitbang_delay(i2c->delay);
+    if (i2c_scl_high(i2c) != ARM_DRIVER_OK)
+        return ARM_DRIVER_ERROR_TIMEOUT;
+    bitbang_delay(i2c->delay);
+
+    if (!SDA_READ(i2c))
+        return ARM_DRIVER_ERROR_BUSY;
+
+    SDA_LOW(i2c);
+    bitbang_delay(i2c->delay);
+    SCL_LOW(i2c);
+    return ARM_DRIVER_OK;
+}
+
+static int32_t i2c_stop(const ARM_GPIO_I2C* i2c)
+{
+    SDA_LOW(i2c);
+    bitbang_delay(i2c->delay);
+    const int32_t status = i2c_scl_high(i2c);
+    bitbang_delay(i2c->delay);
+    SDA_RELEASE(i2c);
+    bitbang_delay(i2c->delay);
+    return status;
+}
+
+// SCL is low on entry and exit. Writes 'bit', returns SDA sampled while SCL is high.
+static int32_t i2c_bit(const ARM_GPIO_I2C* i2c, uint32_t bit, uint32_t* sample)
+{
+    if (bit)
+        SDA_RELEASE(i2c);
+    else
+        SDA_LOW(i2c);
+    bitbang_delay(i2c->delay);
+
+    if (i2c_scl_high(i2c) != ARM_DRIVER_OK)
+        return ARM_DRIVER_ERROR_TIMEOUT;
+    *sample = SDA_READ(i2c);
+    bitbang_delay(i2c->delay);
+
+    SCL_LOW(i2c);
+    return ARM_DRIVER_OK;
+}
+
+// Sends 8 bits (0xFF + ack = 0/1 to receive), returns received byte and ACK bit.
+static int32_t i2c_byte(const ARM_GPIO_I2C* i2c, uint32_t data, uint32_t* result)
+{
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        uint32_t sample;
+        if (i2c_bit(i2c, (data >> (8 - i)) & 1, &sample) != ARM_DRIVER_OK)
+            return ARM_DRIVER_ERROR_TIMEOUT;
+        value = (value << 1) | sample;
+    }
+    *result = value;
+    return ARM_DRIVER_OK;
+}
+
+int32_t ARM_GPIO_I2C_Initialize(ARM_GPIO_I2C* i2c, ARM_GPIO_BUS_PIN scl, ARM_GPIO_BUS_PIN sda, uint32_t delay, uint32_t timeout)
+{
+    if (bitbang_check(scl) != ARM_DRIVER_OK || bitbang_check(sda) != ARM_DRIVER_OK)
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    i2c->scl_gpio = gpio_ports[scl.port]->gpio;
+    i2c->sda_gpio = gpio_ports[sda.port]->gpio;
+    i2c->scl      = (1u << scl.pin);
+    i2c->sda      = (1u << sda.pin);
+    i2c->scl_pin  = scl.pin;
+    i2c->sda_pin  = sda.pin;
+    i2c->delay    = delay;
+    i2c->timeout  = timeout;
+
+    SDA_RELEASE(i2c);
+    if (i2c_scl_high(i2c) != ARM_DRIVER_OK)
+        return ARM_DRIVER_ERROR_TIMEOUT;
+
+    // Slave stuck in the middle of a byte: clock it out.
+    for (uint32_t n = 0; n < 9 && !SDA_READ(i2c); n++)
+    {
+        bitbang_delay(i2c->delay);
+        SCL_LOW(i2c);
+        bitbang_delay(i2c->delay);
+        if (i2c_scl_high(i2c) != ARM_DRIVER_OK)
+            return ARM_DRIVER_ERROR_TIMEOUT;
+    }
+    if (!SDA_READ(i2c))
+        return ARM_DRIVER_ERROR_BUSY;
+
+    // STOP: a slave left in a transaction (or just released) goes idle,
+    // and the next START is seen as one.
+    SCL_LOW(i2c);
+    bitbang_delay(i2c->delay);
+    return i2c_stop(i2c);
+}
+
+static int32_t i2c_transfer(const ARM_GPIO_I2C* i2c, uint32_t addr, uint8_t* rx, const uint8_t* tx, uint32_t length, uint32_t xfer_pending)
+{
+    int32_t status = i2c_start(i2c);
+    if (status != ARM_DRIVER_OK)
+        return status;
+
+    uint32_t result;
+    status = i2c_byte(i2c, (((addr & 0x7F) << 1) | (rx ? 1 : 0)) << 1 | 1, &result);
+    if (status == ARM_DRIVER_OK && (result & 1))
+        status = ARM_DRIVER_ERROR;
+
+    for (uint32_t i = 0; i < length && status == ARM_DRIVER_OK; i++)
+    {
+        if (rx)
+        {
+            // ACK all bytes but the last one.
+            status = i2c_byte(i2c, 0x1FE | (i + 1 == length), &result);
+            rx[i] = (uint8_t)(result >> 1);
+        }
+        else
+        {
+            status = i2c_byte(i2c, ((uint32_t)tx[i] << 1) | 1, &result);
+            if (status == ARM_DRIVER_OK && (result & 1))
+                status = ARM_DRIVER_ERROR;
+        }
+    }
+
+    if (status != ARM_DRIVER_OK || !xfer_pending)
+    {
+        const int32_t stop = i2c_stop(i2c);
+        if (status == ARM_DRIVER_OK)
+            status = stop;
+    }
+
+    return status;
+}
+
+int32_t ARM_GPIO_I2C_Write(const ARM_GPIO_I2C* i2c, uint32_t addr, const uint8_t* data, uint32_t length, uint32_t xfer_pending)
+{
+    return i2c_transfer(i2c, addr, 0, data, length, xfer_pending);
+}
+
+int32_t ARM_GPIO_I2C_Read(const ARM_GPIO_I2C* i2c, uint32_t addr, uint8_t* data, uint32_t length, uint32_t xfer_pending)
+{
+    return i2c_transfer(i2c, addr, data, 0, length, xfer_pending);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Timed sequences
+////////////////////////////////////////////////////////////////////////////////
+
+// ns -> cycles, rounded to nearest.
+static uint32_t pulse_cycles(uint32_t ns, uint32_t clock)
+{
+    return (uint32_t)(((uint64_t)ns * clock + 500000000u) / 1000000000u);
+}
+
+// Deadlines are compared by difference: valid across DWT_CYCCNT wrap.
+#define PULSE_WAIT(deadline)    while ((int32_t)(DWT_CYCCNT - (deadline)) < 0) {}
+
+int32_t ARM_GPIO_Pulse_Initialize(ARM_GPIO_PULSE* pulse, ARM_GPIO_BUS_PIN pin, const ARM_GPIO_PULSE_TIMING* timing, uint32_t clock, uint32_t window, uint32_t options)
+{
+    if (bitbang_check(pin) != ARM_DRIVER_OK || !clock)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    if (options & ~(ARM_GPIO_PULSE_ACTIVE_LOW | ARM_GPIO_PULSE_LSB_FIRST))
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    for (uint32_t value = 0; value < 2; value++)
+    {
+        const uint32_t active = pulse_cycles(timing[value].active, clock);
+        const uint32_t idle   = pulse_cycles(timing[value].idle, clock);
+
+        if (active < ARM_GPIO_PULSE_MIN_CYCLES || idle < ARM_GPIO_PULSE_MIN_CYCLES)
+            return ARM_DRIVER_ERROR_UNSUPPORTED;
+        // Between windows interrupts are masked again LEAD cycles before the
+        // next bit: within the idle phase of the last one.
+        if (window && idle < ARM_GPIO_PULSE_LEAD)
+            return ARM_DRIVER_ERROR_UNSUPPORTED;
+        if ((uint64_t)active + idle > 0x7FFFFFFFu)
+            return ARM_DRIVER_ERROR_PARAMETER;
+
+        pulse->cycles[value] = active;
+        pulse->period[value] = active + idle;
+    }
+
+    const GPIO_MemMapPtr gpio = gpio_ports[pin.port]->gpio;
+    if (options & ARM_GPIO_PULSE_ACTIVE_LOW)
+    {
+        pulse->active = &gpio->PCOR;
+        pulse->idle   = &gpio->PSOR;
+    }
+    else
+    {
+        pulse->active = &gpio->PSOR;
+        pulse->idle   = &gpio->PCOR;
+    }
+    pulse->pin     = (1u << pin.pin);
+    pulse->window  = window;
+    pulse->options = options;
+
+    *pulse->idle = pulse->pin;
+    ARM_GPIO_CycleCounterStart();
+
+    return ARM_DRIVER_OK;
+}
+
+// Bit n starts at the deadline of bit n - 1, not at its actual end: a late
+// edge shortens the following phase instead of shifting the rest of the train.
+// Between windows interrupts are open until LEAD cycles before the next bit;
+// a handler running past it stretches that idle phase and the train restarts
+// from the current time, at most ARM_GPIO_PULSE_RESTARTS times.
+int32_t ARM_GPIO_Pulse_Send(const ARM_GPIO_PULSE* pulse, const uint8_t* data, uint32_t bits, ARM_GPIO_PULSE_ERROR* error)
+{
+    volatile uint32_t* const active = pulse->active;
+    volatile uint32_t* const idle   = pulse->idle;
+    const uint32_t pin    = pulse->pin;
+    const uint32_t window = pulse->window ? pulse->window : bits;
+    const uint32_t lsb    = pulse->options & ARM_GPIO_PULSE_LSB_FIRST;
+
+    int32_t  active_min = 0x7FFFFFFF;
+    int32_t  active_max = -0x7FFFFFFF - 1;
+    uint32_t late_max   = 0;
+    uint32_t stretched  = 0;
+    int32_t  status     = ARM_DRIVER_OK;
+
+    const __istate_t istate = __get_interrupt_state();
+
+    uint32_t start = DWT_CYCCNT + ARM_GPIO_PULSE_LEAD;
+    uint32_t bit   = 0;
+    while (bit < bits)
+    {
+        PULSE_WAIT(start - ARM_GPIO_PULSE_LEAD)
+        __disable_interrupt();
+        if ((int32_t)(DWT_CYCCNT - start) > 0)
+        {
+            if (++stretched > ARM_GPIO_PULSE_RESTARTS)
+            {
+                __set_interrupt_state(istate);
+                status = ARM_DRIVER_ERROR_TIMEOUT;
+                break;
+            }
+            start = DWT_CYCCNT + ARM_GPIO_PULSE_LEAD;
+        }
+
+        const uint32_t end = (bits - bit > window) ? bit + window : bits;
+        for (; bit < end; bit++)
+        {
+            const uint32_t byte  = data[bit >> 3];
+            const uint32_t value = (lsb ? (byte >> (bit & 7)) : (byte >> (7 - (bit & 7)))) & 1;
+
+            PULSE_WAIT(start)
+            *active = pin;
+            const uint32_t t_active = DWT_CYCCNT;
+
+            PULSE_WAIT(start + pulse->cycles[value])
+            *idle = pin;
+            const uint32_t t_idle = DWT_CYCCNT;
+
+            const int32_t  width = (int32_t)(t_idle - t_active - pulse->cycles[value]);
+            const uint32_t late  = t_active - start;
+            if (width < active_min)
+                active_min = width;
+            if (width > active_max)
+                active_max = width;
+            if (late > late_max)
+                late_max = late;
+
+            start += pulse->period[value];
+        }
+
+        __set_interrupt_state(istate);
+    }
+
+    if (status == ARM_DRIVER_OK)
+        PULSE_WAIT(start)
+
+    if (error)
+    {
+        error->active_min = bit ? active_min : 0;
+        error->active_max = bit ? active_max : 0;
+        error->late_max   = late_max;
+        error->stretched  = stretched;
+    }
+
+    return status;
+}
+
+#undef PULSE_WAIT
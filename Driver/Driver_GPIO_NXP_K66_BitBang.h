@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Bit-banged SPI and I2C masters, timed single-wire sequences.
+//
+// Register addresses and masks are resolved once at initialization; the bit
+// loop is unrolled and uses GPIO registers directly. SPI changes data and
+// clock with PTOR: when SCK and MOSI share a port, the clock edge and the
+// data change are a single store, so a bit is 2 stores + 1 load.
+// I2C keeps SCL and SDA edges apart (SDA must not change while SCL is high)
+// and supports clock stretching.
+//
+// Pins must be configured by the caller, e.g. in the board pin table:
+//   SPI: SCK, MOSI - GPIO outputs; MISO - GPIO input
+//   I2C: SCL, SDA  - GPIO outputs with open drain (and pull-up, if not on the board)
+// Unused SPI pins (MOSI or MISO) are given as port ARM_GPIO_BITBANG_PIN_NONE.
+//
+// Timed sequences (WS2812, 1-Wire writes): every bit is an active phase and
+// an idle phase, with durations per bit value. Durations are converted to
+// cycles once; the bit loop is table driven and waits on DWT_CYCCNT against
+// absolute deadlines, so errors don't accumulate from bit to bit. Interrupts
+// are masked for at most 'window' bits and served in the idle phase between
+// windows; a transfer, whose idle phases interrupts stretched too often, is
+// given up. Every transfer reports the achieved timing error.
+//   WS2812: GPIO output, active high, MSB first
+//   1-Wire: GPIO output with open drain, active low, LSB first
+
+#ifndef DRIVER_GPIO_NXP_K66_BITBANG_H_
+#define DRIVER_GPIO_NXP_K66_BITBANG_H_
+
+#include "Driver_GPIO_NXP_K66_Bus.h"
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#define ARM_GPIO_BITBANG_PIN_NONE   0xFF
+
+// SPI modes: CPOL = CPHA, data is sampled on the rising edge.
+#define ARM_GPIO_SPI_MODE_0         0       ///< SCK idles low
+#define ARM_GPIO_SPI_MODE_3         3       ///< SCK idles high
+
+typedef struct
+{
+    GPIO_MemMapPtr  sck_gpio;
+    GPIO_MemMapPtr  mosi_gpio;
+    GPIO_MemMapPtr  miso_gpio;
+    uint32_t        sck;            ///< Masks of the pins
+    uint32_t        mosi;
+    uint32_t        delay;          ///< Extra wait per half period, loop iterations
+    uint8_t         miso_pin;
+    uint8_t         mode;
+    uint8_t         shared;         ///< SCK and MOSI on the same port
+} ARM_GPIO_SPI;
+
+// Timed sequence options.
+#define ARM_GPIO_PULSE_ACTIVE_LOW   (1u << 0)   ///< Active phase drives the pin low
+#define ARM_GPIO_PULSE_LSB_FIRST    (1u << 1)   ///< Bit 0 of every byte is sent first
+
+// Shortest phase the bit loop can time, cycles.
+#ifndef ARM_GPIO_PULSE_MIN_CYCLES
+#define ARM_GPIO_PULSE_MIN_CYCLES   16
+#endif
+
+// Cycles between masking interrupts and the first edge of a window.
+#ifndef ARM_GPIO_PULSE_LEAD
+#define ARM_GPIO_PULSE_LEAD         32
+#endif
+
+// Idle phases between windows a transfer may have stretched by interrupts
+// (the train restarts from the current time); one more gives it up.
+#ifndef ARM_GPIO_PULSE_RESTARTS
+#define ARM_GPIO_PULSE_RESTARTS     4
+#endif
+
+typedef struct
+{
+    GPIO_MemMapPtr  scl_gpio;
+    GPIO_MemMapPtr  sda_gpio;
+    uint32_t        scl;
+    uint32_t        sda;
+    uint8_t         scl_pin;
+    uint8_t         sda_pin;
+    uint32_t        delay;          ///< Wait per half period, loop iterations
+    uint32_t        timeout;        ///< Clock stretching limit, loop iterations
+} ARM_GPIO_I2C;
+
+// Durations of one bit value, ns.
+typedef struct
+{
+    uint32_t        active;
+    uint32_t        idle;
+} ARM_GPIO_PULSE_TIMING;
+
+typedef struct
+{
+    volatile uint32_t*  active;         ///< PSOR or PCOR
+    volatile uint32_t*  idle;           ///< The other one
+    uint32_t            pin;            ///< Mask of the pin
+    uint32_t            cycles[2];      ///< Active phase of bit 0/1, cycles
+    uint32_t            period[2];      ///< Whole bit 0/1, cycles
+    uint32_t            window;         ///< Bits sent with interrupts masked, 0: all
+    uint32_t            options;        ///< ARM_GPIO_PULSE_x
+} ARM_GPIO_PULSE;
+
+// Achieved timing of a transfer.
+typedef struct
+{
+    int32_t         active_min;         ///< Achieved - wanted active phase, cycles
+    int32_t         active_max;
+    uint32_t        late_max;           ///< Largest delay of a bit start after its deadline, cycles
+    uint32_t        stretched;          ///< Idle phases stretched by interrupts between windows
+} ARM_GPIO_PULSE_ERROR;
+
+/**
+  \fn          int32_t ARM_GPIO_SPI_Initialize (ARM_GPIO_SPI* spi, ARM_GPIO_BUS_PIN sck, ARM_GPIO_BUS_PIN mosi, ARM_GPIO_BUS_PIN miso, uint32_t mode, uint32_t delay)
+  \brief       Resolve pins and drive SCK to its idle level.
+  \param[out]  spi       SPI object
+  \param[in]   sck       Clock pin
+  \param[in]   mosi      Data output pin, or port ARM_GPIO_BITBANG_PIN_NONE
+  \param[in]   miso      Data input pin, or port ARM_GPIO_BITBANG_PIN_NONE
+  \param[in]   mode      ARM_GPIO_SPI_MODE_x
+  \param[in]   delay     Extra wait per half period (0 = as fast as possible)
+  \return      \ref execution_status
+
+  \fn          void ARM_GPIO_SPI_Transfer (const ARM_GPIO_SPI* spi, const uint8_t* out, uint8_t* in, uint32_t length)
+  \brief       Full-duplex transfer, MSB first. Chip select is up to the caller.
+  \param[in]   spi       SPI object
+  \param[in]   out       Data to send, or NULL to send 0xFF
+  \param[out]  in        Received data, or NULL
+  \param[in]   length    Number of bytes
+  \return      none
+
+  \fn          int32_t ARM_GPIO_I2C_Initialize (ARM_GPIO_I2C* i2c, ARM_GPIO_BUS_PIN scl, ARM_GPIO_BUS_PIN sda, uint32_t delay, uint32_t timeout)
+  \brief       Resolve pins and release the bus: up to 9 clocks until a stuck
+               slave releases SDA, then STOP.
+  \param[out]  i2c       I2C object
+  \param[in]   scl       Clock pin
+  \param[in]   sda       Data pin
+  \param[in]   delay     Wait per half period
+  \param[in]   timeout   Clock stretching limit
+  \return      \ref execution_status; ARM_DRIVER_ERROR_BUSY if SDA stays low,
+               ARM_DRIVER_ERROR_TIMEOUT if SCL does
+
+  \fn          int32_t ARM_GPIO_I2C_Write (const ARM_GPIO_I2C* i2c, uint32_t addr, const uint8_t* data, uint32_t length, uint32_t xfer_pending)
+  \brief       START, 7-bit address + W, data, STOP (no STOP if xfer_pending:
+               the next transfer begins with repeated START).
+  \return      \ref execution_status; ARM_DRIVER_ERROR on NACK,
+               ARM_DRIVER_ERROR_TIMEOUT on clock stretching timeout,
+               ARM_DRIVER_ERROR_BUSY if SDA is held low by another device
+
+  \fn          int32_t ARM_GPIO_I2C_Read (const ARM_GPIO_I2C* i2c, uint32_t addr, uint8_t* data, uint32_t length, uint32_t xfer_pending)
+  \brief       START, 7-bit address + R, data (last byte NACKed), STOP unless xfer_pending.
+  \return      As ARM_GPIO_I2C_Write
+
+  \fn          int32_t ARM_GPIO_Pulse_Initialize (ARM_GPIO_PULSE* pulse, ARM_GPIO_BUS_PIN pin, const ARM_GPIO_PULSE_TIMING* timing, uint32_t clock, uint32_t window, uint32_t options)
+  \brief       Convert bit timing to cycles and drive the pin to its idle level.
+  \param[out]  pulse     Sequence object
+  \param[in]   pin       Output pin
+  \param[in]   timing    timing[0]: bit 0, timing[1]: bit 1
+  \param[in]   clock     Core clock, Hz (SystemCoreClock)
+  \param[in]   window    Bits sent with interrupts masked, 0: whole transfer
+  \param[in]   options   ARM_GPIO_PULSE_x
+  \return      \ref execution_status; ARM_DRIVER_ERROR_UNSUPPORTED if a phase
+               is shorter than ARM_GPIO_PULSE_MIN_CYCLES, or with a window an
+               idle phase shorter than ARM_GPIO_PULSE_LEAD
+
+  \fn          int32_t ARM_GPIO_Pulse_Send (const ARM_GPIO_PULSE* pulse, const uint8_t* data, uint32_t bits, ARM_GPIO_PULSE_ERROR* error)
+  \brief       Send bits; returns after the idle phase of the last one.
+  \param[in]   pulse     Sequence object
+  \param[in]   data      Bits to send
+  \param[in]   bits      Number of bits
+  \param[out]  error     Achieved timing, or NULL
+  \return      \ref execution_status; ARM_DRIVER_ERROR_TIMEOUT if interrupts
+               stretched more than ARM_GPIO_PULSE_RESTARTS idle phases: the
+               rest isn't sent, the pin is idle
+*/
+int32_t ARM_GPIO_SPI_Initialize(ARM_GPIO_SPI* spi, ARM_GPIO_BUS_PIN sck, ARM_GPIO_BUS_PIN mosi, ARM_GPIO_BUS_PIN miso, uint32_t mode, uint32_t delay);
+void    ARM_GPIO_SPI_Transfer  (const ARM_GPIO_SPI* spi, const uint8_t* out, uint8_t* in, uint32_t length);
+
+int32_t ARM_GPIO_I2C_Initialize(ARM_GPIO_I2C* i2c, ARM_GPIO_BUS_PIN scl, ARM_GPIO_BUS_PIN sda, uint32_t delay, uint32_t timeout);
+int32_t ARM_GPIO_I2C_Write     (const ARM_GPIO_I2C* i2c, uint32_t addr, const uint8_t* data, uint32_t length, uint32_t xfer_pending);
+int32_t ARM_GPIO_I2C_Read      (const ARM_GPIO_I2C* i2c, uint32_t addr, uint8_t* data, uint32_t length, uint32_t xfer_pending);
+
+int32_t ARM_GPIO_Pulse_Initialize(ARM_GPIO_PULSE* pulse, ARM_GPIO_BUS_PIN pin, const ARM_GPIO_PULSE_TIMING* timing, uint32_t clock, uint32_t window, uint32_t options);
+int32_t ARM_GPIO_Pulse_Send      (const ARM_GPIO_PULSE* pulse, const uint8_t* data, uint32_t bits, ARM_GPIO_PULSE_ERROR* error);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_BITBANG_H_ */
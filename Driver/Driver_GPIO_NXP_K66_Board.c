@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_NXP_K66_Board.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//   Compile-time checks of the table
+////////////////////////////////////////////////////////////////////////////////
+
+// Values the driver rejects, or which make no sense on a pin. A peripheral
+// function owns the direction: open drain needs an output for GPIO only.
+#define ARM_GPIO_BOARD_CFG_VALID(func, cfg)                                                     \
+    (!((cfg) & ~ARM_GPIO_PIN_CFG_Msk) &&                                                        \
+     (((cfg) & ARM_GPIO_PIN_CFG_IRQ_Msk)  >> ARM_GPIO_PIN_CFG_IRQ_Pos)  <= ARM_GPIO_PIN_IRQ_LEVEL_LOW && \
+     (((cfg) & ARM_GPIO_PIN_CFG_PULL_Msk) >> ARM_GPIO_PIN_CFG_PULL_Pos) <= ARM_GPIO_PIN_PULL_DOWN &&     \
+     ((func) != ARM_GPIO_BOARD_FUNC_GPIO || ((cfg) & ARM_GPIO_PIN_CFG_OUTPUT) ||                \
+      !((cfg) & ARM_GPIO_PIN_CFG_OPEN_DRAIN)) &&                                                \
+     (ARM_GPIO_DEVICE_PULL           || !((cfg) & ARM_GPIO_PIN_CFG_PULL_Msk)) &&                \
+     (ARM_GPIO_DEVICE_SLEW_RATE      || !((cfg) & ARM_GPIO_PIN_CFG_SPEED_Msk)) &&               \
+     (ARM_GPIO_DEVICE_OPEN_DRAIN     || !((cfg) & ARM_GPIO_PIN_CFG_OPEN_DRAIN)) &&              \
+     (ARM_GPIO_DEVICE_DRIVE_STRENGTH || !((cfg) & ARM_GPIO_PIN_CFG_DRIVE_STRENGTH)))
+
+#define ARM_GPIO_BOARD_CHECK(name, port, pin, func, cfg, init)                                  \
+    _Static_assert((port) < ARM_GPIO_PORT_COUNT, #name ": port doesn't exist on the device");   \
+    _Static_assert((pin) < 32, #name ": pin index out of range");                               \
+    _Static_assert((func) <= ARM_GPIO_BOARD_FUNC_ALT7, #name ": invalid function");             \
+    _Static_assert((init) <= 1, #name ": initial output level must be 0 or 1");                 \
+    _Static_assert(ARM_GPIO_BOARD_CFG_VALID(func, cfg), #name ": invalid configuration");       \
+    _Static_assert(((func) == ARM_GPIO_BOARD_FUNC_DISABLED) == !((cfg) & ARM_GPIO_PIN_CFG_ENABLED), \
+                   #name ": function and ARM_GPIO_PIN_CFG_ENABLED disagree");                   \
+    _Static_assert(((func) == ARM_GPIO_BOARD_FUNC_GPIO) || !((cfg) & ARM_GPIO_PIN_CFG_OUTPUT),  \
+                   #name ": direction is set for a peripheral function");
+
+ARM_GPIO_BOARD_PINS(ARM_GPIO_BOARD_CHECK)
+
+// Every pin is a case label: a pin allocated twice is a duplicate case value,
+// whichever way its port is spelled in the table.
+#define ARM_GPIO_BOARD_CASE(name, port, pin, func, cfg, init) \
+    case (((port) << 5) | (pin)): break;
+
+////////////////////////////////////////////////////////////////////////////////
+//   Initialization
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    uint8_t     port;
+    uint8_t     pin;
+    uint8_t     func;
+    uint8_t     init;
+    uint32_t    cfg;
+} ARM_GPIO_BOARD_PIN;
+
+#define ARM_GPIO_BOARD_ENTRY(name, port, pin, func, cfg, init) \
+    { (port), (pin), (func), (init), (cfg) },
+
+static const ARM_GPIO_BOARD_PIN board_pins[] = {
+    ARM_GPIO_BOARD_PINS(ARM_GPIO_BOARD_ENTRY)
+};
+
+int32_t ARM_GPIO_Board_Initialize(void)
+{
+    switch (0)
+    {
+        ARM_GPIO_BOARD_PINS(ARM_GPIO_BOARD_CASE)
+        default: break;
+    }
+
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        ARM_GPIO_PORT_SNAPSHOT config;
+        config.pddr = 0;
+        config.pdor = 0;
+
+        uint32_t mask = 0;
+
+        for (uint32_t i = 0; i < sizeof(board_pins) / sizeof(board_pins[0]); i++)
+        {
+            const ARM_GPIO_BOARD_PIN* entry = &board_pins[i];
+            if (entry->port != port)
+                continue;
+
+            uint32_t pcr;
+            const int32_t status = ARM_GPIO_EncodeConfig(entry->cfg, &pcr);
+            if (status != ARM_DRIVER_OK)
+                return status;
+
+            const uint32_t bit = (1u << entry->pin);
+
+            config.pcr[entry->pin] = (pcr & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(entry->func);
+            if (entry->cfg & ARM_GPIO_PIN_CFG_OUTPUT)
+                config.pddr |= bit;
+            if (entry->init)
+                config.pdor |= bit;
+            mask |= bit;
+        }
+
+        if (!mask)
+            continue;
+
+        int32_t status = gpio_drivers[port]->PowerControl(ARM_POWER_FULL);
+        if (status != ARM_DRIVER_OK)
+            return status;
+
+        status = ARM_GPIO_ApplyPortConfig(port, &config, mask);
+        if (status != ARM_DRIVER_OK)
+            return status;
+    }
+
+    return ARM_DRIVER_OK;
+}
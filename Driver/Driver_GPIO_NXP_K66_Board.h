@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Board pin allocation.
+//
+// The board provides board_pins.h with the table of all used pins,
+// ARM_GPIO_BOARD_PINS(X), one line per pin:
+//
+//     X(name, port, pin, function, configuration, initial output level)
+//
+//   port           ARM_GPIO_PORT_x
+//   function       ARM_GPIO_BOARD_FUNC_x (value of PCR MUX)
+//   configuration  as for ARM_GPIO_PIN_CFG; ENABLED for every function but DISABLED
+//
+// The table is checked at compile time: a pin allocated twice fails with
+// "duplicate case value", invalid entries fail with a static assertion naming
+// the entry. For every entry BOARD_PORT_<name> and BOARD_PIN_<name> are defined.
+
+#ifndef DRIVER_GPIO_NXP_K66_BOARD_H_
+#define DRIVER_GPIO_NXP_K66_BOARD_H_
+
+#include "Driver_GPIO_NXP_K66.h"
+
+// Pin functions (PCR MUX); meaning of ALTx is given by the device pinout.
+#define ARM_GPIO_BOARD_FUNC_DISABLED    0       ///< Pin disabled / analog
+#define ARM_GPIO_BOARD_FUNC_GPIO        1
+#define ARM_GPIO_BOARD_FUNC_ALT2        2
+#define ARM_GPIO_BOARD_FUNC_ALT3        3
+#define ARM_GPIO_BOARD_FUNC_ALT4        4
+#define ARM_GPIO_BOARD_FUNC_ALT5        5
+#define ARM_GPIO_BOARD_FUNC_ALT6        6
+#define ARM_GPIO_BOARD_FUNC_ALT7        7
+
+#include "board_pins.h"
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#define ARM_GPIO_BOARD_PIN_ENUM(name, port, pin, func, cfg, init) \
+    BOARD_PORT_##name = (port), BOARD_PIN_##name = (pin),
+enum
+{
+    ARM_GPIO_BOARD_PINS(ARM_GPIO_BOARD_PIN_ENUM)
+};
+#undef ARM_GPIO_BOARD_PIN_ENUM
+
+/**
+  \fn          int32_t ARM_GPIO_Board_Initialize (void)
+  \brief       Configure all pins of the board table.
+               Every used port is powered (ARM_POWER_FULL) and configured in one pass:
+               initial output levels, then PCRs (grouped via GPCLR/GPCHR), then one PDDR update.
+               Locked pins are skipped.
+  \return      \ref execution_status
+*/
+int32_t ARM_GPIO_Board_Initialize(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_BOARD_H_ */
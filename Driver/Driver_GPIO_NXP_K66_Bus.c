@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_NXP_K66_Bus.h"
+
+#include <intrinsics.h>
+
+// Compilers emit single ROR instruction for this.
+static inline uint32_t ror32(uint32_t value, uint32_t n)
+{
+    return (value >> n) | (value << ((32 - n) & 31));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int32_t ARM_GPIO_Bus_Initialize(ARM_GPIO_BUS* bus, const ARM_GPIO_BUS_PIN* pins, uint32_t width)
+{
+    if (width == 0 || width > ARM_GPIO_BUS_WIDTH_MAX)
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    // Data bits of every port; also checks for duplicated pins.
+    uint32_t port_bits[ARM_GPIO_PORT_COUNT] = { 0 };
+    uint32_t port_pins[ARM_GPIO_PORT_COUNT] = { 0 };
+
+    for (uint32_t bit = 0; bit < width; bit++)
+    {
+        const uint32_t port = pins[bit].port;
+        const uint32_t pin  = pins[bit].pin;
+
+        if (port >= ARM_GPIO_PORT_COUNT || pin >= 32 || (port_pins[port] & (1u << pin)))
+            return ARM_DRIVER_ERROR_PARAMETER;
+
+        port_bits[port] |= (1u << bit);
+        port_pins[port] |= (1u << pin);
+    }
+
+    bus->width      = width;
+    bus->port_count = 0;
+    bus->idle_pull  = 0;
+
+    uint32_t op_count = 0;
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        if (!port_bits[port])
+            continue;
+
+        ARM_GPIO_BUS_PORT* p = &bus->ports[bus->port_count++];
+        p->gpio      = gpio_ports[port]->gpio;
+        p->pins      = port_pins[port];
+        p->first_op  = op_count;
+        p->index     = port;
+        p->pcr_drive = 0;
+        p->pcr_idle  = 0;
+
+        // Group bits by offset (pin - bit): one op per distinct offset.
+        uint32_t left = port_bits[port];
+        while (left)
+        {
+            const uint32_t first  = __CLZ(__RBIT(left));
+            const uint32_t offset = (pins[first].pin - first) & 31;
+
+            ARM_GPIO_BUS_OP* op = &bus->ops[op_count++];
+            op->data_mask  = 0;
+            op->rotate_out = (32 - offset) & 31;
+            op->rotate_in  = offset;
+
+            for (uint32_t bit = first; bit < width; bit++)
+            {
+                if ((left & (1u << bit)) && ((pins[bit].pin - bit) & 31) == offset)
+                    op->data_mask |= (1u << bit);
+            }
+            left &= ~op->data_mask;
+        }
+
+        p->op_count = op_count - p->first_op;
+    }
+
+    return ARM_DRIVER_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ARM_GPIO_Bus_Write(const ARM_GPIO_BUS* bus, uint32_t data)
+{
+    for (uint32_t i = 0; i < bus->port_count; i++)
+    {
+        const ARM_GPIO_BUS_PORT* p  = &bus->ports[i];
+        const ARM_GPIO_BUS_OP*   op = &bus->ops[p->first_op];
+
+        uint32_t set = 0;
+        for (uint32_t n = p->op_count; n; n--, op++)
+            set |= ror32(data & op->data_mask, op->rotate_out);
+
+        // PDOR of input pins is latched too: ARM_GPIO_Bus_Drive relies on it.
+        p->gpio->PSOR = set;
+        p->gpio->PCOR = p->pins & ~set;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint32_t ARM_GPIO_Bus_Read(const ARM_GPIO_BUS* bus)
+{
+    uint32_t data = 0;
+
+    for (uint32_t i = 0; i < bus->port_count; i++)
+    {
+        const ARM_GPIO_BUS_PORT* p  = &bus->ports[i];
+        const ARM_GPIO_BUS_OP*   op = &bus->ops[p->first_op];
+
+        const uint32_t pdir = p->gpio->PDIR;
+        for (uint32_t n = p->op_count; n; n--, op++)
+            data |= ror32(pdir, op->rotate_in) & op->data_mask;
+    }
+
+    return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Turnaround
+////////////////////////////////////////////////////////////////////////////////
+
+// PCR[15:0] of all bus pins of the port, one store per port half.
+static void bus_write_pcrs(const ARM_GPIO_BUS_PORT* p, uint32_t value)
+{
+    ARM_GPIO_WritePCRGroup(gpio_ports[p->index], p->pins, value);
+}
+
+void ARM_GPIO_Bus_Drive(const ARM_GPIO_BUS* bus, uint32_t data)
+{
+    ARM_GPIO_Bus_Write(bus, data);
+
+    // Directions of all ports back to back: skew between ports is minimal.
+    for (uint32_t i = 0; i < bus->port_count; i++)
+        ARM_GPIO_ModifyPDDR(gpio_ports[bus->ports[i].index], 0, bus->ports[i].pins);
+
+    if (bus->idle_pull)
+    {
+        for (uint32_t i = 0; i < bus->port_count; i++)
+            bus_write_pcrs(&bus->ports[i], bus->ports[i].pcr_drive);
+    }
+}
+
+void ARM_GPIO_Bus_Release(const ARM_GPIO_BUS* bus)
+{
+    if (bus->idle_pull)
+    {
+        for (uint32_t i = 0; i < bus->port_count; i++)
+            bus_write_pcrs(&bus->ports[i], bus->ports[i].pcr_idle);
+    }
+
+    for (uint32_t i = 0; i < bus->port_count; i++)
+        ARM_GPIO_ModifyPDDR(gpio_ports[bus->ports[i].index], bus->ports[i].pins, 0);
+}
+
+int32_t ARM_GPIO_Bus_SetIdlePull(ARM_GPIO_BUS* bus, uint32_t pull)
+{
+#if ARM_GPIO_DEVICE_PULL
+    const uint32_t pull_mask = PORT_PCR_PE_MASK | PORT_PCR_PS_MASK;
+
+    uint32_t idle;
+    switch (pull)
+    {
+        case ARM_GPIO_PIN_PULL_NONE: bus->idle_pull = 0; return ARM_DRIVER_OK;
+        case ARM_GPIO_PIN_PULL_UP:   idle = PORT_PCR_PE_MASK | PORT_PCR_PS_MASK; break;
+        case ARM_GPIO_PIN_PULL_DOWN: idle = PORT_PCR_PE_MASK; break;
+
+        default: return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    // All ports are checked before any is changed.
+    uint16_t drive[ARM_GPIO_PORT_COUNT];
+    for (uint32_t i = 0; i < bus->port_count; i++)
+    {
+        const ARM_GPIO_BUS_PORT* p = &bus->ports[i];
+
+        ARM_GPIO_PORT_SNAPSHOT snapshot;
+        const int32_t status = ARM_GPIO_SavePortConfig(p->index, &snapshot);
+        if (status != ARM_DRIVER_OK)
+            return status;
+
+        // One GPCLR/GPCHR value for all pins: they must agree apart from the pull.
+        const uint32_t base = snapshot.pcr[__CLZ(__RBIT(p->pins))] & 0xFFFFu & ~pull_mask;
+        for (uint32_t left = p->pins; left; left &= left - 1)
+        {
+            const uint32_t pcr = snapshot.pcr[__CLZ(__RBIT(left))];
+            if (pcr & PORT_PCR_LK_MASK)
+                return ARM_DRIVER_ERROR;
+            if ((pcr & 0xFFFFu & ~pull_mask) != base)
+                return ARM_DRIVER_ERROR_UNSUPPORTED;
+        }
+        drive[i] = base;
+    }
+
+    for (uint32_t i = 0; i < bus->port_count; i++)
+    {
+        bus->ports[i].pcr_drive = drive[i];
+        bus->ports[i].pcr_idle  = drive[i] | idle;
+    }
+    bus->idle_pull = 1;
+    return ARM_DRIVER_OK;
+#else
+    if (pull == ARM_GPIO_PIN_PULL_NONE)
+    {
+        bus->idle_pull = 0;
+        return ARM_DRIVER_OK;
+    }
+    return ARM_DRIVER_ERROR_UNSUPPORTED;
+#endif
+}
+
+void ARM_GPIO_Bus_MeasureTurnaround(const ARM_GPIO_BUS* bus, uint32_t data, uint32_t* drive, uint32_t* release)
+{
+    ARM_GPIO_CycleCounterStart();
+
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+
+    // Cost of reading the counter is subtracted.
+    uint32_t start = DWT_CYCCNT;
+    const uint32_t overhead = DWT_CYCCNT - start;
+
+    start = DWT_CYCCNT;
+    ARM_GPIO_Bus_Drive(bus, data);
+    *drive = DWT_CYCCNT - start - overhead;
+
+    start = DWT_CYCCNT;
+    ARM_GPIO_Bus_Release(bus);
+    *release = DWT_CYCCNT - start - overhead;
+
+    __set_interrupt_state(istate);
+}
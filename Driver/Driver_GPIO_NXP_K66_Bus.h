@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Parallel bus over arbitrary (port, pin) lists.
+//
+// Bit N of a data word is mapped to pins[N]. At initialization pins are
+// grouped by port and, inside a port, by the distance between data bit and
+// pin index. Each group is a single mask + rotate, so a contiguous run of pins
+// (or any set of pins with the same offset) costs one operation instead of
+// one operation per pin. Write = 2 stores per port (PSOR + PCOR),
+// read = 1 load per port (PDIR).
+//
+// Turnaround of a bidirectional bus: ARM_GPIO_Bus_Drive preloads the output
+// values of all ports, then turns the pins of every port to outputs with one
+// PDDR store, so no pin drives a stale value. ARM_GPIO_Bus_Release turns them
+// back to inputs with one PDDR store per port. Optionally a pull holds the
+// released bus (ARM_GPIO_Bus_SetIdlePull): it is switched on before the
+// pins are released and off after they are driven, one GPCLR/GPCHR store
+// per port half, so the bus never floats.
+
+#ifndef DRIVER_GPIO_NXP_K66_BUS_H_
+#define DRIVER_GPIO_NXP_K66_BUS_H_
+
+#include "Driver_GPIO_NXP_K66.h"
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#define ARM_GPIO_BUS_WIDTH_MAX  32
+
+// Pin of the bus, as given by user.
+typedef struct
+{
+    uint8_t     port;           ///< ARM_GPIO_PORT_x
+    uint8_t     pin;            ///< Pin index on the port (0..31)
+} ARM_GPIO_BUS_PIN;
+
+// Data bits, which are mapped to the pins of the port with the same offset.
+typedef struct
+{
+    uint32_t    data_mask;      ///< Bits of the data word
+    uint8_t     rotate_out;     ///< Right rotation: data bits -> pins
+    uint8_t     rotate_in;      ///< Right rotation: pins -> data bits
+} ARM_GPIO_BUS_OP;
+
+// Part of the bus on one port.
+typedef struct
+{
+    GPIO_MemMapPtr  gpio;
+    uint32_t        pins;       ///< Mask of all bus pins on the port
+    uint8_t         first_op;   ///< Index of the first op in ARM_GPIO_BUS::ops
+    uint8_t         op_count;
+    uint8_t         index;      ///< ARM_GPIO_PORT_x
+    uint16_t        pcr_drive;  ///< PCR[15:0] of the pins while driven
+    uint16_t        pcr_idle;   ///< PCR[15:0] of the pins while released
+} ARM_GPIO_BUS_PORT;
+
+typedef struct
+{
+    uint8_t             width;
+    uint8_t             port_count;
+    uint8_t             idle_pull;  ///< Turnaround switches the pull (pcr_drive/pcr_idle)
+    ARM_GPIO_BUS_PORT   ports[ARM_GPIO_PORT_COUNT];
+    ARM_GPIO_BUS_OP     ops[ARM_GPIO_BUS_WIDTH_MAX];
+} ARM_GPIO_BUS;
+
+/**
+  \fn          int32_t ARM_GPIO_Bus_Initialize (ARM_GPIO_BUS* bus, const ARM_GPIO_BUS_PIN* pins, uint32_t width)
+  \brief       Compile pin list into per-port mask/rotate sequence.
+  \param[out]  bus    Bus object
+  \param[in]   pins   Pins of the bus, pins[0] = data bit 0
+  \param[in]   width  Number of pins (1..32)
+  \return      \ref execution_status
+
+  \fn          void ARM_GPIO_Bus_Write (const ARM_GPIO_BUS* bus, uint32_t data)
+  \brief       Scatter data word onto the bus pins.
+  \param[in]   bus    Bus object
+  \param[in]   data   Value, bits above width are ignored
+  \return      none
+
+  \fn          uint32_t ARM_GPIO_Bus_Read (const ARM_GPIO_BUS* bus)
+  \brief       Gather data word from the bus pins.
+  \param[in]   bus    Bus object
+  \return      Value of the bus
+
+  \fn          void ARM_GPIO_Bus_Drive (const ARM_GPIO_BUS* bus, uint32_t data)
+  \brief       Turn the bus to outputs, driving data from the first cycle.
+  \param[in]   bus    Bus object
+  \param[in]   data   Value, bits above width are ignored
+  \return      none
+
+  \fn          void ARM_GPIO_Bus_Release (const ARM_GPIO_BUS* bus)
+  \brief       Turn the bus to inputs (idle pull first, if set).
+  \param[in]   bus    Bus object
+  \return      none
+
+  \fn          int32_t ARM_GPIO_Bus_SetIdlePull (ARM_GPIO_BUS* bus, uint32_t pull)
+  \brief       Select the pull of the released bus; takes effect at the next turnaround.
+               Bus pins of a port must have the same PCR[15:0], pull aside, and not be locked.
+               ARM_GPIO_PIN_PULL_NONE: turnaround leaves PCRs as they are.
+  \param[in]   bus    Bus object, ports powered
+  \param[in]   pull   ARM_GPIO_PIN_PULL_x
+  \return      \ref execution_status
+
+  \fn          void ARM_GPIO_Bus_MeasureTurnaround (const ARM_GPIO_BUS* bus, uint32_t data, uint32_t* drive, uint32_t* release)
+  \brief       Benchmark: DWT cycles of ARM_GPIO_Bus_Drive and ARM_GPIO_Bus_Release,
+               interrupts masked. The bus is left released.
+  \param[in]   bus     Bus object
+  \param[in]   data    Value driven
+  \param[out]  drive   Cycles of ARM_GPIO_Bus_Drive
+  \param[out]  release Cycles of ARM_GPIO_Bus_Release
+  \return      none
+*/
+int32_t  ARM_GPIO_Bus_Initialize(ARM_GPIO_BUS* bus, const ARM_GPIO_BUS_PIN* pins, uint32_t width);
+void     ARM_GPIO_Bus_Write     (const ARM_GPIO_BUS* bus, uint32_t data);
+uint32_t ARM_GPIO_Bus_Read      (const ARM_GPIO_BUS* bus);
+void     ARM_GPIO_Bus_Drive     (const ARM_GPIO_BUS* bus, uint32_t data);
+void     ARM_GPIO_Bus_Release   (const ARM_GPIO_BUS* bus);
+int32_t  ARM_GPIO_Bus_SetIdlePull(ARM_GPIO_BUS* bus, uint32_t pull);
+void     ARM_GPIO_Bus_MeasureTurnaround(const ARM_GPIO_BUS* bus, uint32_t data, uint32_t* drive, uint32_t* release);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_BUS_H_ */
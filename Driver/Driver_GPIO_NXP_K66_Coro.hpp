@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Coroutines waiting for pin edges (C++20; driver built with ARM_GPIO_WAIT=1).
+//
+//     arm_gpio::Task pps()
+//     {
+//         typedef arm_gpio::AwaitablePin<ARM_GPIO_PORT_B, 5> Input;
+//         for (;;)
+//         {
+//             co_await Input::rising();
+//             ...
+//         }
+//     }
+//
+//     if (!arm_gpio::Scheduler::instance().spawn(pps()))
+//         ...                                 // no frame: pool too small
+//     arm_gpio::Scheduler::instance().run();
+//
+// The scheduler is cooperative and runs in one thread (main); the handler
+// only moves fired waiters to its ready list, coroutines are resumed by run()
+// in the order they became ready. Awaiters live in the coroutine frame, so
+// waiting allocates nothing. The frame is allocated when the coroutine is
+// called (pps() above), from FramePool by the promise's operator new, never
+// from the heap; spawn only queues the handle. Tasks are created and
+// destroyed in the scheduler's thread, not in handlers.
+
+#ifndef DRIVER_GPIO_NXP_K66_CORO_HPP_
+#define DRIVER_GPIO_NXP_K66_CORO_HPP_
+
+#include "Driver_GPIO_NXP_K66.hpp"
+#include "Driver_GPIO_NXP_K66_Wait.h"
+
+#include <coroutine>
+#include <cstddef>
+
+#if !ARM_GPIO_WAIT
+#error "Driver_GPIO_NXP_K66_Coro.hpp needs the driver built with ARM_GPIO_WAIT=1"
+#endif
+
+// Frame pool: ARM_GPIO_CORO_FRAMES frames of up to ARM_GPIO_CORO_FRAME_SIZE
+// bytes each.
+#ifndef ARM_GPIO_CORO_FRAMES
+#define ARM_GPIO_CORO_FRAMES        8
+#endif
+
+#ifndef ARM_GPIO_CORO_FRAME_SIZE
+#define ARM_GPIO_CORO_FRAME_SIZE    256
+#endif
+
+namespace arm_gpio
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Fixed blocks for the coroutine frames: blocks not yet used are taken in
+// order, returned ones are kept in a free list.
+class FramePool
+{
+public:
+    // nullptr if the frame is larger than a block or all blocks are in use.
+    static void* take(std::size_t size) noexcept
+    {
+        if (size > ARM_GPIO_CORO_FRAME_SIZE)
+            return nullptr;
+
+        Block* block = free_;
+        if (block)
+            free_ = block->next;
+        else if (used_ < ARM_GPIO_CORO_FRAMES)
+            block = &blocks_[used_++];
+        else
+            return nullptr;
+
+        taken_++;
+        return block->bytes;
+    }
+
+    static void give(void* frame) noexcept
+    {
+        Block* const block = static_cast<Block*>(frame);
+        block->next = free_;
+        free_ = block;
+        taken_--;
+    }
+
+    // Frames that may still be taken.
+    static uint32_t available() { return ARM_GPIO_CORO_FRAMES - taken_; }
+
+private:
+    union alignas(std::max_align_t) Block
+    {
+        Block*        next;
+        unsigned char bytes[ARM_GPIO_CORO_FRAME_SIZE];
+    };
+
+    static inline Block    blocks_[ARM_GPIO_CORO_FRAMES];
+    static inline Block*   free_;
+    static inline uint32_t used_;
+    static inline uint32_t taken_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// A task without a frame (pool exhausted or frame too large) is empty: spawn
+// refuses it.
+class Task
+{
+public:
+    struct promise_type
+    {
+        ARM_GPIO_WAITER start;      // Makes the task ready in spawn
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { for (;;); }
+
+        // noexcept with get_return_object_on_allocation_failure: the call
+        // returns an empty task instead of throwing.
+        static void* operator new(std::size_t size) noexcept { return FramePool::take(size); }
+        static void operator delete(void* frame) noexcept { FramePool::give(frame); }
+        static Task get_return_object_on_allocation_failure() { return Task(nullptr); }
+    };
+
+    Task(Task&& other) : handle_(other.handle_) { other.handle_ = nullptr; }
+    ~Task() { if (handle_) handle_.destroy(); }
+
+    // Hands the coroutine over: the scheduler destroys it when it finishes.
+    std::coroutine_handle<promise_type> release()
+    {
+        const std::coroutine_handle<promise_type> handle = handle_;
+        handle_ = nullptr;
+        return handle;
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Task(const Task&) = delete;
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+class Scheduler
+{
+public:
+    static Scheduler& instance()
+    {
+        static Scheduler scheduler;
+        return scheduler;
+    }
+
+    ARM_GPIO_WAITER* volatile* queue() { return &ready_; }
+
+    // Makes the waiter's coroutine ready; any context, also handlers.
+    void post(ARM_GPIO_WAITER* waiter) { ARM_GPIO_Wait_Push(&ready_, waiter); }
+
+    // false if the task is empty (no frame).
+    bool spawn(Task task)
+    {
+        const std::coroutine_handle<Task::promise_type> handle = task.release();
+        if (!handle)
+            return false;
+
+        handle.promise().start.context = handle.address();
+        post(&handle.promise().start);
+        return true;
+    }
+
+    // Resumes the coroutines ready now; returns false if there were none.
+    bool poll()
+    {
+        ARM_GPIO_WAITER* lifo = ARM_GPIO_Wait_TakeAll(&ready_);
+        if (!lifo)
+            return false;
+
+        ARM_GPIO_WAITER* fifo = nullptr;
+        while (lifo)
+        {
+            ARM_GPIO_WAITER* const next = lifo->next;
+            lifo->next = fifo;
+            fifo = lifo;
+            lifo = next;
+        }
+
+        // The waiter is a part of the frame: next is read before resuming.
+        while (fifo)
+        {
+            ARM_GPIO_WAITER* const next = fifo->next;
+            const std::coroutine_handle<> handle = std::coroutine_handle<>::from_address(fifo->context);
+            handle.resume();
+            if (handle.done())
+                handle.destroy();
+            fifo = next;
+        }
+
+        return true;
+    }
+
+    // Sleeps (WFI) while nothing is ready. Masking interrupts closes the race
+    // with the check: a pending interrupt still ends WFI.
+    [[noreturn]] void run()
+    {
+        for (;;)
+        {
+            if (poll())
+                continue;
+
+            const __istate_t state = __get_interrupt_state();
+            __disable_interrupt();
+            if (!ready_)
+                __WFI();
+            __set_interrupt_state(state);
+        }
+    }
+
+private:
+    Scheduler() : ready_(nullptr) {}
+
+    ARM_GPIO_WAITER* volatile ready_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// co_await result: pins, which fired the wait; 0 if the wait was refused
+// (pins not configured for the edge, ARM_GPIO_Wait_Add).
+class EdgeAwaiter
+{
+public:
+    EdgeAwaiter(uint32_t port, uint32_t mask, uint32_t edge) : port_(port)
+    {
+        waiter_.mask  = mask;
+        waiter_.edge  = edge;
+        waiter_.ready = Scheduler::instance().queue();
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        waiter_.context = handle.address();
+        if (ARM_GPIO_Wait_Add(port_, &waiter_) == ARM_DRIVER_OK)
+            return true;
+
+        waiter_.events = 0;
+        return false;
+    }
+
+    uint32_t await_resume() const noexcept { return waiter_.events; }
+
+private:
+    ARM_GPIO_WAITER waiter_;
+    uint32_t        port_;
+};
+
+// Gives up the processor to other ready coroutines.
+class YieldAwaiter
+{
+public:
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        waiter_.context = handle.address();
+        Scheduler::instance().post(&waiter_);
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    ARM_GPIO_WAITER waiter_;
+};
+
+inline YieldAwaiter yield() { return YieldAwaiter(); }
+
+////////////////////////////////////////////////////////////////////////////////
+// Pin with awaitable edges; the pin interrupt must be configured for the
+// awaited edge (ARM_GPIO_PIN_IRQ_RISING for rising(), _FALLING for falling()),
+// edge() takes any.
+template <uint32_t Port, uint32_t N>
+struct AwaitablePin : Pin<Port, N>
+{
+    static EdgeAwaiter rising()  { return EdgeAwaiter(Port, (1u << N), ARM_GPIO_WAIT_RISING); }
+    static EdgeAwaiter falling() { return EdgeAwaiter(Port, (1u << N), ARM_GPIO_WAIT_FALLING); }
+    static EdgeAwaiter edge()    { return EdgeAwaiter(Port, (1u << N), ARM_GPIO_WAIT_EDGE); }
+};
+
+// Any of the pins of a group.
+template <uint32_t Port, uint32_t... Pins>
+struct AwaitablePinGroup : PinGroup<Port, Pins...>
+{
+    static EdgeAwaiter edge() { return EdgeAwaiter(Port, PinGroup<Port, Pins...>::mask, ARM_GPIO_WAIT_EDGE); }
+};
+
+} // namespace arm_gpio
+
+#endif /* DRIVER_GPIO_NXP_K66_CORO_HPP_ */
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_NXP_K66_Histogram.h"
+
+#define SUB_BITS    ARM_GPIO_HISTOGRAM_SUB_BITS
+#define SUB_COUNT   (1u << SUB_BITS)
+
+uint32_t ARM_GPIO_Histogram_BucketLimit(uint32_t bucket)
+{
+    if (bucket >= ARM_GPIO_HISTOGRAM_BUCKETS - 1)
+        return UINT32_MAX;
+    if (bucket < SUB_COUNT)
+        return bucket;
+
+    // Inverse of ARM_GPIO_Histogram_Bucket.
+    const uint32_t shift = (bucket >> SUB_BITS) - 1;
+    const uint32_t low   = (SUB_COUNT | (bucket & (SUB_COUNT - 1))) << shift;
+    return low + (1u << shift) - 1;
+}
+
+uint32_t ARM_GPIO_Histogram_Percentile(const ARM_GPIO_HISTOGRAM* histogram, uint32_t per_mille)
+{
+    if (!histogram->count)
+        return 0;
+    if (per_mille > 1000)
+        per_mille = 1000;
+
+    // Rank of the value, 1-based, rounded up.
+    uint64_t rank = ((uint64_t)histogram->count * per_mille + 999) / 1000;
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < ARM_GPIO_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += histogram->bucket[i];
+        if (seen >= rank)
+        {
+            const uint32_t limit = ARM_GPIO_Histogram_BucketLimit(i);
+            return (limit < histogram->max) ? limit : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
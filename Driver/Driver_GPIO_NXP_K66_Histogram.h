@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Log-linear histogram of cycle counts (HDR style).
+//
+// Values below 2^SUB_BITS have a bucket each; above, every power of two is
+// split into 2^SUB_BITS buckets, so the bucket width is at most 1/8 of the
+// value (SUB_BITS = 3). Values from 2^RANGE_BITS up share the last bucket.
+// Adding a value is CLZ, shift and increment: no division, no loop.
+
+#ifndef DRIVER_GPIO_NXP_K66_HISTOGRAM_H_
+#define DRIVER_GPIO_NXP_K66_HISTOGRAM_H_
+
+#include <stdint.h>
+#include <intrinsics.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#define ARM_GPIO_HISTOGRAM_SUB_BITS     3
+
+// 2^20 cycles = 5.8 ms at 180 MHz.
+#ifndef ARM_GPIO_HISTOGRAM_RANGE_BITS
+#define ARM_GPIO_HISTOGRAM_RANGE_BITS   20
+#endif
+
+#define ARM_GPIO_HISTOGRAM_BUCKETS      (((ARM_GPIO_HISTOGRAM_RANGE_BITS - ARM_GPIO_HISTOGRAM_SUB_BITS + 1) << ARM_GPIO_HISTOGRAM_SUB_BITS) + 1)
+
+typedef struct
+{
+    uint32_t    count;                                  ///< Number of values
+    uint32_t    max;                                    ///< Largest value
+    uint32_t    bucket[ARM_GPIO_HISTOGRAM_BUCKETS];
+} ARM_GPIO_HISTOGRAM;
+
+static inline uint32_t ARM_GPIO_Histogram_Bucket(uint32_t value)
+{
+    if (value >= (1u << ARM_GPIO_HISTOGRAM_RANGE_BITS))
+        return ARM_GPIO_HISTOGRAM_BUCKETS - 1;
+    if (value < (1u << ARM_GPIO_HISTOGRAM_SUB_BITS))
+        return value;
+
+    const uint32_t exp = 31 - __CLZ(value);
+    return ((exp - ARM_GPIO_HISTOGRAM_SUB_BITS + 1) << ARM_GPIO_HISTOGRAM_SUB_BITS)
+         | ((value >> (exp - ARM_GPIO_HISTOGRAM_SUB_BITS)) & ((1u << ARM_GPIO_HISTOGRAM_SUB_BITS) - 1));
+}
+
+static inline void ARM_GPIO_Histogram_Add(ARM_GPIO_HISTOGRAM* histogram, uint32_t value)
+{
+    histogram->bucket[ARM_GPIO_Histogram_Bucket(value)]++;
+    histogram->count++;
+    if (value > histogram->max)
+        histogram->max = value;
+}
+
+/**
+  \fn          uint32_t ARM_GPIO_Histogram_BucketLimit (uint32_t bucket)
+  \brief       Largest value counted in the bucket.
+  \param[in]   bucket    Index of the bucket
+  \return      Upper limit; UINT32_MAX for the last bucket
+
+  \fn          uint32_t ARM_GPIO_Histogram_Percentile (const ARM_GPIO_HISTOGRAM* histogram, uint32_t per_mille)
+  \brief       Value, which per_mille/1000 of the values don't exceed
+               (p50 = 500, p99 = 990, p99.9 = 999).
+               Result is the upper limit of the bucket, never above the largest value.
+  \param[in]   histogram Histogram
+  \param[in]   per_mille Percentile, 0..1000
+  \return      Value; 0 for an empty histogram
+*/
+uint32_t ARM_GPIO_Histogram_BucketLimit(uint32_t bucket);
+uint32_t ARM_GPIO_Histogram_Percentile (const ARM_GPIO_HISTOGRAM* histogram, uint32_t per_mille);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_HISTOGRAM_H_ */
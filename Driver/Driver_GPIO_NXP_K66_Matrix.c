@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_NXP_K66_Matrix.h"
+
+#include <intrinsics.h>
+
+static inline void matrix_delay(uint32_t n)
+{
+    while (n--)
+        __NOP();
+}
+
+// Rows are active low: pressed = 1.
+static inline uint32_t matrix_rows(const ARM_GPIO_MATRIX* matrix)
+{
+    return ~ARM_GPIO_Bus_Read(&matrix->rows) & ((1u << matrix->row_count) - 1);
+}
+
+static void matrix_row_irq(const ARM_GPIO_MATRIX* matrix, uint32_t irq)
+{
+    for (uint32_t i = 0; i < matrix->row_count; i++)
+    {
+        const ARM_GPIO_BUS_PIN pin = matrix->row_pins[i];
+        gpio_drivers[pin.port]->ControlPin(pin.pin, ARM_GPIO_PIN_IRQ, irq);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int32_t ARM_GPIO_Matrix_Initialize(ARM_GPIO_MATRIX* matrix, const ARM_GPIO_BUS_PIN* rows, uint32_t row_count,
+                                   const ARM_GPIO_BUS_PIN* columns, uint32_t column_count, uint32_t settle)
+{
+    if (row_count == 0 || row_count > ARM_GPIO_MATRIX_SIZE_MAX ||
+        column_count == 0 || column_count > ARM_GPIO_MATRIX_SIZE_MAX)
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    const int32_t status = ARM_GPIO_Bus_Initialize(&matrix->rows, rows, row_count);
+    if (status != ARM_DRIVER_OK)
+        return status;
+
+    for (uint32_t i = 0; i < column_count; i++)
+    {
+        if (columns[i].port >= ARM_GPIO_PORT_COUNT || columns[i].pin >= 32)
+            return ARM_DRIVER_ERROR_PARAMETER;
+
+        matrix->columns[i].gpio = gpio_ports[columns[i].port]->gpio;
+        matrix->columns[i].mask = (1u << columns[i].pin);
+    }
+
+    for (uint32_t i = 0; i < column_count; i++)
+    {
+        matrix->columns[i].next_shared = (i + 1 < column_count) &&
+                                         (matrix->columns[i + 1].gpio == matrix->columns[i].gpio);
+        matrix->columns[i].gpio->PSOR = matrix->columns[i].mask;
+    }
+
+    for (uint32_t i = 0; i < row_count; i++)
+        matrix->row_pins[i] = rows[i];
+
+    matrix->row_count    = row_count;
+    matrix->column_count = column_count;
+    matrix->settle       = settle;
+    matrix->idle         = 0;
+    matrix->state        = 0;
+    matrix->count0       = ~(uint64_t)0;
+    matrix->count1       = ~(uint64_t)0;
+
+    return ARM_DRIVER_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint64_t ARM_GPIO_Matrix_Scan(ARM_GPIO_MATRIX* matrix)
+{
+    const ARM_GPIO_MATRIX_COLUMN* column = matrix->columns;
+    uint64_t raw = 0;
+
+    column->gpio->PCOR = column->mask;
+
+    for (uint32_t c = 0; c < matrix->column_count; c++, column++)
+    {
+        matrix_delay(matrix->settle);
+        raw |= (uint64_t)matrix_rows(matrix) << (c * 8);
+
+        // Release this column, drive the next one.
+        if (column->next_shared)
+        {
+            column->gpio->PTOR = column->mask | column[1].mask;
+        }
+        else
+        {
+            column->gpio->PSOR = column->mask;
+            if (c + 1 < matrix->column_count)
+                column[1].gpio->PCOR = column[1].mask;
+        }
+    }
+
+    // Vertical counters: per key, 2-bit count of scans differing from the
+    // debounced state; reset when equal, state toggles on the 4th.
+    uint64_t delta = matrix->state ^ raw;
+    matrix->count0 = ~(matrix->count0 & delta);
+    matrix->count1 = matrix->count0 ^ (matrix->count1 & delta);
+    delta &= matrix->count0 & matrix->count1;
+    matrix->state ^= delta;
+
+    return delta;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int32_t ARM_GPIO_Matrix_Idle(ARM_GPIO_MATRIX* matrix)
+{
+    if (matrix->state)
+        return ARM_DRIVER_ERROR_BUSY;
+
+    for (uint32_t c = 0; c < matrix->column_count; c++)
+        matrix->columns[c].gpio->PCOR = matrix->columns[c].mask;
+    matrix_delay(matrix->settle);
+
+    // Stale flags of the scan edges must not wake us up.
+    for (uint32_t i = 0; i < matrix->row_count; i++)
+        gpio_ports[matrix->row_pins[i].port]->port->ISFR = (1u << matrix->row_pins[i].pin);
+
+    matrix->idle = 1;
+    matrix_row_irq(matrix, ARM_GPIO_PIN_IRQ_FALLING);
+
+    // Key pressed before the interrupts were armed: its edge is gone.
+    if (matrix_rows(matrix))
+    {
+        ARM_GPIO_Matrix_Wake(matrix);
+        return ARM_DRIVER_ERROR_BUSY;
+    }
+
+    return ARM_DRIVER_OK;
+}
+
+void ARM_GPIO_Matrix_Wake(ARM_GPIO_MATRIX* matrix)
+{
+    if (!matrix->idle)
+        return;
+
+    matrix->idle = 0;
+    matrix_row_irq(matrix, ARM_GPIO_PIN_IRQ_NONE);
+
+    for (uint32_t c = 0; c < matrix->column_count; c++)
+        matrix->columns[c].gpio->PSOR = matrix->columns[c].mask;
+}
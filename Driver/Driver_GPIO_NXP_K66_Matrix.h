@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Key matrix scanner, up to 8 columns x 8 rows.
+//
+// Columns are driven low one at a time, rows are read back as a bus
+// (one PDIR load per row port). Moving to the next column is a single PTOR
+// store when both columns share a port. Key state is a 64-bit set,
+// bit (column * 8 + row), debounced with 2-bit vertical counters:
+// a key changes after 4 equal scans, all keys in a few logic operations.
+//
+// Idle: all columns low and falling-edge interrupts on the rows; scanning
+// resumes with ARM_GPIO_Matrix_Wake from the port callback.
+//
+// Pins must be configured by the caller: columns - GPIO outputs with open
+// drain (two keys of one row must not short a high column to a low one),
+// rows - GPIO inputs with pull-up.
+
+#ifndef DRIVER_GPIO_NXP_K66_MATRIX_H_
+#define DRIVER_GPIO_NXP_K66_MATRIX_H_
+
+#include "Driver_GPIO_NXP_K66_Bus.h"
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#define ARM_GPIO_MATRIX_SIZE_MAX    8
+
+typedef struct
+{
+    GPIO_MemMapPtr  gpio;
+    uint32_t        mask;
+    uint32_t        next_shared;        ///< Next column is on the same port
+} ARM_GPIO_MATRIX_COLUMN;
+
+typedef struct
+{
+    ARM_GPIO_BUS            rows;
+    ARM_GPIO_BUS_PIN        row_pins[ARM_GPIO_MATRIX_SIZE_MAX];
+    ARM_GPIO_MATRIX_COLUMN  columns[ARM_GPIO_MATRIX_SIZE_MAX];
+    uint8_t                 row_count;
+    uint8_t                 column_count;
+    uint8_t                 idle;
+    uint32_t                settle;         ///< Wait after column switch, loop iterations
+    uint64_t                state;          ///< Debounced keys, 1 = pressed
+    uint64_t                count0;         ///< Vertical counter
+    uint64_t                count1;
+} ARM_GPIO_MATRIX;
+
+#define ARM_GPIO_MATRIX_KEY(column, row)    ((uint64_t)1 << ((column) * 8 + (row)))
+
+/**
+  \fn          int32_t ARM_GPIO_Matrix_Initialize (ARM_GPIO_MATRIX* matrix, const ARM_GPIO_BUS_PIN* rows, uint32_t row_count, const ARM_GPIO_BUS_PIN* columns, uint32_t column_count, uint32_t settle)
+  \brief       Resolve pins and release all columns.
+  \param[out]  matrix        Matrix object
+  \param[in]   rows          Row pins
+  \param[in]   row_count     1..8
+  \param[in]   columns       Column pins
+  \param[in]   column_count  1..8
+  \param[in]   settle        Wait after driving a column, before the rows are read
+  \return      \ref execution_status
+
+  \fn          uint64_t ARM_GPIO_Matrix_Scan (ARM_GPIO_MATRIX* matrix)
+  \brief       Scan all columns and debounce.
+  \param[in]   matrix        Matrix object
+  \return      Keys, which debounced state changed (new state in matrix->state)
+
+  \fn          int32_t ARM_GPIO_Matrix_Idle (ARM_GPIO_MATRIX* matrix)
+  \brief       Stop scanning: drive all columns and arm falling-edge interrupts on the rows.
+  \param[in]   matrix        Matrix object
+  \return      ARM_DRIVER_OK; ARM_DRIVER_ERROR_BUSY if a key is pressed (keep scanning)
+
+  \fn          void ARM_GPIO_Matrix_Wake (ARM_GPIO_MATRIX* matrix)
+  \brief       Disarm row interrupts and release the columns; may be called from the port callback.
+  \param[in]   matrix        Matrix object
+  \return      none
+*/
+int32_t  ARM_GPIO_Matrix_Initialize(ARM_GPIO_MATRIX* matrix, const ARM_GPIO_BUS_PIN* rows, uint32_t row_count,
+                                    const ARM_GPIO_BUS_PIN* columns, uint32_t column_count, uint32_t settle);
+uint64_t ARM_GPIO_Matrix_Scan      (ARM_GPIO_MATRIX* matrix);
+int32_t  ARM_GPIO_Matrix_Idle      (ARM_GPIO_MATRIX* matrix);
+void     ARM_GPIO_Matrix_Wake      (ARM_GPIO_MATRIX* matrix);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_MATRIX_H_ */
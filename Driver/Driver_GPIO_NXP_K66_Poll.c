@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_NXP_K66_Poll.h"
+
+#include <intrinsics.h>
+
+typedef struct
+{
+    uint32_t    rising;     // pins reported on 0 -> 1
+    uint32_t    falling;    // pins reported on 1 -> 0
+    uint32_t    high;       // pins reported while 1
+    uint32_t    low;        // pins reported while 0
+    uint32_t    last;       // PDIR of the previous pass
+} ARM_GPIO_POLL_PORT;
+
+static ARM_GPIO_POLL_PORT poll_ports[ARM_GPIO_PORT_COUNT];
+static uint32_t           poll_enabled;
+
+////////////////////////////////////////////////////////////////////////////////
+int32_t ARM_GPIO_Poll_Enable(uint32_t port, uint32_t enable)
+{
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    const ARM_GPIO_CONFIG* cfg = gpio_ports[port];
+    if (cfg->state->power == ARM_POWER_OFF)
+        return ARM_DRIVER_ERROR;
+    
+    if (!enable)
+    {
+        poll_enabled &= ~(1u << port);
+        gpio_drivers[port]->Control(ARM_GPIO_CONTROL_CLEAR_EVENTS, 0);
+        return gpio_drivers[port]->Control(ARM_GPIO_CONTROL_IRQ, 1);
+    }
+    
+    gpio_drivers[port]->Control(ARM_GPIO_CONTROL_IRQ, 0);
+    
+    ARM_GPIO_POLL_PORT* poll = &poll_ports[port];
+    poll->rising  = 0;
+    poll->falling = 0;
+    poll->high    = 0;
+    poll->low     = 0;
+    
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        const uint32_t bit = (1u << pin);
+        switch ((ARM_GPIO_GetPCR(cfg, pin) & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT)
+        {
+            case ARM_GPIO_IRQC_RISING:      poll->rising  |= bit;                       break;
+            case ARM_GPIO_IRQC_FALLING:     poll->falling |= bit;                       break;
+            case ARM_GPIO_IRQC_EITHER:      poll->rising  |= bit; poll->falling |= bit; break;
+            case ARM_GPIO_IRQC_LEVEL_HIGH:  poll->high    |= bit;                       break;
+            case ARM_GPIO_IRQC_LEVEL_LOW:   poll->low     |= bit;                       break;
+            default: break;
+        }
+    }
+    
+    poll->last = cfg->gpio->PDIR;
+    poll_enabled |= (1u << port);
+    
+    return ARM_DRIVER_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint32_t ARM_GPIO_Poll(void)
+{
+    const uint32_t enabled = poll_enabled;
+    uint32_t pdir[ARM_GPIO_PORT_COUNT];
+    
+    // Sample first, then process: ports are read within a few bus cycles.
+    for (uint32_t left = enabled; left; left &= left - 1)
+    {
+        const uint32_t port = __CLZ(__RBIT(left));
+        pdir[port] = gpio_ports[port]->gpio->PDIR;
+    }
+    
+    uint32_t active = 0;
+    for (uint32_t left = enabled; left; left &= left - 1)
+    {
+        const uint32_t port = __CLZ(__RBIT(left));
+        ARM_GPIO_POLL_PORT* poll = &poll_ports[port];
+        
+        const uint32_t levels  = pdir[port];
+        const uint32_t changed = levels ^ poll->last;
+        poll->last = levels;
+        
+        const uint32_t events = (changed & ((levels & poll->rising) | (~levels & poll->falling))) |
+                                (levels & poll->high) | (~levels & poll->low);
+        if (!events)
+            continue;
+        
+        active |= (1u << port);
+        ARM_GPIO_DispatchEvents(gpio_ports[port], events);
+    }
+    
+    return active;
+}
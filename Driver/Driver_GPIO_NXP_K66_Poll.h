@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Polled pin events, for inputs too fast for an interrupt per edge.
+//
+// A polled port has its interrupt disabled; ARM_GPIO_Poll reads PDIR of all
+// polled ports back to back, compares them with the previous pass and
+// delivers the events through ARM_GPIO_DispatchEvents as the interrupt
+// handler does - the same ARM_GPIO_SignalEvent_t callback and mask, and the
+// wait lists (ARM_GPIO_WAIT) - so the mode can be chosen per port without
+// changing the application. Events are taken from the pin interrupt
+// configuration (ARM_GPIO_PIN_IRQ): edges are reported once, levels on every
+// pass while active.
+//
+// Call ARM_GPIO_Poll from a timer interrupt or the idle loop; detection
+// latency is one polling period, pulses shorter than it are lost.
+
+#ifndef DRIVER_GPIO_NXP_K66_POLL_H_
+#define DRIVER_GPIO_NXP_K66_POLL_H_
+
+#include "Driver_GPIO_NXP_K66.h"
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+/**
+  \fn          int32_t ARM_GPIO_Poll_Enable (uint32_t port, uint32_t enable)
+  \brief       Switch the port between polling and its interrupt.
+               Enabling reads the pin interrupt configuration and disables
+               the port interrupt; call it again after the configuration changes.
+               Disabling clears stale pin flags and enables the interrupt.
+               Must not run concurrently with ARM_GPIO_Poll.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   enable    1: polling, 0: interrupt
+  \return      \ref execution_status
+
+  \fn          uint32_t ARM_GPIO_Poll (void)
+  \brief       One polling pass over all polled ports.
+  \return      Ports, which signalled events (bit n = ARM_GPIO_PORT_x)
+*/
+int32_t  ARM_GPIO_Poll_Enable(uint32_t port, uint32_t enable);
+uint32_t ARM_GPIO_Poll       (void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_POLL_H_ */
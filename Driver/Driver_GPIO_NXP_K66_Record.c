@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_NXP_K66_Record.h"
+#include "Driver_GPIO_NXP_K66.h"
+
+#include <intrinsics.h>
+
+static uint8_t*          record_buffer;
+static uint32_t          record_size;
+static uint32_t          record_length;
+static uint32_t          record_last;       // DWT_CYCCNT of the last stored record
+static uint32_t          record_dropped;
+static volatile uint32_t record_on;
+
+static uint32_t varint_put(uint8_t* data, uint32_t n, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        data[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    data[n++] = (uint8_t)value;
+    return n;
+}
+
+// Returns bytes consumed, 0 if truncated or longer than 32 bits.
+static uint32_t varint_get(const uint8_t* data, uint32_t length, uint32_t* value)
+{
+    uint32_t result = 0;
+    for (uint32_t n = 0; n < length && n < 5; n++)
+    {
+        result |= (uint32_t)(data[n] & 0x7F) << (7 * n);
+        if (!(data[n] & 0x80))
+        {
+            *value = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int32_t ARM_GPIO_Record_Start(uint8_t* buffer, uint32_t size)
+{
+    if (!buffer)
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    ARM_GPIO_CycleCounterStart();
+
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+
+    record_buffer  = buffer;
+    record_size    = size;
+    record_length  = 0;
+    record_dropped = 0;
+    record_last    = DWT_CYCCNT;
+    record_on      = 1;
+
+    __set_interrupt_state(istate);
+
+    return ARM_DRIVER_OK;
+}
+
+uint32_t ARM_GPIO_Record_Stop(uint32_t* dropped)
+{
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+
+    record_on = 0;
+    const uint32_t length = record_length;
+    if (dropped)
+        *dropped = record_dropped;
+
+    __set_interrupt_state(istate);
+
+    return length;
+}
+
+// Called with interrupts masked: ports may interrupt each other, time and
+// buffer position of the records stay in the same order.
+static void record_put(const uint8_t* data, uint32_t n, uint32_t now)
+{
+    if (!record_dropped && record_size - record_length >= n)
+    {
+        for (uint32_t i = 0; i < n; i++)
+            record_buffer[record_length + i] = data[i];
+        record_length += n;
+        record_last    = now;
+    }
+    else
+    {
+        record_dropped++;
+    }
+}
+
+void ARM_GPIO_Record_Event(uint32_t port, uint32_t mask)
+{
+    if (!record_on)
+        return;
+
+    uint8_t data[ARM_GPIO_RECORD_SIZE_MAX];
+
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+
+    if (record_on)
+    {
+        const uint32_t now = DWT_CYCCNT;
+
+        uint32_t n = 0;
+        data[n++] = (uint8_t)port;
+        n = varint_put(data, n, now - record_last);
+        n = varint_put(data, n, mask);
+        record_put(data, n, now);
+    }
+
+    __set_interrupt_state(istate);
+}
+
+void ARM_GPIO_Record_Tick(void)
+{
+    if (!record_on)
+        return;
+
+    uint8_t data[ARM_GPIO_RECORD_SIZE_MAX];
+
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+
+    const uint32_t now = DWT_CYCCNT;
+    if (record_on && now - record_last >= 0x80000000u)
+    {
+        uint32_t n = 0;
+        data[n++] = ARM_GPIO_RECORD_GAP;
+        n = varint_put(data, n, now - record_last);
+        record_put(data, n, now);
+    }
+
+    __set_interrupt_state(istate);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint32_t ARM_GPIO_Record_Decode(const uint8_t* data, uint32_t length, ARM_GPIO_RECORD_EVENT* event)
+{
+    if (length < 2)
+        return 0;
+
+    event->port = data[0];
+    event->mask = 0;
+
+    uint32_t n = 1;
+    uint32_t used = varint_get(data + n, length - n, &event->delta);
+    if (!used)
+        return 0;
+    n += used;
+
+    if (event->port == ARM_GPIO_RECORD_GAP)
+        return n;
+
+    used = varint_get(data + n, length - n, &event->mask);
+    if (!used)
+        return 0;
+
+    return n + used;
+}
+
+// Waits for the cycles since the previous deadline: unsigned, so a gap
+// record up to 2^32 - 1 cycles is waited for as well.
+int32_t ARM_GPIO_Replay(const uint8_t* trace, uint32_t length, uint32_t speedup, uint32_t* lag_max)
+{
+    uint32_t lag = 0;
+
+    ARM_GPIO_CycleCounterStart();
+    uint32_t deadline = DWT_CYCCNT;
+
+    for (uint32_t pos = 0; pos < length; )
+    {
+        ARM_GPIO_RECORD_EVENT event;
+        const uint32_t used = ARM_GPIO_Record_Decode(trace + pos, length - pos, &event);
+        if (!used || (event.port >= ARM_GPIO_PORT_COUNT && event.port != ARM_GPIO_RECORD_GAP))
+            return ARM_DRIVER_ERROR_PARAMETER;
+        pos += used;
+
+        if (speedup)
+        {
+            const uint32_t step = event.delta / speedup;
+            while (DWT_CYCCNT - deadline < step);
+
+            const uint32_t late = DWT_CYCCNT - deadline - step;
+            if (late > lag)
+                lag = late;
+            deadline += step;
+        }
+
+        if (event.port == ARM_GPIO_RECORD_GAP)
+            continue;
+
+        const __istate_t istate = __get_interrupt_state();
+        __disable_interrupt();
+
+        ARM_GPIO_DispatchEvents(gpio_ports[event.port], event.mask);
+
+        __set_interrupt_state(istate);
+    }
+
+    if (lag_max)
+        *lag_max = lag;
+
+    return ARM_DRIVER_OK;
+}
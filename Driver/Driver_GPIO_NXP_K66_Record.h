@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Record and replay of port events (build the driver with ARM_GPIO_RECORD=1).
+//
+// While recording, every port interrupt (and LLWU wake-up) appends a record:
+//
+//   byte       port index (ARM_GPIO_PORT_x)
+//   varint     DWT cycles since the previous record (modulo 2^32)
+//   varint     mask of pins (ISFR)
+//
+// and ARM_GPIO_Record_Tick a gap record, when the previous one is 2^31 cycles
+// or more ago, so no delta wraps the 32-bit counter:
+//
+//   byte       ARM_GPIO_RECORD_GAP
+//   varint     DWT cycles since the previous record
+//
+// Varint: 7 bits per byte, least significant first, bit 7 set = more bytes.
+// Delta of the first record is counted from ARM_GPIO_Record_Start.
+// A record, which doesn't fit into the buffer, is dropped and so are all
+// after it: the stored records keep their exact times.
+//
+// The format has no device dependency, so records can be decoded off-target.
+
+#ifndef DRIVER_GPIO_NXP_K66_RECORD_H_
+#define DRIVER_GPIO_NXP_K66_RECORD_H_
+
+#include <stdint.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#define ARM_GPIO_RECORD_SIZE_MAX    11      ///< Longest record, bytes
+#define ARM_GPIO_RECORD_GAP         0xFFu   ///< Port byte of a gap record
+
+typedef struct
+{
+    uint32_t    port;           ///< ARM_GPIO_PORT_x, ARM_GPIO_RECORD_GAP
+    uint32_t    mask;           ///< Pins, which events occurred; 0 for a gap
+    uint32_t    delta;          ///< Cycles since the previous record
+} ARM_GPIO_RECORD_EVENT;
+
+/**
+  \fn          int32_t ARM_GPIO_Record_Start (uint8_t* buffer, uint32_t size)
+  \brief       Start recording into the buffer; a running record is discarded.
+  \param[in]   buffer    Storage of the record
+  \param[in]   size      Size of the buffer, bytes
+  \return      \ref execution_status
+
+  \fn          uint32_t ARM_GPIO_Record_Stop (uint32_t* dropped)
+  \brief       Stop recording.
+  \param[out]  dropped   Number of dropped records (may be NULL)
+  \return      Length of the record, bytes
+
+  \fn          void ARM_GPIO_Record_Tick (void)
+  \brief       Append a gap record, if the previous record is 2^31 cycles or more ago.
+               Must be called at least every 2^31 cycles while recording
+               (e.g. from a periodic timer); any context.
+  \return      none
+
+  \fn          void ARM_GPIO_Record_Event (uint32_t port, uint32_t mask)
+  \brief       Append record of the port event; called by the driver.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   mask      Pins, which events occurred
+  \return      none
+
+  \fn          uint32_t ARM_GPIO_Record_Decode (const uint8_t* data, uint32_t length, ARM_GPIO_RECORD_EVENT* event)
+  \brief       Decode one record.
+  \param[in]   data      Start of the record
+  \param[in]   length    Bytes left in the trace
+  \param[out]  event     Decoded record
+  \return      Length of the record, bytes; 0 if the data is truncated or malformed
+
+  \fn          int32_t ARM_GPIO_Replay (const uint8_t* trace, uint32_t length, uint32_t speedup, uint32_t* lag_max)
+  \brief       Deliver recorded events to the ports (ARM_GPIO_DispatchEvents, with
+               interrupts masked), at recorded time intervals divided by speedup.
+               Runs in the caller's context; ports must be initialized.
+  \param[in]   trace     Record
+  \param[in]   length    Length of the record, bytes
+  \param[in]   speedup   Time divider; 1 = original timing, 0 = no waiting
+  \param[out]  lag_max   Largest delay of a callback behind its schedule, cycles (may be NULL)
+  \return      \ref execution_status
+*/
+int32_t  ARM_GPIO_Record_Start (uint8_t* buffer, uint32_t size);
+uint32_t ARM_GPIO_Record_Stop  (uint32_t* dropped);
+void     ARM_GPIO_Record_Tick  (void);
+void     ARM_GPIO_Record_Event (uint32_t port, uint32_t mask);
+uint32_t ARM_GPIO_Record_Decode(const uint8_t* data, uint32_t length, ARM_GPIO_RECORD_EVENT* event);
+int32_t  ARM_GPIO_Replay       (const uint8_t* trace, uint32_t length, uint32_t speedup, uint32_t* lag_max);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_RECORD_H_ */
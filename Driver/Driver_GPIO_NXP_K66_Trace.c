@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_NXP_K66.h"
+
+#if ARM_GPIO_TRACE
+
+_Static_assert((ARM_GPIO_TRACE_SIZE & (ARM_GPIO_TRACE_SIZE - 1)) == 0 && ARM_GPIO_TRACE_SIZE <= 0x800000,
+               "ARM_GPIO_TRACE_SIZE must be a power of two, up to 2^23");
+
+ARM_GPIO_TRACE_RECORD gpio_trace[ARM_GPIO_TRACE_SIZE];
+volatile uint32_t     gpio_trace_head;
+
+void ARM_GPIO_Trace_Start(void)
+{
+    ARM_GPIO_CycleCounterStart();
+
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+
+    for (uint32_t i = 0; i < ARM_GPIO_TRACE_SIZE; i++)
+        gpio_trace[i].info = 0;
+    gpio_trace_head = 0;
+
+    __set_interrupt_state(istate);
+}
+
+uint32_t ARM_GPIO_Trace_Copy(ARM_GPIO_TRACE_RECORD* records, uint32_t max)
+{
+    // Oldest slot is the next one to be written; empty slots are skipped.
+    const uint32_t head = gpio_trace_head;
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < ARM_GPIO_TRACE_SIZE && count < max; i++)
+    {
+        const ARM_GPIO_TRACE_RECORD* record = &gpio_trace[(head + i) & (ARM_GPIO_TRACE_SIZE - 1)];
+        if (record->info)
+            records[count++] = *record;
+    }
+
+    return count;
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Trace of driver operations in a circular RAM buffer (ARM_GPIO_TRACE=1).
+//
+// Every Set/Clear/Toggle/Write of pins, ControlPin and port interrupt adds
+// an 8-byte record:
+//
+//   info   [31:8] DWT_CYCCNT[23:0], [7:3] operation, [2:0] port
+//   mask   pins (interrupt: ISFR); ControlPin: arg[15:0] << 16 | control << 8 | pin
+//
+// When DWT_CYCCNT[31:24] differs from the previous record, a SYNC record
+// with the full counter in mask goes first. A gap between records of 255
+// epochs (2^32 - 2^24 cycles) or more can't be told from a shorter one.
+//
+// Slots are reserved with LDREX/STREX on the head, so the trace is safe
+// from any interrupt priority; a record is 2 stores after the reservation.
+// tools/gpio_trace_vcd.c converts ARM_GPIO_Trace_Copy output into VCD.
+
+#ifndef DRIVER_GPIO_NXP_K66_TRACE_H_
+#define DRIVER_GPIO_NXP_K66_TRACE_H_
+
+#include <stdint.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+// Operations; 0 marks an empty slot.
+#define ARM_GPIO_TRACE_SYNC         1
+#define ARM_GPIO_TRACE_CLEAR        2       ///< ClearPort/ClearPin, WritePin(0)
+#define ARM_GPIO_TRACE_SET          3       ///< SetPort/SetPin, WritePin(1); must be CLEAR + 1
+#define ARM_GPIO_TRACE_TOGGLE       4       ///< TogglePort/TogglePin
+#define ARM_GPIO_TRACE_WRITE        5       ///< WritePort
+#define ARM_GPIO_TRACE_CONTROL_PIN  6       ///< ControlPin
+#define ARM_GPIO_TRACE_IRQ          7       ///< Port interrupt
+
+typedef struct
+{
+    uint32_t    info;
+    uint32_t    mask;
+} ARM_GPIO_TRACE_RECORD;
+
+#define ARM_GPIO_TRACE_STAMP(record)    ((record)->info >> 8)
+#define ARM_GPIO_TRACE_OP(record)       (((record)->info >> 3) & 0x1F)
+#define ARM_GPIO_TRACE_PORT(record)     ((record)->info & 0x07)
+
+/**
+  \fn          void ARM_GPIO_Trace_Start (void)
+  \brief       Empty the trace and start the cycle counter.
+  \return      none
+
+  \fn          uint32_t ARM_GPIO_Trace_Copy (ARM_GPIO_TRACE_RECORD* records, uint32_t max)
+  \brief       Copy the trace, oldest record first.
+               Tracing should be stopped meanwhile (nothing is traced while
+               the port drivers aren't used); the oldest record may not be SYNC.
+  \param[out]  records   Destination
+  \param[in]   max       Size of the destination, records
+  \return      Number of records copied
+*/
+void     ARM_GPIO_Trace_Start(void);
+uint32_t ARM_GPIO_Trace_Copy (ARM_GPIO_TRACE_RECORD* records, uint32_t max);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_TRACE_H_ */
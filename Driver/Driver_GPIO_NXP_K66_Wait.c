@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_GPIO_NXP_K66_Wait.h"
+#include "Driver_GPIO_NXP_K66.h"
+
+#include <intrinsics.h>
+
+static ARM_GPIO_WAITER* volatile wait_lists[ARM_GPIO_PORT_COUNT];
+
+////////////////////////////////////////////////////////////////////////////////
+// Exception entry clears the exclusive monitor: a push interrupted by another
+// push or take-all is retried on the new head.
+void ARM_GPIO_Wait_Push(ARM_GPIO_WAITER* volatile* list, ARM_GPIO_WAITER* waiter)
+{
+    unsigned long* const head = (unsigned long*)list;
+    do
+    {
+        waiter->next = (ARM_GPIO_WAITER*)__LDREX(head);
+    } while (__STREX((unsigned long)waiter, head));
+}
+
+ARM_GPIO_WAITER* ARM_GPIO_Wait_TakeAll(ARM_GPIO_WAITER* volatile* list)
+{
+    unsigned long* const head = (unsigned long*)list;
+    ARM_GPIO_WAITER* first;
+    do
+    {
+        first = (ARM_GPIO_WAITER*)__LDREX(head);
+    } while (__STREX(0, head));
+    
+    return first;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int32_t ARM_GPIO_Wait_Add(uint32_t port, ARM_GPIO_WAITER* waiter)
+{
+    if (port >= ARM_GPIO_PORT_COUNT || !waiter->mask || !waiter->ready || waiter->edge > ARM_GPIO_WAIT_FALLING)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    // Checked once: the pin configuration is not expected to change under a waiter.
+    const ARM_GPIO_CONFIG* cfg = gpio_ports[port];
+    switch (waiter->edge)
+    {
+        case ARM_GPIO_WAIT_RISING:
+            if (ARM_GPIO_IrqcPins(cfg, waiter->mask, ARM_GPIO_IRQC_RISING) != waiter->mask)
+                return ARM_DRIVER_ERROR_UNSUPPORTED;
+            break;
+        case ARM_GPIO_WAIT_FALLING:
+            if (ARM_GPIO_IrqcPins(cfg, waiter->mask, ARM_GPIO_IRQC_FALLING) != waiter->mask)
+                return ARM_DRIVER_ERROR_UNSUPPORTED;
+            break;
+        default:
+            break;
+    }
+    
+    waiter->events = 0;
+    ARM_GPIO_Wait_Push(&wait_lists[port], waiter);
+    return ARM_DRIVER_OK;
+}
+
+// The list is taken as a whole: waiters added meanwhile go to the new list
+// and wait for the next event; the others are pushed back.
+void ARM_GPIO_Wait_Signal(uint32_t port, uint32_t events, uint32_t rising, uint32_t falling)
+{
+    ARM_GPIO_WAITER* waiter = ARM_GPIO_Wait_TakeAll(&wait_lists[port]);
+    
+    while (waiter)
+    {
+        ARM_GPIO_WAITER* const next = waiter->next;
+        
+        uint32_t fired = events & waiter->mask;
+        switch (waiter->edge)
+        {
+            case ARM_GPIO_WAIT_RISING:  fired &= rising;  break;
+            case ARM_GPIO_WAIT_FALLING: fired &= falling; break;
+            default: break;
+        }
+        
+        if (fired)
+        {
+            waiter->events = fired;
+            ARM_GPIO_Wait_Push(waiter->ready, waiter);
+        }
+        else
+        {
+            ARM_GPIO_Wait_Push(&wait_lists[port], waiter);
+        }
+        
+        waiter = next;
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Waiting for pin edges without callbacks (build the driver with ARM_GPIO_WAIT=1).
+//
+// A waiter is a node owned by the waiting code (no allocation). It is added to
+// the wait list of the port; the port interrupt handler moves waiters, which
+// pins had an event, to their ready list. Both lists are lock-free stacks
+// (LDREX/STREX push, take-all), safe between any mix of threads and handlers.
+//
+// Edges come from the pin interrupt configuration (ARM_GPIO_PIN_IRQ): a
+// rising or falling waiter needs its pins configured for that edge, an event
+// of a pin interrupting on both edges only fires edge waiters (the level read
+// in the handler may have changed again since the edge).
+// A waiter can't be removed before it fires.
+
+#ifndef DRIVER_GPIO_NXP_K66_WAIT_H_
+#define DRIVER_GPIO_NXP_K66_WAIT_H_
+
+#include <stdint.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#define ARM_GPIO_WAIT_EDGE      0       ///< Any event of the pin
+#define ARM_GPIO_WAIT_RISING    1       ///< Event of a pin with ARM_GPIO_PIN_IRQ_RISING
+#define ARM_GPIO_WAIT_FALLING   2       ///< Event of a pin with ARM_GPIO_PIN_IRQ_FALLING
+
+typedef struct ARM_GPIO_WAITER
+{
+    struct ARM_GPIO_WAITER*             next;
+    struct ARM_GPIO_WAITER* volatile*   ready;      ///< List the waiter moves to when it fires
+    void*                               context;    ///< Owner's data (e.g. coroutine handle)
+    uint32_t                            mask;       ///< Pins waited for
+    uint32_t                            edge;       ///< ARM_GPIO_WAIT_x
+    uint32_t                            events;     ///< Pins, which fired the waiter
+} ARM_GPIO_WAITER;
+
+/**
+  \fn          int32_t ARM_GPIO_Wait_Add (uint32_t port, ARM_GPIO_WAITER* waiter)
+  \brief       Wait for an event on the pins of waiter->mask.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   waiter    Waiter; mask, edge and ready must be set
+  \return      \ref execution_status;
+               ARM_DRIVER_ERROR_UNSUPPORTED if a pin of a rising or falling waiter
+               doesn't interrupt on that edge alone
+
+  \fn          void ARM_GPIO_Wait_Signal (uint32_t port, uint32_t events, uint32_t rising, uint32_t falling)
+  \brief       Move fired waiters of the port to their ready lists; called by the driver.
+  \param[in]   port      ARM_GPIO_PORT_x
+  \param[in]   events    Pins, which events occurred
+  \param[in]   rising    Pins of events, which interrupt on the rising edge (IRQC 0x9)
+  \param[in]   falling   Pins of events, which interrupt on the falling edge (IRQC 0xA)
+  \return      none
+
+  \fn          void ARM_GPIO_Wait_Push (ARM_GPIO_WAITER* volatile* list, ARM_GPIO_WAITER* waiter)
+  \brief       Push waiter to the list.
+  \param[in]   list      List head
+  \param[in]   waiter    Waiter
+  \return      none
+
+  \fn          ARM_GPIO_WAITER* ARM_GPIO_Wait_TakeAll (ARM_GPIO_WAITER* volatile* list)
+  \brief       Empty the list.
+  \param[in]   list      List head
+  \return      Waiters of the list, last pushed first
+*/
+int32_t          ARM_GPIO_Wait_Add    (uint32_t port, ARM_GPIO_WAITER* waiter);
+void             ARM_GPIO_Wait_Signal (uint32_t port, uint32_t events, uint32_t rising, uint32_t falling);
+void             ARM_GPIO_Wait_Push   (ARM_GPIO_WAITER* volatile* list, ARM_GPIO_WAITER* waiter);
+ARM_GPIO_WAITER* ARM_GPIO_Wait_TakeAll(ARM_GPIO_WAITER* volatile* list);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_GPIO_NXP_K66_WAIT_H_ */
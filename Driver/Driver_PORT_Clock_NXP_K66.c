@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Driver_PORT_Clock_NXP_K66.h"
+
+#include <intrinsics.h>
+
+#define PORT_CLOCK_MASK(n, x, PORT, GPIO, IRQ, CLOCK, PINS, HIGH_DRIVE, FILTER)   CLOCK,
+
+static const uint32_t port_clock_mask[ARM_GPIO_PORT_COUNT] = {
+    ARM_GPIO_DEVICE_PORTS(PORT_CLOCK_MASK)
+};
+
+static uint8_t port_clock_users[ARM_GPIO_PORT_COUNT];
+
+////////////////////////////////////////////////////////////////////////////////
+// Counter and SIM_SCGC5 must change together, and SIM_SCGC5 is shared with
+// other modules: a few instructions with interrupts masked.
+int32_t ARM_PORT_ClockAcquire(uint32_t port)
+{
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    int32_t status = ARM_DRIVER_OK;
+    
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+    
+    if (port_clock_users[port] == UINT8_MAX)
+        status = ARM_DRIVER_ERROR;
+    else if (port_clock_users[port]++ == 0)
+        SIM_SCGC5 |= port_clock_mask[port];
+    
+    __set_interrupt_state(istate);
+    
+    return status;
+}
+
+int32_t ARM_PORT_ClockRelease(uint32_t port)
+{
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    
+    int32_t status = ARM_DRIVER_OK;
+    
+    const __istate_t istate = __get_interrupt_state();
+    __disable_interrupt();
+    
+    if (port_clock_users[port] == 0)
+        status = ARM_DRIVER_ERROR;
+    else if (--port_clock_users[port] == 0)
+        SIM_SCGC5 &= ~port_clock_mask[port];
+    
+    __set_interrupt_state(istate);
+    
+    return status;
+}
+
+uint32_t ARM_PORT_ClockUsers(uint32_t port)
+{
+    return (port < ARM_GPIO_PORT_COUNT) ? port_clock_users[port] : 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reference-counted clock gating of PORTA..PORTE (SIM_SCGC5).
+//
+// Port clock is needed by every peripheral which uses the port's pins
+// (pin mux, PCR), not only by GPIO. Each user acquires the clock before the
+// first access to the port and releases it when done; the port is gated
+// when the last user releases it.
+
+#ifndef DRIVER_PORT_CLOCK_NXP_K66_H_
+#define DRIVER_PORT_CLOCK_NXP_K66_H_
+
+#include "Driver_GPIO_NXP_K66.h"
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+/**
+  \fn          int32_t ARM_PORT_ClockAcquire (uint32_t port)
+  \brief       Take reference to the port clock, enable the clock on the first one.
+  \param[in]   port  ARM_GPIO_PORT_x
+  \return      \ref execution_status
+
+  \fn          int32_t ARM_PORT_ClockRelease (uint32_t port)
+  \brief       Drop reference to the port clock, gate the clock on the last one.
+  \param[in]   port  ARM_GPIO_PORT_x
+  \return      \ref execution_status
+
+  \fn          uint32_t ARM_PORT_ClockUsers (uint32_t port)
+  \brief       Get number of references to the port clock.
+  \param[in]   port  ARM_GPIO_PORT_x
+  \return      Number of users, 0 - port is gated.
+*/
+int32_t  ARM_PORT_ClockAcquire(uint32_t port);
+int32_t  ARM_PORT_ClockRelease(uint32_t port);
+uint32_t ARM_PORT_ClockUsers  (uint32_t port);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* DRIVER_PORT_CLOCK_NXP_K66_H_ */
@@ -42,6 +42,11 @@ extern "C"
 
 /****** GPIO Control Codes *****/
 
+#define ARM_GPIO_CONTROL_IRQ              (0x01)     ///< Enable/disable interrupt of the port; arg = 0: disable, 1: enable.
+#define ARM_GPIO_CONTROL_IRQ_PRIORITY     (0x02)     ///< Set priority of the port's interrupt; arg = priority (0 = highest).
+#define ARM_GPIO_CONTROL_LOCK             (0x03)     ///< Lock configuration of the pins until reset; arg = mask of pins.
+#define ARM_GPIO_CONTROL_DEFAULT_CFG      (0x04)     ///< Configure all unlocked pins at once; arg = configuration (see ARM_GPIO_PIN_CFG).
+#define ARM_GPIO_CONTROL_CLEAR_EVENTS     (0x05)     ///< Clear all pending pin events; arg = none.
 	
 /****** GPIO specific error codes *****/
 
@@ -0,0 +1,14 @@
+// Pin allocation of the board, see Driver_GPIO_NXP_K66_Board.h.
+//
+// X(name, port, pin, function, configuration, initial output level)
+
+#ifndef BOARD_PINS_H_
+#define BOARD_PINS_H_
+
+#define ARM_GPIO_BOARD_PINS(X)                                                                                                  \
+    /* 1PPS input (1 Hz; 200 ms high, 800 ms low) */                                                                             \
+    X(INPUT_1,  ARM_GPIO_PORT_B,  5, ARM_GPIO_BOARD_FUNC_GPIO, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_RISING, 0)        \
+    X(OUTPUT_1, ARM_GPIO_PORT_E, 10, ARM_GPIO_BOARD_FUNC_GPIO, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT,     0)        \
+    X(OUTPUT_2, ARM_GPIO_PORT_E, 11, ARM_GPIO_BOARD_FUNC_GPIO, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT,     0)
+
+#endif /* BOARD_PINS_H_ */
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Discrete-event load of the port interrupt handlers: see gpio_des.h.
+
+#define _GNU_SOURCE
+#include "gpio_des.h"
+#include "Driver_GPIO_NXP_K66_Poll.h"
+#include "Driver_GPIO_NXP_K66_Record.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct
+{
+    GPIO_DES_PORT   config;
+    GPIO_DES_RESULT result;
+} DES_PORT;
+
+static DES_PORT des[ARM_GPIO_PORT_COUNT];
+
+// Polling timer: PIT channel 0.
+#define DES_POLL_IRQ    48
+
+static uint32_t    poll_period;
+static uint64_t    poll_next;           // time of the next pass
+static uint32_t    polled;              // ports, bit n = ARM_GPIO_PORT_x
+
+// Events of gpio_des_replay, by index: the array grows.
+typedef struct
+{
+    uint32_t        port;
+    uint32_t        mask;
+} DES_REPLAY;
+
+static DES_REPLAY* replay;
+static uint32_t    replay_count;
+static uint32_t    replay_size;
+
+static void des_signal(uint32_t port, uint32_t events)
+{
+    DES_PORT* const p = &des[port];
+    const uint64_t now = sim_time();
+
+    p->result.calls++;
+    for (uint32_t left = events; left; left &= left - 1)
+    {
+        const uint64_t latency = now - sim_flag_time(port, (uint32_t)__builtin_ctz(left));
+        ARM_GPIO_Histogram_Add(&p->result.latency, latency > UINT32_MAX ? UINT32_MAX : (uint32_t)latency);
+        p->result.events++;
+    }
+    if (p->config.observe)
+        p->config.observe(port, events);
+    if (p->config.event_cost)
+        sim_advance((uint64_t)p->config.event_cost * (uint32_t)__builtin_popcount(events));
+}
+
+// Model of gpio_shared_handler.
+static void des_handler(uint32_t port)
+{
+    const uint32_t flags = sim_take_flags(port);
+    ARM_GPIO_Record_Event(port, flags);
+    des_signal(port, flags);
+}
+
+#define DES_SIGNAL(n, x, PORT, GPIO, IRQ, CLOCK, PINS, HIGH_DRIVE, FILTER) \
+    static void des_signal_##n(uint32_t events) { des_signal(n, events); } \
+    static void des_handler_##n(void) { des_handler(n); }
+ARM_GPIO_DEVICE_PORTS(DES_SIGNAL)
+
+// Timer interrupt of the polled ports. Flags latched since the previous
+// pass are taken first: an edge then keeps its time until a pass sees it.
+static void des_poll_handler(void)
+{
+    for (uint32_t left = polled; left; left &= left - 1)
+        sim_take_flags((uint32_t)__builtin_ctz(left));
+    ARM_GPIO_Poll();
+}
+
+// The timer counts on while passes are late.
+static void des_poll_tick(void* arg)
+{
+    poll_next += poll_period;
+    sim_at(poll_next, des_poll_tick, NULL);
+    sim_pend(DES_POLL_IRQ);
+}
+
+#define DES_SIGNAL_REF(n, x, PORT, GPIO, IRQ, CLOCK, PINS, HIGH_DRIVE, FILTER) des_signal_##n,
+static const ARM_GPIO_SignalEvent_t des_signals[ARM_GPIO_PORT_COUNT] = {
+    ARM_GPIO_DEVICE_PORTS(DES_SIGNAL_REF)
+};
+
+#define DES_HANDLER_REF(n, x, PORT, GPIO, IRQ, CLOCK, PINS, HIGH_DRIVE, FILTER) des_handler_##n,
+static void (* const des_handlers[ARM_GPIO_PORT_COUNT])(void) = {
+    ARM_GPIO_DEVICE_PORTS(DES_HANDLER_REF)
+};
+
+void gpio_des_reset(void)
+{
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        if (polled & (1u << port))
+            ARM_GPIO_Poll_Enable(port, 0);
+        gpio_drivers[port]->Uninitialize();
+    }
+    sim_reset();
+    polled = 0;
+    memset(des, 0, sizeof(des));
+    free(replay);
+    replay = NULL;
+    replay_count = replay_size = 0;
+}
+
+int32_t gpio_des_port(uint32_t port, const GPIO_DES_PORT* config)
+{
+    if (port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    ARM_DRIVER_GPIO* const driver = gpio_drivers[port];
+    des[port].config = *config;
+    sim_isr_cost[gpio_ports[port]->irq_vector - 16] = config->handler_cost;
+
+    int32_t status = driver->Initialize(des_signals[port]);
+    if (config->model_handler)
+        sim_vectors[gpio_ports[port]->irq_vector] = (uintptr_t)des_handlers[port];
+    if (status == ARM_DRIVER_OK)
+        status = driver->Control(ARM_GPIO_CONTROL_IRQ_PRIORITY, config->priority);
+    if (status == ARM_DRIVER_OK)
+        status = driver->Control(ARM_GPIO_CONTROL_IRQ, 1);
+    if (status == ARM_DRIVER_OK && config->polled)
+    {
+        status = ARM_GPIO_Poll_Enable(port, 1);
+        polled |= 1u << port;
+    }
+    return status;
+}
+
+void gpio_des_poll(uint32_t period, uint32_t priority, uint32_t pass_cost)
+{
+    poll_period = period;
+    sim_vectors[DES_POLL_IRQ + 16] = (uintptr_t)des_poll_handler;
+    sim_isr_cost[DES_POLL_IRQ] = pass_cost;
+    NVIC_IP(DES_POLL_IRQ) = (uint8_t)(priority << (8 - ARM_GPIO_DEVICE_NVIC_PRIO_BITS));
+    NVIC_ISER(DES_POLL_IRQ >> 5) = 1u << (DES_POLL_IRQ & 0x1F);
+    poll_next = sim_time() + 1;
+    sim_at(poll_next, des_poll_tick, NULL);
+}
+
+int32_t gpio_des_wave(const SIM_WAVE* wave)
+{
+    if (wave->port >= ARM_GPIO_PORT_COUNT)
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    const uint32_t cfg = ARM_GPIO_PIN_CFG_ENABLED | (des[wave->port].config.irq << ARM_GPIO_PIN_CFG_IRQ_Pos);
+    const int32_t status = gpio_drivers[wave->port]->ControlPin(wave->pin, ARM_GPIO_PIN_CFG, cfg);
+    if (status != ARM_DRIVER_OK)
+        return status;
+
+    if (polled & (1u << wave->port))
+        ARM_GPIO_Poll_Enable(wave->port, 1);
+
+    sim_wave(wave);
+    return ARM_DRIVER_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Edges, which latch the flags of the pins per IRQC; a level is driven
+// and taken back. All pins of the event change in the same cycle.
+static void des_replay_event(void* arg)
+{
+    const DES_REPLAY* const event = &replay[(uintptr_t)arg];
+    uint32_t levels[3] = { 0, 0, 0 };   // before the edge, after it, at the end
+
+    for (uint32_t left = event->mask; left; left &= left - 1)
+    {
+        const uint32_t pin  = (uint32_t)__builtin_ctz(left);
+        const uint32_t bit  = 1u << pin;
+        const uint32_t irqc = (sim_reg(SIM_BLOCK_PORT(event->port), SIM_PORT_PCR(pin)) >> 16) & 0xFu;
+        switch (irqc)
+        {
+            case 0x9: levels[1] |= bit; levels[2] |= bit; break;        // rising
+            case 0xA: levels[0] |= bit;                   break;        // falling
+            case 0x8: levels[0] |= bit; levels[2] |= bit; break;        // logic 0
+            case 0xC: levels[1] |= bit;                   break;        // logic 1
+            default:                                                    // either edge
+                if (sim_pin_level(event->port, pin))
+                    levels[0] |= bit;
+                else
+                    levels[1] |= bit, levels[2] |= bit;
+                break;
+        }
+    }
+    sim_port_input(event->port, event->mask, levels, 3);
+}
+
+int32_t gpio_des_replay(const uint8_t* trace, uint32_t length, uint32_t speedup, uint64_t start, uint64_t* end)
+{
+    if (!speedup)
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    uint32_t configured[ARM_GPIO_PORT_COUNT] = { 0 };
+    uint64_t recorded = 0;
+    uint64_t time = start;
+
+    for (uint32_t pos = 0; pos < length; )
+    {
+        ARM_GPIO_RECORD_EVENT event;
+        const uint32_t used = ARM_GPIO_Record_Decode(trace + pos, length - pos, &event);
+        if (!used || (event.port >= ARM_GPIO_PORT_COUNT && event.port != ARM_GPIO_RECORD_GAP))
+            return ARM_DRIVER_ERROR_PARAMETER;
+        pos += used;
+
+        recorded += event.delta;
+        time = start + recorded / speedup;
+        if (event.port == ARM_GPIO_RECORD_GAP || !event.mask)
+            continue;
+
+        for (uint32_t left = event.mask & ~configured[event.port]; left; left &= left - 1)
+        {
+            const uint32_t cfg = ARM_GPIO_PIN_CFG_ENABLED | (des[event.port].config.irq << ARM_GPIO_PIN_CFG_IRQ_Pos);
+            const int32_t status = gpio_drivers[event.port]->ControlPin((uint32_t)__builtin_ctz(left), ARM_GPIO_PIN_CFG, cfg);
+            if (status != ARM_DRIVER_OK)
+                return status;
+        }
+        if ((event.mask & ~configured[event.port]) && (polled & (1u << event.port)))
+            ARM_GPIO_Poll_Enable(event.port, 1);
+        configured[event.port] |= event.mask;
+
+        if (replay_count == replay_size)
+        {
+            replay_size = replay_size ? 2 * replay_size : 1024;
+            replay = realloc(replay, replay_size * sizeof(replay[0]));
+        }
+        replay[replay_count].port = event.port;
+        replay[replay_count].mask = event.mask;
+        sim_at(time, des_replay_event, (void*)(uintptr_t)replay_count);
+        replay_count++;
+    }
+
+    if (end)
+        *end = time;
+    return ARM_DRIVER_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void gpio_des_run(uint64_t cycles, GPIO_DES_REPORT* report)
+{
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sim_advance(cycles);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        report->port[port] = des[port].result;
+        sim_port_stats(port, &report->port[port].edges);
+        if (polled & (1u << port))
+        {
+            // Edges matching IRQC: a pass saw them or not.
+            SIM_PORT_STATS* const edges = &report->port[port].edges;
+            const uint64_t matching = edges->latched + edges->lost;
+            edges->latched = report->port[port].events;
+            edges->lost    = matching - edges->latched;
+        }
+    }
+    report->cycles     = sim_time();
+    report->isr_cycles = sim_isr_cycles();
+    report->seconds    = (double)(end.tv_sec - start.tv_sec) + 1e-9 * (double)(end.tv_nsec - start.tv_nsec);
+}
+
+void gpio_des_print(FILE* out, const GPIO_DES_REPORT* report, uint32_t ports)
+{
+    uint64_t edges = 0;
+
+    fprintf(out, "port  prio      edges     events       lost      calls    p50    p99  p99.9      max\n");
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        const GPIO_DES_RESULT* r = &report->port[port];
+        if (!(ports & (1u << port)))
+            continue;
+        char priority[12] = "poll";
+        if (!(polled & (1u << port)))
+            snprintf(priority, sizeof(priority), "%u", des[port].config.priority);
+        fprintf(out, "%c     %4s %10llu %10llu %10llu %10llu %6u %6u %6u %8u\n", 'A' + port, priority,
+                (unsigned long long)r->edges.edges, (unsigned long long)r->events,
+                (unsigned long long)r->edges.lost, (unsigned long long)r->calls,
+                ARM_GPIO_Histogram_Percentile(&r->latency, 500), ARM_GPIO_Histogram_Percentile(&r->latency, 990),
+                ARM_GPIO_Histogram_Percentile(&r->latency, 999), r->latency.max);
+        edges += r->edges.edges;
+    }
+    fprintf(out, "time in handlers %.1f %% of %llu cycles\n",
+            100.0 * (double)report->isr_cycles / (double)report->cycles, (unsigned long long)report->cycles);
+    fprintf(out, "%llu edges in %.3f s wall time: %.2f M edges/s\n",
+            (unsigned long long)edges, report->seconds, 1e-6 * (double)edges / report->seconds);
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host stand-in for the MK64F12 device header: the MK66F18 model with the
+// LLWU flag registers of the part (LLWU_F1, LLWU_F2).
+
+#ifndef MK64F12_H_
+#define MK64F12_H_
+
+#include "MK66F18.h"
+
+#define LLWU_F1                     LLWU_REG(SIM_LLWU_PF(1))
+#define LLWU_F2                     LLWU_REG(SIM_LLWU_PF(2))
+
+#endif /* MK64F12_H_ */
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host stand-in for the MK66F18 device header: the registers the GPIO driver
+// uses, mapped onto the register model of kinetis_sim.h.
+
+#ifndef MK66F18_H_
+#define MK66F18_H_
+
+#include "kinetis_sim.h"
+
+typedef struct PORT_MemMap
+{
+    uint32_t PCR[32];
+    uint32_t GPCLR;
+    uint32_t GPCHR;
+    uint8_t  RESERVED_0[24];
+    uint32_t ISFR;
+    uint8_t  RESERVED_1[28];
+    uint32_t DFER;
+    uint32_t DFCR;
+    uint32_t DFWR;
+} volatile* PORT_MemMapPtr;
+
+typedef struct GPIO_MemMap
+{
+    uint32_t PDOR;
+    uint32_t PSOR;
+    uint32_t PCOR;
+    uint32_t PTOR;
+    uint32_t PDIR;
+    uint32_t PDDR;
+} volatile* GPIO_MemMapPtr;
+
+#define PORTA_BASE_PTR              ((PORT_MemMapPtr)sim_regs[SIM_BLOCK_PORT(0)])
+#define PORTB_BASE_PTR              ((PORT_MemMapPtr)sim_regs[SIM_BLOCK_PORT(1)])
+#define PORTC_BASE_PTR              ((PORT_MemMapPtr)sim_regs[SIM_BLOCK_PORT(2)])
+#define PORTD_BASE_PTR              ((PORT_MemMapPtr)sim_regs[SIM_BLOCK_PORT(3)])
+#define PORTE_BASE_PTR              ((PORT_MemMapPtr)sim_regs[SIM_BLOCK_PORT(4)])
+
+#define PTA_BASE_PTR                ((GPIO_MemMapPtr)sim_regs[SIM_BLOCK_GPIO(0)])
+#define PTB_BASE_PTR                ((GPIO_MemMapPtr)sim_regs[SIM_BLOCK_GPIO(1)])
+#define PTC_BASE_PTR                ((GPIO_MemMapPtr)sim_regs[SIM_BLOCK_GPIO(2)])
+#define PTD_BASE_PTR                ((GPIO_MemMapPtr)sim_regs[SIM_BLOCK_GPIO(3)])
+#define PTE_BASE_PTR                ((GPIO_MemMapPtr)sim_regs[SIM_BLOCK_GPIO(4)])
+
+// Vector numbers.
+#define INT_LLWU                    37
+#define INT_PORTA                   75
+#define INT_PORTB                   76
+#define INT_PORTC                   77
+#define INT_PORTD                   78
+#define INT_PORTE                   79
+
+#define PORT_PCR_PS_MASK            0x1u
+#define PORT_PCR_PE_MASK            0x2u
+#define PORT_PCR_SRE_MASK           0x4u
+#define PORT_PCR_PFE_MASK           0x10u
+#define PORT_PCR_ODE_MASK           0x20u
+#define PORT_PCR_DSE_MASK           0x40u
+#define PORT_PCR_MUX_MASK           0x700u
+#define PORT_PCR_MUX_SHIFT          8
+#define PORT_PCR_MUX(x)             (((uint32_t)(x) << PORT_PCR_MUX_SHIFT) & PORT_PCR_MUX_MASK)
+#define PORT_PCR_LK_MASK            0x8000u
+#define PORT_PCR_IRQC_MASK          0xF0000u
+#define PORT_PCR_IRQC_SHIFT         16
+#define PORT_PCR_IRQC(x)            (((uint32_t)(x) << PORT_PCR_IRQC_SHIFT) & PORT_PCR_IRQC_MASK)
+#define PORT_PCR_ISF_MASK           0x1000000u
+
+#define PORT_GPCLR_GPWD(x)          ((uint32_t)(x) & 0xFFFFu)
+#define PORT_GPCLR_GPWE(x)          (((uint32_t)(x) << 16) & 0xFFFF0000u)
+#define PORT_GPCHR_GPWD(x)          ((uint32_t)(x) & 0xFFFFu)
+#define PORT_GPCHR_GPWE(x)          (((uint32_t)(x) << 16) & 0xFFFF0000u)
+
+#define PORT_DFCR_CS_MASK           0x1u
+#define PORT_DFWR_FILT_MASK         0x1Fu
+#define PORT_DFWR_FILT(x)           ((uint32_t)(x) & PORT_DFWR_FILT_MASK)
+
+#define SIM_SCGC5                   (*(volatile uint32_t*)&sim_regs[SIM_BLOCK_SIM][SIM_SIM_SCGC5])
+#define SIM_SCGC5_PORTA_MASK        0x200u
+#define SIM_SCGC5_PORTB_MASK        0x400u
+#define SIM_SCGC5_PORTC_MASK        0x800u
+#define SIM_SCGC5_PORTD_MASK        0x1000u
+#define SIM_SCGC5_PORTE_MASK        0x2000u
+
+#define NVIC_ISER(n)                (((volatile uint32_t*)&sim_regs[SIM_BLOCK_NVIC][SIM_NVIC_ISER])[n])
+#define NVIC_ICER(n)                (((volatile uint32_t*)&sim_regs[SIM_BLOCK_NVIC][SIM_NVIC_ICER])[n])
+#define NVIC_ISPR(n)                (((volatile uint32_t*)&sim_regs[SIM_BLOCK_NVIC][SIM_NVIC_ISPR])[n])
+#define NVIC_ICPR(n)                (((volatile uint32_t*)&sim_regs[SIM_BLOCK_NVIC][SIM_NVIC_ICPR])[n])
+#define NVIC_IP(n)                  (((volatile uint8_t*)&sim_regs[SIM_BLOCK_NVIC][SIM_NVIC_IP])[n])
+
+#define SCB_VTOR                    ((uintptr_t)sim_vectors)
+
+#define DWT_CYCCNT                  (sim_cycles())
+#define DWT_CTRL                    sim_dwt_ctrl
+#define DWT_CTRL_CYCCNTENA_MASK     0x1u
+
+// Debug Exception and Monitor Control of the driver (Driver_GPIO_NXP_K66.h).
+#define ARM_GPIO_DEMCR              sim_demcr
+
+#define LLWU_REG(offset)            (*(volatile uint8_t*)&sim_regs[SIM_BLOCK_LLWU][offset])
+#define LLWU_PE1                    LLWU_REG(SIM_LLWU_PE(1))
+#define LLWU_PE2                    LLWU_REG(SIM_LLWU_PE(2))
+#define LLWU_PE3                    LLWU_REG(SIM_LLWU_PE(3))
+#define LLWU_PE4                    LLWU_REG(SIM_LLWU_PE(4))
+#define LLWU_PE5                    LLWU_REG(SIM_LLWU_PE(5))
+#define LLWU_PE6                    LLWU_REG(SIM_LLWU_PE(6))
+#define LLWU_PE7                    LLWU_REG(SIM_LLWU_PE(7))
+#define LLWU_PE8                    LLWU_REG(SIM_LLWU_PE(8))
+#define LLWU_PF1                    LLWU_REG(SIM_LLWU_PF(1))
+#define LLWU_PF2                    LLWU_REG(SIM_LLWU_PF(2))
+#define LLWU_PF3                    LLWU_REG(SIM_LLWU_PF(3))
+#define LLWU_PF4                    LLWU_REG(SIM_LLWU_PF(4))
+
+extern uint32_t SystemCoreClock;
+
+#endif /* MK66F18_H_ */
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Discrete-event load of the port interrupt handlers (host build).
+//
+// Square waves on any pins of all ports (sim_wave) are events of the register
+// model: every edge latches its flag per the pin's IRQC, the port interrupt
+// is taken at its NVIC priority and gpio_x_handler of the driver runs, as
+// on the part, with the costs of kinetis_sim.h in virtual cycles. The signal
+// callback of each port measures the latency of every pin event (edge to
+// callback, ARM_GPIO_HISTOGRAM) and may spend cycles per event.
+//
+// The driver's handler costs the host a trapped store (ISFR) per call: for the
+// throughput of the simulation itself a port may use a model handler instead,
+// which takes the flags through the model (sim_take_flags) and calls the same
+// callback.
+//
+// A port may be polled instead (Driver_GPIO_NXP_K66_Poll.h): its interrupt
+// is off and a periodic timer interrupt (gpio_des_poll) runs ARM_GPIO_Poll,
+// which passes the events of the pass to the same callback. The latency is
+// then from the edge to the pass seeing it; an edge not seen by a pass (a
+// pulse within one period, of both edges a pair) is lost.
+//
+// A record of port events (Driver_GPIO_NXP_K66_Record.h), taken on the part
+// or in a simulation, can be pushed back into the simulated ports as edges
+// at its original time intervals or faster (gpio_des_replay).
+//
+// Results: edges, events delivered and events lost (an edge finding its flag
+// still set), handler calls, latency distribution and the share of time
+// spent in handlers. Used to size interrupt budgets before the hardware.
+
+#ifndef GPIO_DES_H_
+#define GPIO_DES_H_
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "Driver_GPIO_NXP_K66_Histogram.h"
+
+#include <stdio.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct
+{
+    uint32_t            priority;       // NVIC priority, 0..15
+    uint32_t            irq;            // ARM_GPIO_PIN_IRQ_x of the pins with a wave
+    uint32_t            event_cost;     // cycles of the callback per pin event
+    uint32_t            handler_cost;   // cycles of the handler per call, on top of the driver
+    uint32_t            model_handler;  // 1: model handler instead of gpio_x_handler
+    void              (*observe)(uint32_t port, uint32_t events);   // optional, called by the callback
+    uint32_t            polled;         // 1: polled by the timer of gpio_des_poll, interrupt off
+} GPIO_DES_PORT;
+
+typedef struct
+{
+    SIM_PORT_STATS      edges;          // edges, latched and lost (missed events);
+                                        // polled: latched = seen by a pass
+    uint64_t            calls;          // handler calls
+    uint64_t            events;         // pin events passed to the callback
+    ARM_GPIO_HISTOGRAM  latency;        // cycles from edge to callback
+} GPIO_DES_RESULT;
+
+typedef struct
+{
+    GPIO_DES_RESULT     port[ARM_GPIO_PORT_COUNT];
+    uint64_t            cycles;         // simulated time
+    uint64_t            isr_cycles;     // time in handlers
+    double              seconds;        // wall time of gpio_des_run
+} GPIO_DES_REPORT;
+
+/**
+  \fn          void gpio_des_reset (void)
+  \brief       Reset the register model (traced mode) and all ports of the simulation.
+
+  \fn          int32_t gpio_des_port (uint32_t port, const GPIO_DES_PORT* config)
+  \brief       Initialize the driver of the port with the simulation's callback,
+               enable its interrupt at the priority, or polling of the port.
+  \return      \ref execution_status
+
+  \fn          void gpio_des_poll (uint32_t period, uint32_t priority, uint32_t pass_cost)
+  \brief       Start the polling timer (PIT channel 0): a pass of ARM_GPIO_Poll every
+               period cycles, from time 1 on, in an interrupt of the priority.
+  \param[in]   period     Cycles between passes
+  \param[in]   priority   NVIC priority, 0..15
+  \param[in]   pass_cost  Cycles of the pass, on top of the callbacks
+
+  \fn          int32_t gpio_des_wave (const SIM_WAVE* wave)
+  \brief       Configure the pin (GPIO input, IRQ of its port) and drive the wave into it.
+               A polled port takes the configuration of the pin (ARM_GPIO_Poll_Enable).
+  \return      \ref execution_status
+
+  \fn          int32_t gpio_des_replay (const uint8_t* trace, uint32_t length, uint32_t speedup, uint64_t start, uint64_t* end)
+  \brief       Configure the pins of the record (GPIO input, IRQ of its port) and
+               schedule its events as edges: each pin of an event gets the edge,
+               which its IRQC latches, at start + recorded time / speedup.
+               Ports are set up with gpio_des_port before.
+  \param[in]   speedup   Time divider, 1 = original timing
+  \param[out]  end       Time of the last edge
+  \return      \ref execution_status; ARM_DRIVER_ERROR_PARAMETER for a malformed record
+
+  \fn          void gpio_des_run (uint64_t cycles, GPIO_DES_REPORT* report)
+  \brief       Run the simulation for the cycles, report the results since gpio_des_reset.
+
+  \fn          void gpio_des_print (FILE* out, const GPIO_DES_REPORT* report, uint32_t ports)
+  \brief       Print the report of the ports (mask of ARM_GPIO_PORT_x bits) as a table.
+*/
+void    gpio_des_reset (void);
+int32_t gpio_des_port  (uint32_t port, const GPIO_DES_PORT* config);
+void    gpio_des_poll  (uint32_t period, uint32_t priority, uint32_t pass_cost);
+int32_t gpio_des_wave  (const SIM_WAVE* wave);
+int32_t gpio_des_replay(const uint8_t* trace, uint32_t length, uint32_t speedup, uint64_t start, uint64_t* end);
+void    gpio_des_run   (uint64_t cycles, GPIO_DES_REPORT* report);
+void    gpio_des_print (FILE* out, const GPIO_DES_REPORT* report, uint32_t ports);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* GPIO_DES_H_ */
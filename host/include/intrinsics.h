@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// IAR intrinsics used by the driver, on the host model (kinetis_sim.h).
+//
+// PRIMASK is per thread and takes the core lock; LDREX/STREX are
+// compare-and-swap on the word (C11 atomics), failing also after an interrupt
+// ran on the thread. __LDREX/__STREX work on unsigned long, which is 64 bits
+// here: 32-bit words go through ARM_GPIO_LDREX/ARM_GPIO_STREX.
+
+#ifndef IAR_HOST_INTRINSICS_H_
+#define IAR_HOST_INTRINSICS_H_
+
+#include <stdint.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+typedef uint32_t __istate_t;
+
+__istate_t    __get_interrupt_state(void);
+void          __set_interrupt_state(__istate_t state);
+void          __disable_interrupt(void);
+void          __enable_interrupt(void);
+void          __WFI(void);
+
+unsigned long __LDREX(unsigned long* address);
+unsigned long __STREX(unsigned long value, unsigned long* address);
+void          __CLREX(void);
+
+uint32_t      sim_ldrex32(volatile void* address);
+uint32_t      sim_strex32(uint32_t value, volatile void* address);
+
+#define ARM_GPIO_LDREX(word)            sim_ldrex32(word)
+#define ARM_GPIO_STREX(value, word)     sim_strex32((value), (word))
+
+static inline void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __ISB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __NOP(void) { __asm__ volatile ("" ::: "memory"); }
+
+static inline unsigned long __CLZ(unsigned long value)
+{
+    return (uint32_t)value ? (unsigned long)__builtin_clz((uint32_t)value) : 32;
+}
+
+static inline unsigned long __RBIT(unsigned long value)
+{
+    uint32_t v = (uint32_t)value;
+    v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+    v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+    v = ((v >> 4) & 0x0F0F0F0Fu) | ((v & 0x0F0F0F0Fu) << 4);
+    return __builtin_bswap32(v);
+}
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* IAR_HOST_INTRINSICS_H_ */
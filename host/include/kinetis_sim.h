@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host model of the Kinetis PORT/GPIO hardware the driver uses (x86-64 Linux).
+//
+// Register blocks are pages of RAM at link-time addresses, so the driver is
+// compiled unchanged against them. In traced mode (default) the pages are
+// read-only for the driver: every store faults, is decoded and applied with
+// the register's semantics (PSOR/PCOR/PTOR, write-1-to-clear ISFR and ISF,
+// GPCLR/GPCHR, PCR lock, NVIC set/clear-enable) through a writable alias of
+// the same pages. Reads are plain loads. A PORT block whose SIM_SCGC5 gate
+// is off can't be accessed at all: the access is counted (sim_gated_accesses)
+// and then let through; every store and the first load after the gate closed
+// are counted, so a test sees any access to a gated port.
+// Loads of PORT and GPIO registers may be trapped as well (sim_trap_loads):
+// each costs the peripheral bridge's cycles and is counted.
+// Plain mode leaves the pages writable: registers are memory, fast enough
+// for multi-threaded stress of the configuration registers.
+//
+// One simulated core: interrupts run on the thread, which made them pending
+// (a register write, an input change, an event), when its PRIMASK is clear and
+// their priority is above the current one. PRIMASK and running a handler take
+// the core lock, so masked sections of different threads exclude each other
+// as on a single core; unmasked thread code runs in parallel.
+// LDREX/STREX (intrinsics.h) are a compare-and-swap on the word; a handler
+// run on the thread meanwhile makes STREX fail, as exception entry clears
+// the exclusive monitor.
+//
+// Time is virtual: DWT_CYCCNT is sim_cycles(), every read costs sim_read_cost
+// cycles and runs the events that became due.
+
+#ifndef KINETIS_SIM_H_
+#define KINETIS_SIM_H_
+
+#include <stdint.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#define SIM_PAGE                4096u
+
+// Register blocks, one page each.
+#define SIM_BLOCK_PORT(n)       (n)                 // PORTA..PORTE
+#define SIM_BLOCK_GPIO(n)       (5 + (n))           // PTA..PTE
+#define SIM_BLOCK_NVIC          10
+#define SIM_BLOCK_SIM           11
+#define SIM_BLOCK_LLWU          12
+#define SIM_BLOCK_COUNT         13
+
+#define SIM_PORT_COUNT          5
+
+// Interrupts: vector numbers of the part, NVIC numbering is vector - 16.
+#define SIM_VECTOR_COUNT        256
+#define SIM_IRQ_COUNT           (SIM_VECTOR_COUNT - 16)
+#define SIM_IRQ_LLWU            21
+#define SIM_IRQ_PORT(n)         (59 + (n))
+#define SIM_IRQ_SOFT            200                 // sim_interrupt()
+
+extern uint8_t   sim_regs[SIM_BLOCK_COUNT][SIM_PAGE];
+extern uintptr_t sim_vectors[SIM_VECTOR_COUNT];
+extern volatile uint32_t sim_dwt_ctrl;
+extern volatile uint32_t sim_demcr;
+
+// Offsets in the blocks.
+#define SIM_PORT_PCR(n)         (4u * (n))
+#define SIM_PORT_GPCLR          0x80u
+#define SIM_PORT_GPCHR          0x84u
+#define SIM_PORT_ISFR           0xA0u
+#define SIM_PORT_DFER           0xC0u
+#define SIM_PORT_DFCR           0xC4u
+#define SIM_PORT_DFWR           0xC8u
+
+#define SIM_GPIO_PDOR           0x00u
+#define SIM_GPIO_PSOR           0x04u
+#define SIM_GPIO_PCOR           0x08u
+#define SIM_GPIO_PTOR           0x0Cu
+#define SIM_GPIO_PDIR           0x10u
+#define SIM_GPIO_PDDR           0x14u
+
+#define SIM_NVIC_ISER           0x000u
+#define SIM_NVIC_ICER           0x080u
+#define SIM_NVIC_ISPR           0x100u
+#define SIM_NVIC_ICPR           0x180u
+#define SIM_NVIC_IP             0x300u
+
+#define SIM_SIM_SCGC5           0x38u
+
+#define SIM_LLWU_PE(n)          ((n) - 1u)          // LLWU_PE1..PE8, bytes
+#define SIM_LLWU_PF(n)          (8u + (n) - 1u)     // LLWU_PF1..PF4 (K66), LLWU_F1..F2 (K64, K22)
+
+////////////////////////////////////////////////////////////////////////////////
+//   Model control
+////////////////////////////////////////////////////////////////////////////////
+
+// Reset values of all registers, time 0, no vectors, no events, statistics cleared.
+void     sim_reset(void);
+
+// 1: registers are write-protected and emulated (default), 0: plain memory.
+void     sim_set_traced(int traced);
+
+// Register value, read through the alias (no access check).
+uint32_t sim_reg(uint32_t block, uint32_t offset);
+// Raw store, bypassing the register semantics (test setup).
+void     sim_reg_poke(uint32_t block, uint32_t offset, uint32_t value);
+
+// Accesses to a PORT block with its clock gated, since sim_reset (stores,
+// first load after the gate closed; traced mode).
+uint32_t sim_gated_accesses(void);
+
+// 1: every load of a PORT or GPIO register (traced mode) faults, costs
+// sim_load_cost cycles and is counted, then the access is single-stepped;
+// for comparing register read-modify-write with shadow copies in RAM.
+// Calling thread only; off after sim_reset.
+void     sim_trap_loads(int on);
+uint64_t sim_loads(void);               // trapped loads since sim_reset
+
+// Called for every emulated store: before (may run an interrupt: the store
+// happens after it) and after it took effect (value = register after the store).
+typedef void (*SIM_WRITE_HOOK)(uint32_t block, uint32_t offset, uint32_t value);
+void     sim_on_write(SIM_WRITE_HOOK before, SIM_WRITE_HOOK after);
+
+// Called by STREX: before (may run an interrupt: the STREX then fails)
+// and after a successful one.
+typedef void (*SIM_STREX_HOOK)(volatile void* address, uint32_t value);
+void     sim_on_strex(SIM_STREX_HOOK before, SIM_STREX_HOOK after);
+
+////////////////////////////////////////////////////////////////////////////////
+//   Pins
+////////////////////////////////////////////////////////////////////////////////
+
+// Drive the pin from outside / stop driving it (pull or last level stays).
+void     sim_pin_input(uint32_t port, uint32_t pin, uint32_t level);
+void     sim_pin_release(uint32_t port, uint32_t pin);
+uint32_t sim_pin_level(uint32_t port, uint32_t pin);
+
+// Drive the pins of mask through the levels (bit per pin) one after another
+// in the same cycle; interrupts run after the last.
+void     sim_port_input(uint32_t port, uint32_t mask, const uint32_t* levels, uint32_t count);
+
+// Edges of the port since sim_reset.
+typedef struct
+{
+    uint64_t edges;                     // level changes of enabled pins (MUX != 0)
+    uint64_t latched;                   // edges, which set the interrupt flag per IRQC
+    uint64_t lost;                      // edges matching IRQC, which found the flag still set
+} SIM_PORT_STATS;
+
+void     sim_port_stats(uint32_t port, SIM_PORT_STATS* stats);
+
+// Time of the edge, which set the pin's interrupt flag last; kept after the
+// flag is cleared, so the signal callback sees when its event happened.
+uint64_t sim_flag_time(uint32_t port, uint32_t pin);
+
+// Read ISFR and write it back, as a handler does, without a trapped store:
+// for model handlers of load tests, where the trap would be the cost.
+uint32_t sim_take_flags(uint32_t port);
+
+////////////////////////////////////////////////////////////////////////////////
+//   Time and events
+////////////////////////////////////////////////////////////////////////////////
+
+extern uint32_t sim_read_cost;          // cycles per DWT_CYCCNT read, default 1
+extern uint32_t sim_write_cost;         // cycles per register store (traced mode), default 2
+extern uint32_t sim_load_cost;          // cycles per trapped PORT/GPIO load, default 4
+
+uint32_t sim_cycles(void);              // DWT_CYCCNT
+uint64_t sim_time(void);
+void     sim_run_until(uint64_t time);  // runs due events, interrupts included
+void     sim_advance(uint64_t cycles);
+
+typedef void (*SIM_EVENT)(void* arg);
+void     sim_at(uint64_t time, SIM_EVENT event, void* arg);
+
+////////////////////////////////////////////////////////////////////////////////
+//   Interrupts
+////////////////////////////////////////////////////////////////////////////////
+
+// Cycles of exception entry and return, and of a handler body (on top of the
+// time its DWT_CYCCNT reads take), by NVIC number.
+extern uint32_t sim_isr_entry;
+extern uint32_t sim_isr_exit;
+extern uint32_t sim_isr_cost[SIM_IRQ_COUNT];
+
+// Run pending interrupts, which may preempt the current context.
+void     sim_dispatch(void);
+
+// Pend NVIC interrupt (edge); it runs at once, if it may.
+void     sim_pend(uint32_t irq);
+
+// Run isr as an interrupt of the highest priority, or when PRIMASK is cleared.
+void     sim_interrupt(void (*isr)(void));
+
+// Nonzero while the calling thread runs a handler.
+uint32_t sim_in_isr(void);
+
+// Cycles with a handler running (nested ones counted once), since sim_reset.
+uint64_t sim_isr_cycles(void);
+
+////////////////////////////////////////////////////////////////////////////////
+//   Waveforms
+////////////////////////////////////////////////////////////////////////////////
+
+// Square wave driven into the pin from outside: rising edge at start, then
+// high and low phases until end. Every edge comes 0..jitter cycles after
+// its nominal time (uniform, deterministic per pin); jitter is shorter than
+// both phases. Edges are events: they run during sim_run_until/sim_advance,
+// latch flags per IRQC and pend the port interrupt, whose handler runs at
+// its NVIC priority.
+typedef struct
+{
+    uint8_t  port;
+    uint8_t  pin;
+    uint32_t high;                      // cycles
+    uint32_t low;
+    uint32_t jitter;
+    uint64_t start;
+    uint64_t end;
+} SIM_WAVE;
+
+void     sim_wave(const SIM_WAVE* wave);
+
+////////////////////////////////////////////////////////////////////////////////
+//   Low-leakage stop (LLS)
+////////////////////////////////////////////////////////////////////////////////
+
+// LLWU_Pn inputs of the part: (port << 5) | pin, 0xFF for none.
+void     sim_llwu_map(const uint8_t* pins, uint32_t count);
+
+extern uint32_t sim_wakeup_cycles;      // LLS exit: LLWU flag to LLWU handler entry
+
+// Enter LLS (SMC + WFI): events run, ports don't latch, edges of the pins
+// enabled in LLWU_PEn set LLWU flags; the first flag wakes the core, which
+// takes the LLWU interrupt after sim_wakeup_cycles. 0: no events left, not woken.
+uint32_t sim_deep_sleep(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* KINETIS_SIM_H_ */
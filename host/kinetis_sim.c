@@ -0,0 +1,1292 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host model of the Kinetis PORT/GPIO hardware: see kinetis_sim.h.
+
+#define _GNU_SOURCE
+#include "kinetis_sim.h"
+#include "intrinsics.h"
+
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+uint8_t   sim_regs[SIM_BLOCK_COUNT][SIM_PAGE] __attribute__((aligned(SIM_PAGE)));
+uintptr_t sim_vectors[SIM_VECTOR_COUNT];
+volatile uint32_t sim_dwt_ctrl;
+volatile uint32_t sim_demcr;
+
+uint32_t SystemCoreClock = 180000000;
+
+uint32_t sim_read_cost = 1;
+uint32_t sim_write_cost = 2;
+uint32_t sim_load_cost = 4;
+uint32_t sim_isr_entry = 12;
+uint32_t sim_isr_exit  = 10;
+uint32_t sim_isr_cost[SIM_IRQ_COUNT];
+uint32_t sim_wakeup_cycles = 1000;
+
+// PCR fields the model acts on.
+#define PCR_PS                  0x1u
+#define PCR_PE                  0x2u
+#define PCR_ODE                 0x20u
+#define PCR_MUX(pcr)            (((pcr) >> 8) & 7u)
+#define PCR_LK                  0x8000u
+#define PCR_IRQC(pcr)           (((pcr) >> 16) & 0xFu)
+#define PCR_ISF                 0x1000000u
+
+#define SCGC5_PORT(n)           (0x200u << (n))
+
+#define THREAD_PRIORITY         0x100
+
+#define EFLAGS_TF               0x100u      // x86 trap flag: single step
+
+static uint8_t* alias;                  // writable view of sim_regs
+static int      traced;
+static uint32_t gated;                  // accesses to gated ports
+static int      port_prot[SIM_PORT_COUNT];
+static int      load_trap;              // PORT and GPIO pages without access
+static uint64_t loads;
+
+static SIM_WRITE_HOOK write_before, write_after;
+static SIM_STREX_HOOK strex_before, strex_after;
+
+static uint32_t ext_driven[SIM_PORT_COUNT];     // pins driven from outside
+static uint32_t ext_level[SIM_PORT_COUNT];
+static uint32_t pin_level[SIM_PORT_COUNT];
+
+static uint8_t  llwu_map[32];                  // LLWU_Pn: (port << 5) | pin, 0xFF none
+static uint32_t llwu_count;
+static uint32_t lls;                            // core in LLS: ports don't latch, LLWU wakes
+
+static uint64_t now;
+static int      active = THREAD_PRIORITY;       // priority of the running handler
+
+static SIM_PORT_STATS port_stats[SIM_PORT_COUNT];
+static uint64_t flag_time[SIM_PORT_COUNT][32];  // last setting of the flag by an edge
+static uint64_t isr_busy;                       // cycles with a handler running
+
+////////////////////////////////////////////////////////////////////////////////
+//   Threads and the core lock
+////////////////////////////////////////////////////////////////////////////////
+
+static __thread struct
+{
+    uint32_t id;
+    uint32_t primask;
+    uint32_t isr;                       // handler nesting
+    uint32_t generation;                // bumped by every handler run on the thread
+
+    int      step_block;                // page opened for a single-stepped load, + 1
+
+    volatile void* excl;                // LDREX reservation
+    uint64_t excl_value;
+    uint32_t excl_generation;
+} t;
+
+static uint32_t thread_count;
+static uint32_t core_owner;
+static uint32_t core_depth;
+
+static uint32_t thread_id(void)
+{
+    if (!t.id)
+        t.id = __atomic_add_fetch(&thread_count, 1, __ATOMIC_RELAXED);
+    return t.id;
+}
+
+static void core_lock(void)
+{
+    const uint32_t id = thread_id();
+    if (__atomic_load_n(&core_owner, __ATOMIC_RELAXED) == id)
+    {
+        core_depth++;
+        return;
+    }
+    for (;;)
+    {
+        uint32_t free = 0;
+        if (__atomic_compare_exchange_n(&core_owner, &free, id, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+        sched_yield();
+    }
+    core_depth = 1;
+}
+
+static void core_unlock(void)
+{
+    if (--core_depth == 0)
+        __atomic_store_n(&core_owner, 0, __ATOMIC_RELEASE);
+}
+
+// Let other threads run while waiting; returns the nesting to restore.
+static uint32_t core_release(void)
+{
+    const uint32_t depth = core_depth;
+    core_depth = 0;
+    __atomic_store_n(&core_owner, 0, __ATOMIC_RELEASE);
+    return depth;
+}
+
+static void core_reacquire(uint32_t depth)
+{
+    core_lock();
+    core_depth = depth;
+}
+
+static void fatal(const char* what, uint32_t block, uint32_t offset)
+{
+    fprintf(stderr, "kinetis_sim: %s (block %u, offset 0x%X)\n", what, block, offset);
+    abort();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Registers
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t* reg(uint32_t block, uint32_t offset)
+{
+    return (uint32_t*)&alias[block * SIM_PAGE + offset];
+}
+
+static inline uint8_t* reg8(uint32_t block, uint32_t offset)
+{
+    return &alias[block * SIM_PAGE + offset];
+}
+
+static void protect(void)
+{
+    for (uint32_t block = 0; block < SIM_BLOCK_COUNT; block++)
+    {
+        int prot = traced ? PROT_READ : PROT_READ | PROT_WRITE;
+        if (traced && load_trap && block < SIM_BLOCK_GPIO(SIM_PORT_COUNT))
+            prot = PROT_NONE;
+        if (block < SIM_PORT_COUNT)
+        {
+            if (traced && !(*reg(SIM_BLOCK_SIM, SIM_SIM_SCGC5) & SCGC5_PORT(block)))
+                prot = PROT_NONE;
+            if (port_prot[block] == prot)
+                continue;
+            port_prot[block] = prot;
+        }
+        mprotect(sim_regs[block], SIM_PAGE, prot);
+    }
+}
+
+static void set_flag(uint32_t port, uint32_t pin)
+{
+    uint32_t* const isfr = reg(SIM_BLOCK_PORT(port), SIM_PORT_ISFR);
+    *isfr |= 1u << pin;
+    *reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin)) |= PCR_ISF;
+}
+
+// Level-sensitive pins keep their flag set while the level lasts.
+static void latch_levels(uint32_t port)
+{
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        const uint32_t pcr = *reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin));
+        if (!PCR_MUX(pcr))
+            continue;
+        const uint32_t level = (pin_level[port] >> pin) & 1;
+        if ((PCR_IRQC(pcr) == 0x8 && !level) || (PCR_IRQC(pcr) == 0xC && level))
+            set_flag(port, pin);
+    }
+}
+
+// In LLS edges of the pins routed to LLWU set its flags (LLWU_PEn: 1 rising, 2 falling, 3 any).
+static void llwu_edges(uint32_t port, uint32_t changed, uint32_t level)
+{
+    for (uint32_t n = 0; n < llwu_count; n++)
+    {
+        const uint32_t pin = llwu_map[n] & 31;
+        if (llwu_map[n] == 0xFF || (llwu_map[n] >> 5) != port || !(changed & (1u << pin)))
+            continue;
+        const uint32_t pe = (*reg8(SIM_BLOCK_LLWU, SIM_LLWU_PE(n / 4 + 1)) >> (2 * (n % 4))) & 3;
+        const uint32_t rising = (level >> pin) & 1;
+        if (pe == 3 || (pe == 1 && rising) || (pe == 2 && !rising))
+            *reg8(SIM_BLOCK_LLWU, SIM_LLWU_PF(n / 8 + 1)) |= (uint8_t)(1u << (n % 8));
+    }
+}
+
+static uint32_t llwu_flags(void)
+{
+    uint32_t flags = 0;
+    for (uint32_t n = 0; n < 4; n++)
+        flags |= (uint32_t)*reg8(SIM_BLOCK_LLWU, SIM_LLWU_PF(n + 1)) << (8 * n);
+    return flags;
+}
+
+// Pin levels from PDDR/PDOR, the external drive and the pulls; flags the edges.
+static void pins_update(uint32_t port)
+{
+    const uint32_t pddr = *reg(SIM_BLOCK_GPIO(port), SIM_GPIO_PDDR);
+    const uint32_t pdor = *reg(SIM_BLOCK_GPIO(port), SIM_GPIO_PDOR);
+    uint32_t gpio = 0, enabled = 0, ode = 0, pullup = 0, pulled = 0;
+
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        const uint32_t pcr = *reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin));
+        const uint32_t bit = 1u << pin;
+        if (PCR_MUX(pcr))
+            enabled |= bit;
+        if (PCR_MUX(pcr) == 1)
+            gpio |= bit;
+        if (pcr & PCR_ODE)
+            ode |= bit;
+        if (pcr & PCR_PE)
+        {
+            pulled |= bit;
+            if (pcr & PCR_PS)
+                pullup |= bit;
+        }
+    }
+
+    // Open drain drives low only.
+    const uint32_t drive = pddr & gpio & ~(ode & pdor);
+    const uint32_t old = pin_level[port];
+    const uint32_t floating = ~drive & ~ext_driven[port];
+    const uint32_t level = (pdor & drive)
+                         | (ext_level[port] & ext_driven[port] & ~drive)
+                         | (floating & pullup)
+                         | (floating & ~pulled & old);
+
+    pin_level[port] = level;
+    *reg(SIM_BLOCK_GPIO(port), SIM_GPIO_PDIR) = level & enabled;
+
+    if (lls)
+    {
+        llwu_edges(port, old ^ level, level);
+        return;
+    }
+
+    SIM_PORT_STATS* const stats = &port_stats[port];
+    for (uint32_t changed = (old ^ level) & enabled; changed; changed &= changed - 1)
+    {
+        const uint32_t pin = (uint32_t)__builtin_ctz(changed);
+        const uint32_t irqc = PCR_IRQC(*reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin)));
+        const uint32_t rising = (level >> pin) & 1;
+        stats->edges++;
+        if (irqc == 0xB || (irqc == 0x9 && rising) || (irqc == 0xA && !rising))
+        {
+            if (*reg(SIM_BLOCK_PORT(port), SIM_PORT_ISFR) & (1u << pin))
+            {
+                stats->lost++;
+                continue;
+            }
+            stats->latched++;
+            flag_time[port][pin] = now;
+            set_flag(port, pin);
+        }
+    }
+    latch_levels(port);
+}
+
+static void write_pcr(uint32_t port, uint32_t pin, uint32_t value)
+{
+    uint32_t* const pcr = reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin));
+    if (*pcr & PCR_LK)
+    {
+        // Only ISF can still be cleared.
+        if (value & PCR_ISF)
+            *pcr &= ~PCR_ISF;
+    }
+    else
+    {
+        *pcr = (value & ~PCR_ISF) | (*pcr & PCR_ISF & ~value);
+    }
+    if (value & PCR_ISF)
+        *reg(SIM_BLOCK_PORT(port), SIM_PORT_ISFR) &= ~(1u << pin);
+}
+
+static void write_gpc(uint32_t port, uint32_t first, uint32_t value)
+{
+    for (uint32_t we = value >> 16; we; we &= we - 1)
+    {
+        const uint32_t pin = first + (uint32_t)__builtin_ctz(we);
+        uint32_t* const pcr = reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin));
+        if (!(*pcr & PCR_LK))
+            *pcr = (*pcr & 0xFFFF0000u) | (value & 0xFFFFu);
+    }
+}
+
+static void apply_write(uint32_t block, uint32_t offset, uint32_t size, uint32_t value)
+{
+    const uint32_t word = size == 4 && !(offset & 3);
+
+    if (block < SIM_BLOCK_GPIO(0))
+    {
+        const uint32_t port = block;
+        if (!word)
+            fatal("PORT access not 32-bit", block, offset);
+        if (offset < SIM_PORT_GPCLR)
+            write_pcr(port, offset / 4, value);
+        else if (offset == SIM_PORT_GPCLR)
+            write_gpc(port, 0, value);
+        else if (offset == SIM_PORT_GPCHR)
+            write_gpc(port, 16, value);
+        else if (offset == SIM_PORT_ISFR)
+        {
+            *reg(block, offset) &= ~value;
+            for (uint32_t clear = value; clear; clear &= clear - 1)
+                *reg(block, SIM_PORT_PCR(__builtin_ctz(clear))) &= ~PCR_ISF;
+        }
+        else
+            *reg(block, offset) = value;
+        pins_update(port);
+    }
+    else if (block < SIM_BLOCK_NVIC)
+    {
+        const uint32_t port = block - SIM_BLOCK_GPIO(0);
+        uint32_t* const pdor = reg(block, SIM_GPIO_PDOR);
+        if (!word)
+            fatal("GPIO access not 32-bit", block, offset);
+        switch (offset)
+        {
+            case SIM_GPIO_PDOR: *pdor  =  value;             break;
+            case SIM_GPIO_PSOR: *pdor |=  value;             break;
+            case SIM_GPIO_PCOR: *pdor &= ~value;             break;
+            case SIM_GPIO_PTOR: *pdor ^=  value;             break;
+            case SIM_GPIO_PDIR:                              break;
+            default:            *reg(block, offset) = value; break;
+        }
+        pins_update(port);
+    }
+    else if (block == SIM_BLOCK_NVIC)
+    {
+        if (offset >= SIM_NVIC_IP && offset < SIM_NVIC_IP + SIM_IRQ_COUNT)
+        {
+            memcpy(reg8(block, offset), &value, size);
+            return;
+        }
+        if (!word)
+            fatal("NVIC access not 32-bit", block, offset);
+        const uint32_t n = (offset & 0x7F) / 4;
+        switch (offset & ~0x7Fu)
+        {
+            case SIM_NVIC_ISER: *reg(block, SIM_NVIC_ISER + 4 * n) |=  value; break;
+            case SIM_NVIC_ICER: *reg(block, SIM_NVIC_ISER + 4 * n) &= ~value; break;
+            case SIM_NVIC_ISPR: *reg(block, SIM_NVIC_ISPR + 4 * n) |=  value; break;
+            case SIM_NVIC_ICPR: *reg(block, SIM_NVIC_ISPR + 4 * n) &= ~value; break;
+            default:            fatal("NVIC register not modelled", block, offset);
+        }
+        *reg(block, SIM_NVIC_ICER + 4 * n) = *reg(block, SIM_NVIC_ISER + 4 * n);
+        *reg(block, SIM_NVIC_ICPR + 4 * n) = *reg(block, SIM_NVIC_ISPR + 4 * n);
+    }
+    else if (block == SIM_BLOCK_SIM)
+    {
+        if (!word)
+            fatal("SIM access not 32-bit", block, offset);
+        *reg(block, offset) = value;
+        protect();
+    }
+    else
+    {
+        if (size != 1)
+            fatal("LLWU access not 8-bit", block, offset);
+        if (offset >= SIM_LLWU_PF(1))
+            *reg8(block, offset) &= (uint8_t)~value;
+        else
+            *reg8(block, offset) = (uint8_t)value;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Emulation of the faulting store (x86-64)
+////////////////////////////////////////////////////////////////////////////////
+
+static const int gpr[16] =
+{
+    REG_RAX, REG_RCX, REG_RDX, REG_RBX, REG_RSP, REG_RBP, REG_RSI, REG_RDI,
+    REG_R8,  REG_R9,  REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15,
+};
+
+typedef struct
+{
+    uint32_t length;
+    uint32_t size;
+    uint32_t op;                        // 0 add, 1 or, 4 and, 5 sub, 6 xor, 8 mov, 9 inc, 10 dec
+    uint32_t source;
+} STORE;
+
+static uint64_t greg(const ucontext_t* uc, uint32_t n, uint32_t size, int rex)
+{
+    // AH..BH: 8-bit registers 4..7 without REX.
+    if (size == 1 && !rex && n >= 4 && n < 8)
+        return (uint64_t)uc->uc_mcontext.gregs[gpr[n - 4]] >> 8;
+    return (uint64_t)uc->uc_mcontext.gregs[gpr[n]];
+}
+
+static int decode(const uint8_t* code, const ucontext_t* uc, STORE* store)
+{
+    const uint8_t* p = code;
+    uint32_t opsize = 4;
+    int rex = 0;
+
+    for (;; p++)
+    {
+        if (*p == 0x66)
+            opsize = 2;
+        else if (*p != 0xF0 && *p != 0x2E && *p != 0x3E)
+            break;
+    }
+    if ((*p & 0xF0) == 0x40)
+        rex = *p++;
+    if (rex & 0x08)
+        return 0;                       // 64-bit store: not a register access
+
+    const uint8_t opcode = *p++;
+    const uint8_t modrm  = *p++;
+    const uint32_t mod = modrm >> 6;
+    const uint32_t r   = ((modrm >> 3) & 7) | ((rex & 0x04) ? 8 : 0);
+    const uint32_t rm  = modrm & 7;
+
+    if (mod == 3)
+        return 0;
+    if (rm == 4)
+    {
+        const uint8_t sib = *p++;
+        if (mod == 0 && (sib & 7) == 5)
+            p += 4;
+    }
+    else if (mod == 0 && rm == 5)
+        p += 4;                         // RIP-relative
+    p += mod == 1 ? 1 : mod == 2 ? 4 : 0;
+
+    const uint32_t byte = !(opcode & 1);
+    store->size = byte ? 1 : opsize;
+
+    switch (opcode)
+    {
+        case 0x88: case 0x89:
+            store->op = 8;
+            store->source = (uint32_t)greg(uc, r, store->size, rex);
+            break;
+        case 0x00: case 0x01: case 0x08: case 0x09: case 0x20: case 0x21:
+        case 0x28: case 0x29: case 0x30: case 0x31:
+            store->op = opcode >> 3;
+            store->source = (uint32_t)greg(uc, r, store->size, rex);
+            break;
+        case 0xC6: case 0xC7:
+            store->op = 8;
+            if (store->size == 4)
+                store->source = *(const uint32_t*)p, p += 4;
+            else if (store->size == 2)
+                store->source = *(const uint16_t*)p, p += 2;
+            else
+                store->source = *p++;
+            break;
+        case 0x80: case 0x81: case 0x83:
+            store->op = r & 7;
+            if (store->op == 2 || store->op == 3 || store->op == 7)
+                return 0;
+            if (opcode == 0x81)
+            {
+                if (store->size == 4)
+                    store->source = *(const uint32_t*)p, p += 4;
+                else
+                    store->source = *(const uint16_t*)p, p += 2;
+            }
+            else
+                store->source = (uint32_t)(int32_t)(int8_t)*p++;
+            break;
+        case 0xFE: case 0xFF:
+            if ((r & 7) > 1)
+                return 0;
+            store->op = 9 + (r & 7);
+            store->source = 1;
+            break;
+        default:
+            return 0;
+    }
+    store->length = (uint32_t)(p - code);
+    return 1;
+}
+
+static uint32_t alu(uint32_t op, uint32_t old, uint32_t source)
+{
+    switch (op)
+    {
+        case 0:  return old + source;
+        case 1:  return old | source;
+        case 4:  return old & source;
+        case 5:  return old - source;
+        case 6:  return old ^ source;
+        case 9:  return old + 1;
+        case 10: return old - 1;
+        default: return source;
+    }
+}
+
+static uint32_t read_sized(const uint8_t* at, uint32_t size)
+{
+    uint32_t value = 0;
+    memcpy(&value, at, size);
+    return value;
+}
+
+static void spend(uint64_t cycles);
+
+// A store of the thread to a register block: value after the ALU operation.
+static void emulate(uint32_t block, uint32_t offset, uint32_t size, uint32_t op, uint32_t source)
+{
+    if (write_before)
+        write_before(block, offset, source);
+
+    core_lock();
+    if (block < SIM_PORT_COUNT && !(*reg(SIM_BLOCK_SIM, SIM_SIM_SCGC5) & SCGC5_PORT(block)))
+        gated++;
+    const uint32_t value = alu(op, read_sized(reg8(block, offset), size), source);
+    apply_write(block, offset, size, value);
+    const uint32_t after = read_sized(reg8(block, offset), size);
+    spend(sim_write_cost);
+    core_unlock();
+
+    if (write_after)
+        write_after(block, offset, after);
+    sim_dispatch();
+}
+
+static void on_fault(int signal, siginfo_t* info, void* context)
+{
+    ucontext_t* const uc = context;
+    const uint8_t* const address = info->si_addr;
+    (void)signal;
+
+    if (address < sim_regs[0] || address >= sim_regs[SIM_BLOCK_COUNT])
+    {
+        // Not ours: crash as usual.
+        struct sigaction dfl = { .sa_handler = SIG_DFL };
+        sigaction(SIGSEGV, &dfl, NULL);
+        return;
+    }
+
+    const uint32_t block  = (uint32_t)(address - sim_regs[0]) / SIM_PAGE;
+    const uint32_t offset = (uint32_t)(address - sim_regs[0]) % SIM_PAGE;
+    const int write = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+
+    const int gate_closed = block < SIM_PORT_COUNT && !(*reg(SIM_BLOCK_SIM, SIM_SIM_SCGC5) & SCGC5_PORT(block));
+    if (block < SIM_PORT_COUNT && port_prot[block] == PROT_NONE && (gate_closed || !load_trap))
+    {
+        // Clock gated: count the access (a store when it is emulated), let it through.
+        core_lock();
+        gated += !write;
+        port_prot[block] = PROT_READ;
+        mprotect(sim_regs[block], SIM_PAGE, PROT_READ);
+        core_unlock();
+        if (!write)
+            return;
+    }
+    if (!write && load_trap && !t.step_block)
+    {
+        // Bridge read: open the page for the one instruction (trap flag).
+        core_lock();
+        loads++;
+        spend(sim_load_cost);
+        core_unlock();
+        t.step_block = (int)block + 1;
+        mprotect(sim_regs[block], SIM_PAGE, PROT_READ);
+        uc->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+        return;
+    }
+    if (!write)
+        fatal("unexpected read fault", block, offset);
+
+    uint8_t* const rip = (uint8_t*)uc->uc_mcontext.gregs[REG_RIP];
+    STORE store;
+    if (!decode(rip, uc, &store))
+    {
+        fprintf(stderr, "kinetis_sim: store not decoded: %02X %02X %02X %02X\n", rip[0], rip[1], rip[2], rip[3]);
+        fatal("unsupported instruction", block, offset);
+    }
+    uc->uc_mcontext.gregs[REG_RIP] += store.length;
+    emulate(block, offset, store.size, store.op, store.source);
+}
+
+// After the single-stepped load: close the page again.
+static void on_step(int signal, siginfo_t* info, void* context)
+{
+    ucontext_t* const uc = context;
+    (void)signal;
+    (void)info;
+
+    if (!t.step_block)
+    {
+        struct sigaction dfl = { .sa_handler = SIG_DFL };
+        sigaction(SIGTRAP, &dfl, NULL);
+        return;
+    }
+    const uint32_t block = (uint32_t)t.step_block - 1;
+    t.step_block = 0;
+    uc->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+    if (load_trap && !(block < SIM_PORT_COUNT && port_prot[block] != PROT_NONE))
+        mprotect(sim_regs[block], SIM_PAGE, PROT_NONE);
+}
+
+__attribute__((constructor))
+static void sim_setup(void)
+{
+    const int fd = memfd_create("kinetis_sim", 0);
+    if (fd < 0 || ftruncate(fd, sizeof(sim_regs)) != 0
+     || mmap(sim_regs, sizeof(sim_regs), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+        fatal("register pages not mapped", 0, 0);
+    alias = mmap(NULL, sizeof(sim_regs), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (alias == MAP_FAILED)
+        fatal("register alias not mapped", 0, 0);
+    close(fd);
+
+    struct sigaction action = { .sa_sigaction = on_fault, .sa_flags = SA_SIGINFO | SA_NODEFER };
+    sigaction(SIGSEGV, &action, NULL);
+    struct sigaction step = { .sa_sigaction = on_step, .sa_flags = SA_SIGINFO | SA_NODEFER };
+    sigaction(SIGTRAP, &step, NULL);
+
+    traced = 1;
+    for (uint32_t port = 0; port < SIM_PORT_COUNT; port++)
+        port_prot[port] = -1;
+    sim_reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Model control
+////////////////////////////////////////////////////////////////////////////////
+
+static void events_clear(void);
+static void waves_clear(void);
+
+void sim_reset(void)
+{
+    core_lock();
+    memset(alias, 0, sizeof(sim_regs));
+    memset(sim_vectors, 0, sizeof(sim_vectors));
+    memset(sim_isr_cost, 0, sizeof(sim_isr_cost));
+    memset(ext_driven, 0, sizeof(ext_driven));
+    memset(ext_level, 0, sizeof(ext_level));
+    memset(pin_level, 0, sizeof(pin_level));
+    *reg(SIM_BLOCK_SIM, SIM_SIM_SCGC5) = 0x00040182u;
+    sim_dwt_ctrl = 0;
+    sim_demcr = 0;
+    sim_read_cost = 1;
+    sim_write_cost = 2;
+    sim_load_cost = 4;
+    load_trap = 0;
+    loads = 0;
+    sim_isr_entry = 12;
+    sim_isr_exit = 10;
+    sim_wakeup_cycles = 1000;
+    lls = 0;
+    now = 0;
+    active = THREAD_PRIORITY;
+    gated = 0;
+    memset(port_stats, 0, sizeof(port_stats));
+    memset(flag_time, 0, sizeof(flag_time));
+    isr_busy = 0;
+    waves_clear();
+    write_before = write_after = NULL;
+    strex_before = strex_after = NULL;
+    events_clear();
+    protect();
+    core_unlock();
+}
+
+void sim_set_traced(int on)
+{
+    core_lock();
+    traced = on;
+    protect();
+    core_unlock();
+}
+
+uint32_t sim_reg(uint32_t block, uint32_t offset)
+{
+    return block == SIM_BLOCK_LLWU ? *reg8(block, offset) : *reg(block, offset);
+}
+
+void sim_reg_poke(uint32_t block, uint32_t offset, uint32_t value)
+{
+    core_lock();
+    if (block == SIM_BLOCK_LLWU)
+        *reg8(block, offset) = (uint8_t)value;
+    else
+        *reg(block, offset) = value;
+    if (block == SIM_BLOCK_SIM)
+        protect();
+    core_unlock();
+}
+
+uint32_t sim_gated_accesses(void)
+{
+    return gated;
+}
+
+void sim_trap_loads(int on)
+{
+    core_lock();
+    load_trap = on;
+    protect();
+    core_unlock();
+}
+
+uint64_t sim_loads(void)
+{
+    return loads;
+}
+
+void sim_on_write(SIM_WRITE_HOOK before, SIM_WRITE_HOOK after)
+{
+    write_before = before;
+    write_after = after;
+}
+
+void sim_on_strex(SIM_STREX_HOOK before, SIM_STREX_HOOK after)
+{
+    strex_before = before;
+    strex_after = after;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Pins
+////////////////////////////////////////////////////////////////////////////////
+
+void sim_pin_input(uint32_t port, uint32_t pin, uint32_t level)
+{
+    core_lock();
+    ext_driven[port] |= 1u << pin;
+    ext_level[port] = (ext_level[port] & ~(1u << pin)) | ((level & 1u) << pin);
+    pins_update(port);
+    core_unlock();
+    sim_dispatch();
+}
+
+void sim_port_input(uint32_t port, uint32_t mask, const uint32_t* levels, uint32_t count)
+{
+    core_lock();
+    ext_driven[port] |= mask;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ext_level[port] = (ext_level[port] & ~mask) | (levels[i] & mask);
+        pins_update(port);
+    }
+    core_unlock();
+    sim_dispatch();
+}
+
+void sim_pin_release(uint32_t port, uint32_t pin)
+{
+    core_lock();
+    ext_driven[port] &= ~(1u << pin);
+    pins_update(port);
+    core_unlock();
+    sim_dispatch();
+}
+
+uint32_t sim_pin_level(uint32_t port, uint32_t pin)
+{
+    return (pin_level[port] >> pin) & 1;
+}
+
+void sim_port_stats(uint32_t port, SIM_PORT_STATS* stats)
+{
+    core_lock();
+    *stats = port_stats[port];
+    core_unlock();
+}
+
+uint64_t sim_flag_time(uint32_t port, uint32_t pin)
+{
+    return flag_time[port][pin];
+}
+
+uint32_t sim_take_flags(uint32_t port)
+{
+    core_lock();
+    const uint32_t isfr = *reg(SIM_BLOCK_PORT(port), SIM_PORT_ISFR);
+    apply_write(SIM_BLOCK_PORT(port), SIM_PORT_ISFR, 4, isfr);
+    core_unlock();
+    return isfr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Time and events
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    uint64_t  time;
+    uint64_t  sequence;                 // FIFO among events of the same time
+    SIM_EVENT event;
+    void*     arg;
+} EVENT;
+
+static EVENT*   heap;
+static uint32_t heap_count, heap_size;
+static uint64_t sequence;
+
+static int before(const EVENT* a, const EVENT* b)
+{
+    return a->time < b->time || (a->time == b->time && a->sequence < b->sequence);
+}
+
+static void events_clear(void)
+{
+    heap_count = 0;
+    sequence = 0;
+}
+
+void sim_at(uint64_t time, SIM_EVENT event, void* arg)
+{
+    core_lock();
+    if (heap_count == heap_size)
+    {
+        heap_size = heap_size ? 2 * heap_size : 256;
+        heap = realloc(heap, heap_size * sizeof(EVENT));
+        if (!heap)
+            fatal("out of memory", 0, 0);
+    }
+    uint32_t i = heap_count++;
+    const EVENT e = { time, sequence++, event, arg };
+    while (i && before(&e, &heap[(i - 1) / 2]))
+    {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = e;
+    core_unlock();
+}
+
+static EVENT pop(void)
+{
+    const EVENT top = heap[0];
+    const EVENT last = heap[--heap_count];
+    uint32_t i = 0;
+    for (;;)
+    {
+        uint32_t child = 2 * i + 1;
+        if (child >= heap_count)
+            break;
+        if (child + 1 < heap_count && before(&heap[child + 1], &heap[child]))
+            child++;
+        if (!before(&heap[child], &last))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
+// Runs the first event at its time (core lock held).
+static void run_event(void)
+{
+    const EVENT e = pop();
+    if (e.time > now)
+        now = e.time;
+    e.event(e.arg);
+    sim_dispatch();
+}
+
+// Time passes in the current context: events and interrupts come in between.
+static void spend(uint64_t cycles)
+{
+    const uint64_t end = now + cycles;
+    while (heap_count && heap[0].time <= end)
+        run_event();
+    if (now < end)
+        now = end;
+}
+
+uint32_t sim_cycles(void)
+{
+    core_lock();
+    now += sim_read_cost;
+    while (heap_count && heap[0].time <= now)
+        run_event();
+    const uint32_t cycles = (uint32_t)now;
+    core_unlock();
+    return cycles;
+}
+
+uint64_t sim_time(void)
+{
+    return now;
+}
+
+void sim_run_until(uint64_t time)
+{
+    core_lock();
+    if (time > now)
+        spend(time - now);
+    core_unlock();
+    sim_dispatch();
+}
+
+void sim_advance(uint64_t cycles)
+{
+    core_lock();
+    spend(cycles);
+    core_unlock();
+    sim_dispatch();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Interrupts
+////////////////////////////////////////////////////////////////////////////////
+
+static int priority(uint32_t irq)
+{
+    return irq == SIM_IRQ_SOFT ? -1 : *reg8(SIM_BLOCK_NVIC, SIM_NVIC_IP + irq);
+}
+
+// Highest priority interrupt that may preempt the running context, or -1.
+static int next_irq(void)
+{
+    int best = -1, best_priority = active;
+    if (lls)
+        return -1;
+    for (uint32_t n = 0; n < SIM_IRQ_COUNT / 32; n++)
+    {
+        uint32_t enabled = *reg(SIM_BLOCK_NVIC, SIM_NVIC_ISER + 4 * n);
+        uint32_t pending = *reg(SIM_BLOCK_NVIC, SIM_NVIC_ISPR + 4 * n);
+        if (n == SIM_IRQ_SOFT / 32)
+            enabled |= 1u << (SIM_IRQ_SOFT % 32);
+        for (uint32_t port = 0; port < SIM_PORT_COUNT; port++)
+        {
+            if (SIM_IRQ_PORT(port) / 32 == n && *reg(SIM_BLOCK_PORT(port), SIM_PORT_ISFR))
+                pending |= 1u << (SIM_IRQ_PORT(port) % 32);
+        }
+        if (SIM_IRQ_LLWU / 32 == n && llwu_flags())
+            pending |= 1u << (SIM_IRQ_LLWU % 32);
+        for (uint32_t candidates = enabled & pending; candidates; candidates &= candidates - 1)
+        {
+            const uint32_t irq = 32 * n + (uint32_t)__builtin_ctz(candidates);
+            if (priority(irq) < best_priority)
+            {
+                best = (int)irq;
+                best_priority = priority(irq);
+            }
+        }
+    }
+    return best;
+}
+
+static void run_isr(uint32_t irq)
+{
+    const int preempted = active;
+    const uint64_t start = now;
+    *reg(SIM_BLOCK_NVIC, SIM_NVIC_ISPR + 4 * (irq / 32)) &= ~(1u << (irq % 32));
+    *reg(SIM_BLOCK_NVIC, SIM_NVIC_ICPR + 4 * (irq / 32)) &= ~(1u << (irq % 32));
+    active = priority(irq);
+    t.isr++;
+    t.generation++;
+
+    now += sim_isr_entry;
+    void (*const handler)(void) = (void (*)(void))sim_vectors[irq + 16];
+    if (!handler)
+        fatal("no handler", SIM_BLOCK_NVIC, irq);
+    handler();
+    if (irq < SIM_IRQ_COUNT)
+        spend(sim_isr_cost[irq]);
+    now += sim_isr_exit;
+
+    t.generation++;
+    t.isr--;
+    active = preempted;
+    if (preempted == THREAD_PRIORITY)
+        isr_busy += now - start;
+}
+
+void sim_dispatch(void)
+{
+    if (t.primask)
+        return;
+    core_lock();
+    for (uint32_t runs = 0;; runs++)
+    {
+        const int irq = next_irq();
+        if (irq < 0)
+            break;
+        if (runs == 10000000)
+            fatal("interrupt never cleared", SIM_BLOCK_NVIC, (uint32_t)irq);
+        run_isr((uint32_t)irq);
+    }
+    core_unlock();
+}
+
+void sim_pend(uint32_t irq)
+{
+    core_lock();
+    *reg(SIM_BLOCK_NVIC, SIM_NVIC_ISPR + 4 * (irq / 32)) |= 1u << (irq % 32);
+    *reg(SIM_BLOCK_NVIC, SIM_NVIC_ICPR + 4 * (irq / 32)) |= 1u << (irq % 32);
+    core_unlock();
+    sim_dispatch();
+}
+
+void sim_interrupt(void (*isr)(void))
+{
+    sim_vectors[SIM_IRQ_SOFT + 16] = (uintptr_t)isr;
+    sim_pend(SIM_IRQ_SOFT);
+}
+
+uint32_t sim_in_isr(void)
+{
+    return t.isr;
+}
+
+uint64_t sim_isr_cycles(void)
+{
+    return isr_busy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Waveforms
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    SIM_WAVE wave;
+    uint64_t nominal;                   // time of the edge without jitter
+    uint32_t level;                     // level after the edge
+    uint32_t seed;
+} WAVE;
+
+static WAVE**   waves;
+static uint32_t wave_count, wave_size;
+
+static void waves_clear(void)
+{
+    for (uint32_t n = 0; n < wave_count; n++)
+        free(waves[n]);
+    wave_count = 0;
+}
+
+// Edge of the wave: the pin changes, the next edge is scheduled.
+static void wave_edge(void* arg)
+{
+    WAVE* const w = arg;
+    const uint32_t port = w->wave.port, pin = w->wave.pin;
+
+    ext_driven[port] |= 1u << pin;
+    ext_level[port] = (ext_level[port] & ~(1u << pin)) | (w->level << pin);
+    pins_update(port);
+
+    w->nominal += w->level ? w->wave.high : w->wave.low;
+    w->level ^= 1;
+
+    uint64_t next = w->nominal;
+    if (w->wave.jitter)
+    {
+        uint32_t x = w->seed;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        w->seed = x;
+        next += x % (w->wave.jitter + 1);
+    }
+    if (next < w->wave.end)
+        sim_at(next, wave_edge, w);
+}
+
+void sim_wave(const SIM_WAVE* wave)
+{
+    if (!wave->high || !wave->low || wave->jitter >= wave->high || wave->jitter >= wave->low)
+        fatal("wave: jitter must be shorter than both phases", SIM_BLOCK_PORT(wave->port), wave->pin);
+
+    WAVE* const w = calloc(1, sizeof(WAVE));
+    if (!w)
+        fatal("out of memory", 0, 0);
+    w->wave = *wave;
+    w->nominal = wave->start;
+    w->level = 1;
+    w->seed = 0x9E3779B9u ^ (wave->port << 5) ^ wave->pin ^ (uint32_t)wave->start;
+
+    core_lock();
+    if (wave_count == wave_size)
+    {
+        wave_size = wave_size ? 2 * wave_size : 64;
+        waves = realloc(waves, wave_size * sizeof(WAVE*));
+        if (!waves)
+            fatal("out of memory", 0, 0);
+    }
+    waves[wave_count++] = w;
+    core_unlock();
+
+    if (wave->start < wave->end)
+        sim_at(wave->start, wave_edge, w);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Intrinsics
+////////////////////////////////////////////////////////////////////////////////
+
+__istate_t __get_interrupt_state(void)
+{
+    return t.primask;
+}
+
+void __set_interrupt_state(__istate_t state)
+{
+    if (state)
+        __disable_interrupt();
+    else
+        __enable_interrupt();
+}
+
+void __disable_interrupt(void)
+{
+    if (t.primask)
+        return;
+    core_lock();
+    t.primask = 1;
+}
+
+void __enable_interrupt(void)
+{
+    if (!t.primask)
+        return;
+    t.primask = 0;
+    core_unlock();
+    sim_dispatch();
+}
+
+// Sleeps until an interrupt is pending: the next event, or another thread.
+void __WFI(void)
+{
+    core_lock();
+    if (next_irq() < 0)
+    {
+        if (heap_count)
+            run_event();
+        else
+        {
+            const uint32_t depth = core_release();
+            usleep(10);
+            core_reacquire(depth);
+        }
+    }
+    core_unlock();
+    sim_dispatch();
+}
+
+void sim_llwu_map(const uint8_t* pins, uint32_t count)
+{
+    core_lock();
+    llwu_count = count < 32 ? count : 32;
+    memcpy(llwu_map, pins, llwu_count);
+    core_unlock();
+}
+
+uint32_t sim_deep_sleep(void)
+{
+    core_lock();
+    lls = 1;
+    while (heap_count && !llwu_flags())
+        run_event();
+    const uint32_t woken = llwu_flags() != 0;
+    if (woken)
+        spend(sim_wakeup_cycles);
+    lls = 0;
+    core_unlock();
+    sim_dispatch();
+    return woken;
+}
+
+static int in_regs(volatile void* address)
+{
+    return (const volatile uint8_t*)address >= sim_regs[0]
+        && (const volatile uint8_t*)address <  sim_regs[SIM_BLOCK_COUNT];
+}
+
+static uint64_t ldrex(volatile void* address, uint32_t size)
+{
+    uint64_t value = 0;
+    if (size == 8)
+        value = __atomic_load_n((volatile uint64_t*)address, __ATOMIC_SEQ_CST);
+    else
+        value = __atomic_load_n((volatile uint32_t*)address, __ATOMIC_SEQ_CST);
+    t.excl = address;
+    t.excl_value = value;
+    t.excl_generation = t.generation;
+    return value;
+}
+
+static uint32_t strex(volatile void* address, uint64_t value, uint32_t size)
+{
+    if (strex_before)
+        strex_before(address, (uint32_t)value);
+
+    const int reserved = t.excl == address && t.excl_generation == t.generation;
+    t.excl = NULL;
+    if (!reserved)
+        return 1;
+
+    uint64_t expected = t.excl_value;
+    int stored;
+    if (traced && in_regs(address))
+    {
+        // Register: compare and store with its semantics.
+        const uint32_t offset = (uint32_t)((const volatile uint8_t*)address - sim_regs[0]);
+        core_lock();
+        stored = *(uint32_t*)&alias[offset] == (uint32_t)expected;
+        if (stored)
+            apply_write(offset / SIM_PAGE, offset % SIM_PAGE, 4, (uint32_t)value);
+        core_unlock();
+        sim_dispatch();
+    }
+    else if (size == 8)
+        stored = __atomic_compare_exchange_n((volatile uint64_t*)address, &expected, value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    else
+    {
+        uint32_t expected32 = (uint32_t)expected;
+        stored = __atomic_compare_exchange_n((volatile uint32_t*)address, &expected32, (uint32_t)value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+    if (!stored)
+        return 1;
+
+    if (strex_after)
+        strex_after(address, (uint32_t)value);
+    return 0;
+}
+
+unsigned long __LDREX(unsigned long* address)
+{
+    return (unsigned long)ldrex(address, sizeof(unsigned long));
+}
+
+unsigned long __STREX(unsigned long value, unsigned long* address)
+{
+    return strex(address, value, sizeof(unsigned long));
+}
+
+void __CLREX(void)
+{
+    t.excl = NULL;
+}
+
+uint32_t sim_ldrex32(volatile void* address)
+{
+    return (uint32_t)ldrex(address, 4);
+}
+
+uint32_t sim_strex32(uint32_t value, volatile void* address)
+{
+    return strex(address, value, 4);
+}
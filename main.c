@@ -4,6 +4,7 @@
 #include <intrinsics.h>
 
 #include "Driver_GPIO.h"
+#include "Driver_GPIO_NXP_K66_Board.h"
 
 extern ARM_DRIVER_GPIO Driver_GPIO0;	// PORT A
 extern ARM_DRIVER_GPIO Driver_GPIO1;	// PORT B
@@ -11,16 +12,14 @@ extern ARM_DRIVER_GPIO Driver_GPIO2;	// PORT C
 extern ARM_DRIVER_GPIO Driver_GPIO3;	// PORT D
 extern ARM_DRIVER_GPIO Driver_GPIO4;	// PORT E
 
-// Board:
-// pin B5 - input of 1PPS (1 Hz; 200 ms high, 800 ms low)
-// pins E10, E11 - outputs
+// Board: see board_pins.h
 
 ARM_DRIVER_GPIO* port_in  = &Driver_GPIO1;
 ARM_DRIVER_GPIO* port_out = &Driver_GPIO4;
 
-#define PIN_INPUT_1 	5
-#define PIN_OUTPUT_1 	10
-#define PIN_OUTPUT_2	11
+#define PIN_INPUT_1 	BOARD_PIN_INPUT_1
+#define PIN_OUTPUT_1 	BOARD_PIN_OUTPUT_1
+#define PIN_OUTPUT_2	BOARD_PIN_OUTPUT_2
 
 int pps_counter = 0;
 
@@ -32,17 +31,15 @@ void pps_handler()
 void port_b_callback(uint32_t event)
 {
     // event = mask of pins, which interrupts are active
-    if (event & (1 << 5))
+    if (event & (1 << PIN_INPUT_1))
         pps_handler();
 }
 
 
 int main()
 {
-    // Enable all ports: required for other peripherals, not only for GPIO.
-    SIM_SCGC5 |= 
-        SIM_SCGC5_PORTA_MASK | SIM_SCGC5_PORTB_MASK | SIM_SCGC5_PORTC_MASK |
-        SIM_SCGC5_PORTD_MASK | SIM_SCGC5_PORTE_MASK;
+    // Port clocks are reference-counted: Initialize (or PowerControl(ARM_POWER_FULL))
+    // enables the clock of the port, other peripherals use ARM_PORT_ClockAcquire().
     
     asm("CPSIE i");
     
@@ -57,14 +54,10 @@ int main()
         printf("Interrupts on both rising and falling edges are not supported!\n");
     
     port_out->Initialize(0);
-    port_out->PowerControl(ARM_POWER_FULL);
-    
-//  port_out->Control(0, 0);
-    
-    port_out->ControlPin(PIN_OUTPUT_1, ARM_GPIO_PIN_DIRECTION, ARM_GPIO_PIN_DIRECTION_OUTPUT);
-    port_out->ControlPin(PIN_OUTPUT_1, ARM_GPIO_PIN_STATE, ARM_GPIO_PIN_STATE_ENABLE);
+    port_in->Initialize(port_b_callback);
     
-    port_out->ControlPin(PIN_OUTPUT_2, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT);
+    // Powers the ports and configures all pins of board_pins.h.
+    ARM_GPIO_Board_Initialize();
     
     port_out->SetPin(PIN_OUTPUT_1);
     port_out->ClearPin(PIN_OUTPUT_1);
@@ -77,14 +70,12 @@ int main()
     port_out->TogglePort((1 << PIN_OUTPUT_1) | (1 << PIN_OUTPUT_2));
     printf("Read port: %08x\n", port_out->ReadPort());
     
-    port_in->Initialize(port_b_callback);
-    port_in->PowerControl(ARM_POWER_FULL);
-    port_in->ControlPin(PIN_INPUT_1, ARM_GPIO_PIN_CFG, 
-                        ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_RISING);
+    // Configuration of the input must not be changed by other code.
+    port_in->Control(ARM_GPIO_CONTROL_LOCK, (1 << PIN_INPUT_1));
     
-    NVIC_ISER((INT_PORTB - 16) >> 5) = (1 << ((INT_PORTB - 16) & 0x1F));
-    __DSB();
-    __ISB();
+    port_in->Control(ARM_GPIO_CONTROL_CLEAR_EVENTS, 0);
+    port_in->Control(ARM_GPIO_CONTROL_IRQ_PRIORITY, 2);
+    port_in->Control(ARM_GPIO_CONTROL_IRQ, 1);
     
     while (1);
 }
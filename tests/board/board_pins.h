@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Board of test_board: GPIO pins and peripheral functions, see
+// Driver_GPIO_NXP_K66_Board.h.
+//
+// X(name, port, pin, function, configuration, initial output level)
+
+#ifndef BOARD_PINS_H_
+#define BOARD_PINS_H_
+
+#define ARM_GPIO_BOARD_PINS(X)                                                                                                  \
+    X(LED,      ARM_GPIO_PORT_C,  5, ARM_GPIO_BOARD_FUNC_GPIO, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT,     1)        \
+    X(BUTTON,   ARM_GPIO_PORT_C,  6, ARM_GPIO_BOARD_FUNC_GPIO, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_PULL_UP,    0)        \
+    X(RESET_N,  ARM_GPIO_PORT_C,  7, ARM_GPIO_BOARD_FUNC_GPIO,                                                                   \
+      ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT | ARM_GPIO_PIN_CFG_OPEN_DRAIN,                                 1)        \
+    /* I2C0: open drain with a peripheral function, no direction */                                                             \
+    X(I2C_SCL,  ARM_GPIO_PORT_E, 24, ARM_GPIO_BOARD_FUNC_ALT5,                                                                   \
+      ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OPEN_DRAIN | ARM_GPIO_PIN_CFG_PULL_UP,                                0)        \
+    X(I2C_SDA,  ARM_GPIO_PORT_E, 25, ARM_GPIO_BOARD_FUNC_ALT5,                                                                   \
+      ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OPEN_DRAIN | ARM_GPIO_PIN_CFG_PULL_UP,                                0)        \
+    X(ADC_IN,   ARM_GPIO_PORT_E,  4, ARM_GPIO_BOARD_FUNC_DISABLED, 0,                                                   0)
+
+#endif /* BOARD_PINS_H_ */
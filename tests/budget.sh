@@ -0,0 +1,112 @@
+#!/bin/sh
+#
+# Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Plumbing of tools/gpio_budget.sh, run with the host compiler (CROSS=):
+# budget checks, iteration bounds of loops, stack of callees and the
+# callback allowance, --update. The numbers are the host's, not Cortex-M4's.
+#
+#   tests/budget.sh <work directory>
+
+set -eu
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$1
+mkdir -p "$WORK"
+
+export CROSS= ARCH_FLAGS= COMPAT_INCLUDE="$ROOT/host/include" DEVICE_INCLUDE="$ROOT/host/include" OUT="$WORK"
+
+FAILED=0
+
+fail()
+{
+    echo "FAILED: $*"
+    FAILED=1
+}
+
+# budget <lines>: runs the script on a budget of the lines; output in $WORK/out.txt, returns its status.
+budget()
+{
+    printf '%s\n' "$@" > "$WORK/test_budget.txt"
+    STATUS=0
+    sh "$ROOT/tools/gpio_budget.sh" "$WORK/test_budget.txt" -Wno-missing-braces > "$WORK/out.txt" 2>&1 || STATUS=$?
+    return $STATUS
+}
+
+# column <function> <n>: column n of the function in the report.
+column()
+{
+    awk -v fn="$1" -v n="$2" '$1 == fn { v = $n; sub(/~$/, "", v); print v }' "$WORK/out.txt"
+}
+
+expect_message()
+{
+    grep -q "$1" "$WORK/out.txt" || fail "no '$1' in the report"
+}
+
+# Limits: met, exceeded, function missing.
+budget "ARM_GPIO_SetPort_1 100 100 100 100 -" || fail "limits met, status $STATUS"
+budget "ARM_GPIO_ControlPin_Shared 1 - - - -" && fail "size over the limit passed"
+expect_message "BUDGET ARM_GPIO_ControlPin_Shared: size"
+budget "no_such_function - - - - -" && fail "missing function passed"
+expect_message "BUDGET no_such_function: not found"
+
+# A loop needs an iteration bound for a cycle limit; the bound multiplies the estimate.
+budget "ARM_GPIO_IrqcPins - - - 100000" && fail "loop without a bound passed"
+expect_message "BUDGET ARM_GPIO_IrqcPins: cycle limit of a loop without an iteration bound"
+[ "$(awk '$1 == "ARM_GPIO_IrqcPins" { print $5 }' "$WORK/out.txt")" = "$(column ARM_GPIO_IrqcPins 5)~" ] ||
+    fail "ARM_GPIO_IrqcPins not marked as a loop"
+budget "ARM_GPIO_IrqcPins - - - - -" || fail "loop without a cycle limit, status $STATUS"
+budget "ARM_GPIO_IrqcPins - - - 100000 32" || fail "bounded loop, status $STATUS"
+ONE_PASS=$(column ARM_GPIO_IrqcPins 5)
+budget "ARM_GPIO_IrqcPins - - - $((ONE_PASS * 31)) 32" && fail "bound of 32 iterations not applied"
+expect_message "BUDGET ARM_GPIO_IrqcPins: cycles $((ONE_PASS * 32)) >"
+
+# Total stack: callees below the function, the signal callback as the allowance.
+budget "ARM_GPIO_Control_Shared - - - - -"
+[ "$(column ARM_GPIO_Control_Shared 4)" -ge $(($(column ARM_GPIO_Control_Shared 3) + $(column ARM_GPIO_Control_DefaultConfig 4))) ] ||
+    fail "total stack of ARM_GPIO_Control_Shared without its callees"
+CALLBACK_STACK=1000 budget "ARM_GPIO_DispatchEvents - - 1000 - -" && fail "callback allowance not counted"
+[ "$(column ARM_GPIO_DispatchEvents 4)" = $(($(column ARM_GPIO_DispatchEvents 3) + 1000)) ] ||
+    fail "total stack of ARM_GPIO_DispatchEvents is not its frame + 1000"
+
+# --update: measured values into the limits, comments, '-' and bounds kept.
+printf '%s\n' "# comment" "" "ARM_GPIO_SetPort_1 1 1 - 1 -" "ARM_GPIO_IrqcPins 1 1 1 1 4" > "$WORK/test_budget.txt"
+sh "$ROOT/tools/gpio_budget.sh" --update "$WORK/test_budget.txt" -Wno-missing-braces > "$WORK/out.txt" 2>&1 ||
+    fail "--update of a budget without missing functions or bounds failed"
+EXPECTED=$(printf '%-32s%-8s%-8s%-8s%-8s%s' ARM_GPIO_IrqcPins "$(column ARM_GPIO_IrqcPins 2)" "$(column ARM_GPIO_IrqcPins 3)" \
+           "$(column ARM_GPIO_IrqcPins 4)" $(($(column ARM_GPIO_IrqcPins 5) * 4)) 4)
+[ "$(sed -n 4p "$WORK/test_budget.txt")" = "$EXPECTED" ] || fail "updated line: $(sed -n 4p "$WORK/test_budget.txt")"
+[ "$(sed -n 1p "$WORK/test_budget.txt")" = "# comment" ] || fail "comment not kept"
+[ "$(awk 'NR == 3 { print $4 }' "$WORK/test_budget.txt")" = "-" ] || fail "'-' not kept"
+sh "$ROOT/tools/gpio_budget.sh" "$WORK/test_budget.txt" -Wno-missing-braces > "$WORK/out.txt" 2>&1 ||
+    fail "updated budget not met"
+
+# A template reports exceeded limits without failing; --update drops the marker.
+budget "# TEMPLATE: estimates" "ARM_GPIO_ControlPin_Shared 1 - - - -" || fail "template failed, status $STATUS"
+expect_message "BUDGET ARM_GPIO_ControlPin_Shared: size"
+expect_message "is a template: not enforced"
+budget "# TEMPLATE: estimates" "no_such_function - - - - -" || fail "template with a missing function failed, status $STATUS"
+printf '%s\n' "# TEMPLATE: estimates" "ARM_GPIO_SetPort_1 1 - - -" > "$WORK/test_budget.txt"
+sh "$ROOT/tools/gpio_budget.sh" --update "$WORK/test_budget.txt" -Wno-missing-braces > "$WORK/out.txt" 2>&1 ||
+    fail "--update of a template failed"
+grep -q "TEMPLATE" "$WORK/test_budget.txt" && fail "--update kept the template marker"
+budget "$(cat "$WORK/test_budget.txt")" || fail "measured budget from a template not met, status $STATUS"
+
+[ $FAILED = 0 ] && echo "gpio_budget.sh: all checks passed"
+exit $FAILED
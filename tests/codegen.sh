@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Code generated for the typed pins: for every name, pin_<name> and raw_<name>
+# of the program must disassemble to the same instructions.
+#
+#   tests/codegen.sh <program> <name>...
+#
+# Addresses of the instructions and rip-relative displacements differ
+# between the functions and are removed; the register targets remain.
+
+set -eu
+
+PROGRAM=$1
+shift
+
+body()
+{
+    objdump -d --no-show-raw-insn --disassemble="$1" "$PROGRAM" |
+        sed -n '/^[0-9a-f]* <'"$1"'>:$/,/^$/p' |
+        sed -e '1d' -e '/^$/d' \
+            -e 's/^ *[0-9a-f]*:[[:space:]]*//' \
+            -e 's/-\{0,1\}0x[0-9a-f]*(%rip)/(%rip)/g' \
+            -e 's/[[:space:]]*#[[:space:]]*[0-9a-f]* </ # </' \
+            -e 's/\b[0-9a-f]* <'"$1"'/</g' \
+            -e 's/[[:space:]]\{1,\}/ /g'
+}
+
+FAILED=0
+for NAME in "$@"; do
+    WRAPPED=$(body "pin_$NAME")
+    RAW=$(body "raw_$NAME")
+    if [ -z "$WRAPPED" ] || [ "$WRAPPED" != "$RAW" ]; then
+        echo "pin_$NAME differs from raw_$NAME:"
+        echo "$WRAPPED" | sed 's/^/  pin: /'
+        echo "$RAW" | sed 's/^/  raw: /'
+        FAILED=1
+    else
+        echo "pin_$NAME: $(echo "$WRAPPED" | wc -l) instructions, same as raw_$NAME"
+    fi
+done
+exit $FAILED
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// K66 without the optional PORTx_PCRn features, for the driver build of
+// test_fuzz_bare (-include): requests for them must be refused. Included
+// first, the part's header is then skipped by its include guard.
+
+#ifndef GPIO_MK66F18_BARE_H_
+#define GPIO_MK66F18_BARE_H_
+
+#include "Device/GPIO_MK66F18.h"
+
+#undef  ARM_GPIO_DEVICE_PULL
+#undef  ARM_GPIO_DEVICE_SLEW_RATE
+#undef  ARM_GPIO_DEVICE_OPEN_DRAIN
+#undef  ARM_GPIO_DEVICE_DRIVE_STRENGTH
+
+#define ARM_GPIO_DEVICE_PULL                0
+#define ARM_GPIO_DEVICE_SLEW_RATE           0
+#define ARM_GPIO_DEVICE_OPEN_DRAIN          0
+#define ARM_GPIO_DEVICE_DRIVE_STRENGTH      0
+
+#endif /* GPIO_MK66F18_BARE_H_ */
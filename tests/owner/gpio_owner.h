@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Owners of test_ownership, for its driver build (-include): the thread's
+// owner id, another one while the thread runs a handler; a violating write
+// is counted instead of stopping in the default fault loop.
+
+#ifndef GPIO_OWNER_H_
+#define GPIO_OWNER_H_
+
+#include <stdint.h>
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+uint32_t test_gpio_owner(void);
+void     test_gpio_ownership_fault(uint32_t port, uint32_t mask);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#define ARM_GPIO_OWNER_CURRENT()                test_gpio_owner()
+#define ARM_GPIO_OWNERSHIP_FAULT(port, mask)    test_gpio_ownership_fault((port), (mask))
+
+#endif /* GPIO_OWNER_H_ */
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Minimal checks for the host tests: a failed check is reported and counted,
+// the test goes on; main returns TEST_RESULT().
+
+#ifndef GPIO_TEST_H_
+#define GPIO_TEST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+static unsigned test_failures;
+
+#define TEST_CHECK(cond)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++;                                                    \
+        }                                                                       \
+    } while (0)
+
+#define TEST_EQUAL(actual, expected)                                            \
+    do {                                                                        \
+        const unsigned long long test_a_ = (unsigned long long)(actual);       \
+        const unsigned long long test_e_ = (unsigned long long)(expected);     \
+        if (test_a_ != test_e_) {                                               \
+            fprintf(stderr, "%s:%d: %s = 0x%llX, expected 0x%llX\n",           \
+                    __FILE__, __LINE__, #actual, test_a_, test_e_);             \
+            test_failures++;                                                    \
+        }                                                                       \
+    } while (0)
+
+#define TEST_RESULT()   (test_failures ? (fprintf(stderr, "%u check(s) failed\n", test_failures), 1) : 0)
+
+// Deterministic pseudo-random numbers (xorshift32), seed != 0.
+static inline uint32_t test_random(uint32_t* seed)
+{
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *seed = x;
+}
+
+#endif /* GPIO_TEST_H_ */
@@ -0,0 +1,583 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// SPI and I2C engines against slave models, which follow the pin levels
+// of the register model after every store: SPI modes 0 and 3 with SCK and
+// MOSI on one port and on two, bursts in both directions; I2C ACK and
+// NACK, clock stretching timeout, recovery of a slave stuck in a byte.
+// The benchmark compares each engine with the same protocol through the
+// driver's SetPin/ClearPin/ReadPin on plain register memory.
+
+#include "Driver_GPIO_NXP_K66_BitBang.h"
+#include "test.h"
+
+#include <string.h>
+#include <time.h>
+
+#define BURST           32u
+
+static void power_all_ports(void)
+{
+    SIM_SCGC5 |= SIM_SCGC5_PORTA_MASK | SIM_SCGC5_PORTB_MASK | SIM_SCGC5_PORTC_MASK
+               | SIM_SCGC5_PORTD_MASK | SIM_SCGC5_PORTE_MASK;
+}
+
+// GPIO pin: output (PDDR) or input, with the PCR bits given.
+static void gpio_pin(ARM_GPIO_BUS_PIN pin, uint32_t pcr, uint32_t output)
+{
+    gpio_ports[pin.port]->port->PCR[pin.pin] = PORT_PCR_MUX(1) | pcr;
+    if (output)
+        gpio_ports[pin.port]->gpio->PDDR |= (1u << pin.pin);
+}
+
+static uint32_t level(ARM_GPIO_BUS_PIN pin)
+{
+    return sim_pin_level(pin.port, pin.pin);
+}
+
+static uint32_t stores;                     // GPIO stores since the transfer started
+
+////////////////////////////////////////////////////////////////////////////////
+//   SPI
+////////////////////////////////////////////////////////////////////////////////
+
+// Slave: samples MOSI on the rising edge, shifts MISO out after the falling
+// one (mode 0: the first bit before the transfer).
+static struct
+{
+    ARM_GPIO_BUS_PIN sck, mosi, miso;
+    uint32_t        prev_sck, prev_mosi;
+    uint32_t        bits;
+    uint8_t         rx[BURST];
+    uint8_t         tx[BURST];
+    uint32_t        skewed;                 // MOSI changed with a rising edge
+} spi_slave;
+
+static void spi_slave_out(void)
+{
+    const uint32_t bit = spi_slave.bits;
+    if (bit < 8 * BURST)
+        sim_pin_input(spi_slave.miso.port, spi_slave.miso.pin, (spi_slave.tx[bit >> 3] >> (7 - (bit & 7))) & 1);
+}
+
+static void spi_slave_write(uint32_t block, uint32_t offset, uint32_t value)
+{
+    if (block < SIM_BLOCK_GPIO(0) || block > SIM_BLOCK_GPIO(4))
+        return;
+    stores++;
+
+    const uint32_t sck  = level(spi_slave.sck);
+    const uint32_t mosi = level(spi_slave.mosi);
+    if (!spi_slave.prev_sck && sck)
+    {
+        if (mosi != spi_slave.prev_mosi)
+            spi_slave.skewed++;
+        if (spi_slave.bits < 8 * BURST)
+            spi_slave.rx[spi_slave.bits >> 3] = (uint8_t)((spi_slave.rx[spi_slave.bits >> 3] << 1) | mosi);
+        spi_slave.bits++;
+    }
+    else if (spi_slave.prev_sck && !sck)
+        spi_slave_out();
+
+    spi_slave.prev_sck  = sck;
+    spi_slave.prev_mosi = mosi;
+}
+
+static void check_spi(ARM_GPIO_BUS_PIN sck, ARM_GPIO_BUS_PIN mosi, ARM_GPIO_BUS_PIN miso, uint32_t mode, uint32_t* seed)
+{
+    sim_reset();
+    power_all_ports();
+    gpio_pin(sck, 0, 1);
+    gpio_pin(mosi, 0, 1);
+    gpio_pin(miso, 0, 0);
+
+    ARM_GPIO_SPI spi;
+    TEST_EQUAL(ARM_GPIO_SPI_Initialize(&spi, sck, mosi, miso, mode, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(spi.shared, sck.port == mosi.port);
+    TEST_EQUAL(level(sck), mode == ARM_GPIO_SPI_MODE_3);
+
+    uint8_t out[BURST], in[BURST];
+    memset(&spi_slave, 0, sizeof(spi_slave));
+    spi_slave.sck  = sck;
+    spi_slave.mosi = mosi;
+    spi_slave.miso = miso;
+    for (uint32_t n = 0; n < BURST; n++)
+    {
+        out[n] = (uint8_t)test_random(seed);
+        spi_slave.tx[n] = (uint8_t)test_random(seed);
+    }
+    spi_slave.prev_sck  = level(sck);
+    spi_slave.prev_mosi = level(mosi);
+    if (mode == ARM_GPIO_SPI_MODE_0)
+        spi_slave_out();
+
+    stores = 0;
+    sim_on_write(NULL, spi_slave_write);
+    ARM_GPIO_SPI_Transfer(&spi, out, in, BURST);
+    sim_on_write(NULL, NULL);
+
+    TEST_EQUAL(spi_slave.bits, 8 * BURST);
+    TEST_EQUAL(spi_slave.skewed, 0);
+    TEST_CHECK(memcmp(spi_slave.rx, out, BURST) == 0);
+    TEST_CHECK(memcmp(in, spi_slave.tx, BURST) == 0);
+    TEST_EQUAL(level(sck), mode == ARM_GPIO_SPI_MODE_3);
+    printf("SPI mode %u, %s: %.2f stores/bit\n", mode, spi.shared ? "SCK+MOSI one port" : "SCK, MOSI two ports",
+           (double)stores / (8 * BURST));
+
+    // No data: 0xFF goes out, nothing is stored.
+    memset(&spi_slave.rx, 0, sizeof(spi_slave.rx));
+    spi_slave.bits = 0;
+    if (mode == ARM_GPIO_SPI_MODE_0)
+        spi_slave_out();
+    sim_on_write(NULL, spi_slave_write);
+    ARM_GPIO_SPI_Transfer(&spi, NULL, NULL, 2);
+    sim_on_write(NULL, NULL);
+    TEST_EQUAL(spi_slave.bits, 16);
+    TEST_EQUAL(spi_slave.rx[0], 0xFF);
+    TEST_EQUAL(spi_slave.rx[1], 0xFF);
+}
+
+static void test_spi(void)
+{
+    static const ARM_GPIO_BUS_PIN sck = { 2, 5 }, mosi_shared = { 2, 6 }, miso_shared = { 2, 7 };
+    static const ARM_GPIO_BUS_PIN mosi_split = { 3, 2 }, miso_split = { 1, 3 };
+    uint32_t seed = 1;
+
+    check_spi(sck, mosi_shared, miso_shared, ARM_GPIO_SPI_MODE_0, &seed);
+    check_spi(sck, mosi_shared, miso_shared, ARM_GPIO_SPI_MODE_3, &seed);
+    check_spi(sck, mosi_split, miso_split, ARM_GPIO_SPI_MODE_0, &seed);
+    check_spi(sck, mosi_split, miso_split, ARM_GPIO_SPI_MODE_3, &seed);
+
+    ARM_GPIO_SPI spi;
+    static const ARM_GPIO_BUS_PIN none = { ARM_GPIO_BITBANG_PIN_NONE, 0 }, bad = { 5, 0 };
+    TEST_EQUAL(ARM_GPIO_SPI_Initialize(&spi, sck, none, none, 1, 0), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(ARM_GPIO_SPI_Initialize(&spi, bad, none, none, 0, 0), ARM_DRIVER_ERROR_PARAMETER);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   I2C
+////////////////////////////////////////////////////////////////////////////////
+
+static const ARM_GPIO_BUS_PIN SCL = { 1, 2 }, SDA = { 1, 3 };
+
+#define SLAVE_ADDR      0x50u
+
+enum { IDLE, ADDRESS, WRITE, ACK, READ, MASTER_ACK };
+
+// Slave at SLAVE_ADDR: receives written bytes, ACKs up to 'accept' of them;
+// sends tx[] on reads. With 'stretch' it holds SCL low after its address ACK.
+static struct
+{
+    uint32_t        state, next;
+    uint32_t        prev_scl, prev_sda;
+    uint32_t        bits, byte, master_ack;
+    uint8_t         rx[BURST];
+    uint32_t        rx_count, accept;
+    uint8_t         tx[BURST];
+    uint32_t        tx_count;
+    uint32_t        stretch;
+    uint32_t        starts, stops;
+} i2c_slave;
+
+static void sda_drive(uint32_t bit)
+{
+    if (bit)
+        sim_pin_release(SDA.port, SDA.pin);
+    else
+        sim_pin_input(SDA.port, SDA.pin, 0);
+}
+
+static void i2c_slave_send(void)
+{
+    const uint32_t byte = i2c_slave.tx[i2c_slave.tx_count % BURST];
+    sda_drive((byte >> (7 - i2c_slave.bits)) & 1);
+    i2c_slave.bits++;
+}
+
+static void i2c_slave_falling(void)
+{
+    switch (i2c_slave.state)
+    {
+        case ADDRESS:
+            if (i2c_slave.bits < 8)
+                break;
+            if ((i2c_slave.byte >> 1) != SLAVE_ADDR)
+            {
+                i2c_slave.state = IDLE;
+                break;
+            }
+            sda_drive(0);
+            i2c_slave.next  = (i2c_slave.byte & 1) ? READ : WRITE;
+            i2c_slave.state = ACK;
+            if (i2c_slave.stretch)
+                sim_pin_input(SCL.port, SCL.pin, 0);
+            break;
+
+        case WRITE:
+            if (i2c_slave.bits < 8)
+                break;
+            i2c_slave.rx[i2c_slave.rx_count++ % BURST] = (uint8_t)i2c_slave.byte;
+            if (i2c_slave.rx_count > i2c_slave.accept)
+            {
+                i2c_slave.state = IDLE;
+                break;
+            }
+            sda_drive(0);
+            i2c_slave.next  = WRITE;
+            i2c_slave.state = ACK;
+            break;
+
+        case ACK:
+            sda_drive(1);
+            i2c_slave.bits  = 0;
+            i2c_slave.byte  = 0;
+            i2c_slave.state = i2c_slave.next;
+            if (i2c_slave.state == READ)
+                i2c_slave_send();
+            break;
+
+        case READ:
+            if (i2c_slave.bits < 8)
+                i2c_slave_send();
+            else
+            {
+                sda_drive(1);
+                i2c_slave.tx_count++;
+                i2c_slave.state = MASTER_ACK;
+            }
+            break;
+
+        case MASTER_ACK:
+            i2c_slave.bits  = 0;
+            i2c_slave.state = i2c_slave.master_ack ? IDLE : READ;
+            if (i2c_slave.state == READ)
+                i2c_slave_send();
+            break;
+
+        default: break;
+    }
+}
+
+static void i2c_slave_write(uint32_t block, uint32_t offset, uint32_t value)
+{
+    if (block < SIM_BLOCK_GPIO(0) || block > SIM_BLOCK_GPIO(4))
+        return;
+    stores++;
+
+    const uint32_t scl = level(SCL);
+    const uint32_t sda = level(SDA);
+    if (i2c_slave.prev_scl && scl && sda != i2c_slave.prev_sda)
+    {
+        // START/repeated START or STOP: the slave lets go of SDA.
+        if (!sda)
+        {
+            i2c_slave.starts++;
+            i2c_slave.state = ADDRESS;
+            i2c_slave.bits  = 0;
+            i2c_slave.byte  = 0;
+        }
+        else
+        {
+            i2c_slave.stops++;
+            i2c_slave.state = IDLE;
+        }
+    }
+    else if (!i2c_slave.prev_scl && scl)
+    {
+        if (i2c_slave.state == ADDRESS || i2c_slave.state == WRITE)
+        {
+            i2c_slave.byte = (i2c_slave.byte << 1) | sda;
+            i2c_slave.bits++;
+        }
+        else if (i2c_slave.state == MASTER_ACK)
+            i2c_slave.master_ack = sda;
+    }
+    else if (i2c_slave.prev_scl && !scl)
+        i2c_slave_falling();
+
+    i2c_slave.prev_scl = level(SCL);
+    i2c_slave.prev_sda = level(SDA);
+}
+
+// Open drain with pull-up, released; slave idle, ACKing everything.
+static void i2c_setup(void)
+{
+    sim_reset();
+    power_all_ports();
+    gpio_ports[SCL.port]->gpio->PDOR |= (1u << SCL.pin) | (1u << SDA.pin);
+    gpio_pin(SCL, PORT_PCR_ODE_MASK | PORT_PCR_PE_MASK | PORT_PCR_PS_MASK, 1);
+    gpio_pin(SDA, PORT_PCR_ODE_MASK | PORT_PCR_PE_MASK | PORT_PCR_PS_MASK, 1);
+
+    memset(&i2c_slave, 0, sizeof(i2c_slave));
+    i2c_slave.accept   = BURST;
+    i2c_slave.prev_scl = level(SCL);
+    i2c_slave.prev_sda = level(SDA);
+    sim_on_write(NULL, i2c_slave_write);
+}
+
+static void test_i2c_transfers(void)
+{
+    ARM_GPIO_I2C i2c;
+    uint8_t data[8], in[8];
+    uint32_t seed = 2;
+    for (uint32_t n = 0; n < 8; n++)
+        data[n] = (uint8_t)test_random(&seed);
+
+    i2c_setup();
+    TEST_EQUAL(ARM_GPIO_I2C_Initialize(&i2c, SCL, SDA, 0, 1000), ARM_DRIVER_OK);
+    TEST_EQUAL(i2c_slave.stops, 1);
+
+    // Write: every byte ACKed.
+    stores = 0;
+    TEST_EQUAL(ARM_GPIO_I2C_Write(&i2c, SLAVE_ADDR, data, 8, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(i2c_slave.rx_count, 8);
+    TEST_CHECK(memcmp(i2c_slave.rx, data, 8) == 0);
+    TEST_EQUAL(i2c_slave.starts, 1);
+    TEST_EQUAL(i2c_slave.stops, 2);
+    printf("I2C: %.2f stores/bit\n", (double)stores / (9 * 9));
+
+    // Write, repeated START, read: the last byte NACKed.
+    for (uint32_t n = 0; n < 8; n++)
+        i2c_slave.tx[n] = (uint8_t)test_random(&seed);
+    TEST_EQUAL(ARM_GPIO_I2C_Write(&i2c, SLAVE_ADDR, data, 1, 1), ARM_DRIVER_OK);
+    TEST_EQUAL(i2c_slave.stops, 2);
+    TEST_EQUAL(ARM_GPIO_I2C_Read(&i2c, SLAVE_ADDR, in, 8, 0), ARM_DRIVER_OK);
+    TEST_CHECK(memcmp(in, i2c_slave.tx, 8) == 0);
+    TEST_EQUAL(i2c_slave.tx_count, 8);
+    TEST_EQUAL(i2c_slave.master_ack, 1);
+    TEST_EQUAL(i2c_slave.starts, 3);
+    TEST_EQUAL(i2c_slave.stops, 3);
+
+    // Address NACK.
+    const uint32_t received = i2c_slave.rx_count;
+    TEST_EQUAL(ARM_GPIO_I2C_Write(&i2c, SLAVE_ADDR + 1, data, 8, 0), ARM_DRIVER_ERROR);
+    TEST_EQUAL(i2c_slave.rx_count, received);
+    TEST_EQUAL(i2c_slave.stops, 4);
+
+    // Data NACK: the third byte.
+    i2c_slave.rx_count = 0;
+    i2c_slave.accept   = 2;
+    TEST_EQUAL(ARM_GPIO_I2C_Write(&i2c, SLAVE_ADDR, data, 8, 0), ARM_DRIVER_ERROR);
+    TEST_EQUAL(i2c_slave.rx_count, 3);
+    TEST_EQUAL(i2c_slave.stops, 5);
+    TEST_EQUAL(level(SCL), 1);
+    TEST_EQUAL(level(SDA), 1);
+
+    sim_on_write(NULL, NULL);
+}
+
+static void test_i2c_stretch(void)
+{
+    ARM_GPIO_I2C i2c;
+    const uint8_t data[2] = { 0x12, 0x34 };
+
+    // Slave holds SCL low after its address ACK, longer than the limit.
+    i2c_setup();
+    TEST_EQUAL(ARM_GPIO_I2C_Initialize(&i2c, SCL, SDA, 0, 1000), ARM_DRIVER_OK);
+    i2c_slave.stretch = 1;
+    TEST_EQUAL(ARM_GPIO_I2C_Write(&i2c, SLAVE_ADDR, data, 2, 0), ARM_DRIVER_ERROR_TIMEOUT);
+    TEST_EQUAL(level(SCL), 0);
+    TEST_EQUAL(i2c_slave.rx_count, 0);
+
+    // Let go: the slave still holds its ACK on SDA, recovery clocks it out.
+    i2c_slave.stretch = 0;
+    sim_pin_release(SCL.port, SCL.pin);
+    i2c_slave.prev_scl = level(SCL);
+    TEST_EQUAL(ARM_GPIO_I2C_Initialize(&i2c, SCL, SDA, 0, 1000), ARM_DRIVER_OK);
+    TEST_EQUAL(i2c_slave.state, IDLE);
+    TEST_EQUAL(ARM_GPIO_I2C_Write(&i2c, SLAVE_ADDR, data, 2, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(i2c_slave.rx_count, 2);
+
+    // SCL held low from the start.
+    sim_pin_input(SCL.port, SCL.pin, 0);
+    TEST_EQUAL(ARM_GPIO_I2C_Initialize(&i2c, SCL, SDA, 0, 1000), ARM_DRIVER_ERROR_TIMEOUT);
+    sim_pin_release(SCL.port, SCL.pin);
+
+    sim_on_write(NULL, NULL);
+}
+
+static void test_i2c_recovery(void)
+{
+    ARM_GPIO_I2C i2c;
+    const uint8_t data[1] = { 0xA5 };
+
+    // Slave reset away from the master in the middle of a read: it drives
+    // the 4th bit of 0x00 and waits for clocks.
+    i2c_setup();
+    i2c_slave.state = READ;
+    i2c_slave.bits  = 3;
+    i2c_slave.tx[0] = 0x00;
+    sda_drive(0);
+    i2c_slave.prev_sda = level(SDA);
+
+    TEST_EQUAL(ARM_GPIO_I2C_Initialize(&i2c, SCL, SDA, 0, 1000), ARM_DRIVER_OK);
+    TEST_EQUAL(i2c_slave.starts, 0);
+    TEST_EQUAL(i2c_slave.stops, 1);
+    TEST_EQUAL(i2c_slave.state, IDLE);
+    TEST_EQUAL(level(SCL), 1);
+    TEST_EQUAL(level(SDA), 1);
+    TEST_EQUAL(ARM_GPIO_I2C_Write(&i2c, SLAVE_ADDR, data, 1, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(i2c_slave.rx[0], 0xA5);
+
+    // SDA held low for good: 9 clocks don't free it.
+    sim_pin_input(SDA.port, SDA.pin, 0);
+    TEST_EQUAL(ARM_GPIO_I2C_Initialize(&i2c, SCL, SDA, 0, 1000), ARM_DRIVER_ERROR_BUSY);
+    sim_pin_release(SDA.port, SDA.pin);
+
+    sim_on_write(NULL, NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Bit rate: host time on plain register memory, engine against the same
+//   protocol through the driver's function pointers. Target cycles:
+//   tools/gpio_budget.sh.
+////////////////////////////////////////////////////////////////////////////////
+
+static double elapsed_ns(const struct timespec* start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return 1e9 * (double)(end.tv_sec - start->tv_sec) + (double)(end.tv_nsec - start->tv_nsec);
+}
+
+// Mode 0 through SetPin/ClearPin/WritePin/ReadPin.
+static void spi_pins(ARM_GPIO_BUS_PIN sck, ARM_GPIO_BUS_PIN mosi, ARM_GPIO_BUS_PIN miso, const uint8_t* out, uint8_t* in, uint32_t length)
+{
+    ARM_DRIVER_GPIO* const sck_gpio  = gpio_drivers[sck.port];
+    ARM_DRIVER_GPIO* const mosi_gpio = gpio_drivers[mosi.port];
+    ARM_DRIVER_GPIO* const miso_gpio = gpio_drivers[miso.port];
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        uint32_t result = 0;
+        for (int32_t bit = 7; bit >= 0; bit--)
+        {
+            mosi_gpio->WritePin(mosi.pin, (out[i] >> bit) & 1);
+            sck_gpio->SetPin(sck.pin);
+            result = (result << 1) | miso_gpio->ReadPin(miso.pin);
+            sck_gpio->ClearPin(sck.pin);
+        }
+        in[i] = (uint8_t)result;
+    }
+}
+
+static void benchmark_spi(ARM_GPIO_BUS_PIN sck, ARM_GPIO_BUS_PIN mosi, ARM_GPIO_BUS_PIN miso)
+{
+    const uint32_t count = 20000;
+    uint8_t out[BURST], in[BURST];
+    memset(out, 0x5A, sizeof(out));
+
+    ARM_GPIO_SPI spi;
+    TEST_EQUAL(ARM_GPIO_SPI_Initialize(&spi, sck, mosi, miso, ARM_GPIO_SPI_MODE_0, 0), ARM_DRIVER_OK);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        ARM_GPIO_SPI_Transfer(&spi, out, in, BURST);
+    const double engine = elapsed_ns(&start) / (count * 8.0 * BURST);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        spi_pins(sck, mosi, miso, out, in, BURST);
+    const double pins = elapsed_ns(&start) / (count * 8.0 * BURST);
+
+    printf("SPI, %s: engine %.2f ns/bit (%.0f Mbit/s), SetPin/ClearPin/ReadPin %.2f ns/bit (%.0f Mbit/s)\n",
+           spi.shared ? "SCK+MOSI one port" : "SCK, MOSI two ports", engine, 1e3 / engine, pins, 1e3 / pins);
+}
+
+static void i2c_pins_scl_high(ARM_DRIVER_GPIO* gpio, uint32_t timeout)
+{
+    gpio->SetPin(SCL.pin);
+    for (uint32_t n = timeout; !gpio->ReadPin(SCL.pin) && n; n--)
+        ;
+}
+
+// START, address byte and ACK clock, STOP through SetPin/ClearPin/ReadPin.
+static uint32_t i2c_pins_address(uint32_t byte, uint32_t timeout)
+{
+    ARM_DRIVER_GPIO* const gpio = gpio_drivers[SCL.port];
+    uint32_t result = 0;
+
+    gpio->SetPin(SDA.pin);
+    i2c_pins_scl_high(gpio, timeout);
+    if (!gpio->ReadPin(SDA.pin))
+        return 0;
+    gpio->ClearPin(SDA.pin);
+    gpio->ClearPin(SCL.pin);
+
+    for (int32_t bit = 8; bit >= 0; bit--)
+    {
+        gpio->WritePin(SDA.pin, (byte >> bit) & 1);
+        i2c_pins_scl_high(gpio, timeout);
+        result = (result << 1) | gpio->ReadPin(SDA.pin);
+        gpio->ClearPin(SCL.pin);
+    }
+
+    gpio->ClearPin(SDA.pin);
+    i2c_pins_scl_high(gpio, timeout);
+    gpio->SetPin(SDA.pin);
+    return result;
+}
+
+// Both lines read high: the address is NACKed, every call is START, 9 clocks, STOP.
+static void benchmark_i2c(void)
+{
+    const uint32_t count = 200000;
+    const uint8_t data[1] = { 0 };
+
+    ARM_GPIO_I2C i2c;
+    sim_reg_poke(SIM_BLOCK_GPIO(SCL.port), SIM_GPIO_PDIR, (1u << SCL.pin) | (1u << SDA.pin));
+    TEST_EQUAL(ARM_GPIO_I2C_Initialize(&i2c, SCL, SDA, 0, 1000), ARM_DRIVER_OK);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        TEST_EQUAL(ARM_GPIO_I2C_Write(&i2c, SLAVE_ADDR, data, 1, 0), ARM_DRIVER_ERROR);
+    const double engine = elapsed_ns(&start) / (count * 9.0);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        TEST_EQUAL(i2c_pins_address((SLAVE_ADDR << 2) | 1, 1000), 0x1FF);
+    const double pins = elapsed_ns(&start) / (count * 9.0);
+
+    printf("I2C: engine %.2f ns/bit (%.0f Mbit/s), SetPin/ClearPin/ReadPin %.2f ns/bit (%.0f Mbit/s)\n",
+           engine, 1e3 / engine, pins, 1e3 / pins);
+}
+
+static void benchmark(void)
+{
+    static const ARM_GPIO_BUS_PIN sck = { 2, 5 }, mosi_shared = { 2, 6 }, miso_shared = { 2, 7 };
+    static const ARM_GPIO_BUS_PIN mosi_split = { 3, 2 }, miso_split = { 1, 3 };
+
+    sim_reset();
+    sim_set_traced(0);
+    benchmark_spi(sck, mosi_shared, miso_shared);
+    benchmark_spi(sck, mosi_split, miso_split);
+    benchmark_i2c();
+    sim_set_traced(1);
+}
+
+int main(void)
+{
+    test_spi();
+    test_i2c_transfers();
+    test_i2c_stretch();
+    test_i2c_recovery();
+    benchmark();
+    return TEST_RESULT();
+}
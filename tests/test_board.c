@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Board pin table (Driver_GPIO_NXP_K66_Board.c built with tests/board/board_pins.h):
+// GPIO pins and peripheral functions, open drain without direction on I2C.
+
+#include "Driver_GPIO_NXP_K66_Board.h"
+#include "test.h"
+
+static uint32_t pcr(uint32_t port, uint32_t pin)
+{
+    return sim_reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin));
+}
+
+static void test_initialize(void)
+{
+    const uint32_t pull_up = PORT_PCR_PE_MASK | PORT_PCR_PS_MASK;
+
+    TEST_EQUAL(ARM_GPIO_Board_Initialize(), ARM_DRIVER_OK);
+
+    TEST_EQUAL(pcr(BOARD_PORT_LED, BOARD_PIN_LED), PORT_PCR_MUX(1));
+    TEST_EQUAL(pcr(BOARD_PORT_BUTTON, BOARD_PIN_BUTTON), PORT_PCR_MUX(1) | pull_up);
+    TEST_EQUAL(pcr(BOARD_PORT_RESET_N, BOARD_PIN_RESET_N), PORT_PCR_MUX(1) | PORT_PCR_ODE_MASK);
+    TEST_EQUAL(pcr(BOARD_PORT_I2C_SCL, BOARD_PIN_I2C_SCL), PORT_PCR_MUX(5) | PORT_PCR_ODE_MASK | pull_up);
+    TEST_EQUAL(pcr(BOARD_PORT_I2C_SDA, BOARD_PIN_I2C_SDA), PORT_PCR_MUX(5) | PORT_PCR_ODE_MASK | pull_up);
+    TEST_EQUAL(pcr(BOARD_PORT_ADC_IN, BOARD_PIN_ADC_IN), 0);
+
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_C), SIM_GPIO_PDDR), (1u << 5) | (1u << 7));
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_C), SIM_GPIO_PDOR), (1u << 5) | (1u << 7));
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_E), SIM_GPIO_PDDR), 0);
+
+    // Open-drain output released: the pin floats to its external level.
+    sim_pin_input(ARM_GPIO_PORT_C, 7, 0);
+    TEST_EQUAL(sim_pin_level(ARM_GPIO_PORT_C, 7), 0);
+    TEST_EQUAL(sim_pin_level(ARM_GPIO_PORT_C, 5), 1);
+}
+
+int main(void)
+{
+    sim_reset();
+    test_initialize();
+    TEST_EQUAL(sim_gated_accesses(), 0);
+    return TEST_RESULT();
+}
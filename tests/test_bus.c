@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Bus mapping: data bits land on the listed pins and come back from them,
+// for fixed layouts and random pin lists, through the register model.
+// Then bytes/s of the bus against a WritePin/ReadPin loop over the same
+// pins, for a contiguous, a two-port and a scattered layout.
+
+#include "Driver_GPIO_NXP_K66_Bus.h"
+#include "test.h"
+
+#include <time.h>
+
+static void power_all_ports(void)
+{
+    SIM_SCGC5 |= SIM_SCGC5_PORTA_MASK | SIM_SCGC5_PORTB_MASK | SIM_SCGC5_PORTC_MASK
+               | SIM_SCGC5_PORTD_MASK | SIM_SCGC5_PORTE_MASK;
+}
+
+static void gpio_pins(const ARM_GPIO_BUS_PIN* pins, uint32_t width)
+{
+    for (uint32_t bit = 0; bit < width; bit++)
+        gpio_ports[pins[bit].port]->port->PCR[pins[bit].pin] = PORT_PCR_MUX(1);
+}
+
+// Data word from the PDOR bits of the pins.
+static uint32_t pdor_data(const ARM_GPIO_BUS_PIN* pins, uint32_t width)
+{
+    uint32_t data = 0;
+    for (uint32_t bit = 0; bit < width; bit++)
+        data |= ((sim_reg(SIM_BLOCK_GPIO(pins[bit].port), SIM_GPIO_PDOR) >> pins[bit].pin) & 1u) << bit;
+    return data;
+}
+
+static void drive_inputs(const ARM_GPIO_BUS_PIN* pins, uint32_t width, uint32_t data)
+{
+    for (uint32_t bit = 0; bit < width; bit++)
+        sim_pin_input(pins[bit].port, pins[bit].pin, (data >> bit) & 1);
+}
+
+static uint32_t mask(uint32_t width)
+{
+    return width == 32 ? 0xFFFFFFFFu : (1u << width) - 1;
+}
+
+static void check_bus(const ARM_GPIO_BUS_PIN* pins, uint32_t width, uint32_t* seed)
+{
+    ARM_GPIO_BUS bus;
+    TEST_EQUAL(ARM_GPIO_Bus_Initialize(&bus, pins, width), ARM_DRIVER_OK);
+    gpio_pins(pins, width);
+
+    for (int n = 0; n < 64; n++)
+    {
+        const uint32_t data = test_random(seed);
+        ARM_GPIO_Bus_Write(&bus, data);
+        TEST_EQUAL(pdor_data(pins, width), data & mask(width));
+
+        drive_inputs(pins, width, ~data);
+        TEST_EQUAL(ARM_GPIO_Bus_Read(&bus), ~data & mask(width));
+    }
+
+    // Turnaround: pins follow the driven data, and the inputs when released.
+    for (uint32_t bit = 0; bit < width; bit++)
+        sim_pin_release(pins[bit].port, pins[bit].pin);
+    const uint32_t data = test_random(seed);
+    ARM_GPIO_Bus_Drive(&bus, data);
+    TEST_EQUAL(ARM_GPIO_Bus_Read(&bus), data & mask(width));
+    ARM_GPIO_Bus_Release(&bus);
+    for (uint32_t bit = 0; bit < width; bit++)
+        TEST_EQUAL((sim_reg(SIM_BLOCK_GPIO(pins[bit].port), SIM_GPIO_PDDR) >> pins[bit].pin) & 1, 0);
+    drive_inputs(pins, width, ~data);
+    TEST_EQUAL(ARM_GPIO_Bus_Read(&bus), ~data & mask(width));
+}
+
+static void test_layouts(void)
+{
+    uint32_t seed = 1;
+
+    // Contiguous run: one op.
+    static const ARM_GPIO_BUS_PIN run[8] = { {2,0}, {2,1}, {2,2}, {2,3}, {2,4}, {2,5}, {2,6}, {2,7} };
+    ARM_GPIO_BUS bus;
+    TEST_EQUAL(ARM_GPIO_Bus_Initialize(&bus, run, 8), ARM_DRIVER_OK);
+    TEST_EQUAL(bus.port_count, 1);
+    TEST_EQUAL(bus.ports[0].op_count, 1);
+    check_bus(run, 8, &seed);
+
+    // Reversed, split over ports, wrapping offsets.
+    static const ARM_GPIO_BUS_PIN mixed[12] =
+    {
+        {0,31}, {0,30}, {1,0}, {1,1}, {4,24}, {4,25}, {3,5}, {0,29}, {1,16}, {4,0}, {2,31}, {2,12}
+    };
+    check_bus(mixed, 12, &seed);
+
+    // Errors: width, port, pin, duplicate.
+    static const ARM_GPIO_BUS_PIN dup[2] = { {1,3}, {1,3} };
+    static const ARM_GPIO_BUS_PIN bad_port[1] = { {5,0} };
+    static const ARM_GPIO_BUS_PIN bad_pin[1] = { {0,32} };
+    TEST_EQUAL(ARM_GPIO_Bus_Initialize(&bus, run, 0), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_Bus_Initialize(&bus, run, 33), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_Bus_Initialize(&bus, dup, 2), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_Bus_Initialize(&bus, bad_port, 1), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_Bus_Initialize(&bus, bad_pin, 1), ARM_DRIVER_ERROR_PARAMETER);
+}
+
+static void test_random_layouts(void)
+{
+    uint32_t seed = 0x2545F491u;
+
+    for (int n = 0; n < 200; n++)
+    {
+        sim_reset();
+        power_all_ports();
+
+        ARM_GPIO_BUS_PIN pins[ARM_GPIO_BUS_WIDTH_MAX];
+        uint32_t used[ARM_GPIO_PORT_COUNT] = { 0 };
+        const uint32_t width = 1 + test_random(&seed) % ARM_GPIO_BUS_WIDTH_MAX;
+        for (uint32_t bit = 0; bit < width; bit++)
+        {
+            uint32_t port, pin;
+            do
+            {
+                port = test_random(&seed) % ARM_GPIO_PORT_COUNT;
+                pin  = test_random(&seed) % 32;
+            } while (used[port] & (1u << pin));
+            used[port] |= 1u << pin;
+            pins[bit].port = (uint8_t)port;
+            pins[bit].pin  = (uint8_t)pin;
+        }
+        check_bus(pins, width, &seed);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Bytes/s: stores per byte in the register model, host time on plain
+//   register memory. Target cycles: tools/gpio_budget.sh.
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t gpio_stores;
+
+static void count_store(uint32_t block, uint32_t offset, uint32_t value)
+{
+    gpio_stores += block >= SIM_BLOCK_GPIO(0) && block < SIM_BLOCK_GPIO(SIM_PORT_COUNT);
+}
+
+static double elapsed_ns(const struct timespec* start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return 1e9 * (double)(end.tv_sec - start->tv_sec) + (double)(end.tv_nsec - start->tv_nsec);
+}
+
+static void pins_write(const ARM_GPIO_BUS_PIN* pins, uint32_t data)
+{
+    for (uint32_t bit = 0; bit < 8; bit++)
+        gpio_drivers[pins[bit].port]->WritePin(pins[bit].pin, (data >> bit) & 1);
+}
+
+static uint32_t pins_read(const ARM_GPIO_BUS_PIN* pins)
+{
+    uint32_t data = 0;
+    for (uint32_t bit = 0; bit < 8; bit++)
+        data |= gpio_drivers[pins[bit].port]->ReadPin(pins[bit].pin) << bit;
+    return data;
+}
+
+static void benchmark_layout(const char* name, const ARM_GPIO_BUS_PIN* pins)
+{
+    const uint32_t count = 1000000;
+    ARM_GPIO_BUS bus;
+    TEST_EQUAL(ARM_GPIO_Bus_Initialize(&bus, pins, 8), ARM_DRIVER_OK);
+    gpio_pins(pins, 8);
+
+    // Stores of 256 bytes.
+    sim_on_write(NULL, count_store);
+    gpio_stores = 0;
+    for (uint32_t data = 0; data < 256; data++)
+        ARM_GPIO_Bus_Write(&bus, data);
+    const uint32_t bus_stores = gpio_stores;
+    gpio_stores = 0;
+    for (uint32_t data = 0; data < 256; data++)
+        pins_write(pins, data);
+    const uint32_t pin_stores = gpio_stores;
+    sim_on_write(NULL, NULL);
+    TEST_CHECK(bus_stores <= 256 * 2 * bus.port_count);
+    TEST_EQUAL(pin_stores, 256 * 8);
+
+    sim_set_traced(0);
+    struct timespec start;
+    volatile uint32_t sink = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        ARM_GPIO_Bus_Write(&bus, n);
+    const double bus_write = elapsed_ns(&start) / count;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        pins_write(pins, n);
+    const double pin_write = elapsed_ns(&start) / count;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        sink += ARM_GPIO_Bus_Read(&bus);
+    const double bus_read = elapsed_ns(&start) / count;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        sink += pins_read(pins);
+    const double pin_read = elapsed_ns(&start) / count;
+    sim_set_traced(1);
+
+    uint32_t ops = 0;
+    for (uint32_t p = 0; p < bus.port_count; p++)
+        ops += bus.ports[p].op_count;
+    printf("%-10s %u port(s) %2u ops: write %6.1f / %6.1f MB/s, read %6.1f / %6.1f MB/s, stores/byte %.2f / %.2f\n",
+           name, bus.port_count, ops,
+           1e3 / bus_write, 1e3 / pin_write, 1e3 / bus_read, 1e3 / pin_read,
+           bus_stores / 256.0, pin_stores / 256.0);
+}
+
+// Bus against WritePin/ReadPin loop (bus / loop).
+static void benchmark(void)
+{
+    static const ARM_GPIO_BUS_PIN contiguous[8] = { {2,0}, {2,1}, {2,2}, {2,3}, {2,4}, {2,5}, {2,6}, {2,7} };
+    static const ARM_GPIO_BUS_PIN split[8]      = { {2,0}, {2,1}, {2,2}, {2,3}, {3,4}, {3,5}, {3,6}, {3,7} };
+    static const ARM_GPIO_BUS_PIN reversed[8]   = { {2,7}, {2,6}, {2,5}, {2,4}, {2,3}, {2,2}, {2,1}, {2,0} };
+    static const ARM_GPIO_BUS_PIN scattered[8]  = { {0,31}, {1,0}, {4,24}, {3,5}, {0,29}, {1,16}, {4,0}, {2,12} };
+
+    sim_reset();
+    power_all_ports();
+    printf("8-bit bus / WritePin, ReadPin loop:\n");
+    benchmark_layout("contiguous", contiguous);
+    benchmark_layout("split", split);
+    benchmark_layout("reversed", reversed);
+    benchmark_layout("scattered", scattered);
+}
+
+int main(void)
+{
+    power_all_ports();
+    test_layouts();
+    test_random_layouts();
+    TEST_CHECK(sim_gated_accesses() == 0);
+    benchmark();
+    return TEST_RESULT();
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Port-wide Control commands against the registers they set: NVIC enable
+// and priority of the port's vector, LK of the selected pins, the default
+// configuration of all unlocked pins, ISFR; unknown commands are refused
+// with ARM_DRIVER_ERROR_PARAMETER, powered or not.
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "test.h"
+
+static uint32_t pcr(uint32_t port, uint32_t pin)
+{
+    return sim_reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin));
+}
+
+static uint32_t nvic_enabled(uint32_t irq)
+{
+    return (sim_reg(SIM_BLOCK_NVIC, SIM_NVIC_ISER + 4 * (irq / 32)) >> (irq % 32)) & 1;
+}
+
+static void start(void)
+{
+    sim_reset();
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+        TEST_EQUAL(gpio_drivers[port]->Initialize(NULL), ARM_DRIVER_OK);
+}
+
+static void stop(void)
+{
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+        gpio_drivers[port]->Uninitialize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Enable and disable the vector of each port, the others untouched.
+static void test_irq(void)
+{
+    start();
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        TEST_EQUAL(gpio_drivers[port]->Control(ARM_GPIO_CONTROL_IRQ, 1), ARM_DRIVER_OK);
+        for (uint32_t other = 0; other < ARM_GPIO_PORT_COUNT; other++)
+            TEST_EQUAL(nvic_enabled(SIM_IRQ_PORT(other)), other <= port);
+    }
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_C]->Control(ARM_GPIO_CONTROL_IRQ, 0), ARM_DRIVER_OK);
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+        TEST_EQUAL(nvic_enabled(SIM_IRQ_PORT(port)), port != ARM_GPIO_PORT_C);
+
+    // Not a port access: allowed with the port off.
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_D]->PowerControl(ARM_POWER_OFF), ARM_DRIVER_OK);
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_D]->Control(ARM_GPIO_CONTROL_IRQ, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(nvic_enabled(SIM_IRQ_PORT(ARM_GPIO_PORT_D)), 0);
+    stop();
+}
+
+// NVIC_IP holds the priority in its upper ARM_GPIO_DEVICE_NVIC_PRIO_BITS;
+// out of range leaves it.
+static void test_priority(void)
+{
+    const uint32_t levels = 1u << ARM_GPIO_DEVICE_NVIC_PRIO_BITS;
+    start();
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        const uint32_t ip = SIM_NVIC_IP + SIM_IRQ_PORT(port);
+        for (uint32_t priority = 0; priority < levels; priority++)
+        {
+            TEST_EQUAL(gpio_drivers[port]->Control(ARM_GPIO_CONTROL_IRQ_PRIORITY, priority), ARM_DRIVER_OK);
+            TEST_EQUAL(sim_reg(SIM_BLOCK_NVIC, ip) & 0xFFu, priority << (8 - ARM_GPIO_DEVICE_NVIC_PRIO_BITS));
+        }
+        TEST_EQUAL(gpio_drivers[port]->Control(ARM_GPIO_CONTROL_IRQ_PRIORITY, levels), ARM_DRIVER_ERROR_PARAMETER);
+        TEST_EQUAL(gpio_drivers[port]->Control(ARM_GPIO_CONTROL_IRQ_PRIORITY, 0xFFFFFFFFu), ARM_DRIVER_ERROR_PARAMETER);
+        TEST_EQUAL(sim_reg(SIM_BLOCK_NVIC, ip) & 0xFFu, (levels - 1) << (8 - ARM_GPIO_DEVICE_NVIC_PRIO_BITS));
+    }
+    // Neighbouring vectors keep theirs.
+    TEST_EQUAL(sim_reg(SIM_BLOCK_NVIC, SIM_NVIC_IP + SIM_IRQ_PORT(0) - 1) & 0xFFu, 0);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_NVIC, SIM_NVIC_IP + SIM_IRQ_PORT(ARM_GPIO_PORT_COUNT)) & 0xFFu, 0);
+    stop();
+}
+
+// LK on the selected pins that exist, nothing else; locked pins refuse
+// configuration.
+static void test_lock(void)
+{
+    start();
+    ARM_DRIVER_GPIO* const b = gpio_drivers[ARM_GPIO_PORT_B];
+    const uint32_t pins = gpio_ports[ARM_GPIO_PORT_B]->pins;
+    const uint32_t mask = 0x0000F00Fu;             // B12..15 don't exist
+    TEST_EQUAL(b->ControlPin(1, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_UP), ARM_DRIVER_OK);
+    const uint32_t pin1 = pcr(ARM_GPIO_PORT_B, 1);
+
+    TEST_EQUAL(b->Control(ARM_GPIO_CONTROL_LOCK, mask), ARM_DRIVER_OK);
+    for (uint32_t pin = 0; pin < 32; pin++)
+        TEST_EQUAL((pcr(ARM_GPIO_PORT_B, pin) & PORT_PCR_LK_MASK) != 0, ((mask & pins) >> pin) & 1);
+    TEST_EQUAL(pcr(ARM_GPIO_PORT_B, 1), pin1 | PORT_PCR_LK_MASK);
+    TEST_EQUAL(b->ControlPin(1, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_NONE), ARM_DRIVER_ERROR);
+    TEST_EQUAL(b->ControlPin(4, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_UP), ARM_DRIVER_OK);
+
+    // Again, with more pins: the locked ones stay as they are.
+    TEST_EQUAL(b->Control(ARM_GPIO_CONTROL_LOCK, 0x30u), ARM_DRIVER_OK);
+    TEST_EQUAL(pcr(ARM_GPIO_PORT_B, 1), pin1 | PORT_PCR_LK_MASK);
+    TEST_CHECK(pcr(ARM_GPIO_PORT_B, 4) & PORT_PCR_LK_MASK);
+    TEST_EQUAL(b->ControlPin(4, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_NONE), ARM_DRIVER_ERROR);
+    stop();
+}
+
+// All unlocked pins reset to the configuration, DSE only where it exists;
+// direction follows it.
+static void test_default_config(void)
+{
+    start();
+    const ARM_GPIO_CONFIG* const cfg = gpio_ports[ARM_GPIO_PORT_A];
+    ARM_DRIVER_GPIO* const a = gpio_drivers[ARM_GPIO_PORT_A];
+    for (uint32_t pin = 0; pin < 8; pin++)
+        TEST_EQUAL(a->ControlPin(pin, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT |
+                                 ARM_GPIO_PIN_CFG_IRQ_RISING | ARM_GPIO_PIN_CFG_PULL_DOWN), ARM_DRIVER_OK);
+    TEST_EQUAL(a->Control(ARM_GPIO_CONTROL_LOCK, 1u << 2), ARM_DRIVER_OK);
+    const uint32_t locked = pcr(ARM_GPIO_PORT_A, 2);
+
+    const uint32_t arg = ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_PULL_UP;
+    uint32_t value;
+    TEST_EQUAL(ARM_GPIO_EncodeConfig(arg, &value), ARM_DRIVER_OK);
+    TEST_EQUAL(a->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, arg), ARM_DRIVER_OK);
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        const uint32_t bit = 1u << pin;
+        if (pin == 2)
+            TEST_EQUAL(pcr(ARM_GPIO_PORT_A, pin), locked);
+        else if (cfg->pins & bit)
+            TEST_EQUAL(pcr(ARM_GPIO_PORT_A, pin), (cfg->high_drive & bit) ? value : value & ~PORT_PCR_DSE_MASK);
+        else
+            TEST_EQUAL(pcr(ARM_GPIO_PORT_A, pin), 0);
+    }
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_A), SIM_GPIO_PDDR), 1u << 2);
+
+    TEST_EQUAL(a->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, arg | ARM_GPIO_PIN_CFG_OUTPUT), ARM_DRIVER_OK);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_A), SIM_GPIO_PDDR), cfg->pins);
+    TEST_EQUAL(a->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, 0xFFFFFFFFu), ARM_DRIVER_ERROR_PARAMETER);
+    stop();
+}
+
+// Pending flags of the port dropped, no handler run.
+static void test_clear_events(void)
+{
+    start();
+    ARM_DRIVER_GPIO* const e = gpio_drivers[ARM_GPIO_PORT_E];
+    const uint32_t pins = gpio_ports[ARM_GPIO_PORT_E]->pins;
+    for (uint32_t pin = 0; pin < 32; pin++)
+        if (pins & (1u << pin))
+            TEST_EQUAL(e->ControlPin(pin, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_RISING), ARM_DRIVER_OK);
+    sim_port_input(ARM_GPIO_PORT_E, pins, &pins, 1);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(ARM_GPIO_PORT_E), SIM_PORT_ISFR), pins);
+
+    TEST_EQUAL(e->Control(ARM_GPIO_CONTROL_CLEAR_EVENTS, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(ARM_GPIO_PORT_E), SIM_PORT_ISFR), 0);
+    for (uint32_t pin = 0; pin < 32; pin++)
+        TEST_EQUAL(pcr(ARM_GPIO_PORT_E, pin) & PORT_PCR_ISF_MASK, 0);
+    stop();
+}
+
+// Unknown commands: PARAMETER, also with the port off, where the port
+// commands return ERROR without touching it.
+static void test_unknown(void)
+{
+    static const uint32_t unknown[] = { 0, ARM_GPIO_CONTROL_CLEAR_EVENTS + 1, 0x80, 0xFFFFFFFFu };
+    start();
+    ARM_DRIVER_GPIO* const c = gpio_drivers[ARM_GPIO_PORT_C];
+    for (uint32_t n = 0; n < sizeof(unknown) / sizeof(unknown[0]); n++)
+        TEST_EQUAL(c->Control(unknown[n], 0), ARM_DRIVER_ERROR_PARAMETER);
+
+    TEST_EQUAL(c->PowerControl(ARM_POWER_OFF), ARM_DRIVER_OK);
+    for (uint32_t n = 0; n < sizeof(unknown) / sizeof(unknown[0]); n++)
+        TEST_EQUAL(c->Control(unknown[n], 0), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(c->Control(ARM_GPIO_CONTROL_LOCK, 1), ARM_DRIVER_ERROR);
+    TEST_EQUAL(c->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, 0), ARM_DRIVER_ERROR);
+    TEST_EQUAL(c->Control(ARM_GPIO_CONTROL_CLEAR_EVENTS, 0), ARM_DRIVER_ERROR);
+    stop();
+    TEST_EQUAL(sim_gated_accesses(), 0);
+}
+
+int main(void)
+{
+    test_irq();
+    test_priority();
+    test_lock();
+    test_default_config();
+    test_clear_events();
+    test_unknown();
+    return TEST_RESULT();
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Discrete-event load (host/gpio_des.h): waves on pins of all ports, flags
+// latched per IRQC, handlers in NVIC priority order, lost events, latency
+// and time in handlers; polled ports against the interrupt; then the speed
+// of the simulation.
+
+#include "gpio_des.h"
+#include "test.h"
+
+#include <string.h>
+
+static GPIO_DES_PORT port_config(uint32_t priority, uint32_t irq)
+{
+    GPIO_DES_PORT config = { priority, irq, 0, 0, 0, NULL, 0 };
+    return config;
+}
+
+static void wave(uint32_t port, uint32_t pin, uint32_t high, uint32_t low, uint32_t jitter, uint64_t start, uint64_t end)
+{
+    const SIM_WAVE w = { (uint8_t)port, (uint8_t)pin, high, low, jitter, start, end };
+    TEST_EQUAL(gpio_des_wave(&w), ARM_DRIVER_OK);
+}
+
+// Light load on 8 pins of every port: every edge is an event.
+static void test_all_ports(void)
+{
+    GPIO_DES_REPORT report;
+
+    gpio_des_reset();
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        const GPIO_DES_PORT config = port_config(port + 1, ARM_GPIO_PIN_IRQ_BOTH);
+        TEST_EQUAL(gpio_des_port(port, &config), ARM_DRIVER_OK);
+        for (uint32_t pin = 0; pin < 8; pin++)
+            wave(port, pin, 2000 + 100 * pin, 3000 + 50 * port, 40, 1000 + 7 * pin + 13 * port, 1000000);
+    }
+    gpio_des_run(1100000, &report);
+
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        const GPIO_DES_RESULT* r = &report.port[port];
+        TEST_CHECK(r->edges.edges > 8 * 300);
+        TEST_EQUAL(r->edges.lost, 0);
+        TEST_EQUAL(r->edges.latched, r->edges.edges);
+        TEST_EQUAL(r->events, r->edges.edges);
+        TEST_EQUAL(r->latency.count, r->events);
+        TEST_CHECK(r->calls > 0 && r->calls <= r->events);
+    }
+    TEST_CHECK(report.isr_cycles > 0 && report.isr_cycles < report.cycles / 2);
+    TEST_EQUAL(sim_gated_accesses(), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t pin_events[32];
+
+static void count_pins(uint32_t port, uint32_t events)
+{
+    for (; events; events &= events - 1)
+        pin_events[__builtin_ctz(events)]++;
+}
+
+// Per-pin IRQC: 10 periods, each rising and falling edge once.
+static void test_irqc(void)
+{
+    static const uint32_t irq[5] = {
+        ARM_GPIO_PIN_IRQ_RISING, ARM_GPIO_PIN_IRQ_FALLING, ARM_GPIO_PIN_IRQ_BOTH, ARM_GPIO_PIN_IRQ_NONE, ARM_GPIO_PIN_IRQ_BOTH
+    };
+    static const uint32_t expected[5] = { 10, 10, 20, 0, 20 };
+    GPIO_DES_REPORT report;
+
+    gpio_des_reset();
+    memset(pin_events, 0, sizeof(pin_events));
+    GPIO_DES_PORT config = port_config(4, ARM_GPIO_PIN_IRQ_NONE);
+    config.observe = count_pins;
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_B, &config), ARM_DRIVER_OK);
+    for (uint32_t pin = 0; pin < 5; pin++)
+    {
+        wave(ARM_GPIO_PORT_B, pin, 500, 500, 0, 100 + pin, 100 + pin + 10 * 1000);
+        TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_B]->ControlPin(pin, ARM_GPIO_PIN_IRQ, irq[pin]), ARM_DRIVER_OK);
+    }
+    gpio_des_run(20000, &report);
+
+    for (uint32_t pin = 0; pin < 5; pin++)
+        TEST_EQUAL(pin_events[pin], expected[pin]);
+    TEST_EQUAL(report.port[ARM_GPIO_PORT_B].edges.edges, 5 * 20);
+    TEST_EQUAL(report.port[ARM_GPIO_PORT_B].edges.latched, 60);
+    TEST_EQUAL(report.port[ARM_GPIO_PORT_B].edges.lost, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t order[64][2];           // port, handler nesting
+static uint32_t order_count;
+
+static void record_order(uint32_t port, uint32_t events)
+{
+    if (order_count < 64)
+    {
+        order[order_count][0] = port;
+        order[order_count][1] = sim_in_isr();
+        order_count++;
+    }
+}
+
+static void test_priority(void)
+{
+    GPIO_DES_REPORT report;
+
+    // Edges on C (priority 6), E (priority 1) and A (priority 3) at the same
+    // time: E, A, C. Then D (priority 2) during the callback of C, which
+    // takes 2000 cycles: D preempts.
+    gpio_des_reset();
+    order_count = 0;
+    GPIO_DES_PORT config = port_config(6, ARM_GPIO_PIN_IRQ_RISING);
+    config.observe = record_order;
+    config.event_cost = 2000;
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_C, &config), ARM_DRIVER_OK);
+    config.event_cost = 0;
+    config.priority = 1;
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_E, &config), ARM_DRIVER_OK);
+    config.priority = 3;
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_A, &config), ARM_DRIVER_OK);
+    config.priority = 2;
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_D, &config), ARM_DRIVER_OK);
+
+    // Same cycle: configure all, then one edge event of each.
+    sim_advance(10);
+    const uint64_t t0 = sim_time() + 100;
+    wave(ARM_GPIO_PORT_C, 1, 5000, 5000, 0, t0, t0 + 1);
+    wave(ARM_GPIO_PORT_E, 1, 5000, 5000, 0, t0, t0 + 1);
+    wave(ARM_GPIO_PORT_A, 1, 5000, 5000, 0, t0, t0 + 1);
+    wave(ARM_GPIO_PORT_D, 1, 5000, 5000, 0, t0 + 1000, t0 + 1001);
+    gpio_des_run(10000, &report);
+
+    TEST_EQUAL(order_count, 4);
+    TEST_EQUAL(order[0][0], ARM_GPIO_PORT_E);
+    TEST_EQUAL(order[1][0], ARM_GPIO_PORT_A);
+    TEST_EQUAL(order[2][0], ARM_GPIO_PORT_C);
+    TEST_EQUAL(order[2][1], 1);
+    TEST_EQUAL(order[3][0], ARM_GPIO_PORT_D);
+    TEST_EQUAL(order[3][1], 2);
+
+    // E's handler delays A's by its duration.
+    TEST_CHECK(report.port[ARM_GPIO_PORT_A].latency.max > report.port[ARM_GPIO_PORT_E].latency.max);
+    TEST_CHECK(report.port[ARM_GPIO_PORT_D].latency.max < report.port[ARM_GPIO_PORT_C].latency.max);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Callback longer than the period: events are lost, the flag keeps one.
+static void test_overload(void)
+{
+    GPIO_DES_REPORT report;
+
+    gpio_des_reset();
+    GPIO_DES_PORT config = port_config(5, ARM_GPIO_PIN_IRQ_BOTH);
+    config.event_cost = 300;
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_D, &config), ARM_DRIVER_OK);
+    wave(ARM_GPIO_PORT_D, 0, 100, 100, 0, 1000, 201000);
+    gpio_des_run(210000, &report);
+
+    const GPIO_DES_RESULT* r = &report.port[ARM_GPIO_PORT_D];
+    TEST_EQUAL(r->edges.edges, 2000);
+    TEST_CHECK(r->edges.lost > 1000);
+    TEST_EQUAL(r->edges.latched + r->edges.lost, r->edges.edges);
+    TEST_EQUAL(r->events, r->edges.latched);
+    TEST_CHECK(report.isr_cycles > 190000);
+}
+
+// Latency of a lone pin: exception entry and the handler up to the callback,
+// the same for every event.
+static void test_latency(void)
+{
+    GPIO_DES_REPORT report;
+
+    gpio_des_reset();
+    const GPIO_DES_PORT config = port_config(5, ARM_GPIO_PIN_IRQ_BOTH);
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_E, &config), ARM_DRIVER_OK);
+    wave(ARM_GPIO_PORT_E, 3, 1000, 1000, 0, 1000, 101000);
+    gpio_des_run(110000, &report);
+
+    const ARM_GPIO_HISTOGRAM* latency = &report.port[ARM_GPIO_PORT_E].latency;
+    TEST_EQUAL(latency->count, 100);
+    TEST_CHECK(latency->max >= sim_isr_entry);
+    TEST_EQUAL(ARM_GPIO_Histogram_Percentile(latency, 0), latency->max);
+    printf("lone pin: edge to callback %u cycles\n", latency->max);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Polled port: every edge further apart than the period is seen by the next
+// pass, once; a pulse within one period is lost.
+static void test_polled(void)
+{
+    GPIO_DES_REPORT report;
+
+    gpio_des_reset();
+    GPIO_DES_PORT config = port_config(4, ARM_GPIO_PIN_IRQ_BOTH);
+    config.polled = 1;
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_C, &config), ARM_DRIVER_OK);
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_D, &config), ARM_DRIVER_OK);
+    gpio_des_poll(1000, 4, 50);
+    for (uint32_t pin = 0; pin < 4; pin++)
+        wave(ARM_GPIO_PORT_C, pin, 2500 + 100 * pin, 3000, 100, 1000 + 13 * pin, 1000000);
+    wave(ARM_GPIO_PORT_D, 0, 300, 4700, 0, 1500, 1000000);
+    gpio_des_run(1100000, &report);
+
+    const GPIO_DES_RESULT* c = &report.port[ARM_GPIO_PORT_C];
+    TEST_CHECK(c->edges.edges > 4 * 300);
+    TEST_EQUAL(c->edges.lost, 0);
+    TEST_EQUAL(c->events, c->edges.edges);
+    TEST_CHECK(c->calls < c->events);
+    TEST_CHECK(c->latency.max <= 1000 + sim_isr_entry);
+    TEST_CHECK(ARM_GPIO_Histogram_Percentile(&c->latency, 0) < 1000);
+
+    // Passes at 1, 1001, ...: the pulse from 1500 + 5000 n to 1800 + 5000 n
+    // falls between two.
+    const GPIO_DES_RESULT* d = &report.port[ARM_GPIO_PORT_D];
+    TEST_EQUAL(d->edges.edges, 2 * 200);
+    TEST_EQUAL(d->events, 0);
+    TEST_EQUAL(d->edges.lost, d->edges.edges);
+}
+
+// Interrupt against polling on 16 pins of port A: edge rate, which each
+// mode delivers without a loss, worst latency and time in handlers, to
+// choose the mode of a port. Handler 60 cycles a call, callback 20 an event;
+// a pass 40 cycles every 600.
+static void compare_modes(void)
+{
+    static const uint32_t phases[] = { 40000, 16000, 8000, 4000, 2000, 1400, 1000, 800, 700, 500 };
+    double busy[sizeof(phases) / sizeof(phases[0])][2];
+    uint32_t best[2] = { 0, 0 };
+
+    printf("phase  mode       edges/s     lost  max latency  handlers\n");
+    for (uint32_t n = 0; n < sizeof(phases) / sizeof(phases[0]); n++)
+    {
+        for (uint32_t poll = 0; poll < 2; poll++)
+        {
+            GPIO_DES_REPORT report;
+
+            gpio_des_reset();
+            GPIO_DES_PORT config = port_config(4, ARM_GPIO_PIN_IRQ_BOTH);
+            config.event_cost   = 20;
+            config.handler_cost = poll ? 0 : 60;
+            config.polled       = poll;
+            TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_A, &config), ARM_DRIVER_OK);
+            if (poll)
+                gpio_des_poll(600, 4, 40);
+            for (uint32_t pin = 0; pin < 16; pin++)
+                wave(ARM_GPIO_PORT_A, pin, phases[n], phases[n], phases[n] / 4, 1000 + 37 * pin, 1801000);
+            gpio_des_run(1801000 + 2 * 600, &report);   // the last pass sees the last edge
+
+            const GPIO_DES_RESULT* r = &report.port[ARM_GPIO_PORT_A];
+            const double rate = (double)r->events * 180e6 / 1800000.0;
+            printf("%5u  %-9s %8.0fk %8llu %12u %8.1f %%\n", phases[n], poll ? "polled" : "interrupt", 1e-3 * rate,
+                   (unsigned long long)r->edges.lost, r->latency.max,
+                   100.0 * (double)report.isr_cycles / (double)report.cycles);
+            busy[n][poll] = (double)report.isr_cycles / (double)report.cycles;
+            if (!r->edges.lost && rate > best[poll])
+                best[poll] = (uint32_t)rate;
+            if (poll)
+                TEST_CHECK(!r->events || r->latency.max <= 600 + sim_isr_entry + 40 + 20 * 16);
+        }
+    }
+    printf("without a loss: interrupt %.2f M edges/s, polled %.2f M edges/s\n", 1e-6 * best[0], 1e-6 * best[1]);
+    TEST_CHECK(best[0] > 0 && best[1] > 0);
+
+    // A pass costs less than the handler calls of dense edges, more than
+    // those of sparse ones.
+    TEST_CHECK(busy[0][0] < busy[0][1]);
+    TEST_CHECK(busy[6][1] < busy[6][0]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// 20 pins of every port, 1 s at 180 MHz for the model handlers,
+// 0.1 s for the driver's (a trapped store per call).
+static void benchmark(uint32_t model, uint64_t cycles)
+{
+    GPIO_DES_REPORT report;
+
+    gpio_des_reset();
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        GPIO_DES_PORT config = port_config(port + 2, ARM_GPIO_PIN_IRQ_BOTH);
+        config.model_handler = model;
+        TEST_EQUAL(gpio_des_port(port, &config), ARM_DRIVER_OK);
+        for (uint32_t pin = 0; pin < 20; pin++)
+        {
+            if (gpio_ports[port]->pins & (1u << pin))
+                wave(port, pin, 3000 + 97 * pin, 4000 + 31 * port, 500, 1000 + pin, cycles);
+        }
+    }
+    gpio_des_run(cycles, &report);
+
+    uint64_t edges = 0, lost = 0, calls = 0;
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        edges += report.port[port].edges.edges;
+        lost  += report.port[port].edges.lost;
+        calls += report.port[port].calls;
+    }
+    TEST_EQUAL(lost, 0);
+    printf("%s handlers: %llu edges, %llu calls, %.1f %% in handlers, %.2f M edges/s\n",
+           model ? "model " : "driver", (unsigned long long)edges, (unsigned long long)calls,
+           100.0 * (double)report.isr_cycles / (double)report.cycles, 1e-6 * (double)edges / report.seconds);
+}
+
+int main(void)
+{
+    test_all_ports();
+    test_irqc();
+    test_priority();
+    test_overload();
+    test_latency();
+    test_polled();
+    compare_modes();
+    benchmark(1, 180000000u);
+    benchmark(0, 18000000u);
+    return TEST_RESULT();
+}
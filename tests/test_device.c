@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Per-part pin description (ARM_GPIO_DEVICE_PORTS): pins missing on the
+// package are refused, high drive strength only where the part has it,
+// digital filter only on the pins of PORTx_DFER. Built for every device.
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "test.h"
+
+static const uint32_t DRIVE_HIGH_CFG = ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT | ARM_GPIO_PIN_CFG_DRIVE_STRENGTH;
+
+static void test_pins(void)
+{
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        const ARM_GPIO_CONFIG* const cfg = gpio_ports[port];
+        ARM_DRIVER_GPIO* const driver = gpio_drivers[port];
+        TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+        TEST_EQUAL(cfg->high_drive & ~cfg->pins, 0);
+        TEST_EQUAL(cfg->filter & ~cfg->pins, 0);
+
+        for (uint32_t pin = 0; pin < 32; pin++)
+        {
+            const uint32_t bit = 1u << pin;
+            const int32_t missing = (cfg->pins & bit) ? ARM_DRIVER_OK : ARM_DRIVER_ERROR_PARAMETER;
+            const int32_t drive = !(cfg->pins & bit) ? ARM_DRIVER_ERROR_PARAMETER
+                                : (cfg->high_drive & bit) ? ARM_DRIVER_OK : ARM_DRIVER_ERROR_UNSUPPORTED;
+
+            TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_STATE, ARM_GPIO_PIN_STATE_ENABLE), missing);
+            TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_DIRECTION, ARM_GPIO_PIN_DIRECTION_OUTPUT), missing);
+            TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_DRIVE_STRENGTH, ARM_GPIO_PIN_DRIVE_STRENGTH_LOW), missing);
+            TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_DRIVE_STRENGTH, ARM_GPIO_PIN_DRIVE_STRENGTH_HIGH), drive);
+            TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_CFG, DRIVE_HIGH_CFG), drive);
+
+            // A refused command leaves the PCR alone.
+            const uint32_t pcr = sim_reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin));
+            TEST_EQUAL(pcr & PORT_PCR_DSE_MASK, (drive == ARM_DRIVER_OK) ? PORT_PCR_DSE_MASK : 0);
+            TEST_EQUAL(pcr & PORT_PCR_MUX_MASK, missing == ARM_DRIVER_OK ? PORT_PCR_MUX(1) : 0);
+        }
+
+        // Default configuration: existing pins only, DSE where the pin has it.
+        TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+        sim_reset();
+        TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+        TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, DRIVE_HIGH_CFG), ARM_DRIVER_OK);
+        for (uint32_t pin = 0; pin < 32; pin++)
+        {
+            const uint32_t bit = 1u << pin;
+            const uint32_t pcr = sim_reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin));
+            TEST_EQUAL(pcr & PORT_PCR_MUX_MASK, (cfg->pins & bit) ? PORT_PCR_MUX(1) : 0);
+            TEST_EQUAL(pcr & PORT_PCR_DSE_MASK, (cfg->high_drive & bit) ? PORT_PCR_DSE_MASK : 0);
+        }
+        TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(port), SIM_GPIO_PDDR), cfg->pins);
+        TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+    }
+}
+
+// Part-specific spot checks against the data sheet.
+static void test_part(void)
+{
+    ARM_DRIVER_GPIO* const a = gpio_drivers[ARM_GPIO_PORT_A];
+    ARM_DRIVER_GPIO* const b = gpio_drivers[ARM_GPIO_PORT_B];
+    TEST_EQUAL(a->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(b->Initialize(NULL), ARM_DRIVER_OK);
+
+    TEST_EQUAL(a->ControlPin(20, ARM_GPIO_PIN_STATE, ARM_GPIO_PIN_STATE_ENABLE), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(b->ControlPin(1, ARM_GPIO_PIN_DRIVE_STRENGTH, ARM_GPIO_PIN_DRIVE_STRENGTH_HIGH), ARM_DRIVER_OK);
+#if defined(ARM_GPIO_DEVICE_MK22F51212)
+    TEST_EQUAL(a->ControlPin(6, ARM_GPIO_PIN_STATE, ARM_GPIO_PIN_STATE_ENABLE), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(b->ControlPin(2, ARM_GPIO_PIN_DRIVE_STRENGTH, ARM_GPIO_PIN_DRIVE_STRENGTH_HIGH), ARM_DRIVER_ERROR_UNSUPPORTED);
+#else
+    TEST_EQUAL(a->ControlPin(6, ARM_GPIO_PIN_STATE, ARM_GPIO_PIN_STATE_ENABLE), ARM_DRIVER_OK);
+    TEST_EQUAL(b->ControlPin(2, ARM_GPIO_PIN_DRIVE_STRENGTH, ARM_GPIO_PIN_DRIVE_STRENGTH_HIGH), ARM_DRIVER_OK);
+#endif
+
+    TEST_EQUAL(a->Uninitialize(), ARM_DRIVER_OK);
+    TEST_EQUAL(b->Uninitialize(), ARM_DRIVER_OK);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Digital filter
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t filter_writes[8][2];
+static uint32_t filter_count;
+
+static void on_write(uint32_t block, uint32_t offset, uint32_t value)
+{
+    if (block == SIM_BLOCK_PORT(ARM_GPIO_PORT_D) && offset >= SIM_PORT_DFER && filter_count < 8)
+    {
+        filter_writes[filter_count][0] = offset;
+        filter_writes[filter_count][1] = value;
+        filter_count++;
+    }
+}
+
+static void test_filter(void)
+{
+    const uint32_t filter = gpio_ports[ARM_GPIO_PORT_D]->filter;
+    ARM_DRIVER_GPIO* const driver = gpio_drivers[ARM_GPIO_PORT_D];
+    TEST_CHECK(filter != 0);
+
+    // Ports without filter, pins outside DFER, bad arguments, gated port.
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        if (!gpio_ports[port]->filter)
+            TEST_EQUAL(ARM_GPIO_SetDigitalFilter(port, 1, ARM_GPIO_FILTER_CLOCK_BUS, 4), ARM_DRIVER_ERROR_UNSUPPORTED);
+    }
+    TEST_EQUAL(ARM_GPIO_SetDigitalFilter(ARM_GPIO_PORT_D, ~filter, ARM_GPIO_FILTER_CLOCK_BUS, 4), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(ARM_GPIO_SetDigitalFilter(ARM_GPIO_PORT_D, 1, 2, 4), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_SetDigitalFilter(ARM_GPIO_PORT_D, 1, ARM_GPIO_FILTER_CLOCK_BUS, 32), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_SetDigitalFilter(ARM_GPIO_PORT_COUNT, 0, ARM_GPIO_FILTER_CLOCK_BUS, 0), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_SetDigitalFilter(ARM_GPIO_PORT_D, 1, ARM_GPIO_FILTER_CLOCK_BUS, 4), ARM_DRIVER_ERROR);
+
+    TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(ARM_GPIO_SetDigitalFilter(ARM_GPIO_PORT_D, 0x3, ARM_GPIO_FILTER_CLOCK_BUS, 4), ARM_DRIVER_OK);
+
+    // Reconfigure: filters off before clock and width change.
+    sim_on_write(NULL, on_write);
+    TEST_EQUAL(ARM_GPIO_SetDigitalFilter(ARM_GPIO_PORT_D, filter, ARM_GPIO_FILTER_CLOCK_LPO, 31), ARM_DRIVER_OK);
+    sim_on_write(NULL, NULL);
+
+    TEST_EQUAL(filter_count, 4);
+    TEST_EQUAL(filter_writes[0][0], SIM_PORT_DFER);
+    TEST_EQUAL(filter_writes[0][1], 0);
+    TEST_EQUAL(filter_writes[3][0], SIM_PORT_DFER);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(ARM_GPIO_PORT_D), SIM_PORT_DFER), filter);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(ARM_GPIO_PORT_D), SIM_PORT_DFCR), PORT_DFCR_CS_MASK);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(ARM_GPIO_PORT_D), SIM_PORT_DFWR), 31);
+
+    TEST_EQUAL(ARM_GPIO_SetDigitalFilter(ARM_GPIO_PORT_D, 0, ARM_GPIO_FILTER_CLOCK_BUS, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(ARM_GPIO_PORT_D), SIM_PORT_DFER), 0);
+    TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+}
+
+int main(void)
+{
+    sim_reset();
+    test_pins();
+    test_part();
+    test_filter();
+    TEST_EQUAL(sim_gated_accesses(), 0);
+    return TEST_RESULT();
+}
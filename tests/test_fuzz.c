@@ -0,0 +1,524 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Differential test of the pin configuration: random sequences of ControlPin,
+// Control(LOCK, DEFAULT_CFG) and the *Port/*Pin writes run on the driver
+// over the register model and on a reference model written from the
+// reference manual and Driver_GPIO.h; return codes and PCR, PDDR and PDOR of
+// every port must agree after every call. Built with and without shadow
+// registers and for a part without the optional PCR features.
+//
+//     test_fuzz [operations [seed]]
+//
+// runs longer sequences; the first divergence is printed with the call.
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+// PCR fields of the configuration: PS, PE, SRE, PFE, ODE, DSE, MUX, LK, IRQC.
+#define PCR_CONFIG      0x000F877Fu
+#define PCR_PS          0x00000001u
+#define PCR_PE          0x00000002u
+#define PCR_SRE         0x00000004u
+#define PCR_ODE         0x00000020u
+#define PCR_DSE         0x00000040u
+#define PCR_MUX_GPIO    0x00000100u
+#define PCR_MUX         0x00000700u
+#define PCR_LK          0x00008000u
+#define PCR_IRQC(irqc)  ((uint32_t)(irqc) << 16)
+#define PCR_IRQC_MASK   0x000F0000u
+
+// Restart (reset, locks gone) after this many operations.
+#define RUN_LENGTH      4096u
+
+typedef struct
+{
+    uint32_t pcr[32];
+    uint32_t pddr;
+    uint32_t pdor;
+} MODEL_PORT;
+
+static MODEL_PORT model[ARM_GPIO_PORT_COUNT];
+
+////////////////////////////////////////////////////////////////////////////////
+//   Reference model
+////////////////////////////////////////////////////////////////////////////////
+
+// IRQC by ARM_GPIO_PIN_IRQ_x.
+static const uint8_t irqc_of[6] = { 0x0, 0x9, 0xA, 0xB, 0xC, 0x8 };
+
+// ARM_GPIO_PIN_CFG value: fields checked in their order in the argument.
+static int32_t model_encode(uint32_t arg, uint32_t* pcr)
+{
+    if (arg & ~0x7FFu)
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    const uint32_t irq   = (arg >> 2) & 7;
+    const uint32_t pull  = (arg >> 5) & 3;
+    const uint32_t speed = (arg >> 7) & 3;
+    const uint32_t od    = (arg >> 9) & 1;
+    const uint32_t ds    = (arg >> 10) & 1;
+
+    if (irq > 5)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    if (pull && !ARM_GPIO_DEVICE_PULL)
+        return ARM_DRIVER_ERROR_UNSUPPORTED;
+    if (pull == 3)
+        return ARM_DRIVER_ERROR_PARAMETER;
+    if ((speed && !ARM_GPIO_DEVICE_SLEW_RATE) || (od && !ARM_GPIO_DEVICE_OPEN_DRAIN) || (ds && !ARM_GPIO_DEVICE_DRIVE_STRENGTH))
+        return ARM_DRIVER_ERROR_UNSUPPORTED;
+
+    *pcr = ((arg & 1) ? PCR_MUX_GPIO : 0)
+         | PCR_IRQC(irqc_of[irq])
+         | (pull == 1 ? PCR_PE | PCR_PS : pull == 2 ? PCR_PE : 0)
+         | (speed >= 2 ? PCR_SRE : 0)
+         | (od ? PCR_ODE : 0)
+         | (ds ? PCR_DSE : 0);
+    return ARM_DRIVER_OK;
+}
+
+// A single-field command on an unlocked pin: new PCR or an error.
+static int32_t model_field(uint32_t control, uint32_t arg, uint32_t* pcr)
+{
+    uint32_t v = *pcr;
+    switch (control)
+    {
+        case ARM_GPIO_PIN_STATE:
+            if (arg > 1)
+                return ARM_DRIVER_ERROR_PARAMETER;
+            v = (v & ~PCR_MUX) | (arg ? PCR_MUX_GPIO : 0);
+            break;
+        case ARM_GPIO_PIN_IRQ:
+            if (arg > 5)
+                return ARM_DRIVER_ERROR_PARAMETER;
+            v = (v & ~PCR_IRQC_MASK) | PCR_IRQC(irqc_of[arg]);
+            break;
+        case ARM_GPIO_PIN_PULL:
+            if (arg > 2)
+                return ARM_DRIVER_ERROR_PARAMETER;
+            v = (v & ~(PCR_PE | PCR_PS)) | (arg == 1 ? PCR_PE | PCR_PS : arg == 2 ? PCR_PE : 0);
+            break;
+        case ARM_GPIO_PIN_SPEED:
+            if (arg > 3)
+                return ARM_DRIVER_ERROR_PARAMETER;
+            v = (v & ~PCR_SRE) | (arg >= 2 ? PCR_SRE : 0);
+            break;
+        case ARM_GPIO_PIN_OPEN_DRAIN:
+            if (arg > 1)
+                return ARM_DRIVER_ERROR_PARAMETER;
+            v = (v & ~PCR_ODE) | (arg ? PCR_ODE : 0);
+            break;
+        default:
+            if (arg > 1)
+                return ARM_DRIVER_ERROR_PARAMETER;
+            v = (v & ~PCR_DSE) | (arg ? PCR_DSE : 0);
+            break;
+    }
+    *pcr = v;
+    return ARM_DRIVER_OK;
+}
+
+static int32_t model_control_pin(uint32_t port, uint32_t pin, uint32_t control, uint32_t arg)
+{
+    const ARM_GPIO_CONFIG* const cfg = gpio_ports[port];
+    MODEL_PORT* const m = &model[port];
+
+    if (pin >= 32 || !(cfg->pins & (1u << pin)))
+        return ARM_DRIVER_ERROR_PARAMETER;
+
+    const uint32_t bit = 1u << pin;
+    uint32_t pcr;
+    int32_t status;
+    switch (control)
+    {
+        case ARM_GPIO_PIN_CFG:
+            if ((status = model_encode(arg, &pcr)) != ARM_DRIVER_OK)
+                return status;
+            if ((pcr & PCR_DSE) && !(cfg->high_drive & bit))
+                return ARM_DRIVER_ERROR_UNSUPPORTED;
+            if (m->pcr[pin] & PCR_LK)
+                return ARM_DRIVER_ERROR;
+            m->pcr[pin] = pcr;
+            m->pddr = (arg & ARM_GPIO_PIN_CFG_OUTPUT) ? m->pddr | bit : m->pddr & ~bit;
+            return ARM_DRIVER_OK;
+
+        // PDDR is not covered by the lock.
+        case ARM_GPIO_PIN_DIRECTION:
+            if (arg > 1)
+                return ARM_DRIVER_ERROR_PARAMETER;
+            m->pddr = arg ? m->pddr | bit : m->pddr & ~bit;
+            return ARM_DRIVER_OK;
+
+        case ARM_GPIO_PIN_STATE:
+        case ARM_GPIO_PIN_IRQ:
+            break;
+        case ARM_GPIO_PIN_PULL:
+            if (!ARM_GPIO_DEVICE_PULL)
+                return ARM_DRIVER_ERROR_UNSUPPORTED;
+            break;
+        case ARM_GPIO_PIN_SPEED:
+            if (!ARM_GPIO_DEVICE_SLEW_RATE)
+                return ARM_DRIVER_ERROR_UNSUPPORTED;
+            break;
+        case ARM_GPIO_PIN_OPEN_DRAIN:
+            if (!ARM_GPIO_DEVICE_OPEN_DRAIN)
+                return ARM_DRIVER_ERROR_UNSUPPORTED;
+            break;
+        case ARM_GPIO_PIN_DRIVE_STRENGTH:
+            if (!ARM_GPIO_DEVICE_DRIVE_STRENGTH || (arg == ARM_GPIO_PIN_DRIVE_STRENGTH_HIGH && !(cfg->high_drive & bit)))
+                return ARM_DRIVER_ERROR_UNSUPPORTED;
+            break;
+        default:
+            return ARM_DRIVER_ERROR_UNSUPPORTED;
+    }
+
+    // The lock is checked before the argument.
+    if (m->pcr[pin] & PCR_LK)
+        return ARM_DRIVER_ERROR;
+    return model_field(control, arg, &m->pcr[pin]);
+}
+
+static int32_t model_control(uint32_t port, uint32_t control, uint32_t arg)
+{
+    const ARM_GPIO_CONFIG* const cfg = gpio_ports[port];
+    MODEL_PORT* const m = &model[port];
+
+    if (control == ARM_GPIO_CONTROL_LOCK)
+    {
+        for (uint32_t pin = 0; pin < 32; pin++)
+        {
+            if (arg & cfg->pins & (1u << pin))
+                m->pcr[pin] |= PCR_LK;
+        }
+        return ARM_DRIVER_OK;
+    }
+
+    // ARM_GPIO_CONTROL_DEFAULT_CFG: DSE only where the pin has it.
+    uint32_t pcr;
+    const int32_t status = model_encode(arg, &pcr);
+    if (status != ARM_DRIVER_OK)
+        return status;
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        const uint32_t bit = 1u << pin;
+        if (!(cfg->pins & bit) || (m->pcr[pin] & PCR_LK))
+            continue;
+        m->pcr[pin] = (cfg->high_drive & bit) ? pcr : pcr & ~PCR_DSE;
+        m->pddr = (arg & ARM_GPIO_PIN_CFG_OUTPUT) ? m->pddr | bit : m->pddr & ~bit;
+    }
+    return ARM_DRIVER_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Driver against the model
+////////////////////////////////////////////////////////////////////////////////
+
+static void start(void)
+{
+    sim_reset();
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        TEST_EQUAL(gpio_drivers[port]->Initialize(NULL), ARM_DRIVER_OK);
+        TEST_EQUAL(gpio_drivers[port]->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+
+        MODEL_PORT* const m = &model[port];
+        for (uint32_t pin = 0; pin < 32; pin++)
+            m->pcr[pin] = sim_reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin)) & PCR_CONFIG;
+        m->pddr = sim_reg(SIM_BLOCK_GPIO(port), SIM_GPIO_PDDR);
+        m->pdor = sim_reg(SIM_BLOCK_GPIO(port), SIM_GPIO_PDOR);
+    }
+}
+
+static void stop(void)
+{
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        gpio_drivers[port]->PowerControl(ARM_POWER_OFF);
+        gpio_drivers[port]->Uninitialize();
+    }
+}
+
+// Registers of the port differing from the model, reported; 0 if none.
+static uint32_t compare(uint32_t port, const char* call)
+{
+    const MODEL_PORT* const m = &model[port];
+    uint32_t differ = 0;
+
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        const uint32_t pcr = sim_reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin)) & PCR_CONFIG;
+        if (pcr != m->pcr[pin])
+        {
+            fprintf(stderr, "%s: PCR%u = 0x%08X, model 0x%08X\n", call, pin, pcr, m->pcr[pin]);
+            differ++;
+        }
+    }
+    const uint32_t pddr = sim_reg(SIM_BLOCK_GPIO(port), SIM_GPIO_PDDR);
+    const uint32_t pdor = sim_reg(SIM_BLOCK_GPIO(port), SIM_GPIO_PDOR);
+    if (pddr != m->pddr)
+        fprintf(stderr, "%s: PDDR = 0x%08X, model 0x%08X\n", call, pddr, m->pddr), differ++;
+    if (pdor != m->pdor)
+        fprintf(stderr, "%s: PDOR = 0x%08X, model 0x%08X\n", call, pdor, m->pdor), differ++;
+#if ARM_GPIO_SHADOW_REGS
+    if (ARM_GPIO_VerifyShadow(port))
+        fprintf(stderr, "%s: shadow differs from hardware\n", call), differ++;
+#endif
+    return differ;
+}
+
+// Argument of a pin command: mostly valid values, sometimes any.
+static uint32_t random_arg(uint32_t control, uint32_t* seed)
+{
+    const uint32_t r = test_random(seed);
+    if ((r & 0xFF) == 0)
+        return test_random(seed);
+    if (control == ARM_GPIO_PIN_CFG || control == ARM_GPIO_CONTROL_DEFAULT_CFG)
+        return (r >> 8) & ((r & 0x100) ? 0xFFFu : 0x7FFu);
+    return (r >> 8) % 5;
+}
+
+// One random call on the driver and the model; 0 if they diverged.
+static uint32_t step(uint32_t* seed)
+{
+    const uint32_t r      = test_random(seed);
+    const uint32_t port   = (r >> 4) % ARM_GPIO_PORT_COUNT;
+    const ARM_GPIO_CONFIG* const cfg = gpio_ports[port];
+    ARM_DRIVER_GPIO* const driver = gpio_drivers[port];
+    MODEL_PORT* const m   = &model[port];
+    const uint32_t value  = test_random(seed);
+    const uint32_t pin    = value & 31;
+    const uint32_t bit    = 1u << pin;
+
+    char call[96];
+    int32_t status = ARM_DRIVER_OK, expected = ARM_DRIVER_OK;
+
+    switch (r & 15)
+    {
+        case 0: case 1: case 2: case 3: case 4: case 5: case 6:
+        {
+            // Pins of the package, sometimes any number; commands 0..9.
+            uint32_t p = pin;
+            if (!(value & 0x300))
+                p = (value >> 10) % 34;
+            else
+                while (!(cfg->pins & (1u << p)))
+                    p = (p + 1) & 31;
+            const uint32_t control = (value >> 16) % 10;
+            const uint32_t arg = random_arg(control, seed);
+            snprintf(call, sizeof(call), "port %u ControlPin(%u, %u, 0x%X)", port, p, control, arg);
+            status   = driver->ControlPin(p, control, arg);
+            expected = model_control_pin(port, p, control, arg);
+            break;
+        }
+        case 7:
+            if ((value >> 8) & 15)
+            {
+                const uint32_t arg = random_arg(ARM_GPIO_CONTROL_DEFAULT_CFG, seed);
+                snprintf(call, sizeof(call), "port %u Control(DEFAULT_CFG, 0x%X)", port, arg);
+                status   = driver->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, arg);
+                expected = model_control(port, ARM_GPIO_CONTROL_DEFAULT_CFG, arg);
+            }
+            else
+            {
+                snprintf(call, sizeof(call), "port %u Control(LOCK, 0x%X)", port, bit);
+                status   = driver->Control(ARM_GPIO_CONTROL_LOCK, bit);
+                expected = model_control(port, ARM_GPIO_CONTROL_LOCK, bit);
+            }
+            break;
+        case 8:
+            snprintf(call, sizeof(call), "port %u SetPort(0x%X)", port, value);
+            driver->SetPort(value);
+            m->pdor |= value;
+            break;
+        case 9:
+            snprintf(call, sizeof(call), "port %u ClearPort(0x%X)", port, value);
+            driver->ClearPort(value);
+            m->pdor &= ~value;
+            break;
+        case 10:
+            snprintf(call, sizeof(call), "port %u TogglePort(0x%X)", port, value);
+            driver->TogglePort(value);
+            m->pdor ^= value;
+            break;
+        case 11:
+            snprintf(call, sizeof(call), "port %u WritePort(0x%X)", port, value);
+            driver->WritePort(value);
+            m->pdor = value;
+            break;
+        case 12:
+            snprintf(call, sizeof(call), "port %u SetPin(%u)", port, pin);
+            driver->SetPin(pin);
+            m->pdor |= bit;
+            break;
+        case 13:
+            snprintf(call, sizeof(call), "port %u ClearPin(%u)", port, pin);
+            driver->ClearPin(pin);
+            m->pdor &= ~bit;
+            break;
+        case 14:
+            snprintf(call, sizeof(call), "port %u TogglePin(%u)", port, pin);
+            driver->TogglePin(pin);
+            m->pdor ^= bit;
+            break;
+        default:
+            snprintf(call, sizeof(call), "port %u WritePin(%u, %u)", port, pin, (value >> 5) & 1);
+            driver->WritePin(pin, (value >> 5) & 1);
+            m->pdor = (value & 0x20) ? m->pdor | bit : m->pdor & ~bit;
+            break;
+    }
+
+    uint32_t differ = compare(port, call);
+    if (status != expected)
+    {
+        fprintf(stderr, "%s: returned %d, model %d\n", call, status, expected);
+        differ++;
+    }
+    return differ == 0;
+}
+
+static void test_fuzz(uint32_t operations, uint32_t seed)
+{
+    const clock_t begin = clock();
+    uint32_t done = 0;
+
+    while (done < operations)
+    {
+        start();
+        uint32_t n = 0;
+        while (n < RUN_LENGTH && done < operations && step(&seed))
+            n++, done++;
+        stop();
+
+        if (n < RUN_LENGTH && done < operations)
+        {
+            fprintf(stderr, "diverged after %u operations\n", done);
+            test_failures++;
+            break;
+        }
+    }
+
+    const double seconds = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    printf("%u operations, %.0f per second\n", done, seconds > 0 ? done / seconds : 0.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Cases found by the harness, kept as plain tests
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t pcr(uint32_t pin)
+{
+    return sim_reg(SIM_BLOCK_PORT(ARM_GPIO_PORT_C), SIM_PORT_PCR(pin));
+}
+
+// Bits of ARM_GPIO_PIN_CFG above the drive strength are refused, the pin is left alone.
+static void test_unknown_bits(void)
+{
+    ARM_DRIVER_GPIO* const driver = gpio_drivers[ARM_GPIO_PORT_C];
+    start();
+
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED), ARM_DRIVER_OK);
+    const uint32_t before = pcr(5);
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_OUTPUT | (1u << 11)), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, 0x80000000u), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, 1u << 11), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(pcr(5), before);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_C), SIM_GPIO_PDDR) & (1u << 5), 0);
+
+    // IRQ codes 6, 7 and unknown commands.
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, 6u << ARM_GPIO_PIN_CFG_IRQ_Pos), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_IRQ, 7), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(driver->ControlPin(5, 0, 0), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(driver->ControlPin(5, 9, 0), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(pcr(5), before);
+
+    stop();
+}
+
+// Pull none clears PS too: the same PCR as a pin never pulled.
+static void test_pull_none(void)
+{
+#if ARM_GPIO_DEVICE_PULL
+    ARM_DRIVER_GPIO* const driver = gpio_drivers[ARM_GPIO_PORT_C];
+    start();
+
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED), ARM_DRIVER_OK);
+    const uint32_t plain = pcr(5);
+
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_UP), ARM_DRIVER_OK);
+    TEST_EQUAL(pcr(5) & (PCR_PE | PCR_PS), PCR_PE | PCR_PS);
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_NONE), ARM_DRIVER_OK);
+    TEST_EQUAL(pcr(5), plain);
+
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_PULL_UP), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_PULL_NONE), ARM_DRIVER_OK);
+    TEST_EQUAL(pcr(5), plain);
+
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_UP), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_DOWN), ARM_DRIVER_OK);
+    TEST_EQUAL(pcr(5) & (PCR_PE | PCR_PS), PCR_PE);
+
+    stop();
+#endif
+}
+
+// A feature missing on the part: its command and a nonzero field of
+// ARM_GPIO_PIN_CFG are unsupported, a zero field is accepted.
+static void test_missing_features(void)
+{
+    ARM_DRIVER_GPIO* const driver = gpio_drivers[ARM_GPIO_PORT_C];
+    start();
+
+    static const struct
+    {
+        uint32_t present;
+        uint32_t control;
+        uint32_t field;
+    } features[] =
+    {
+        { ARM_GPIO_DEVICE_PULL,           ARM_GPIO_PIN_PULL,           ARM_GPIO_PIN_CFG_PULL_UP },
+        { ARM_GPIO_DEVICE_SLEW_RATE,      ARM_GPIO_PIN_SPEED,          ARM_GPIO_PIN_CFG_SPEED_LOW },
+        { ARM_GPIO_DEVICE_OPEN_DRAIN,     ARM_GPIO_PIN_OPEN_DRAIN,     ARM_GPIO_PIN_CFG_OPEN_DRAIN },
+        { ARM_GPIO_DEVICE_DRIVE_STRENGTH, ARM_GPIO_PIN_DRIVE_STRENGTH, ARM_GPIO_PIN_CFG_DRIVE_STRENGTH },
+    };
+
+    for (uint32_t n = 0; n < sizeof(features) / sizeof(features[0]); n++)
+    {
+        const int32_t expected = features[n].present ? ARM_DRIVER_OK : ARM_DRIVER_ERROR_UNSUPPORTED;
+        TEST_EQUAL(driver->ControlPin(5, features[n].control, 0), expected);
+        TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | features[n].field), expected);
+        TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, features[n].field), expected);
+    }
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT), ARM_DRIVER_OK);
+
+    stop();
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t operations = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 200000;
+    const uint32_t seed       = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 0x2545F491u;
+
+    test_unknown_bits();
+    test_pull_none();
+    test_missing_features();
+    test_fuzz(operations, seed ? seed : 1);
+    return TEST_RESULT();
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Log-linear histogram: bucket mapping and its inverse, percentiles against
+// exact ones of sorted data, and the port handler histogram of the driver
+// (ARM_GPIO_ISR_HISTOGRAM) taken while events arrive.
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "Driver_GPIO_NXP_K66_Histogram.h"
+#include "test.h"
+
+#include <stdlib.h>
+
+#define RANGE   (1u << ARM_GPIO_HISTOGRAM_RANGE_BITS)
+
+// Every value up to the range: buckets in order without gaps, the value
+// between the limits of its bucket and the one before, width at most 1/8.
+static void test_buckets(void)
+{
+    uint32_t failures = 0;
+    uint32_t previous = 0;
+
+    for (uint32_t value = 0; value < RANGE + 16; value++)
+    {
+        const uint32_t bucket = ARM_GPIO_Histogram_Bucket(value);
+        const uint32_t limit  = ARM_GPIO_Histogram_BucketLimit(bucket);
+        const uint32_t below  = bucket ? ARM_GPIO_Histogram_BucketLimit(bucket - 1) : 0;
+
+        if (bucket < previous || bucket > previous + 1 || bucket >= ARM_GPIO_HISTOGRAM_BUCKETS)
+            failures++;
+        if (value > limit || (bucket && value <= below))
+            failures++;
+        if (value < RANGE && limit - below > (value >> ARM_GPIO_HISTOGRAM_SUB_BITS) + 1)
+            failures++;
+        previous = bucket;
+    }
+    TEST_EQUAL(failures, 0);
+
+    for (uint32_t value = 0; value < 8; value++)
+        TEST_EQUAL(ARM_GPIO_Histogram_Bucket(value), value);
+    TEST_EQUAL(ARM_GPIO_Histogram_Bucket(RANGE - 1), ARM_GPIO_HISTOGRAM_BUCKETS - 2);
+    TEST_EQUAL(ARM_GPIO_Histogram_Bucket(RANGE), ARM_GPIO_HISTOGRAM_BUCKETS - 1);
+    TEST_EQUAL(ARM_GPIO_Histogram_Bucket(UINT32_MAX), ARM_GPIO_HISTOGRAM_BUCKETS - 1);
+    TEST_EQUAL(ARM_GPIO_Histogram_BucketLimit(ARM_GPIO_HISTOGRAM_BUCKETS - 2), RANGE - 1);
+    TEST_EQUAL(ARM_GPIO_Histogram_BucketLimit(ARM_GPIO_HISTOGRAM_BUCKETS - 1), UINT32_MAX);
+}
+
+static int compare(const void* a, const void* b)
+{
+    const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Log-uniform values: a percentile is the exact one rounded up to its bucket
+// limit, never above the largest value.
+static void test_percentiles(void)
+{
+    static uint32_t values[10007];
+    const uint32_t count = sizeof(values) / sizeof(values[0]);
+    static const uint32_t per_mille[] = { 0, 1, 100, 500, 900, 990, 999, 1000 };
+    ARM_GPIO_HISTOGRAM histogram = { 0 };
+    uint32_t seed = 12345;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint32_t bits = test_random(&seed) % 22;
+        values[i] = test_random(&seed) & ((2u << bits) - 1);
+        ARM_GPIO_Histogram_Add(&histogram, values[i]);
+    }
+    qsort(values, count, sizeof(values[0]), compare);
+    TEST_EQUAL(histogram.count, count);
+    TEST_EQUAL(histogram.max, values[count - 1]);
+
+    for (uint32_t i = 0; i < sizeof(per_mille) / sizeof(per_mille[0]); i++)
+    {
+        uint64_t rank = ((uint64_t)count * per_mille[i] + 999) / 1000;
+        const uint32_t exact = values[rank ? rank - 1 : 0];
+        uint32_t expected = ARM_GPIO_Histogram_BucketLimit(ARM_GPIO_Histogram_Bucket(exact));
+        if (expected > histogram.max)
+            expected = histogram.max;
+        TEST_EQUAL(ARM_GPIO_Histogram_Percentile(&histogram, per_mille[i]), expected);
+    }
+    TEST_EQUAL(ARM_GPIO_Histogram_Percentile(&histogram, 1000), histogram.max);
+    TEST_EQUAL(ARM_GPIO_Histogram_Percentile(&histogram, 5000), histogram.max);
+
+    const ARM_GPIO_HISTOGRAM empty = { 0 };
+    TEST_EQUAL(ARM_GPIO_Histogram_Percentile(&empty, 500), 0);
+
+    // One value: every percentile is that value.
+    ARM_GPIO_HISTOGRAM one = { 0 };
+    ARM_GPIO_Histogram_Add(&one, 1000);
+    TEST_EQUAL(ARM_GPIO_Histogram_Percentile(&one, 0), 1000);
+    TEST_EQUAL(ARM_GPIO_Histogram_Percentile(&one, 999), 1000);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define driver  gpio_drivers[ARM_GPIO_PORT_D]
+
+static uint32_t callback_cycles;
+
+static void signal_event(uint32_t event)
+{
+    sim_advance(callback_cycles);
+}
+
+static void edges(uint32_t count, uint32_t cycles)
+{
+    callback_cycles = cycles;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sim_pin_input(ARM_GPIO_PORT_D, 4, !sim_pin_level(ARM_GPIO_PORT_D, 4));
+        sim_advance(10 * cycles + 1000);
+    }
+}
+
+// Handler duration: entry to return of the callback. Taking the histogram
+// starts a new one; no event counted twice or lost across takes.
+static void test_isr_histogram(void)
+{
+    ARM_GPIO_HISTOGRAM histogram;
+
+    sim_reset();
+    TEST_EQUAL(driver->Initialize(signal_event), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(4, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_BOTH), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_IRQ, 1), ARM_DRIVER_OK);
+    TEST_EQUAL(ARM_GPIO_GetIsrHistogram(ARM_GPIO_PORT_COUNT, &histogram), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_GetIsrHistogram(ARM_GPIO_PORT_D, &histogram), ARM_DRIVER_OK);
+    TEST_EQUAL(histogram.count, 0);
+
+    edges(90, 200);
+    edges(10, 5000);
+    TEST_EQUAL(ARM_GPIO_GetIsrHistogram(ARM_GPIO_PORT_D, &histogram), ARM_DRIVER_OK);
+    TEST_EQUAL(histogram.count, 100);
+    const uint32_t p50 = ARM_GPIO_Histogram_Percentile(&histogram, 500);
+    const uint32_t p99 = ARM_GPIO_Histogram_Percentile(&histogram, 990);
+    TEST_CHECK(p50 >= 200 && p50 < 200 + 200 / 8 + 100);
+    TEST_CHECK(p99 >= 5000 && p99 <= histogram.max);
+    TEST_CHECK(histogram.max >= 5000 && histogram.max < 5100);
+
+    TEST_EQUAL(ARM_GPIO_GetIsrHistogram(ARM_GPIO_PORT_D, &histogram), ARM_DRIVER_OK);
+    TEST_EQUAL(histogram.count, 0);
+
+    // Takes between bursts: the counts add up.
+    uint32_t total = 0;
+    for (uint32_t i = 1; i <= 10; i++)
+    {
+        edges(i, 100 * i);
+        TEST_EQUAL(ARM_GPIO_GetIsrHistogram(ARM_GPIO_PORT_D, &histogram), ARM_DRIVER_OK);
+        TEST_EQUAL(histogram.count, i);
+        TEST_CHECK(histogram.max >= 100 * i);
+        total += histogram.count;
+    }
+    TEST_EQUAL(total, 55);
+
+    TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+}
+
+int main(void)
+{
+    test_buckets();
+    test_percentiles();
+    test_isr_histogram();
+    return TEST_RESULT();
+}
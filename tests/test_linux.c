@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Linux character-device backend against a fake gpiochip: open() of
+// /dev/gpiochip* and ioctl() are wrapped (-Wl,--wrap), a line request is a
+// pipe, whose write end the test uses to queue edge events. Port operations,
+// re-requests and their rollback, event batching, calls from the event
+// thread, and the cost of an operation and of an event.
+
+#define _GNU_SOURCE
+#include "Driver_GPIO_Linux.h"
+#include "test.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/gpio.h>
+
+extern ARM_DRIVER_GPIO Driver_GPIO0;
+#define driver  (&Driver_GPIO0)
+
+////////////////////////////////////////////////////////////////////////////////
+//   Fake gpiochip
+////////////////////////////////////////////////////////////////////////////////
+
+int __real_open(const char* path, int flags, ...);
+int __real_ioctl(int fd, unsigned long request, ...);
+
+static int      chip_fd = -1;
+static int      line_fd = -1;           // read end of the request's pipe
+static int      event_fd = -1;          // write end
+static uint32_t line_pins;              // pins of the request
+static uint32_t levels;                 // line levels: outputs driven, inputs from the test
+static uint32_t outputs;
+
+static uint32_t requests;               // GPIO_V2_GET_LINE_IOCTL
+static uint32_t set_configs;
+static uint32_t set_values;
+static uint32_t get_values;
+static int      fail_requests;          // fail the next n requests with EBUSY
+
+static struct gpio_v2_line_config line_config;
+
+static uint32_t unpack(uint64_t bits)
+{
+    uint32_t value = 0;
+    for (uint32_t lines = line_pins; lines; lines &= lines - 1, bits >>= 1)
+    {
+        if (bits & 1)
+            value |= lines & -lines;
+    }
+    return value;
+}
+
+static uint64_t pack(uint32_t value)
+{
+    uint64_t bits = 0, bit = 1;
+    for (uint32_t lines = line_pins; lines; lines &= lines - 1, bit <<= 1)
+    {
+        if (value & lines & -lines)
+            bits |= bit;
+    }
+    return bits;
+}
+
+// Output pins and initial levels of a line config.
+static void fake_config(const struct gpio_v2_line_config* config)
+{
+    line_config = *config;
+    outputs = (config->flags & GPIO_V2_LINE_FLAG_OUTPUT) ? line_pins : 0;
+    for (uint32_t i = 0; i < config->num_attrs; i++)
+    {
+        const struct gpio_v2_line_config_attribute* attr = &config->attrs[i];
+        const uint32_t pins = unpack(attr->mask);
+        if (attr->attr.id == GPIO_V2_LINE_ATTR_ID_FLAGS)
+            outputs = (attr->attr.flags & GPIO_V2_LINE_FLAG_OUTPUT) ? (outputs | pins) : (outputs & ~pins);
+        else if (attr->attr.id == GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES)
+            levels = (levels & ~pins) | unpack(attr->attr.values);
+    }
+}
+
+int __wrap_open(const char* path, int flags, ...)
+{
+    if (!strncmp(path, "/dev/gpiochip", 13))
+        return chip_fd = __real_open("/dev/null", O_RDWR | O_CLOEXEC);
+
+    va_list args;
+    va_start(args, flags);
+    const int mode = va_arg(args, int);
+    va_end(args);
+    return __real_open(path, flags, mode);
+}
+
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+    va_list args;
+    va_start(args, request);
+    void* const arg = va_arg(args, void*);
+    va_end(args);
+
+    if (fd == chip_fd && request == GPIO_V2_GET_LINE_IOCTL)
+    {
+        struct gpio_v2_line_request* r = arg;
+        requests++;
+        if (fail_requests)
+        {
+            fail_requests--;
+            errno = EBUSY;
+            return -1;
+        }
+
+        int pipe_fds[2];
+        if (pipe2(pipe_fds, O_CLOEXEC) < 0)
+            return -1;
+        if (event_fd >= 0)
+            close(event_fd);
+        line_fd  = r->fd = pipe_fds[0];
+        event_fd = pipe_fds[1];
+        line_pins = 0;
+        for (uint32_t i = 0; i < r->num_lines; i++)
+            line_pins |= 1u << r->offsets[i];
+        fake_config(&r->config);
+        return 0;
+    }
+    if (fd == line_fd && fd >= 0)
+    {
+        struct gpio_v2_line_values* v = arg;
+        switch (request)
+        {
+            case GPIO_V2_LINE_SET_CONFIG_IOCTL:
+                set_configs++;
+                fake_config(arg);
+                return 0;
+            case GPIO_V2_LINE_SET_VALUES_IOCTL:
+            {
+                set_values++;
+                const uint32_t mask = unpack(v->mask) & outputs;
+                levels = (levels & ~mask) | (unpack(v->bits) & mask);
+                return 0;
+            }
+            case GPIO_V2_LINE_GET_VALUES_IOCTL:
+                get_values++;
+                v->bits = pack(levels) & v->mask;
+                return 0;
+        }
+    }
+    return __real_ioctl(fd, request, arg);
+}
+
+static void queue_events(const uint32_t* pins, uint32_t count)
+{
+    struct gpio_v2_line_event events[64];
+    memset(events, 0, sizeof(events));
+    for (uint32_t i = 0; i < count; i++)
+        events[i].offset = pins[i];
+    TEST_EQUAL(write(event_fd, events, count * sizeof(events[0])), count * sizeof(events[0]));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Callback
+////////////////////////////////////////////////////////////////////////////////
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  signalled = PTHREAD_COND_INITIALIZER;
+static uint32_t        calls;
+static uint32_t        events;
+static struct timespec call_time;
+
+// From the callback: results of driver calls on the event thread.
+static int             callback_calls;
+static int32_t         irq_off_status, request_status, config_status;
+
+static void signal_event(uint32_t event)
+{
+    if (callback_calls)
+    {
+        irq_off_status = driver->Control(ARM_GPIO_CONTROL_IRQ, 0);
+        request_status = driver->ControlPin(12, ARM_GPIO_PIN_STATE, ARM_GPIO_PIN_STATE_ENABLE);
+        config_status  = driver->ControlPin(7, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_DOWN);
+    }
+
+    pthread_mutex_lock(&lock);
+    clock_gettime(CLOCK_MONOTONIC, &call_time);
+    calls++;
+    events |= event;
+    pthread_cond_signal(&signalled);
+    pthread_mutex_unlock(&lock);
+}
+
+// Waits for the callbacks; 0 if they don't come within 2 s.
+static int wait_calls(uint32_t count)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += 2;
+
+    pthread_mutex_lock(&lock);
+    int result = 1;
+    while (calls < count && result)
+        result = pthread_cond_timedwait(&signalled, &lock, &deadline) == 0;
+    pthread_mutex_unlock(&lock);
+    return calls >= count;
+}
+
+static void reset_calls(void)
+{
+    pthread_mutex_lock(&lock);
+    calls = events = 0;
+    pthread_mutex_unlock(&lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Pins 3, 5 outputs, 7 input with both edges.
+static void start(void)
+{
+    TEST_EQUAL(driver->Initialize(signal_event), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(3, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(5, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(7, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_BOTH), ARM_DRIVER_OK);
+    TEST_EQUAL(line_pins, (1u << 3) | (1u << 5) | (1u << 7));
+    TEST_EQUAL(outputs, (1u << 3) | (1u << 5));
+}
+
+// Pin configuration and output levels outlive Uninitialize: cleared.
+static void stop(void)
+{
+    driver->WritePort(0);
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+    callback_calls = 0;
+    fail_requests = 0;
+}
+
+// One ioctl per operation, outputs only; inputs read back.
+static void test_port_access(void)
+{
+    start();
+    set_values = get_values = 0;
+
+    driver->SetPort((1u << 3) | (1u << 7));
+    TEST_EQUAL(levels & outputs, 1u << 3);
+    driver->TogglePort((1u << 3) | (1u << 5));
+    TEST_EQUAL(levels & outputs, 1u << 5);
+    driver->WritePort(1u << 3);
+    TEST_EQUAL(levels & outputs, 1u << 3);
+    driver->ClearPin(3);
+    driver->WritePin(5, 1);
+    TEST_EQUAL(levels & outputs, 1u << 5);
+    driver->TogglePin(5);
+    TEST_EQUAL(levels & outputs, 0);
+    TEST_EQUAL(set_values, 6);
+
+    // Pins without output: no ioctl.
+    driver->SetPort(1u << 7);
+    driver->SetPort(1u << 20);
+    TEST_EQUAL(set_values, 6);
+
+    levels |= 1u << 7;
+    driver->SetPin(3);
+    TEST_EQUAL(driver->ReadPort(), (1u << 3) | (1u << 7));
+    TEST_EQUAL(driver->ReadPin(7), 1);
+    TEST_EQUAL(driver->ReadPin(5), 0);
+    TEST_EQUAL(get_values, 3);
+    stop();
+}
+
+// Configuration of enabled pins in place; enabling a pin requests the lines
+// again with the output levels kept; a failed request takes the old lines back.
+static void test_request(void)
+{
+    start();
+    driver->SetPin(5);
+    requests = set_configs = 0;
+
+    TEST_EQUAL(driver->ControlPin(7, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_UP), ARM_DRIVER_OK);
+    TEST_EQUAL(requests, 0);
+    TEST_EQUAL(set_configs, 1);
+    TEST_CHECK(line_config.num_attrs >= 2);
+
+    levels = 0;
+    TEST_EQUAL(driver->ControlPin(9, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT), ARM_DRIVER_OK);
+    TEST_EQUAL(requests, 1);
+    TEST_EQUAL(line_pins, (1u << 3) | (1u << 5) | (1u << 7) | (1u << 9));
+    TEST_EQUAL(levels & outputs, 1u << 5);
+
+    // Rollback: the request of pin 10 fails, pins 3, 5, 7, 9 are taken back.
+    fail_requests = 1;
+    TEST_EQUAL(driver->ControlPin(10, ARM_GPIO_PIN_STATE, ARM_GPIO_PIN_STATE_ENABLE), ARM_DRIVER_ERROR_BUSY);
+    TEST_EQUAL(requests, 3);
+    TEST_EQUAL(line_pins, (1u << 3) | (1u << 5) | (1u << 7) | (1u << 9));
+    set_values = 0;
+    driver->SetPin(9);
+    TEST_EQUAL(set_values, 1);
+
+    // Rollback fails too: no lines, operations do nothing until the next request.
+    fail_requests = 2;
+    TEST_EQUAL(driver->ControlPin(10, ARM_GPIO_PIN_STATE, ARM_GPIO_PIN_STATE_ENABLE), ARM_DRIVER_ERROR);
+    TEST_EQUAL(requests, 5);
+    set_values = get_values = 0;
+    driver->SetPin(9);
+    TEST_EQUAL(driver->ReadPort(), 0);
+    TEST_EQUAL(set_values + get_values, 0);
+
+    TEST_EQUAL(driver->ControlPin(10, ARM_GPIO_PIN_STATE, ARM_GPIO_PIN_STATE_ENABLE), ARM_DRIVER_OK);
+    TEST_EQUAL(requests, 6);
+    TEST_EQUAL(line_pins, (1u << 3) | (1u << 5) | (1u << 7) | (1u << 9) | (1u << 10));
+    stop();
+}
+
+// One callback per read: events of one batch are one call.
+static void test_events(void)
+{
+    static const uint32_t three[] = { 7, 7, 9 };
+    uint32_t many[ARM_GPIO_LINUX_EVENT_BATCH + 4];
+
+    start();
+    reset_calls();
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_IRQ, 1), ARM_DRIVER_OK);
+    queue_events(three, 3);
+    TEST_CHECK(wait_calls(1));
+    usleep(10000);
+    TEST_EQUAL(calls, 1);
+    TEST_EQUAL(events, (1u << 7) | (1u << 9));
+
+    for (uint32_t i = 0; i < ARM_GPIO_LINUX_EVENT_BATCH + 4; i++)
+        many[i] = (i < ARM_GPIO_LINUX_EVENT_BATCH) ? 7 : 11;
+    reset_calls();
+    queue_events(many, ARM_GPIO_LINUX_EVENT_BATCH + 4);
+    TEST_CHECK(wait_calls(2));
+    usleep(10000);
+    TEST_EQUAL(calls, 2);
+    TEST_EQUAL(events, (1u << 7) | (1u << 11));
+
+    // Interrupt disabled: events stay queued for GetPortEvents.
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_IRQ, 0), ARM_DRIVER_OK);
+    reset_calls();
+    queue_events(three, 3);
+    TEST_EQUAL(driver->GetPortEvents(), (1u << 7) | (1u << 9));
+    driver->ClearPortEvents(1u << 7);
+    TEST_EQUAL(driver->GetPortEvents(), 1u << 9);
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_CLEAR_EVENTS, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->GetPortEvents(), 0);
+    TEST_EQUAL(calls, 0);
+
+    // Enabled while no pin is: the thread starts with the first request.
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_IRQ, 1), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(7, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_BOTH), ARM_DRIVER_OK);
+    queue_events(three, 1);
+    TEST_CHECK(wait_calls(1));
+    stop();
+}
+
+// On the event thread: the thread can't stop itself, nor request lines
+// again; configuration in place works.
+static void test_callback_thread(void)
+{
+    static const uint32_t pin7 = 7;
+
+    start();
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_IRQ, 1), ARM_DRIVER_OK);
+    reset_calls();
+    set_configs = 0;
+    callback_calls = 1;
+    queue_events(&pin7, 1);
+    TEST_CHECK(wait_calls(1));
+    TEST_EQUAL(irq_off_status, ARM_DRIVER_ERROR_BUSY);
+    TEST_EQUAL(request_status, ARM_DRIVER_ERROR_BUSY);
+    TEST_EQUAL(config_status, ARM_DRIVER_OK);
+    TEST_EQUAL(set_configs, 1);
+    TEST_CHECK(!(line_pins & (1u << 12)));
+    stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static double elapsed_ns(const struct timespec* start, const struct timespec* end)
+{
+    return 1e9 * (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+// Driver overhead of an operation (the fake ioctl is a few loads), and the
+// latency of the event thread: pipe write to callback.
+static void benchmark(void)
+{
+    const uint32_t count = 1000000;
+    struct timespec start_time, end_time;
+    static const uint32_t pin7 = 7;
+
+    start();
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    for (uint32_t i = 0; i < count; i++)
+        driver->TogglePin(3);
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    printf("TogglePin: %.1f ns (fake ioctl)\n", elapsed_ns(&start_time, &end_time) / count);
+
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_IRQ, 1), ARM_DRIVER_OK);
+    double total = 0, worst = 0;
+    const uint32_t samples = 200;
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        reset_calls();
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        queue_events(&pin7, 1);
+        TEST_CHECK(wait_calls(1));
+        const double ns = elapsed_ns(&start_time, &call_time);
+        total += ns;
+        if (ns > worst)
+            worst = ns;
+    }
+    printf("event to callback: %.1f us average, %.1f us max\n", total / samples / 1000, worst / 1000);
+    stop();
+}
+
+int main(void)
+{
+    test_port_access();
+    test_request();
+    test_events();
+    test_callback_thread();
+    benchmark();
+    return TEST_RESULT();
+}
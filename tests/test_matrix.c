@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Key matrix scanner on a simulated matrix: a pressed key pulls its row low
+// while its column is driven low. Debounce against a reference counter per
+// key, the store sequence of a scan, idle and wake-up by a row edge.
+// Then the cost of a scan of an 8x8 matrix against driving each column and
+// reading each row through the driver's function pointers.
+
+#include "Driver_GPIO_NXP_K66_Matrix.h"
+#include "test.h"
+
+#include <time.h>
+
+#define ROWS        4
+#define COLUMNS     5
+
+// Columns: PTC0..3 (one PTOR store between them), PTD5; rows PTB0..3.
+static const ARM_GPIO_BUS_PIN rows[ROWS] = {
+    { ARM_GPIO_PORT_B, 0 }, { ARM_GPIO_PORT_B, 1 }, { ARM_GPIO_PORT_B, 2 }, { ARM_GPIO_PORT_B, 3 }
+};
+static const ARM_GPIO_BUS_PIN columns[COLUMNS] = {
+    { ARM_GPIO_PORT_C, 0 }, { ARM_GPIO_PORT_C, 1 }, { ARM_GPIO_PORT_C, 2 }, { ARM_GPIO_PORT_C, 3 },
+    { ARM_GPIO_PORT_D, 5 }
+};
+
+static ARM_GPIO_MATRIX matrix;
+static uint64_t        pressed;         // keys held down, ARM_GPIO_MATRIX_KEY bits
+static uint32_t        gpio_stores;     // stores to PTx since the last reset of the count
+static uint32_t        woken;
+
+static uint32_t column_low(uint32_t c)
+{
+    const uint32_t block = SIM_BLOCK_GPIO(columns[c].port);
+    const uint32_t bit = 1u << columns[c].pin;
+    return (sim_reg(block, SIM_GPIO_PDDR) & bit) && !(sim_reg(block, SIM_GPIO_PDOR) & bit);
+}
+
+static void matrix_update(void)
+{
+    for (uint32_t r = 0; r < ROWS; r++)
+    {
+        uint32_t low = 0;
+        for (uint32_t c = 0; c < COLUMNS; c++)
+            low |= (pressed & ARM_GPIO_MATRIX_KEY(c, r)) && column_low(c);
+        if (low)
+            sim_pin_input(rows[r].port, rows[r].pin, 0);
+        else
+            sim_pin_release(rows[r].port, rows[r].pin);
+    }
+}
+
+static void on_write(uint32_t block, uint32_t offset, uint32_t value)
+{
+    if (block >= SIM_BLOCK_GPIO(0) && block < SIM_BLOCK_GPIO(SIM_PORT_COUNT))
+    {
+        gpio_stores++;
+        matrix_update();
+    }
+}
+
+static void press(uint64_t keys)
+{
+    pressed = keys;
+    matrix_update();
+}
+
+static void row_event(uint32_t event)
+{
+    woken |= event;
+    ARM_GPIO_Matrix_Wake(&matrix);
+}
+
+static void setup(void)
+{
+    const uint32_t row_cfg    = ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_PULL_UP;
+    const uint32_t column_cfg = ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT | ARM_GPIO_PIN_CFG_OPEN_DRAIN;
+
+    sim_reset();
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_B]->Initialize(row_event), ARM_DRIVER_OK);
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_C]->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_D]->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_B]->Control(ARM_GPIO_CONTROL_IRQ, 1), ARM_DRIVER_OK);
+    for (uint32_t r = 0; r < ROWS; r++)
+        TEST_EQUAL(gpio_drivers[rows[r].port]->ControlPin(rows[r].pin, ARM_GPIO_PIN_CFG, row_cfg), ARM_DRIVER_OK);
+    for (uint32_t c = 0; c < COLUMNS; c++)
+        TEST_EQUAL(gpio_drivers[columns[c].port]->ControlPin(columns[c].pin, ARM_GPIO_PIN_CFG, column_cfg), ARM_DRIVER_OK);
+
+    pressed = 0;
+    sim_on_write(NULL, on_write);
+    TEST_EQUAL(ARM_GPIO_Matrix_Initialize(&matrix, rows, ROWS, columns, COLUMNS, 2), ARM_DRIVER_OK);
+}
+
+static void teardown(void)
+{
+    sim_on_write(NULL, NULL);
+    for (uint32_t port = ARM_GPIO_PORT_B; port <= ARM_GPIO_PORT_D; port++)
+        TEST_EQUAL(gpio_drivers[port]->Uninitialize(), ARM_DRIVER_OK);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void test_parameters(void)
+{
+    ARM_GPIO_MATRIX m;
+    const ARM_GPIO_BUS_PIN bad = { ARM_GPIO_PORT_COUNT, 0 };
+
+    TEST_EQUAL(ARM_GPIO_Matrix_Initialize(&m, rows, 0, columns, COLUMNS, 0), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_Matrix_Initialize(&m, rows, ROWS, columns, 9, 0), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(ARM_GPIO_Matrix_Initialize(&m, rows, ROWS, &bad, 1, 0), ARM_DRIVER_ERROR_PARAMETER);
+}
+
+// A key changes after 4 equal scans; bounces shorter than that are filtered.
+static void test_debounce(void)
+{
+    const uint64_t key = ARM_GPIO_MATRIX_KEY(4, 2);
+
+    setup();
+    press(key);
+    for (uint32_t i = 0; i < 3; i++)
+        TEST_EQUAL(ARM_GPIO_Matrix_Scan(&matrix), 0);
+    TEST_EQUAL(ARM_GPIO_Matrix_Scan(&matrix), key);
+    TEST_EQUAL(matrix.state, key);
+    TEST_EQUAL(ARM_GPIO_Matrix_Scan(&matrix), 0);
+
+    // Release bouncing: 3 open, 1 closed, 3 open, then the 4th.
+    static const uint8_t bounce[] = { 0, 0, 0, 1, 0, 0, 0 };
+    for (uint32_t i = 0; i < sizeof(bounce); i++)
+    {
+        press(bounce[i] ? key : 0);
+        TEST_EQUAL(ARM_GPIO_Matrix_Scan(&matrix), 0);
+    }
+    TEST_EQUAL(ARM_GPIO_Matrix_Scan(&matrix), key);
+    TEST_EQUAL(matrix.state, 0);
+    teardown();
+}
+
+// All keys random: per key the count of scans differing from its state,
+// reset when equal; the state toggles on the 4th.
+static void test_reference(void)
+{
+    uint8_t  count[COLUMNS * 8] = { 0 };
+    uint64_t state = 0;
+    uint32_t seed = 0xC0FFEE, failures = 0, changes = 0;
+
+    setup();
+    for (uint32_t scan = 0; scan < 2000; scan++)
+    {
+        // Keys flip rarely, so that some reach 4 equal scans.
+        uint64_t keys = pressed;
+        for (uint32_t c = 0; c < COLUMNS; c++)
+        {
+            for (uint32_t r = 0; r < ROWS; r++)
+            {
+                if (test_random(&seed) % 5 == 0)
+                    keys ^= ARM_GPIO_MATRIX_KEY(c, r);
+            }
+        }
+        press(keys);
+
+        uint64_t expected = 0;
+        for (uint32_t key = 0; key < COLUMNS * 8; key++)
+        {
+            const uint64_t bit = (uint64_t)1 << key;
+            if (!((keys ^ state) & bit))
+                count[key] = 0;
+            else if (++count[key] == 4)
+            {
+                count[key] = 0;
+                expected |= bit;
+            }
+        }
+        state ^= expected;
+
+        const uint64_t delta = ARM_GPIO_Matrix_Scan(&matrix);
+        failures += (delta != expected) || (matrix.state != state);
+        changes  += (uint32_t)__builtin_popcountll(delta);
+    }
+    TEST_EQUAL(failures, 0);
+    TEST_CHECK(changes > 50);
+    teardown();
+}
+
+// Stores of a scan: drive the first column, then one PTOR per shared pair,
+// PSOR + PCOR to the other port, PSOR of the last.
+static void test_scan_stores(void)
+{
+    setup();
+    gpio_stores = 0;
+    ARM_GPIO_Matrix_Scan(&matrix);
+    TEST_EQUAL(gpio_stores, 1 + 3 + 2 + 1);
+    for (uint32_t c = 0; c < COLUMNS; c++)
+        TEST_CHECK(!column_low(c));
+    teardown();
+}
+
+// Idle: columns low, rows armed; a key wakes the scanner from the callback.
+static void test_idle(void)
+{
+    setup();
+    TEST_EQUAL(ARM_GPIO_Matrix_Idle(&matrix), ARM_DRIVER_OK);
+    for (uint32_t c = 0; c < COLUMNS; c++)
+        TEST_CHECK(column_low(c));
+
+    woken = 0;
+    press(ARM_GPIO_MATRIX_KEY(2, 1));
+    TEST_EQUAL(woken, 1u << 1);
+    TEST_EQUAL(matrix.idle, 0);
+    for (uint32_t c = 0; c < COLUMNS; c++)
+        TEST_CHECK(!column_low(c));
+
+    // Debounced key down: keep scanning.
+    for (uint32_t i = 0; i < 4; i++)
+        ARM_GPIO_Matrix_Scan(&matrix);
+    TEST_EQUAL(ARM_GPIO_Matrix_Idle(&matrix), ARM_DRIVER_ERROR_BUSY);
+
+    // Released, but pressed again before idle: seen without an edge.
+    press(0);
+    for (uint32_t i = 0; i < 4; i++)
+        ARM_GPIO_Matrix_Scan(&matrix);
+    TEST_EQUAL(matrix.state, 0);
+    press(ARM_GPIO_MATRIX_KEY(0, 3));
+    woken = 0;
+    TEST_EQUAL(ARM_GPIO_Matrix_Idle(&matrix), ARM_DRIVER_ERROR_BUSY);
+    TEST_EQUAL(woken, 0);
+    TEST_EQUAL(matrix.idle, 0);
+    teardown();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   8x8 scan: loads and stores in the model (bridge loads charged), host
+//   time on plain register memory. Target cycles: tools/gpio_budget.sh.
+////////////////////////////////////////////////////////////////////////////////
+
+// Columns PTC0..7, rows PTB0..7, no settle delay.
+static const ARM_GPIO_BUS_PIN rows8[8] = {
+    { ARM_GPIO_PORT_B, 0 }, { ARM_GPIO_PORT_B, 1 }, { ARM_GPIO_PORT_B, 2 }, { ARM_GPIO_PORT_B, 3 },
+    { ARM_GPIO_PORT_B, 4 }, { ARM_GPIO_PORT_B, 5 }, { ARM_GPIO_PORT_B, 6 }, { ARM_GPIO_PORT_B, 7 }
+};
+static const ARM_GPIO_BUS_PIN columns8[8] = {
+    { ARM_GPIO_PORT_C, 0 }, { ARM_GPIO_PORT_C, 1 }, { ARM_GPIO_PORT_C, 2 }, { ARM_GPIO_PORT_C, 3 },
+    { ARM_GPIO_PORT_C, 4 }, { ARM_GPIO_PORT_C, 5 }, { ARM_GPIO_PORT_C, 6 }, { ARM_GPIO_PORT_C, 7 }
+};
+
+// 8 column drives and 64 ReadPin; debounce of the same 4 scans per key,
+// a counter each, when debounce is set.
+static uint64_t pins_scan(uint64_t* state, uint8_t* count, uint32_t debounce)
+{
+    ARM_DRIVER_GPIO* const column_gpio = gpio_drivers[ARM_GPIO_PORT_C];
+    ARM_DRIVER_GPIO* const row_gpio    = gpio_drivers[ARM_GPIO_PORT_B];
+    uint64_t keys = 0;
+
+    for (uint32_t c = 0; c < 8; c++)
+    {
+        column_gpio->ClearPin(columns8[c].pin);
+        for (uint32_t r = 0; r < 8; r++)
+            keys |= (uint64_t)!row_gpio->ReadPin(rows8[r].pin) << (c * 8 + r);
+        column_gpio->SetPin(columns8[c].pin);
+    }
+    if (!debounce)
+        return keys;
+
+    uint64_t changed = 0;
+    for (uint32_t key = 0; key < 64; key++)
+    {
+        const uint64_t bit = (uint64_t)1 << key;
+        if (!((keys ^ *state) & bit))
+            count[key] = 0;
+        else if (++count[key] == 4)
+        {
+            count[key] = 0;
+            changed |= bit;
+        }
+    }
+    *state ^= changed;
+    return changed;
+}
+
+static double elapsed_ns(const struct timespec* start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return 1e9 * (double)(end.tv_sec - start->tv_sec) + (double)(end.tv_nsec - start->tv_nsec);
+}
+
+static void benchmark(void)
+{
+    const uint32_t row_cfg    = ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_PULL_UP;
+    const uint32_t column_cfg = ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT | ARM_GPIO_PIN_CFG_OPEN_DRAIN;
+    const uint32_t count = 200000;
+    uint64_t state = 0;
+    uint8_t counters[64] = { 0 };
+    volatile uint64_t sink = 0;
+
+    sim_reset();
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_B]->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_C]->Initialize(NULL), ARM_DRIVER_OK);
+    for (uint32_t n = 0; n < 8; n++)
+    {
+        TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_B]->ControlPin(rows8[n].pin, ARM_GPIO_PIN_CFG, row_cfg), ARM_DRIVER_OK);
+        TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_C]->ControlPin(columns8[n].pin, ARM_GPIO_PIN_CFG, column_cfg), ARM_DRIVER_OK);
+    }
+    ARM_GPIO_MATRIX m;
+    TEST_EQUAL(ARM_GPIO_Matrix_Initialize(&m, rows8, 8, columns8, 8, 0), ARM_DRIVER_OK);
+
+    // One scan of each in the model, no key pressed.
+    pressed = 0;
+    sim_on_write(NULL, on_write);
+    sim_trap_loads(1);
+    uint64_t loads = sim_loads(), time = sim_time();
+    gpio_stores = 0;
+    ARM_GPIO_Matrix_Scan(&m);
+    const uint32_t scan_stores = gpio_stores;
+    const uint64_t scan_loads  = sim_loads() - loads;
+    const uint64_t scan_cycles = sim_time() - time;
+    loads = sim_loads(), time = sim_time();
+    gpio_stores = 0;
+    pins_scan(&state, counters, 1);
+    const uint32_t pin_stores = gpio_stores;
+    const uint64_t pin_loads  = sim_loads() - loads;
+    const uint64_t pin_cycles = sim_time() - time;
+    sim_trap_loads(0);
+    sim_on_write(NULL, NULL);
+    TEST_EQUAL(scan_stores, 1 + 7 + 1);
+    TEST_EQUAL(scan_loads, 8);
+    TEST_EQUAL(pin_stores, 16);
+    TEST_EQUAL(pin_loads, 64);
+
+    sim_set_traced(0);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        sink += ARM_GPIO_Matrix_Scan(&m);
+    const double scan = elapsed_ns(&start) / count;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        sink += pins_scan(&state, counters, 0);
+    const double pins = elapsed_ns(&start) / count;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0; n < count; n++)
+        sink += pins_scan(&state, counters, 1);
+    const double pins_debounced = elapsed_ns(&start) / count;
+    sim_set_traced(1);
+
+    printf("8x8 scan: ARM_GPIO_Matrix_Scan %.1f ns, 8 drives + 64 ReadPin %.1f ns (%.1f ns with debounce)\n",
+           scan, pins, pins_debounced);
+    printf("          model: %u stores + %llu loads = %llu cycles against %u + %llu = %llu cycles\n",
+           scan_stores, (unsigned long long)scan_loads, (unsigned long long)scan_cycles,
+           pin_stores, (unsigned long long)pin_loads, (unsigned long long)pin_cycles);
+
+    for (uint32_t port = ARM_GPIO_PORT_B; port <= ARM_GPIO_PORT_C; port++)
+        gpio_drivers[port]->Uninitialize();
+}
+
+int main(void)
+{
+    test_parameters();
+    test_debounce();
+    test_reference();
+    test_scan_stores();
+    test_idle();
+    benchmark();
+    return TEST_RESULT();
+}
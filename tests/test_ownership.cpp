@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Pin ownership under contention: threads claiming overlapping pins of one
+// port at the same time, and handlers injected into the claim and release
+// of the thread, trying the thread's pins. Claims are all or none, a pin
+// has one owner at a time, and nobody else changes a claimed pin.
+// The thread run measures claim/release throughput by thread count.
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "test.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static const ARM_GPIO_CONFIG* const port = gpio_ports[ARM_GPIO_PORT_A];
+static ARM_DRIVER_GPIO* const driver = gpio_drivers[ARM_GPIO_PORT_A];
+
+static const uint32_t ISR_OWNER = 100;
+
+static thread_local uint32_t thread_owner = 1;
+static std::atomic<uint32_t> faults(0);
+static uint32_t fault_mask;
+
+extern "C" uint32_t test_gpio_owner(void)
+{
+    return sim_in_isr() ? ISR_OWNER : thread_owner;
+}
+
+extern "C" void test_gpio_ownership_fault(uint32_t port, uint32_t mask)
+{
+    TEST_EQUAL(port, ARM_GPIO_PORT_A);
+    fault_mask = mask;
+    faults++;
+}
+
+// First 16 pins of the port on the package, contended for.
+static uint32_t pins[16];
+
+static void find_pins(void)
+{
+    uint32_t count = 0;
+    for (uint32_t pin = 0; pin < 32 && count < 16; pin++)
+    {
+        if (port->pins & (1u << pin))
+            pins[count++] = pin;
+    }
+    TEST_EQUAL(count, 16);
+}
+
+// 1..3 pins of pins[0..count - 1].
+static uint32_t random_mask(uint32_t count, uint32_t* seed)
+{
+    uint32_t mask = 0;
+    for (uint32_t n = 1 + test_random(seed) % 3; n; n--)
+        mask |= 1u << pins[test_random(seed) % count];
+    return mask;
+}
+
+static uint32_t random_pin(uint32_t mask, uint32_t* seed)
+{
+    uint32_t pin;
+    do
+    {
+        pin = test_random(seed) % 32;
+    } while (!(mask & (1u << pin)));
+    return pin;
+}
+
+static uint32_t pddr(void)
+{
+    return sim_reg(SIM_BLOCK_GPIO(0), SIM_GPIO_PDDR);
+}
+
+static uint32_t pdor(void)
+{
+    return sim_reg(SIM_BLOCK_GPIO(0), SIM_GPIO_PDOR);
+}
+
+static uint32_t pcr(uint32_t pin)
+{
+    return sim_reg(SIM_BLOCK_PORT(0), SIM_PORT_PCR(pin));
+}
+
+// Pins of the mask owned by the caller.
+static uint32_t owned_by(uint32_t owner, uint32_t mask)
+{
+    uint32_t owned = 0;
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        if ((mask & port->state->owned & (1u << pin)) && port->state->owner[pin] == owner)
+            owned |= 1u << pin;
+    }
+    return owned;
+}
+
+static void start(void)
+{
+    sim_reset();
+    faults = 0;
+    TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+}
+
+static void stop(void)
+{
+    TEST_EQUAL(port->state->owned, 0);
+    driver->PowerControl(ARM_POWER_OFF);
+    driver->Uninitialize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Owners on threads
+////////////////////////////////////////////////////////////////////////////////
+
+// Test's record of the pin holders, taken after a claim succeeded and given
+// back before the release: two holders at a time is a double claim.
+static std::atomic<uint32_t> holder[32];
+
+static uint64_t contend(uint32_t owner, uint32_t ops, uint32_t count)
+{
+    uint32_t seed = 0x9E3779B9u * owner;
+    uint64_t busy = 0;
+    thread_owner = owner;
+    for (uint32_t op = 0; op < ops; op++)
+    {
+        const uint32_t mask = random_mask(count, &seed);
+        const int32_t status = ARM_GPIO_Claim(ARM_GPIO_PORT_A, mask);
+        if (status != ARM_DRIVER_OK)
+        {
+            // None of the pins taken; not the owner, so no release either.
+            TEST_EQUAL(status, ARM_DRIVER_ERROR_BUSY);
+            TEST_EQUAL(owned_by(owner, mask), 0);
+            TEST_EQUAL(ARM_GPIO_Release(ARM_GPIO_PORT_A, mask), ARM_DRIVER_ERROR);
+            busy++;
+            continue;
+        }
+        
+        for (uint32_t left = mask; left; left &= left - 1)
+            TEST_EQUAL(holder[__builtin_ctz(left)].exchange(owner), 0);
+        
+        TEST_EQUAL(owned_by(owner, mask), mask);
+        const uint32_t out = test_random(&seed) & 1;
+        const uint32_t pin = random_pin(mask, &seed);
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_DIRECTION, out), ARM_DRIVER_OK);
+        TEST_EQUAL((pddr() >> pin) & 1, out);
+        
+        for (uint32_t left = mask; left; left &= left - 1)
+            TEST_EQUAL(holder[__builtin_ctz(left)].exchange(0), owner);
+        TEST_EQUAL(ARM_GPIO_Release(ARM_GPIO_PORT_A, mask), ARM_DRIVER_OK);
+    }
+    return busy;
+}
+
+static void test_threads(uint32_t threads)
+{
+    const uint32_t OPS = 50000;
+    const uint32_t COUNT = 8;           // contended pins: masks overlap often
+    
+    sim_set_traced(0);
+    start();
+    
+    std::atomic<uint32_t> ready(0);
+    std::atomic<uint64_t> busy(0);
+    std::vector<std::thread> workers;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < threads; n++)
+    {
+        workers.emplace_back([n, threads, &ready, &busy]
+        {
+            ready++;
+            while (ready < threads)
+                ;
+            busy += contend(n + 1, OPS, COUNT);
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    
+    if (threads > 1)
+        TEST_CHECK(busy > 0);
+    TEST_EQUAL(faults, 0);
+    printf("claim/release, %u thread(s): %.0f ns per claim, %.1f%% busy\n",
+           threads, ns / OPS, 100.0 * busy / (threads * OPS));
+    
+    stop();
+    sim_set_traced(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Handlers inside claim and release
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t thread_held;            // claims of the thread which returned OK, till its release returns
+static uint32_t isr_held;
+static uint32_t isr_seed = 11;
+static uint32_t injections;
+
+// Other owner: claims and releases pins of its own, and tries the thread's.
+static void isr(void)
+{
+    injections++;
+    
+    if (isr_held && (test_random(&isr_seed) & 1))
+    {
+        TEST_EQUAL(ARM_GPIO_Release(ARM_GPIO_PORT_A, isr_held), ARM_DRIVER_OK);
+        isr_held = 0;
+    }
+    else
+    {
+        const uint32_t mask = random_mask(16, &isr_seed);
+        const int32_t status = ARM_GPIO_Claim(ARM_GPIO_PORT_A, mask);
+        TEST_EQUAL(status, (mask & (thread_held | isr_held)) ? ARM_DRIVER_ERROR_BUSY : ARM_DRIVER_OK);
+        if (status == ARM_DRIVER_OK)
+            isr_held |= mask;
+    }
+    
+    if (isr_held)
+    {
+        const uint32_t pin = random_pin(isr_held, &isr_seed);
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_DIRECTION, test_random(&isr_seed) & 1), ARM_DRIVER_OK);
+        driver->TogglePin(pin);
+    }
+    
+    if (thread_held)
+    {
+        const uint32_t pin = random_pin(thread_held, &isr_seed);
+        const uint32_t before_pcr = pcr(pin);
+        const uint32_t before_pddr = pddr();
+        const uint32_t before_pdor = pdor();
+        
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_UP), ARM_DRIVER_ERROR_BUSY);
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_DIRECTION, !((before_pddr >> pin) & 1)), ARM_DRIVER_ERROR_BUSY);
+        TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_LOCK, 1u << pin), ARM_DRIVER_ERROR_BUSY);
+        TEST_EQUAL(ARM_GPIO_Release(ARM_GPIO_PORT_A, 1u << pin), ARM_DRIVER_ERROR);
+        
+        const uint32_t counted = faults;
+        driver->TogglePin(pin);
+        TEST_EQUAL(faults, counted + 1);
+        TEST_EQUAL(fault_mask, 1u << pin);
+        
+        TEST_EQUAL(pcr(pin), before_pcr);
+        TEST_EQUAL(pddr() & thread_held, before_pddr & thread_held);
+        TEST_EQUAL(pdor() & thread_held, before_pdor & thread_held);
+    }
+    
+    // Reconfigures everything but the thread's pins.
+    if ((test_random(&isr_seed) & 7) == 0)
+    {
+        const uint32_t cfg = ARM_GPIO_PIN_CFG_ENABLED | ((test_random(&isr_seed) & 1) ? ARM_GPIO_PIN_CFG_OUTPUT : 0);
+        const uint32_t before_pddr = pddr();
+        TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, cfg), ARM_DRIVER_OK);
+        TEST_EQUAL(pddr() & thread_held, before_pddr & thread_held);
+    }
+}
+
+static void release_isr(void)
+{
+    if (isr_held)
+        TEST_EQUAL(ARM_GPIO_Release(ARM_GPIO_PORT_A, isr_held), ARM_DRIVER_OK);
+    isr_held = 0;
+}
+
+// Between LDREX and STREX of claim and release: the STREX fails, is retried.
+static void on_strex(volatile void*, uint32_t)
+{
+    if (!sim_in_isr() && (test_random(&isr_seed) & 1))
+        sim_interrupt(isr);
+}
+
+// Inside the thread's configuration and writes.
+static void on_write(uint32_t block, uint32_t, uint32_t)
+{
+    if ((block == SIM_BLOCK_GPIO(0) || block == SIM_BLOCK_PORT(0)) && !sim_in_isr() && (test_random(&isr_seed) & 3) == 0)
+        sim_interrupt(isr);
+}
+
+static void test_interrupts(void)
+{
+    start();
+    sim_on_strex(on_strex, NULL);
+    sim_on_write(on_write, NULL);
+    
+    uint32_t seed = 5;
+    uint32_t claims = 0;
+    for (int op = 0; op < 5000; op++)
+    {
+        const uint32_t mask = random_mask(16, &seed);
+        const int32_t status = ARM_GPIO_Claim(ARM_GPIO_PORT_A, mask);
+        TEST_EQUAL(status, (mask & isr_held) ? ARM_DRIVER_ERROR_BUSY : ARM_DRIVER_OK);
+        if (status != ARM_DRIVER_OK)
+        {
+            TEST_EQUAL(owned_by(1, mask), 0);
+            TEST_EQUAL(ARM_GPIO_Release(ARM_GPIO_PORT_A, mask), ARM_DRIVER_ERROR);
+            continue;
+        }
+        claims++;
+        thread_held = mask;
+        
+        // Directions and levels of the claimed pins, the handlers must keep them.
+        uint32_t out = 0;
+        for (uint32_t left = mask; left; left &= left - 1)
+        {
+            const uint32_t pin = __builtin_ctz(left);
+            const uint32_t level = test_random(&seed) & 1;
+            TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_DIRECTION, ARM_GPIO_PIN_DIRECTION_OUTPUT), ARM_DRIVER_OK);
+            driver->WritePin(pin, level);
+            out |= level << pin;
+        }
+        TEST_EQUAL(pddr() & mask, mask);
+        TEST_EQUAL(pdor() & mask, out);
+        
+        TEST_EQUAL(ARM_GPIO_Release(ARM_GPIO_PORT_A, mask), ARM_DRIVER_OK);
+        thread_held = 0;
+    }
+    
+    // Handler's pins are not the thread's to release.
+    if (isr_held)
+        TEST_EQUAL(ARM_GPIO_Release(ARM_GPIO_PORT_A, isr_held), ARM_DRIVER_ERROR);
+    
+    sim_on_strex(NULL, NULL);
+    sim_on_write(NULL, NULL);
+    sim_interrupt(release_isr);
+    
+    TEST_CHECK(injections > 1000);
+    TEST_CHECK(claims > 1000);
+    TEST_CHECK(faults > 100);
+    stop();
+}
+
+int main(void)
+{
+    find_pins();
+    test_threads(1);
+    test_threads(2);
+    test_threads(4);
+    test_interrupts();
+    return TEST_RESULT();
+}
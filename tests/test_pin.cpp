@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Typed pins (Driver_GPIO_NXP_K66.hpp): register access, configuration of
+// GPIO and peripheral functions. The pin_x/raw_x pairs are compared
+// instruction by instruction by codegen.sh: the wrappers must compile to
+// the same code as hand-written register access.
+
+#include "Driver_GPIO_NXP_K66.hpp"
+#include "test.h"
+
+using namespace arm_gpio;
+
+typedef Pin<ARM_GPIO_PORT_C, 5>             Led;
+typedef PinGroup<ARM_GPIO_PORT_B, 0, 1, 3>  Bus;
+
+#define CODEGEN extern "C" __attribute__((noinline, used))
+
+CODEGEN void     pin_set(void)              { Led::set(); }
+CODEGEN void     raw_set(void)              { PTC_BASE_PTR->PSOR = 1u << 5; }
+CODEGEN void     pin_clear(void)            { Led::clear(); }
+CODEGEN void     raw_clear(void)            { PTC_BASE_PTR->PCOR = 1u << 5; }
+CODEGEN void     pin_toggle(void)           { Led::toggle(); }
+CODEGEN void     raw_toggle(void)           { PTC_BASE_PTR->PTOR = 1u << 5; }
+CODEGEN void     pin_write(bool v)          { Led::write(v); }
+CODEGEN void     raw_write(bool v)          { if (v) PTC_BASE_PTR->PSOR = 1u << 5; else PTC_BASE_PTR->PCOR = 1u << 5; }
+CODEGEN bool     pin_read(void)             { return Led::read(); }
+CODEGEN bool     raw_read(void)             { return (PTC_BASE_PTR->PDIR >> 5) & 1; }
+CODEGEN void     pin_group_set(void)        { Bus::set(); }
+CODEGEN void     raw_group_set(void)        { PTB_BASE_PTR->PSOR = 0xBu; }
+CODEGEN void     pin_group_write(uint32_t v) { Bus::write(v); }
+CODEGEN void     raw_group_write(uint32_t v) { PTB_BASE_PTR->PSOR = v & 0xBu; PTB_BASE_PTR->PCOR = ~v & 0xBu; }
+CODEGEN uint32_t pin_group_read(void)       { return Bus::read(); }
+CODEGEN uint32_t raw_group_read(void)       { return PTB_BASE_PTR->PDIR & 0xBu; }
+
+static uint32_t pcr(uint32_t port, uint32_t pin)
+{
+    return sim_reg(SIM_BLOCK_PORT(port), SIM_PORT_PCR(pin));
+}
+
+static void test_access(void)
+{
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_B]->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_C]->Initialize(NULL), ARM_DRIVER_OK);
+
+    TEST_EQUAL(Led::configure<ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT>(), ARM_DRIVER_OK);
+    pin_set();
+    TEST_CHECK(pin_read());
+    pin_toggle();
+    TEST_CHECK(!pin_read());
+    pin_write(true);
+    TEST_CHECK(Led::read());
+    pin_clear();
+    TEST_CHECK(!Led::read());
+
+    TEST_EQUAL(Bus::configure<ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT>(), ARM_DRIVER_OK);
+    pin_group_write(0x9u);
+    TEST_EQUAL(pin_group_read(), 0x9u);
+    pin_group_set();
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_B), SIM_GPIO_PDOR), 0xBu);
+}
+
+// Open drain needs an output for GPIO only: a peripheral owns the direction.
+static void test_function(void)
+{
+    typedef Pin<ARM_GPIO_PORT_B, 2> Sda;
+    typedef PinGroup<ARM_GPIO_PORT_B, 16, 17> Uart;
+
+    static_assert(PinConfig<ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OPEN_DRAIN, 2>::mux == 2, "");
+
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_B), SIM_GPIO_PDOR) & (1u << 2), 0);
+    gpio_drivers[ARM_GPIO_PORT_B]->SetPin(2);
+    TEST_EQUAL(Sda::configure<ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT>(), ARM_DRIVER_OK);
+    TEST_EQUAL((Sda::configure<ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OPEN_DRAIN | ARM_GPIO_PIN_CFG_PULL_UP, 2>()), ARM_DRIVER_OK);
+    TEST_EQUAL(pcr(ARM_GPIO_PORT_B, 2), PORT_PCR_MUX(2) | PORT_PCR_ODE_MASK | PORT_PCR_PE_MASK | PORT_PCR_PS_MASK);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_B), SIM_GPIO_PDDR) & (1u << 2), 0);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(ARM_GPIO_PORT_B), SIM_GPIO_PDOR) & (1u << 2), 1u << 2);
+
+    TEST_EQUAL((Uart::configure<ARM_GPIO_PIN_CFG_ENABLED, 3>()), ARM_DRIVER_OK);
+    TEST_EQUAL(pcr(ARM_GPIO_PORT_B, 16), PORT_PCR_MUX(3));
+    TEST_EQUAL(pcr(ARM_GPIO_PORT_B, 17), PORT_PCR_MUX(3));
+
+    // Back to GPIO through ControlPin.
+    TEST_EQUAL(Sda::configure<ARM_GPIO_PIN_CFG_ENABLED>(), ARM_DRIVER_OK);
+    TEST_EQUAL(pcr(ARM_GPIO_PORT_B, 2), PORT_PCR_MUX(1));
+
+    // Locked pin is left as it is, as by ARM_GPIO_ApplyPortConfig.
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_B]->Control(ARM_GPIO_CONTROL_LOCK, 1u << 16), ARM_DRIVER_OK);
+    TEST_EQUAL((Pin<ARM_GPIO_PORT_B, 16>::configure<ARM_GPIO_PIN_CFG_ENABLED, 2>()), ARM_DRIVER_OK);
+    TEST_EQUAL(pcr(ARM_GPIO_PORT_B, 16), PORT_PCR_MUX(3) | PORT_PCR_LK_MASK);
+}
+
+int main(void)
+{
+    sim_reset();
+    test_access();
+    test_function();
+    return TEST_RESULT();
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Polled ports (Driver_GPIO_NXP_K66_Poll.h) against a reference of the pin
+// interrupt configuration: random levels are driven into two polled ports
+// between passes, every edge of a pin configured for it is dispatched
+// exactly once, levels on every pass, nothing from the port interrupt.
+// Built with ARM_GPIO_WAIT, waiters fire on polled edges too.
+
+#include "Driver_GPIO_NXP_K66_Poll.h"
+#if ARM_GPIO_WAIT
+#include "Driver_GPIO_NXP_K66_Wait.h"
+#endif
+#include "test.h"
+
+#include <string.h>
+
+// Port A: 0..3 rising, 4..7 falling, 8..11 both, 12 high, 13 low, 14..15 no IRQ.
+// Port C: 0..7 both.
+#define A_RISING    0x000Fu
+#define A_FALLING   0x00F0u
+#define A_BOTH      0x0F00u
+#define A_HIGH      0x1000u
+#define A_LOW       0x2000u
+#define A_PINS      0xFFFFu
+#define C_BOTH      0x00FFu
+
+static const uint32_t ports[2] = { ARM_GPIO_PORT_A, ARM_GPIO_PORT_C };
+
+static struct
+{
+    uint32_t    calls;
+    uint32_t    events;             // of the last call
+    uint32_t    count[32];          // dispatches per pin
+    uint32_t    from_isr;           // calls from the port interrupt
+} signalled[2];
+
+static void signal(uint32_t index, uint32_t events)
+{
+    signalled[index].calls++;
+    signalled[index].events = events;
+    for (uint32_t left = events; left; left &= left - 1)
+        signalled[index].count[__builtin_ctz(left)]++;
+    signalled[index].from_isr += sim_in_isr() != 0;
+}
+
+static void signal_a(uint32_t events) { signal(0, events); }
+static void signal_c(uint32_t events) { signal(1, events); }
+
+static void configure(uint32_t port, uint32_t pins, uint32_t irq)
+{
+    for (uint32_t left = pins; left; left &= left - 1)
+        TEST_EQUAL(gpio_drivers[port]->ControlPin((uint32_t)__builtin_ctz(left), ARM_GPIO_PIN_CFG,
+                                                  ARM_GPIO_PIN_CFG_ENABLED | irq), ARM_DRIVER_OK);
+}
+
+static void drive(uint32_t port, uint32_t pins, uint32_t levels)
+{
+    sim_port_input(port, pins, &levels, 1);
+}
+
+static void start(void)
+{
+    sim_reset();
+    memset(signalled, 0, sizeof(signalled));
+
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_A]->Initialize(signal_a), ARM_DRIVER_OK);
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_C]->Initialize(signal_c), ARM_DRIVER_OK);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        TEST_EQUAL(gpio_drivers[ports[i]]->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+        TEST_EQUAL(gpio_drivers[ports[i]]->Control(ARM_GPIO_CONTROL_IRQ, 1), ARM_DRIVER_OK);
+    }
+    drive(ARM_GPIO_PORT_A, A_PINS, A_LOW);
+    drive(ARM_GPIO_PORT_C, C_BOTH, 0);
+
+    configure(ARM_GPIO_PORT_A, A_RISING,  ARM_GPIO_PIN_CFG_IRQ_RISING);
+    configure(ARM_GPIO_PORT_A, A_FALLING, ARM_GPIO_PIN_CFG_IRQ_FALLING);
+    configure(ARM_GPIO_PORT_A, A_BOTH,    ARM_GPIO_PIN_CFG_IRQ_BOTH);
+    configure(ARM_GPIO_PORT_A, A_HIGH,    ARM_GPIO_PIN_CFG_IRQ_LEVEL_HIGH);
+    configure(ARM_GPIO_PORT_A, A_LOW,     ARM_GPIO_PIN_CFG_IRQ_LEVEL_LOW);
+    configure(ARM_GPIO_PORT_A, A_PINS & ~(A_RISING | A_FALLING | A_BOTH | A_HIGH | A_LOW), 0);
+    configure(ARM_GPIO_PORT_C, C_BOTH,    ARM_GPIO_PIN_CFG_IRQ_BOTH);
+
+    TEST_EQUAL(ARM_GPIO_Poll_Enable(ARM_GPIO_PORT_A, 1), ARM_DRIVER_OK);
+    TEST_EQUAL(ARM_GPIO_Poll_Enable(ARM_GPIO_PORT_C, 1), ARM_DRIVER_OK);
+}
+
+// Level pins inactive before the interrupt is back.
+static void stop(void)
+{
+    drive(ARM_GPIO_PORT_A, A_HIGH | A_LOW, A_LOW);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        ARM_GPIO_Poll_Enable(ports[i], 0);
+        gpio_drivers[ports[i]]->PowerControl(ARM_POWER_OFF);
+        gpio_drivers[ports[i]]->Uninitialize();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Dispatch
+////////////////////////////////////////////////////////////////////////////////
+
+// One edge per pass: each reaches the callback once, in the pass after it.
+static void test_edges(void)
+{
+    start();
+
+    TEST_EQUAL(ARM_GPIO_Poll(), 0);
+    drive(ARM_GPIO_PORT_A, A_LOW, 0);
+    TEST_EQUAL(ARM_GPIO_Poll(), 1u << ARM_GPIO_PORT_A);
+    TEST_EQUAL(signalled[0].events, A_LOW);
+    TEST_EQUAL(signalled[0].calls, 1);
+
+    drive(ARM_GPIO_PORT_A, 1u << 0, 1u << 0);
+    TEST_EQUAL(signalled[0].calls, 1);                      // no interrupt
+    TEST_EQUAL(ARM_GPIO_Poll(), 1u << ARM_GPIO_PORT_A);
+    TEST_EQUAL(signalled[0].events, (1u << 0) | A_LOW);
+    TEST_EQUAL(ARM_GPIO_Poll(), 1u << ARM_GPIO_PORT_A);
+    TEST_EQUAL(signalled[0].events, A_LOW);                 // reported once
+
+    drive(ARM_GPIO_PORT_A, (1u << 0) | (1u << 4), 1u << 4); // A0 falls, A4 rises: neither
+    ARM_GPIO_Poll();
+    TEST_EQUAL(signalled[0].events, A_LOW);
+    drive(ARM_GPIO_PORT_A, 1u << 4, 0);
+    ARM_GPIO_Poll();
+    TEST_EQUAL(signalled[0].events, (1u << 4) | A_LOW);
+
+    drive(ARM_GPIO_PORT_A, A_HIGH | A_LOW | (1u << 14), A_HIGH | A_LOW | (1u << 14));
+    for (uint32_t pass = 0; pass < 3; pass++)
+    {
+        TEST_EQUAL(ARM_GPIO_Poll(), 1u << ARM_GPIO_PORT_A);
+        TEST_EQUAL(signalled[0].events, A_HIGH);
+    }
+    drive(ARM_GPIO_PORT_A, A_HIGH, 0);
+    TEST_EQUAL(ARM_GPIO_Poll(), 0);
+
+    drive(ARM_GPIO_PORT_C, 1u << 3, 1u << 3);
+    TEST_EQUAL(ARM_GPIO_Poll(), 1u << ARM_GPIO_PORT_C);
+    TEST_EQUAL(signalled[1].events, 1u << 3);
+    drive(ARM_GPIO_PORT_C, 1u << 3, 0);
+    TEST_EQUAL(ARM_GPIO_Poll(), 1u << ARM_GPIO_PORT_C);
+    TEST_EQUAL(signalled[1].events, 1u << 3);
+
+    // A pulse within one period is not seen (Driver_GPIO_NXP_K66_Poll.h).
+    drive(ARM_GPIO_PORT_C, 1u << 4, 1u << 4);
+    drive(ARM_GPIO_PORT_C, 1u << 4, 0);
+    TEST_EQUAL(ARM_GPIO_Poll(), 0);
+
+    TEST_EQUAL(signalled[0].from_isr + signalled[1].from_isr, 0);
+    stop();
+}
+
+// Random levels on many pins of both ports per pass against the reference:
+// every qualifying change of the snapshot, any number per pass, is one
+// dispatch of its pin; one call per port and pass with events.
+static void test_random_passes(void)
+{
+    start();
+    uint32_t seed = 0x9E3779B9u;
+    uint32_t levels[2] = { A_LOW, 0 };
+    uint32_t expected[2][32];
+    uint32_t calls[2] = { 0, 0 };
+    memset(expected, 0, sizeof(expected));
+
+    for (uint32_t pass = 0; pass < 20000; pass++)
+    {
+        uint32_t events[2];
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            const uint32_t pins = i ? C_BOTH : A_PINS;
+            const uint32_t next = (levels[i] & ~pins) | (test_random(&seed) & pins);
+            const uint32_t mask = test_random(&seed) & pins;  // pins driven this pass
+            const uint32_t now  = (levels[i] & ~mask) | (next & mask);
+            drive(ports[i], mask, now);
+
+            const uint32_t changed = now ^ levels[i];
+            events[i] = i ? (changed & C_BOTH)
+                          : (changed & ((now & (A_RISING | A_BOTH)) | (~now & (A_FALLING | A_BOTH)))) |
+                            (now & A_HIGH) | (~now & A_LOW);
+            levels[i] = now;
+            for (uint32_t left = events[i]; left; left &= left - 1)
+                expected[i][__builtin_ctz(left)]++;
+            calls[i] += events[i] != 0;
+        }
+
+        const uint32_t active = ARM_GPIO_Poll();
+        TEST_EQUAL(active, (events[0] ? 1u << ARM_GPIO_PORT_A : 0) | (events[1] ? 1u << ARM_GPIO_PORT_C : 0));
+        for (uint32_t i = 0; i < 2; i++)
+            if (events[i])
+                TEST_EQUAL(signalled[i].events, events[i]);
+    }
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        TEST_EQUAL(signalled[i].calls, calls[i]);
+        TEST_EQUAL(signalled[i].from_isr, 0);
+        for (uint32_t pin = 0; pin < 32; pin++)
+            TEST_EQUAL(signalled[i].count[pin], expected[i][pin]);
+    }
+    stop();
+}
+
+// Back to the interrupt: flags latched while polled are dropped, edges
+// interrupt again.
+static void test_disable(void)
+{
+    start();
+
+    drive(ARM_GPIO_PORT_C, 1u << 0, 1u << 0);
+    TEST_EQUAL(ARM_GPIO_Poll_Enable(ARM_GPIO_PORT_C, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(signalled[1].calls, 0);
+    TEST_EQUAL(ARM_GPIO_Poll(), 0);
+
+    drive(ARM_GPIO_PORT_C, 1u << 1, 1u << 1);
+    TEST_EQUAL(signalled[1].calls, 1);
+    TEST_EQUAL(signalled[1].events, 1u << 1);
+    TEST_EQUAL(signalled[1].from_isr, 1);
+
+    TEST_EQUAL(ARM_GPIO_Poll_Enable(ARM_GPIO_PORT_COUNT, 1), ARM_DRIVER_ERROR_PARAMETER);
+    stop();
+    TEST_EQUAL(ARM_GPIO_Poll_Enable(ARM_GPIO_PORT_A, 1), ARM_DRIVER_ERROR);
+}
+
+#if ARM_GPIO_WAIT
+////////////////////////////////////////////////////////////////////////////////
+//   Waiters
+////////////////////////////////////////////////////////////////////////////////
+
+// The same waiters as with the interrupt: rising, falling and edge waiters
+// fire in the pass seeing their edge, before the callback.
+static void test_waiters(void)
+{
+    start();
+    ARM_GPIO_WAITER* volatile ready = NULL;
+    ARM_GPIO_WAITER rising  = { .ready = &ready, .mask = 1u << 1, .edge = ARM_GPIO_WAIT_RISING  };
+    ARM_GPIO_WAITER falling = { .ready = &ready, .mask = 1u << 5, .edge = ARM_GPIO_WAIT_FALLING };
+    ARM_GPIO_WAITER edge    = { .ready = &ready, .mask = 1u << 2, .edge = ARM_GPIO_WAIT_EDGE    };
+    TEST_EQUAL(ARM_GPIO_Wait_Add(ARM_GPIO_PORT_A, &rising), ARM_DRIVER_OK);
+    TEST_EQUAL(ARM_GPIO_Wait_Add(ARM_GPIO_PORT_A, &falling), ARM_DRIVER_OK);
+    TEST_EQUAL(ARM_GPIO_Wait_Add(ARM_GPIO_PORT_C, &edge), ARM_DRIVER_OK);
+
+    drive(ARM_GPIO_PORT_A, (1u << 1) | (1u << 5), (1u << 1) | (1u << 5));
+    drive(ARM_GPIO_PORT_C, 1u << 2, 1u << 2);
+    TEST_CHECK(ready == NULL);
+
+    ARM_GPIO_Poll();
+    uint32_t fired = 0;
+    for (ARM_GPIO_WAITER* waiter = ARM_GPIO_Wait_TakeAll(&ready); waiter; waiter = waiter->next)
+        fired |= waiter->mask;
+    TEST_EQUAL(fired, (1u << 1) | (1u << 2));
+    TEST_EQUAL(rising.events, 1u << 1);
+    TEST_EQUAL(edge.events, 1u << 2);
+
+    drive(ARM_GPIO_PORT_A, 1u << 5, 0);
+    ARM_GPIO_Poll();
+    TEST_CHECK(ARM_GPIO_Wait_TakeAll(&ready) == &falling);
+    TEST_EQUAL(falling.events, 1u << 5);
+
+    stop();
+}
+#endif
+
+int main(void)
+{
+    test_edges();
+    test_random_passes();
+    test_disable();
+#if ARM_GPIO_WAIT
+    test_waiters();
+#endif
+    return TEST_RESULT();
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Port clock gating: Initialize powers the port, Uninitialize gates it, the
+// clock is shared with other users; no driver call touches a gated port
+// (the register model counts every access to a PORT block without clock).
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "Driver_PORT_Clock_NXP_K66.h"
+#include "test.h"
+
+static const uint32_t clock_mask[ARM_GPIO_PORT_COUNT] =
+{
+    SIM_SCGC5_PORTA_MASK, SIM_SCGC5_PORTB_MASK, SIM_SCGC5_PORTC_MASK, SIM_SCGC5_PORTD_MASK, SIM_SCGC5_PORTE_MASK
+};
+
+static uint32_t clocked(uint32_t port)
+{
+    return (sim_reg(SIM_BLOCK_SIM, SIM_SIM_SCGC5) & clock_mask[port]) != 0;
+}
+
+// Every call, which may reach the PORT registers; results are not checked.
+static void all_calls(uint32_t port)
+{
+    ARM_DRIVER_GPIO* const driver = gpio_drivers[port];
+    ARM_GPIO_PORT_SNAPSHOT snapshot = { { 0 } };
+
+    driver->Control(ARM_GPIO_CONTROL_CLEAR_EVENTS, 0);
+    driver->Control(ARM_GPIO_CONTROL_DEFAULT_CFG, ARM_GPIO_PIN_CFG_ENABLED);
+    for (uint32_t control = ARM_GPIO_PIN_CFG; control <= ARM_GPIO_PIN_DRIVE_STRENGTH; control++)
+        driver->ControlPin(5, control, 1);
+    ARM_GPIO_SavePortConfig(port, &snapshot);
+    ARM_GPIO_RestorePortConfig(port, &snapshot);
+    driver->PowerControl(ARM_POWER_LOW);
+}
+
+static void test_initialize(void)
+{
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        ARM_DRIVER_GPIO* const driver = gpio_drivers[port];
+        TEST_CHECK(!clocked(port));
+
+        // Old API: no PowerControl, the port works.
+        TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+        TEST_CHECK(clocked(port));
+        TEST_EQUAL(ARM_PORT_ClockUsers(port), 1);
+        TEST_EQUAL(driver->ControlPin(2, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT), ARM_DRIVER_OK);
+        driver->SetPin(2);
+        TEST_EQUAL(driver->ReadPin(2), 1);
+        all_calls(port);
+
+        // PowerControl(FULL) after Initialize takes no second reference.
+        TEST_EQUAL(driver->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+        TEST_EQUAL(ARM_PORT_ClockUsers(port), 1);
+
+        TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+        TEST_CHECK(!clocked(port));
+        TEST_EQUAL(ARM_PORT_ClockUsers(port), 0);
+
+        // Gated: every call refuses before touching the port.
+        TEST_EQUAL(driver->ControlPin(2, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED), ARM_DRIVER_ERROR);
+        all_calls(port);
+        TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+    }
+    TEST_EQUAL(sim_gated_accesses(), 0);
+}
+
+static void test_shared_clock(void)
+{
+    ARM_DRIVER_GPIO* const driver = gpio_drivers[ARM_GPIO_PORT_D];
+
+    // Another peripheral holds the clock: Uninitialize doesn't gate the port.
+    TEST_EQUAL(ARM_PORT_ClockAcquire(ARM_GPIO_PORT_D), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(ARM_PORT_ClockUsers(ARM_GPIO_PORT_D), 2);
+    TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+    TEST_CHECK(clocked(ARM_GPIO_PORT_D));
+    TEST_EQUAL(ARM_PORT_ClockRelease(ARM_GPIO_PORT_D), ARM_DRIVER_OK);
+    TEST_CHECK(!clocked(ARM_GPIO_PORT_D));
+    TEST_EQUAL(ARM_PORT_ClockRelease(ARM_GPIO_PORT_D), ARM_DRIVER_ERROR);
+
+    // ARM_POWER_LOW keeps the clock, OFF gates it.
+    TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_LOW), ARM_DRIVER_OK);
+    TEST_CHECK(clocked(ARM_GPIO_PORT_D));
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_OFF), ARM_DRIVER_OK);
+    TEST_CHECK(!clocked(ARM_GPIO_PORT_D));
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_LOW), ARM_DRIVER_ERROR);
+    TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+    TEST_EQUAL(sim_gated_accesses(), 0);
+}
+
+// The check itself: an access to a gated port is counted.
+static void test_detector(void)
+{
+    const uint32_t before = sim_gated_accesses();
+    (void)PORTA_BASE_PTR->PCR[0];
+    PORTB_BASE_PTR->PCR[1] = PORT_PCR_MUX(1);
+    TEST_EQUAL(sim_gated_accesses(), before + 2);
+}
+
+int main(void)
+{
+    test_initialize();
+    test_shared_clock();
+    test_detector();
+    return TEST_RESULT();
+}
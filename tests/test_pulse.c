@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Timed sequences on the register model: edges of the pin come at absolute
+// deadlines (no error accumulates from bit to bit, also across the
+// DWT_CYCCNT wrap), handlers run between windows only, and interrupts
+// stretching the idle phases give the transfer up after
+// ARM_GPIO_PULSE_RESTARTS restarts.
+
+#include "Driver_GPIO_NXP_K66_BitBang.h"
+#include "test.h"
+
+#define CLOCK           120000000u
+#define SLACK           8u                  // cycles of the bit loop from deadline to store
+#define BITS            96u
+
+static const ARM_GPIO_BUS_PIN PIN = { ARM_GPIO_PORT_C, 5 };
+
+// WS2812: bit 0 400/850 ns, bit 1 800/450 ns.
+static const ARM_GPIO_PULSE_TIMING WS2812[2] = { { 400, 850 }, { 800, 450 } };
+
+// Stores to PSOR/PCOR of the pin: time and level driven.
+static uint64_t edge_time[2 * BITS];
+static uint32_t edge_level[2 * BITS];
+static uint32_t edges;
+
+static uint32_t handler_edges[2 * BITS];    // edges before the handler ran
+static uint32_t handlers;
+static uint32_t handlers_left;
+static uint32_t armed;                      // next edge pends a handler
+
+static void handler(void)
+{
+    if (handlers < 2 * BITS)
+        handler_edges[handlers] = edges;
+    handlers++;
+    if (handlers_left)
+    {
+        handlers_left--;
+        armed = 1;
+    }
+}
+
+static void pend(void* arg)
+{
+    sim_interrupt(handler);
+}
+
+static void on_write(uint32_t block, uint32_t offset, uint32_t value)
+{
+    if (block != (uint32_t)SIM_BLOCK_GPIO(PIN.port) || (offset != SIM_GPIO_PSOR && offset != SIM_GPIO_PCOR))
+        return;
+    if (edges < 2 * BITS)
+    {
+        edge_time[edges] = sim_time();
+        edge_level[edges] = (offset == SIM_GPIO_PSOR);
+    }
+    edges++;
+    
+    if (armed)
+    {
+        armed = 0;
+        sim_at(sim_time() + 1, pend, NULL);
+    }
+}
+
+static uint32_t bit_value(const uint8_t* data, uint32_t bit, uint32_t options)
+{
+    const uint32_t byte = data[bit >> 3];
+    return ((options & ARM_GPIO_PULSE_LSB_FIRST) ? (byte >> (bit & 7)) : (byte >> (7 - (bit & 7)))) & 1;
+}
+
+static void start(uint64_t time)
+{
+    sim_reset();
+    sim_advance(time);
+    edges = 0;
+}
+
+// Bits first..last - 1, sent back to back: every active edge at its deadline
+// from the first one, every active phase as long as its value's.
+static void check_train(const ARM_GPIO_PULSE* pulse, const uint8_t* data, uint32_t first, uint32_t last)
+{
+    const uint32_t active = !(pulse->options & ARM_GPIO_PULSE_ACTIVE_LOW);
+    uint64_t deadline = edge_time[2 * first];
+    for (uint32_t bit = first; bit < last; bit++)
+    {
+        const uint32_t value = bit_value(data, bit, pulse->options);
+        const uint64_t on  = edge_time[2 * bit];
+        const uint64_t off = edge_time[2 * bit + 1];
+        
+        TEST_EQUAL(edge_level[2 * bit], active);
+        TEST_EQUAL(edge_level[2 * bit + 1], !active);
+        TEST_CHECK(on + SLACK >= deadline && on <= deadline + SLACK);
+        TEST_CHECK(off - on + SLACK >= pulse->cycles[value] && off - on <= pulse->cycles[value] + SLACK);
+        deadline += pulse->period[value];
+    }
+}
+
+static void random_data(uint8_t* data, uint32_t* seed)
+{
+    for (uint32_t n = 0; n < BITS / 8; n++)
+        data[n] = (uint8_t)test_random(seed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Initialization
+////////////////////////////////////////////////////////////////////////////////
+
+static void test_initialize(void)
+{
+    ARM_GPIO_PULSE pulse;
+    start(0);
+    
+    TEST_EQUAL(ARM_GPIO_Pulse_Initialize(&pulse, PIN, WS2812, CLOCK, 8, 0), ARM_DRIVER_OK);
+    TEST_EQUAL(pulse.cycles[0], 48);
+    TEST_EQUAL(pulse.cycles[1], 96);
+    TEST_EQUAL(pulse.period[0], 150);
+    TEST_EQUAL(pulse.period[1], 150);
+    
+    // Idle phase timeable, but shorter than the lead of a window.
+    const ARM_GPIO_PULSE_TIMING short_idle[2] = { { 400, 200 }, { 800, 450 } };
+    TEST_CHECK(200u * (CLOCK / 1000000u) / 1000u < ARM_GPIO_PULSE_LEAD);
+    TEST_EQUAL(ARM_GPIO_Pulse_Initialize(&pulse, PIN, short_idle, CLOCK, 8, 0), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(ARM_GPIO_Pulse_Initialize(&pulse, PIN, short_idle, CLOCK, 0, 0), ARM_DRIVER_OK);
+    
+    const ARM_GPIO_PULSE_TIMING too_short[2] = { { 100, 850 }, { 800, 450 } };
+    TEST_EQUAL(ARM_GPIO_Pulse_Initialize(&pulse, PIN, too_short, CLOCK, 0, 0), ARM_DRIVER_ERROR_UNSUPPORTED);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Deadlines
+////////////////////////////////////////////////////////////////////////////////
+
+static void check_deadlines(uint64_t time, uint32_t window, uint32_t options, uint32_t* seed)
+{
+    ARM_GPIO_PULSE pulse;
+    ARM_GPIO_PULSE_ERROR error;
+    uint8_t data[BITS / 8];
+    
+    start(time);
+    random_data(data, seed);
+    TEST_EQUAL(ARM_GPIO_Pulse_Initialize(&pulse, PIN, WS2812, CLOCK, window, options), ARM_DRIVER_OK);
+    sim_on_write(NULL, on_write);
+    TEST_EQUAL(ARM_GPIO_Pulse_Send(&pulse, data, BITS, &error), ARM_DRIVER_OK);
+    sim_on_write(NULL, NULL);
+    
+    TEST_EQUAL(edges, 2 * BITS);
+    check_train(&pulse, data, 0, BITS);
+    
+    // Returns after the idle phase of the last bit.
+    const uint32_t last = bit_value(data, BITS - 1, options);
+    TEST_CHECK(sim_time() >= edge_time[2 * BITS - 2] + pulse.period[last] - SLACK);
+    
+    TEST_CHECK(error.active_min >= 0 && error.active_max <= (int32_t)SLACK);
+    TEST_CHECK(error.active_min <= error.active_max);
+    TEST_CHECK(error.late_max <= SLACK);
+    TEST_EQUAL(error.stretched, 0);
+}
+
+static void test_deadlines(void)
+{
+    uint32_t seed = 3;
+    check_deadlines(0, 0, 0, &seed);
+    check_deadlines(0, 8, 0, &seed);
+    check_deadlines(0, 1, ARM_GPIO_PULSE_ACTIVE_LOW | ARM_GPIO_PULSE_LSB_FIRST, &seed);
+    
+    // DWT_CYCCNT wraps in the middle of the train.
+    check_deadlines(0x100000000ull - BITS * 150 / 2, 0, 0, &seed);
+    check_deadlines(0x100000000ull - BITS * 150 / 2, 4, ARM_GPIO_PULSE_LSB_FIRST, &seed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Interrupts between windows
+////////////////////////////////////////////////////////////////////////////////
+
+// Count handlers, each cost cycles long, pended at the first edge and at the
+// first edge after the previous one ran: they run between windows, a long
+// one stretches the idle phase.
+static int32_t send_interrupted(ARM_GPIO_PULSE* pulse, const uint8_t* data, uint32_t window, uint32_t cost, uint32_t count, ARM_GPIO_PULSE_ERROR* error)
+{
+    start(1000);
+    TEST_EQUAL(ARM_GPIO_Pulse_Initialize(pulse, PIN, WS2812, CLOCK, window, 0), ARM_DRIVER_OK);
+    
+    sim_isr_cost[SIM_IRQ_SOFT] = cost;
+    handlers = 0;
+    handlers_left = count - 1;
+    armed = 1;
+    
+    sim_on_write(NULL, on_write);
+    const int32_t status = ARM_GPIO_Pulse_Send(pulse, data, BITS, error);
+    sim_on_write(NULL, NULL);
+    armed = 0;
+    
+    // Between windows only: after the idle edge of a window's last bit.
+    for (uint32_t n = 0; n < handlers && n < 2 * BITS; n++)
+        TEST_EQUAL(handler_edges[n] % (2 * (window ? window : BITS)), 0);
+    return status;
+}
+
+static void test_windows(void)
+{
+    const uint32_t WINDOW = 8;
+    ARM_GPIO_PULSE pulse;
+    ARM_GPIO_PULSE_ERROR error;
+    uint8_t data[BITS / 8];
+    uint32_t seed = 5;
+    random_data(data, &seed);
+    
+    // Short handlers fit in the idle phase: the train keeps its deadlines.
+    TEST_EQUAL(send_interrupted(&pulse, data, WINDOW, 4, BITS, &error), ARM_DRIVER_OK);
+    TEST_EQUAL(edges, 2 * BITS);
+    TEST_EQUAL(handlers, BITS / WINDOW);
+    TEST_EQUAL(error.stretched, 0);
+    TEST_CHECK(error.late_max <= SLACK);
+    check_train(&pulse, data, 0, BITS);
+    
+    // Two long ones: two restarts, each window on its deadlines.
+    TEST_EQUAL(send_interrupted(&pulse, data, WINDOW, 1000, 2, &error), ARM_DRIVER_OK);
+    TEST_EQUAL(edges, 2 * BITS);
+    TEST_EQUAL(error.stretched, 2);
+    for (uint32_t bit = 0; bit < BITS; bit += WINDOW)
+        check_train(&pulse, data, bit, bit + WINDOW);
+    check_train(&pulse, data, 2 * WINDOW, BITS);
+    TEST_CHECK(edge_time[2 * WINDOW] - edge_time[0] > 1000 + WINDOW * 150);
+}
+
+static void test_restarts(void)
+{
+    const uint32_t WINDOW = 4;
+    ARM_GPIO_PULSE pulse;
+    ARM_GPIO_PULSE_ERROR error;
+    uint8_t data[BITS / 8];
+    uint32_t seed = 7;
+    random_data(data, &seed);
+    
+    // Every idle phase stretched: given up after the last restart allowed,
+    // with the pin idle.
+    TEST_EQUAL(send_interrupted(&pulse, data, WINDOW, 1000, BITS, &error), ARM_DRIVER_ERROR_TIMEOUT);
+    TEST_EQUAL(error.stretched, ARM_GPIO_PULSE_RESTARTS + 1);
+    TEST_EQUAL(edges, 2 * WINDOW * (ARM_GPIO_PULSE_RESTARTS + 1));
+    TEST_EQUAL(edge_level[edges - 1], 0);
+    for (uint32_t bit = 0; 2 * bit < edges; bit += WINDOW)
+        check_train(&pulse, data, bit, bit + WINDOW);
+    TEST_CHECK(error.active_min >= 0 && error.active_max <= (int32_t)SLACK);
+    
+    // One window: the handlers wait for its end.
+    TEST_EQUAL(send_interrupted(&pulse, data, 0, 1000, BITS, &error), ARM_DRIVER_OK);
+    TEST_EQUAL(edges, 2 * BITS);
+    TEST_EQUAL(handlers, 1);
+    TEST_EQUAL(error.stretched, 0);
+    check_train(&pulse, data, 0, BITS);
+}
+
+int main(void)
+{
+    test_initialize();
+    test_deadlines();
+    test_windows();
+    test_restarts();
+    return TEST_RESULT();
+}
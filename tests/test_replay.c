@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Record and replay of port events: records taken from the simulated ports,
+// gap records over DWT wrap, dropping after a full buffer, replay through
+// ARM_GPIO_DispatchEvents and the host replayer (gpio_des_replay).
+
+#include "gpio_des.h"
+#include "Driver_GPIO_NXP_K66_Record.h"
+#include "test.h"
+
+#include <intrinsics.h>
+#include <string.h>
+
+#define EVENT_MAX   8192
+
+typedef struct
+{
+    uint32_t port;
+    uint32_t mask;
+} EVENT;
+
+static EVENT    events[EVENT_MAX];
+static uint32_t event_count;
+static uint32_t unmasked;               // events delivered with interrupts enabled
+
+static void collect(uint32_t port, uint32_t mask)
+{
+    if (event_count < EVENT_MAX)
+        events[event_count++] = (EVENT){ port, mask };
+    if (!__get_interrupt_state())
+        unmasked++;
+}
+
+static uint8_t  trace[65536];
+static EVENT    recorded[EVENT_MAX];
+static uint32_t recorded_count;
+
+static void setup_ports(void)
+{
+    GPIO_DES_PORT config = { 3, ARM_GPIO_PIN_IRQ_BOTH, 0, 0, 0, collect };
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_A, &config), ARM_DRIVER_OK);
+    config.priority = 5;
+    config.irq = ARM_GPIO_PIN_IRQ_RISING;
+    TEST_EQUAL(gpio_des_port(ARM_GPIO_PORT_C, &config), ARM_DRIVER_OK);
+}
+
+static void test_record(uint32_t* length)
+{
+    gpio_des_reset();
+    setup_ports();
+    for (uint32_t pin = 0; pin < 4; pin++)
+    {
+        const SIM_WAVE wave = { ARM_GPIO_PORT_A, (uint8_t)pin, 900, 900, 50, 1000 + pin, 300000 };
+        TEST_EQUAL(gpio_des_wave(&wave), ARM_DRIVER_OK);
+    }
+    const SIM_WAVE wave = { ARM_GPIO_PORT_C, 5, 3000, 2000, 0, 1000, 300000 };
+    TEST_EQUAL(gpio_des_wave(&wave), ARM_DRIVER_OK);
+
+    event_count = 0;
+    TEST_EQUAL(ARM_GPIO_Record_Start(trace, sizeof(trace)), ARM_DRIVER_OK);
+    GPIO_DES_REPORT report;
+    gpio_des_run(310000, &report);
+    uint32_t dropped;
+    *length = ARM_GPIO_Record_Stop(&dropped);
+    TEST_EQUAL(dropped, 0);
+
+    // The record holds every handler call, in order.
+    uint32_t count = 0;
+    for (uint32_t pos = 0; pos < *length; )
+    {
+        ARM_GPIO_RECORD_EVENT event;
+        const uint32_t used = ARM_GPIO_Record_Decode(trace + pos, *length - pos, &event);
+        TEST_CHECK(used);
+        if (!used)
+            break;
+        pos += used;
+        TEST_CHECK(count < event_count && event.port == events[count].port && event.mask == events[count].mask);
+        count++;
+    }
+    TEST_EQUAL(count, event_count);
+    TEST_EQUAL(count, report.port[ARM_GPIO_PORT_A].calls + report.port[ARM_GPIO_PORT_C].calls);
+    TEST_CHECK(report.port[ARM_GPIO_PORT_C].events > 50);
+
+    memcpy(recorded, events, sizeof(events));
+    recorded_count = event_count;
+}
+
+static int same_events(void)
+{
+    return event_count == recorded_count && !memcmp(events, recorded, event_count * sizeof(EVENT));
+}
+
+// ARM_GPIO_Replay on the target: events through the callbacks, interrupts masked.
+static void test_replay(uint32_t length)
+{
+    uint32_t lag;
+
+    event_count = unmasked = 0;
+    TEST_EQUAL(ARM_GPIO_Replay(trace, length, 0, NULL), ARM_DRIVER_OK);
+    TEST_CHECK(same_events());
+    TEST_EQUAL(unmasked, 0);
+
+    event_count = 0;
+    const uint64_t start = sim_time();
+    TEST_EQUAL(ARM_GPIO_Replay(trace, length, 1, &lag), ARM_DRIVER_OK);
+    TEST_CHECK(same_events());
+    TEST_CHECK(lag < 100);
+    TEST_CHECK(sim_time() - start > 290000 && sim_time() - start < 310000);
+}
+
+// Host replayer: the record as edges into fresh ports gives the same handler
+// calls at original speed, and all events four times faster.
+static void test_host_replay(uint32_t length)
+{
+    GPIO_DES_REPORT report;
+    uint64_t end;
+
+    gpio_des_reset();
+    setup_ports();
+    event_count = 0;
+    TEST_EQUAL(gpio_des_replay(trace, length, 1, 1000, &end), ARM_DRIVER_OK);
+    TEST_CHECK(end > 290000 && end < 310000);
+    gpio_des_run(end + 10000, &report);
+    TEST_CHECK(same_events());
+    TEST_EQUAL(report.port[ARM_GPIO_PORT_A].edges.lost + report.port[ARM_GPIO_PORT_C].edges.lost, 0);
+
+    uint32_t pin_events = 0;
+    for (uint32_t i = 0; i < recorded_count; i++)
+        pin_events += (uint32_t)__builtin_popcount(recorded[i].mask);
+
+    gpio_des_reset();
+    setup_ports();
+    event_count = 0;
+    TEST_EQUAL(gpio_des_replay(trace, length, 4, 1000, &end), ARM_DRIVER_OK);
+    TEST_CHECK(end > 1000 + 290000 / 4 && end < 1000 + 310000 / 4);
+    gpio_des_run(end + 10000, &report);
+    TEST_EQUAL(report.port[ARM_GPIO_PORT_A].events + report.port[ARM_GPIO_PORT_C].events, pin_events);
+    TEST_EQUAL(report.port[ARM_GPIO_PORT_A].edges.lost + report.port[ARM_GPIO_PORT_C].edges.lost, 0);
+
+    TEST_EQUAL(gpio_des_replay(trace, length, 0, 0, &end), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(gpio_des_replay(trace, length - 1, 1, 0, &end), ARM_DRIVER_ERROR_PARAMETER);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// 5.5 * 2^31 cycles with a tick every 2^31: the deltas add up across DWT wraps.
+static void test_gap(void)
+{
+    gpio_des_reset();
+    setup_ports();
+    TEST_EQUAL(gpio_drivers[ARM_GPIO_PORT_A]->ControlPin(7, ARM_GPIO_PIN_CFG,
+               ARM_GPIO_PIN_CFG_ENABLED | (ARM_GPIO_PIN_IRQ_BOTH << ARM_GPIO_PIN_CFG_IRQ_Pos)), ARM_DRIVER_OK);
+
+    TEST_EQUAL(ARM_GPIO_Record_Start(trace, sizeof(trace)), ARM_DRIVER_OK);
+    const uint64_t start = sim_time();
+    ARM_GPIO_Record_Tick();                 // too early: no record
+    TEST_EQUAL(ARM_GPIO_Record_Stop(NULL), 0);
+
+    TEST_EQUAL(ARM_GPIO_Record_Start(trace, sizeof(trace)), ARM_DRIVER_OK);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        sim_advance(0x80000000u);
+        ARM_GPIO_Record_Tick();
+    }
+    sim_advance(0x40000000u);
+    event_count = 0;
+    sim_pin_input(ARM_GPIO_PORT_A, 7, 1);
+    const uint64_t elapsed = sim_time() - start;
+    const uint32_t length = ARM_GPIO_Record_Stop(NULL);
+
+    uint32_t gaps = 0, others = 0;
+    uint64_t total = 0;
+    for (uint32_t pos = 0; pos < length; )
+    {
+        ARM_GPIO_RECORD_EVENT event;
+        const uint32_t used = ARM_GPIO_Record_Decode(trace + pos, length - pos, &event);
+        TEST_CHECK(used);
+        if (!used)
+            break;
+        pos += used;
+        total += event.delta;
+        if (event.port == ARM_GPIO_RECORD_GAP)
+            gaps++;
+        else
+            others++;
+        TEST_EQUAL(event.mask, event.port == ARM_GPIO_RECORD_GAP ? 0 : 1u << 7);
+    }
+    TEST_EQUAL(gaps, 5);
+    TEST_EQUAL(others, 1);
+    TEST_CHECK(total <= elapsed && elapsed - total < 1000);
+
+    // Gaps are waited for, not delivered.
+    uint32_t lag;
+    event_count = 0;
+    const uint64_t replay_start = sim_time();
+    TEST_EQUAL(ARM_GPIO_Replay(trace, length, 1024, &lag), ARM_DRIVER_OK);
+    TEST_EQUAL(event_count, 1);
+    TEST_CHECK(sim_time() - replay_start >= total / 1024 - 8);
+    TEST_CHECK(lag < 100);
+}
+
+// After the first dropped record nothing is stored, not even a short one.
+static void test_drop(void)
+{
+    uint8_t buffer[10];
+
+    gpio_des_reset();
+    TEST_EQUAL(ARM_GPIO_Record_Start(buffer, sizeof(buffer)), ARM_DRIVER_OK);
+    sim_advance(100000);
+    ARM_GPIO_Record_Event(ARM_GPIO_PORT_B, 0x10000);    // 1 + 3 + 3 bytes
+    ARM_GPIO_Record_Event(ARM_GPIO_PORT_B, 0x10000);    // 1 + 1 + 3: doesn't fit
+    ARM_GPIO_Record_Event(ARM_GPIO_PORT_B, 1);          // 1 + 1 + 1: would fit
+    uint32_t dropped;
+    TEST_EQUAL(ARM_GPIO_Record_Stop(&dropped), 7);
+    TEST_EQUAL(dropped, 2);
+}
+
+int main(void)
+{
+    uint32_t length;
+
+    test_record(&length);
+    test_replay(length);
+    test_host_replay(length);
+    test_gap();
+    test_drop();
+    return TEST_RESULT();
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Port snapshot restore (ARM_GPIO_SavePortConfig/RestorePortConfig/
+// ApplyPortConfig) by the stores it makes: nothing for unchanged pins, one
+// GPCLR/GPCHR per distinct PCR[15:0] (a PCR store per pin with shadow
+// registers), a PCR store where IRQC differs, none to locked pins, and
+// pending pin flags survive.
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "test.h"
+
+#include <string.h>
+
+#define driver  gpio_drivers[ARM_GPIO_PORT_A]
+
+typedef struct
+{
+    uint32_t block;
+    uint32_t offset;
+    uint32_t value;                     // stored, before the register semantics
+} STORE;
+
+static STORE    stores[64];
+static uint32_t store_count;
+
+static void record(uint32_t block, uint32_t offset, uint32_t value)
+{
+    if (block < SIM_BLOCK_GPIO(SIM_PORT_COUNT) && store_count < 64)
+    {
+        const STORE store = { block, offset, value };
+        stores[store_count++] = store;
+    }
+}
+
+// Stores of the restore.
+static uint32_t restore(const ARM_GPIO_PORT_SNAPSHOT* snapshot)
+{
+    store_count = 0;
+    sim_on_write(record, NULL);
+    TEST_EQUAL(ARM_GPIO_RestorePortConfig(ARM_GPIO_PORT_A, snapshot), ARM_DRIVER_OK);
+    sim_on_write(NULL, NULL);
+    return store_count;
+}
+
+static uint32_t pcr(uint32_t pin)
+{
+    return sim_reg(SIM_BLOCK_PORT(0), SIM_PORT_PCR(pin));
+}
+
+static void start(ARM_GPIO_PORT_SNAPSHOT* snapshot)
+{
+    sim_reset();
+    TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+    for (uint32_t pin = 0; pin < 20; pin++)
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(8, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_OUTPUT), ARM_DRIVER_OK);
+    driver->SetPin(8);
+    TEST_EQUAL(ARM_GPIO_SavePortConfig(ARM_GPIO_PORT_A, snapshot), ARM_DRIVER_OK);
+}
+
+static void stop(void)
+{
+    driver->PowerControl(ARM_POWER_OFF);
+    driver->Uninitialize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Restoring the configuration the port has: no store at all.
+static void test_unchanged(void)
+{
+    ARM_GPIO_PORT_SNAPSHOT snapshot;
+    start(&snapshot);
+    TEST_EQUAL(restore(&snapshot), 0);
+    TEST_EQUAL(ARM_GPIO_ApplyPortConfig(ARM_GPIO_PORT_A, &snapshot, 0x0F), ARM_DRIVER_OK);
+    stop();
+}
+
+// Pull-ups on 0..2 and 16..17 back to no pull, pull-downs on 4..5 to pull-
+// ups: one store per restored value and port half (GPCLR twice, GPCHR once),
+// other pins untouched.
+static void test_groups(void)
+{
+    ARM_GPIO_PORT_SNAPSHOT snapshot;
+    start(&snapshot);
+    uint32_t saved[32];
+    for (uint32_t pin = 0; pin < 32; pin++)
+        saved[pin] = pcr(pin);
+
+    static const uint32_t pulled[] = { 0, 1, 2, 16, 17 };
+    for (uint32_t i = 0; i < 5; i++)
+        TEST_EQUAL(driver->ControlPin(pulled[i], ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_UP), ARM_DRIVER_OK);
+    for (uint32_t pin = 4; pin < 6; pin++)
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_DOWN), ARM_DRIVER_OK);
+
+    const uint32_t pull_up = PORT_PCR_PE_MASK | PORT_PCR_PS_MASK;
+    for (uint32_t pin = 4; pin < 6; pin++)
+        snapshot.pcr[pin] = saved[pin] = saved[pin] | pull_up;
+
+    const uint32_t count = restore(&snapshot);
+    for (uint32_t pin = 0; pin < 32; pin++)
+        TEST_EQUAL(pcr(pin), saved[pin]);
+#if ARM_GPIO_SHADOW_REGS
+    TEST_EQUAL(count, 7);
+    for (uint32_t n = 0; n < count; n++)
+        TEST_CHECK(stores[n].offset < SIM_PORT_PCR(32));
+#else
+    TEST_EQUAL(count, 3);
+    uint32_t plain = 0, up = 0, high = 0;
+    for (uint32_t n = 0; n < count; n++)
+    {
+        TEST_EQUAL(stores[n].block, SIM_BLOCK_PORT(0));
+        const uint32_t value = stores[n].value & 0xFFFFu;
+        if (stores[n].offset == SIM_PORT_GPCHR && value == (saved[16] & 0xFFFFu))
+            high |= stores[n].value >> 16;
+        else if (stores[n].offset == SIM_PORT_GPCLR && value == (saved[0] & 0xFFFFu))
+            plain |= stores[n].value >> 16;
+        else if (stores[n].offset == SIM_PORT_GPCLR && value == (saved[4] & 0xFFFFu))
+            up |= stores[n].value >> 16;
+        else
+            TEST_CHECK(0);
+    }
+    TEST_EQUAL(plain, 0x07);
+    TEST_EQUAL(up, 0x30);
+    TEST_EQUAL(high, 0x3);
+#endif
+    stop();
+}
+
+// IRQC is above PCR[15:0]: its own PCR store. Output level and direction
+// only where they differ.
+static void test_irqc_and_gpio(void)
+{
+    ARM_GPIO_PORT_SNAPSHOT snapshot;
+    start(&snapshot);
+    TEST_EQUAL(driver->ControlPin(3, ARM_GPIO_PIN_IRQ, ARM_GPIO_PIN_IRQ_RISING), ARM_DRIVER_OK);
+    driver->ClearPin(8);
+
+    TEST_EQUAL(restore(&snapshot), 2);
+    TEST_EQUAL(stores[0].block, SIM_BLOCK_GPIO(0));
+    TEST_EQUAL(stores[0].offset, SIM_GPIO_PDOR);
+    TEST_EQUAL(stores[1].block, SIM_BLOCK_PORT(0));
+    TEST_EQUAL(stores[1].offset, SIM_PORT_PCR(3));
+    TEST_EQUAL(pcr(3), snapshot.pcr[3]);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(0), SIM_GPIO_PDOR), snapshot.pdor);
+
+    TEST_EQUAL(driver->ControlPin(8, ARM_GPIO_PIN_DIRECTION, ARM_GPIO_PIN_DIRECTION_INPUT), ARM_DRIVER_OK);
+    TEST_EQUAL(restore(&snapshot), 1);
+    TEST_EQUAL(stores[0].offset, SIM_GPIO_PDDR);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(0), SIM_GPIO_PDDR), 1u << 8);
+    stop();
+}
+
+// A locked pin keeps its configuration and gets no store; the others of its
+// group are restored.
+static void test_locked(void)
+{
+    ARM_GPIO_PORT_SNAPSHOT snapshot;
+    start(&snapshot);
+    for (uint32_t pin = 0; pin < 3; pin++)
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_PULL, ARM_GPIO_PIN_PULL_UP), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_LOCK, 1u << 1), ARM_DRIVER_OK);
+    const uint32_t locked = pcr(1);
+    TEST_CHECK(locked & PORT_PCR_LK_MASK);
+    snapshot.pcr[1] |= 0x00090000u;         // IRQC too: would be a PCR store
+
+    const uint32_t count = restore(&snapshot);
+    TEST_EQUAL(pcr(1), locked);
+    TEST_EQUAL(pcr(0), snapshot.pcr[0]);
+    TEST_EQUAL(pcr(2), snapshot.pcr[2]);
+    for (uint32_t n = 0; n < count; n++)
+    {
+        TEST_CHECK(stores[n].offset != SIM_PORT_PCR(1));
+        if (stores[n].offset == SIM_PORT_GPCLR)
+            TEST_EQUAL(stores[n].value >> 16, 0x5);
+    }
+#if ARM_GPIO_SHADOW_REGS
+    TEST_EQUAL(count, 2);
+#else
+    TEST_EQUAL(count, 1);
+#endif
+    stop();
+}
+
+// Flags pending on pins being restored stay set: ISF is never written as 1,
+// from the port or from the snapshot.
+static void test_flags(void)
+{
+    ARM_GPIO_PORT_SNAPSHOT snapshot;
+    start(&snapshot);
+    for (uint32_t pin = 10; pin < 13; pin++)
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_IRQ, ARM_GPIO_PIN_IRQ_RISING), ARM_DRIVER_OK);
+    for (uint32_t pin = 10; pin < 13; pin++)
+        sim_pin_input(ARM_GPIO_PORT_A, pin, 1);
+    TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(0), SIM_PORT_ISFR), 0x7u << 10);
+
+    // 10, 11: PCR[15:0] and IRQC as in the snapshot, which carries ISF on 11.
+    ARM_GPIO_PORT_SNAPSHOT target;
+    TEST_EQUAL(ARM_GPIO_SavePortConfig(ARM_GPIO_PORT_A, &target), ARM_DRIVER_OK);
+    TEST_EQUAL(target.pcr[10] & PORT_PCR_ISF_MASK, 0);
+    target.pcr[10] |= PORT_PCR_PE_MASK;
+    target.pcr[11] = snapshot.pcr[11] | PORT_PCR_ISF_MASK;
+
+    const uint32_t count = restore(&target);
+    TEST_CHECK(count >= 2);
+    for (uint32_t n = 0; n < count; n++)
+    {
+        if (stores[n].offset < SIM_PORT_PCR(32))
+            TEST_EQUAL(stores[n].value & PORT_PCR_ISF_MASK, 0);
+        TEST_CHECK(stores[n].offset != SIM_PORT_ISFR);
+    }
+    TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(0), SIM_PORT_ISFR), 0x7u << 10);
+    for (uint32_t pin = 10; pin < 13; pin++)
+        TEST_CHECK(pcr(pin) & PORT_PCR_ISF_MASK);
+    TEST_EQUAL(pcr(11) & ~PORT_PCR_ISF_MASK, snapshot.pcr[11]);
+    stop();
+}
+
+int main(void)
+{
+    test_unchanged();
+    test_groups();
+    test_irqc_and_gpio();
+    test_locked();
+    test_flags();
+    TEST_CHECK(sim_gated_accesses() == 0);
+    return TEST_RESULT();
+}
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Read-modify-write of PDDR and PCR from several contexts: threads changing
+// their own pins of one port at the same time, and interrupts injected
+// inside the read-modify-write of the thread. No update may be lost and, with
+// shadow registers, hardware and shadow must agree at the end, and PDDR
+// takes the committed shadow values in their order: a retried STREX or a
+// preempted writer never stores a stale one.
+// Then the cost of the read-modify-write in the model, with every register
+// load charged the peripheral bridge (sim_load_cost): run by both builds,
+// register and shadow, for the comparison.
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "test.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static const ARM_GPIO_CONFIG* const port = gpio_ports[ARM_GPIO_PORT_A];
+static ARM_DRIVER_GPIO* const driver = gpio_drivers[ARM_GPIO_PORT_A];
+
+static const uint32_t PULL_MASK = PORT_PCR_PE_MASK | PORT_PCR_PS_MASK;
+
+static uint32_t pull_bits(uint32_t pull)
+{
+    return pull == ARM_GPIO_PIN_PULL_UP   ? PORT_PCR_PE_MASK | PORT_PCR_PS_MASK
+         : pull == ARM_GPIO_PIN_PULL_DOWN ? PORT_PCR_PE_MASK : 0;
+}
+
+// Expected state of the pins, kept by the context owning them.
+struct Pins
+{
+    uint32_t pddr = 0;
+    uint32_t pull[32] = {};
+};
+
+// Pin of first..first + count - 1, implemented on the package.
+static uint32_t random_pin(uint32_t first, uint32_t count, uint32_t* seed)
+{
+    uint32_t pin;
+    do
+    {
+        pin = first + test_random(seed) % count;
+    } while (!(port->pins & (1u << pin)));
+    return pin;
+}
+
+static void random_op(uint32_t pin, uint32_t* seed, Pins* expected)
+{
+    const uint32_t r = test_random(seed);
+    if (r & 1)
+    {
+        const uint32_t out = (r >> 1) & 1;
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_DIRECTION, out), ARM_DRIVER_OK);
+        expected->pddr = (expected->pddr & ~(1u << pin)) | (out << pin);
+    }
+    else
+    {
+        const uint32_t pull = (r >> 1) % 3;
+        TEST_EQUAL(driver->ControlPin(pin, ARM_GPIO_PIN_PULL, pull), ARM_DRIVER_OK);
+        expected->pull[pin] = pull_bits(pull);
+    }
+}
+
+static void check(const Pins& expected, uint32_t pins)
+{
+    TEST_EQUAL(sim_reg(SIM_BLOCK_GPIO(0), SIM_GPIO_PDDR) & pins, expected.pddr & pins);
+    for (uint32_t pin = 0; pin < 32; pin++)
+    {
+        if (pins & (1u << pin))
+            TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(0), SIM_PORT_PCR(pin)) & PULL_MASK, expected.pull[pin]);
+    }
+#if ARM_GPIO_SHADOW_REGS
+    TEST_EQUAL(ARM_GPIO_VerifyShadow(ARM_GPIO_PORT_A), 0);
+#endif
+}
+
+static void start(void)
+{
+    sim_reset();
+    TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+}
+
+static void stop(void)
+{
+    driver->PowerControl(ARM_POWER_OFF);
+    driver->Uninitialize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Threads
+////////////////////////////////////////////////////////////////////////////////
+
+static void test_threads(void)
+{
+    const int THREADS = 4;
+    const int OPS = 20000;
+
+    sim_set_traced(0);
+    start();
+
+    std::vector<Pins> expected(THREADS);
+    std::atomic<int> ready(0);
+    std::vector<std::thread> threads;
+    for (int n = 0; n < THREADS; n++)
+    {
+        threads.emplace_back([n, &expected, &ready]
+        {
+            uint32_t seed = 0x9E3779B9u * (uint32_t)(n + 1);
+            ready++;
+            while (ready < THREADS)
+                ;
+            for (int op = 0; op < OPS; op++)
+                random_op(random_pin(8 * n, 8, &seed), &seed, &expected[n]);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (int n = 0; n < THREADS; n++)
+        check(expected[n], 0xFFu << (8 * n));
+
+    stop();
+    sim_set_traced(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Interrupts inside the read-modify-write
+////////////////////////////////////////////////////////////////////////////////
+
+static Pins     isr_expected;
+static uint32_t isr_seed = 7;
+static uint32_t injected;
+static uint32_t injections;
+
+// Interrupt changing pins 16..31.
+static void isr(void)
+{
+    injected = 1;
+    random_op(random_pin(16, 16, &isr_seed), &isr_seed, &isr_expected);
+    injected = 0;
+    injections++;
+}
+
+// Shadow registers: between LDREX and STREX, and before the hardware store.
+static void on_strex(volatile void*, uint32_t)
+{
+    if (!injected && !sim_in_isr() && (test_random(&isr_seed) & 1))
+        sim_interrupt(isr);
+}
+
+// Without: inside the masked section, the interrupt comes at its end.
+static void on_write(uint32_t block, uint32_t offset, uint32_t)
+{
+    const bool config = (block == SIM_BLOCK_GPIO(0) && offset == SIM_GPIO_PDDR)
+                     || (block == SIM_BLOCK_PORT(0) && offset < SIM_PORT_GPCLR);
+    if (config && !injected && !sim_in_isr() && (test_random(&isr_seed) & 1))
+        sim_interrupt(isr);
+}
+
+static void test_interrupts(void)
+{
+    start();
+    sim_on_strex(on_strex, NULL);
+    sim_on_write(on_write, NULL);
+
+    Pins expected;
+    uint32_t seed = 3;
+    for (int op = 0; op < 5000; op++)
+        random_op(random_pin(0, 16, &seed), &seed, &expected);
+
+    sim_on_strex(NULL, NULL);
+    sim_on_write(NULL, NULL);
+
+    TEST_CHECK(injections > 1000);
+    check(expected, 0x0000FFFFu);
+    check(isr_expected, 0xFFFF0000u);
+    stop();
+}
+
+#if ARM_GPIO_SHADOW_REGS
+////////////////////////////////////////////////////////////////////////////////
+//   Order of the PDDR stores
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<uint32_t> committed;     // shadow values of successful STREXes
+static std::vector<uint32_t> stored;        // hardware PDDR stores
+static uint32_t depth;                      // handlers nested
+
+static void order_isr(void)
+{
+    depth++;
+    random_op(random_pin(16, 16, &isr_seed), &isr_seed, &isr_expected);
+    depth--;
+    injections++;
+}
+
+// Handlers preempt the thread and each other, up to two deep.
+static void inject(void)
+{
+    if (depth < 2 && (test_random(&isr_seed) & 3) == 0)
+        sim_interrupt(order_isr);
+}
+
+// Between LDREX and STREX of the shadow and of the writer's busy flag.
+static void order_strex(volatile void* address, uint32_t)
+{
+    if (address == &port->state->pddr || address == &port->state->pddr_busy)
+        inject();
+}
+
+static void order_committed(volatile void* address, uint32_t value)
+{
+    if (address == &port->state->pddr)
+        committed.push_back(value);
+}
+
+// Before the hardware store, after the writer read the shadow.
+static void order_write(uint32_t block, uint32_t offset, uint32_t)
+{
+    if (block == SIM_BLOCK_GPIO(0) && offset == SIM_GPIO_PDDR)
+        inject();
+}
+
+static void order_stored(uint32_t block, uint32_t offset, uint32_t value)
+{
+    if (block == SIM_BLOCK_GPIO(0) && offset == SIM_GPIO_PDDR)
+        stored.push_back(value);
+}
+
+static void test_pddr_order(void)
+{
+    start();
+    isr_expected = Pins();
+    injections = 0;
+    committed.clear();
+    stored.clear();
+    sim_on_strex(order_strex, order_committed);
+    sim_on_write(order_write, order_stored);
+    
+    Pins expected;
+    uint32_t seed = 9;
+    for (int op = 0; op < 5000; op++)
+        random_op(random_pin(0, 16, &seed), &seed, &expected);
+    
+    sim_on_strex(NULL, NULL);
+    sim_on_write(NULL, NULL);
+    
+    // Stores follow the commits in order, ending with the last; a writer
+    // may store the current value again, which a context found changed.
+    size_t current = 0;
+    for (uint32_t value : stored)
+    {
+        while (current < committed.size() && committed[current] != value)
+            current++;
+        TEST_CHECK(current < committed.size());
+        if (current == committed.size())
+            break;
+    }
+    TEST_CHECK(!stored.empty() && stored.back() == committed.back());
+    
+    TEST_CHECK(injections > 1000);
+    check(expected, 0x0000FFFFu);
+    check(isr_expected, 0xFFFF0000u);
+    stop();
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//   Cycles per read-modify-write
+////////////////////////////////////////////////////////////////////////////////
+
+// Register loads and model cycles of one ControlPin, direction (PDDR) and
+// pull (PCR); the shadow build reads RAM only.
+static void measure(void)
+{
+    const uint32_t OPS = 1000;
+    start();
+    sim_trap_loads(1);
+
+    const char* const names[2] = { "PDDR", "PCR " };
+    for (uint32_t target = 0; target < 2; target++)
+    {
+        const uint64_t loads = sim_loads();
+        const uint64_t time = sim_time();
+        for (uint32_t n = 0; n < OPS; n++)
+        {
+            if (target == 0)
+                driver->ControlPin(n % 8, ARM_GPIO_PIN_DIRECTION, (n >> 3) & 1);
+            else
+                driver->ControlPin(n % 8, ARM_GPIO_PIN_PULL, (n >> 3) % 3);
+        }
+        const double per_op = (double)(sim_loads() - loads) / OPS;
+        printf("%s: %s read-modify-write %.2f register loads, %.1f cycles (%u per load, %u per store)\n",
+               ARM_GPIO_SHADOW_REGS ? "shadow  " : "register", names[target], per_op,
+               (double)(sim_time() - time) / OPS, sim_load_cost, sim_write_cost);
+        TEST_EQUAL(per_op, ARM_GPIO_SHADOW_REGS ? 0 : 1);
+    }
+
+    sim_trap_loads(0);
+    stop();
+}
+
+int main(void)
+{
+    test_threads();
+    test_interrupts();
+#if ARM_GPIO_SHADOW_REGS
+    test_pddr_order();
+#endif
+    measure();
+    return TEST_RESULT();
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Trace of driver operations: tools/gpio_trace_vcd on traces of the driver
+// across DWT epochs and on traces, which lost their start, and the cost of
+// tracing a SetPort (built with and without ARM_GPIO_TRACE).
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define driver  gpio_drivers[ARM_GPIO_PORT_B]
+
+#if ARM_GPIO_TRACE
+
+#define CHANGES_MAX 64
+
+// Times of the PTB changes in the VCD of the records (1 GHz clock: ns = cycles).
+static uint32_t convert(const ARM_GPIO_TRACE_RECORD* records, uint32_t count, uint64_t* times)
+{
+    FILE* file = fopen("trace.bin", "wb");
+    TEST_CHECK(file && fwrite(records, sizeof(records[0]), count, file) == count);
+    fclose(file);
+    TEST_EQUAL(system(GPIO_TRACE_VCD " trace.bin trace.vcd 1000000000 2>/dev/null"), 0);
+
+    uint32_t changes = 0;
+    uint64_t now = 0;
+    char line[128];
+    file = fopen("trace.vcd", "r");
+    TEST_CHECK(file);
+    while (file && fgets(line, sizeof(line), file))
+    {
+        if (line[0] == '#')
+            now = strtoull(line + 1, NULL, 10);
+        else if (line[0] == 'b' && strstr(line, " P1") && changes < CHANGES_MAX)
+            times[changes++] = now;
+    }
+    if (file)
+        fclose(file);
+    return changes;
+}
+
+// Gaps of the driver's operations: within an epoch, one, several, the longest
+// a SYNC tells apart (255 epochs).
+static void test_driver_trace(void)
+{
+    static const uint64_t gaps[] = { 100, 1u << 24, 3 * (1u << 24) + 5, 0xFEFFFFF0u, 7, (1u << 24) - 1 };
+    const uint32_t count = sizeof(gaps) / sizeof(gaps[0]) + 1;
+    uint64_t expected[CHANGES_MAX], times[CHANGES_MAX];
+    ARM_GPIO_TRACE_RECORD records[2 * CHANGES_MAX];
+
+    sim_reset();
+    TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+    sim_advance(0x12345678u);
+    ARM_GPIO_Trace_Start();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (i)
+            sim_advance(gaps[i - 1]);
+        expected[i] = sim_time();
+        if (i & 1)
+            driver->ClearPort(1u << i);
+        else
+            driver->SetPort(1u << i);
+    }
+
+    const uint32_t n = ARM_GPIO_Trace_Copy(records, 2 * CHANGES_MAX);
+    TEST_EQUAL(ARM_GPIO_TRACE_OP(&records[0]), ARM_GPIO_TRACE_SYNC);
+    TEST_EQUAL(convert(records, n, times), count);
+
+    // A record is a few cycles after sim_time() before the call.
+    for (uint32_t i = 1; i < count; i++)
+    {
+        const int64_t error = (int64_t)(times[i] - times[0]) - (int64_t)(expected[i] - expected[0]);
+        TEST_CHECK(error >= -8 && error <= 8);
+    }
+    TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+}
+
+#define RECORD(stamp, op, port, mask)   { ((uint32_t)(stamp) << 8) | ((op) << 3) | (port), (mask) }
+#define SYNC(epoch, stamp)              RECORD(stamp, ARM_GPIO_TRACE_SYNC, 0, ((uint32_t)(epoch) << 24) | (stamp))
+
+// The trace lost its start (circular buffer): records of an unknown epoch,
+// a stamp wrap, then the first SYNC, which only sets the epoch; later SYNCs
+// count the epochs.
+static void test_wrapped_trace(void)
+{
+    static const ARM_GPIO_TRACE_RECORD records[] = {
+        RECORD(0xFFFF00, ARM_GPIO_TRACE_SET,   1, 1),      // 0
+        RECORD(0x000100, ARM_GPIO_TRACE_CLEAR, 1, 1),      // 0x200: one epoch later
+        SYNC(9, 0x000300),
+        RECORD(0x000300, ARM_GPIO_TRACE_SET,   1, 2),      // 0x400
+        SYNC(11, 0x000050),
+        RECORD(0x000050, ARM_GPIO_TRACE_CLEAR, 1, 2),      // 2 * 2^24 + 0x150
+        RECORD(0x000060, ARM_GPIO_TRACE_SET,   1, 4),      // 2 * 2^24 + 0x160
+    };
+    static const uint64_t expected[] = { 0, 0x200, 0x400, 2 * (1u << 24) + 0x150, 2 * (1u << 24) + 0x160 };
+    uint64_t times[CHANGES_MAX];
+
+    TEST_EQUAL(convert(records, sizeof(records) / sizeof(records[0]), times), 5);
+    for (uint32_t i = 0; i < 5; i++)
+        TEST_EQUAL(times[i], expected[i]);
+
+    // Starting with SYNC: its epoch is the origin.
+    static const ARM_GPIO_TRACE_RECORD synced[] = {
+        SYNC(5, 0x000010),
+        RECORD(0x000010, ARM_GPIO_TRACE_SET,   1, 1),      // 0
+        RECORD(0x000020, ARM_GPIO_TRACE_CLEAR, 1, 1),      // 0x10
+        SYNC(6, 0x000005),
+        RECORD(0x000005, ARM_GPIO_TRACE_SET,   1, 1),      // 2^24 - 0xB
+    };
+    TEST_EQUAL(convert(synced, sizeof(synced) / sizeof(synced[0]), times), 3);
+    TEST_EQUAL(times[0], 0);
+    TEST_EQUAL(times[1], 0x10);
+    TEST_EQUAL(times[2], (1u << 24) - 0xB);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Host time of SetPort on plain register memory; the build without
+// ARM_GPIO_TRACE gives the baseline. Target cycles: tools/gpio_budget.sh.
+static void benchmark(void)
+{
+    const uint32_t count = 10000000;
+    struct timespec start, end;
+
+    sim_reset();
+    sim_set_traced(0);
+    TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+#if ARM_GPIO_TRACE
+    ARM_GPIO_Trace_Start();
+#endif
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < count; i++)
+        driver->SetPort(i);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    const double ns = 1e9 * (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec);
+    printf("SetPort, trace %s: %.1f ns\n", ARM_GPIO_TRACE ? "on" : "off", ns / count);
+
+    TEST_EQUAL(driver->Uninitialize(), ARM_DRIVER_OK);
+    sim_set_traced(1);
+}
+
+int main(void)
+{
+#if ARM_GPIO_TRACE
+    test_driver_trace();
+    test_wrapped_trace();
+#endif
+    benchmark();
+    return TEST_RESULT();
+}
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Wait lists (Driver_GPIO_NXP_K66_Wait.h): rising and falling waiters are
+// told apart by the pin's IRQC, not by the level read in the handler, and
+// refused on pins not interrupting on that edge. Coroutines of the scheduler
+// (Driver_GPIO_NXP_K66_Coro.hpp) run in their own thread, fired by edges
+// driven from other threads: no edge may be lost or go to the wrong waiter.
+// Their frames come from the frame pool, returned when they finish.
+
+#include "Driver_GPIO_NXP_K66_Coro.hpp"
+#include "test.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace arm_gpio;
+
+static ARM_DRIVER_GPIO* const driver = gpio_drivers[ARM_GPIO_PORT_A];
+
+static ARM_GPIO_WAITER* volatile ready;
+
+static void start(void)
+{
+    sim_reset();
+    TEST_EQUAL(driver->Initialize(NULL), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->Control(ARM_GPIO_CONTROL_IRQ, 1), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(0, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_RISING), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(1, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_FALLING), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(2, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_BOTH), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(3, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED), ARM_DRIVER_OK);
+    ready = nullptr;
+}
+
+static void stop(void)
+{
+    driver->PowerControl(ARM_POWER_OFF);
+    driver->Uninitialize();
+}
+
+static int32_t add(ARM_GPIO_WAITER* waiter, uint32_t mask, uint32_t edge)
+{
+    waiter->mask  = mask;
+    waiter->edge  = edge;
+    waiter->ready = &ready;
+    return ARM_GPIO_Wait_Add(ARM_GPIO_PORT_A, waiter);
+}
+
+// Waiters fired since the last call, as a mask of their pins.
+static uint32_t take(void)
+{
+    uint32_t fired = 0;
+    for (ARM_GPIO_WAITER* waiter = ARM_GPIO_Wait_TakeAll(&ready); waiter; waiter = waiter->next)
+        fired |= waiter->mask;
+    return fired;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Edge of the waiter against the pin interrupt
+////////////////////////////////////////////////////////////////////////////////
+
+static void test_add(void)
+{
+    start();
+
+    ARM_GPIO_WAITER waiter[8];
+    TEST_EQUAL(add(&waiter[0], 1u << 0, ARM_GPIO_WAIT_RISING), ARM_DRIVER_OK);
+    TEST_EQUAL(add(&waiter[1], 1u << 1, ARM_GPIO_WAIT_FALLING), ARM_DRIVER_OK);
+    TEST_EQUAL(add(&waiter[2], 1u << 2, ARM_GPIO_WAIT_EDGE), ARM_DRIVER_OK);
+
+    TEST_EQUAL(add(&waiter[3], 1u << 1, ARM_GPIO_WAIT_RISING), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(add(&waiter[3], 1u << 0, ARM_GPIO_WAIT_FALLING), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(add(&waiter[3], 1u << 2, ARM_GPIO_WAIT_RISING), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(add(&waiter[3], 1u << 2, ARM_GPIO_WAIT_FALLING), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(add(&waiter[3], 1u << 3, ARM_GPIO_WAIT_RISING), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(add(&waiter[3], (1u << 0) | (1u << 2), ARM_GPIO_WAIT_RISING), ARM_DRIVER_ERROR_UNSUPPORTED);
+    TEST_EQUAL(add(&waiter[3], 0, ARM_GPIO_WAIT_EDGE), ARM_DRIVER_ERROR_PARAMETER);
+    TEST_EQUAL(add(&waiter[3], 1u << 0, 3), ARM_DRIVER_ERROR_PARAMETER);
+
+    // Refused waiters are not in the list: only the accepted ones fire.
+    sim_pin_input(ARM_GPIO_PORT_A, 0, 1);
+    sim_pin_input(ARM_GPIO_PORT_A, 1, 1);
+    sim_pin_input(ARM_GPIO_PORT_A, 2, 1);
+    TEST_EQUAL(take(), (1u << 0) | (1u << 2));
+    sim_pin_input(ARM_GPIO_PORT_A, 1, 0);
+    TEST_EQUAL(take(), 1u << 1);
+
+    stop();
+}
+
+// The level read by the handler is not the edge: a rising edge of a pulse,
+// which is over when the handler runs, still fires the rising waiter; both
+// edges of a pin interrupting on both fire only edge waiters.
+static void test_routing(void)
+{
+    start();
+
+    ARM_GPIO_WAITER rising, falling, edge;
+    TEST_EQUAL(add(&rising, 1u << 0, ARM_GPIO_WAIT_RISING), ARM_DRIVER_OK);
+    TEST_EQUAL(add(&falling, 1u << 1, ARM_GPIO_WAIT_FALLING), ARM_DRIVER_OK);
+    TEST_EQUAL(add(&edge, 1u << 2, ARM_GPIO_WAIT_EDGE), ARM_DRIVER_OK);
+
+    sim_pin_input(ARM_GPIO_PORT_A, 1, 1);
+    TEST_EQUAL(take(), 0);
+
+    __disable_interrupt();
+    sim_pin_input(ARM_GPIO_PORT_A, 0, 1);
+    sim_pin_input(ARM_GPIO_PORT_A, 0, 0);
+    sim_pin_input(ARM_GPIO_PORT_A, 1, 0);
+    sim_pin_input(ARM_GPIO_PORT_A, 1, 1);
+    __enable_interrupt();
+    TEST_EQUAL(take(), (1u << 0) | (1u << 1));
+    TEST_EQUAL(rising.events, 1u << 0);
+    TEST_EQUAL(falling.events, 1u << 1);
+
+    sim_pin_input(ARM_GPIO_PORT_A, 2, 1);
+    TEST_EQUAL(take(), 1u << 2);
+    TEST_EQUAL(add(&edge, 1u << 2, ARM_GPIO_WAIT_EDGE), ARM_DRIVER_OK);
+    sim_pin_input(ARM_GPIO_PORT_A, 2, 0);
+    TEST_EQUAL(take(), 1u << 2);
+
+    stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Frame pool
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t finished;
+
+static Task short_task(void)
+{
+    co_await yield();
+    finished++;
+}
+
+// The array lives across the suspension: in the frame, larger than a block.
+static Task large_task(void)
+{
+    volatile unsigned char bytes[ARM_GPIO_CORO_FRAME_SIZE];
+    bytes[0] = 1;
+    co_await yield();
+    finished += bytes[0];
+}
+
+static void test_pool(void)
+{
+    Scheduler& scheduler = Scheduler::instance();
+    TEST_EQUAL(FramePool::available(), ARM_GPIO_CORO_FRAMES);
+
+    for (uint32_t round = 1; round <= 2; round++)
+    {
+        for (uint32_t n = 0; n < ARM_GPIO_CORO_FRAMES; n++)
+            TEST_CHECK(scheduler.spawn(short_task()));
+        TEST_EQUAL(FramePool::available(), 0);
+        TEST_CHECK(!scheduler.spawn(short_task()));
+
+        while (scheduler.poll())
+            ;
+        TEST_EQUAL(finished, round * ARM_GPIO_CORO_FRAMES);
+        TEST_EQUAL(FramePool::available(), ARM_GPIO_CORO_FRAMES);
+    }
+
+    // Not spawned: the task's destructor returns the frame.
+    {
+        Task task = short_task();
+        TEST_EQUAL(FramePool::available(), ARM_GPIO_CORO_FRAMES - 1);
+    }
+    TEST_EQUAL(FramePool::available(), ARM_GPIO_CORO_FRAMES);
+
+    TEST_CHECK(!scheduler.spawn(large_task()));
+    TEST_EQUAL(FramePool::available(), ARM_GPIO_CORO_FRAMES);
+    TEST_CHECK(!scheduler.poll());
+    TEST_EQUAL(finished, 2 * ARM_GPIO_CORO_FRAMES);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//   Scheduler thread, edges from other threads
+////////////////////////////////////////////////////////////////////////////////
+
+static const uint32_t ROUNDS = 2000;
+
+// A task's wait is in the list: the next edge of its pin may come.
+static std::atomic<uint32_t> armed[3];
+static std::atomic<uint32_t> done;
+static uint32_t              counts[3];
+static uint32_t              wrong;
+
+struct ArmedAwaiter : EdgeAwaiter
+{
+    ArmedAwaiter(EdgeAwaiter awaiter, uint32_t task) : EdgeAwaiter(awaiter), task(task) {}
+
+    bool await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        const bool suspended = EdgeAwaiter::await_suspend(handle);
+        armed[task]++;
+        return suspended;
+    }
+
+    uint32_t task;
+};
+
+template <class Input>
+static Task count(EdgeAwaiter (*wait)(), uint32_t task, uint32_t edges)
+{
+    for (uint32_t n = 0; n < edges; n++)
+    {
+        const uint32_t events = co_await ArmedAwaiter(wait(), task);
+        if (events == Input::mask)
+            counts[task]++;
+        else
+            wrong++;
+        if (n % 64 == 0)
+            co_await yield();
+    }
+    done++;
+}
+
+// Waits until the task's wait for the edge number n is in the list.
+static void wait_armed(uint32_t task, uint32_t n)
+{
+    while (armed[task] <= n)
+        std::this_thread::yield();
+}
+
+static void test_threads(void)
+{
+    typedef AwaitablePin<ARM_GPIO_PORT_A, 0> Rising;
+    typedef AwaitablePin<ARM_GPIO_PORT_A, 1> Falling;
+    typedef AwaitablePin<ARM_GPIO_PORT_A, 2> Both;
+
+    start();
+    sim_pin_input(ARM_GPIO_PORT_A, 1, 1);
+
+    Scheduler& scheduler = Scheduler::instance();
+    scheduler.spawn(count<Rising>(Rising::rising, 0, ROUNDS));
+    scheduler.spawn(count<Falling>(Falling::falling, 1, ROUNDS));
+    scheduler.spawn(count<Both>(Both::edge, 2, 2 * ROUNDS));
+
+    std::thread tasks([&scheduler]
+    {
+        while (done < 3)
+        {
+            if (!scheduler.poll())
+                std::this_thread::yield();
+        }
+    });
+
+    // Pulses of pins 0 and 1 from one thread, of pin 2 from another; the
+    // pulse ends before the task may wait again: rising and falling waiters
+    // see the edge of their IRQC, whatever the level is when they resume.
+    std::thread pulses([]
+    {
+        for (uint32_t n = 0; n < ROUNDS; n++)
+        {
+            wait_armed(0, n);
+            sim_pin_input(ARM_GPIO_PORT_A, 0, 1);
+            sim_pin_input(ARM_GPIO_PORT_A, 0, 0);
+            wait_armed(1, n);
+            sim_pin_input(ARM_GPIO_PORT_A, 1, 0);
+            sim_pin_input(ARM_GPIO_PORT_A, 1, 1);
+        }
+    });
+    std::thread toggles([]
+    {
+        for (uint32_t n = 0; n < 2 * ROUNDS; n++)
+        {
+            wait_armed(2, n);
+            sim_pin_input(ARM_GPIO_PORT_A, 2, ~n & 1);
+        }
+    });
+
+    pulses.join();
+    toggles.join();
+    tasks.join();
+
+    TEST_EQUAL(counts[0], ROUNDS);
+    TEST_EQUAL(counts[1], ROUNDS);
+    TEST_EQUAL(counts[2], 2 * ROUNDS);
+    TEST_EQUAL(wrong, 0);
+    TEST_CHECK(!scheduler.poll());
+    TEST_EQUAL(FramePool::available(), ARM_GPIO_CORO_FRAMES);
+
+    stop();
+}
+
+int main(void)
+{
+    test_add();
+    test_routing();
+    test_pool();
+    test_threads();
+    return TEST_RESULT();
+}
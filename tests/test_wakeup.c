@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// ARM_POWER_LOW: LLWU routing of the port's pins and the wake-up latency,
+// pin edge to ARM_GPIO_SignalEvent_t, in the host model of LLS.
+
+#include "Driver_GPIO_NXP_K66.h"
+#include "test.h"
+
+#define LLWU_PIN(port, pin)     (((ARM_GPIO_PORT_##port) << 5) | (pin))
+#define LLWU_PIN_NONE           0xFF
+
+static const uint8_t llwu_pins[ARM_GPIO_DEVICE_LLWU_PIN_COUNT] = { ARM_GPIO_DEVICE_LLWU_PINS };
+
+#define driver  gpio_drivers[ARM_GPIO_PORT_C]
+
+static uint32_t signalled;
+static uint64_t signal_time;
+
+static void signal_event(uint32_t event)
+{
+    signalled |= event;
+    signal_time = sim_time();
+}
+
+static uint32_t llwu_field(uint32_t port, uint32_t pin)
+{
+    for (uint32_t n = 0; n < ARM_GPIO_DEVICE_LLWU_PIN_COUNT; n++)
+    {
+        if (llwu_pins[n] == ((port << 5) | pin))
+            return (sim_reg(SIM_BLOCK_LLWU, SIM_LLWU_PE(n / 4 + 1)) >> (2 * (n % 4))) & 3;
+    }
+    return 0xFF;
+}
+
+static void start(void)
+{
+    sim_reset();
+    sim_llwu_map(llwu_pins, ARM_GPIO_DEVICE_LLWU_PIN_COUNT);
+    TEST_EQUAL(driver->Initialize(signal_event), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(1, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED | ARM_GPIO_PIN_CFG_IRQ_RISING), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(3, ARM_GPIO_PIN_CFG, ARM_GPIO_PIN_CFG_ENABLED), ARM_DRIVER_OK);
+}
+
+// Pins of the port without an edge interrupt are disabled in LLWU, pins of
+// other ports are kept.
+static void test_routing(void)
+{
+    start();
+    for (uint32_t n = 1; n <= 8; n++)
+        sim_reg_poke(SIM_BLOCK_LLWU, SIM_LLWU_PE(n), 0xFF);
+
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_LOW), ARM_DRIVER_OK);
+    TEST_EQUAL(llwu_field(ARM_GPIO_PORT_C, 1), 1);      // rising
+    TEST_EQUAL(llwu_field(ARM_GPIO_PORT_C, 3), 0);
+    TEST_EQUAL(llwu_field(ARM_GPIO_PORT_C, 4), 0);
+    TEST_EQUAL(llwu_field(ARM_GPIO_PORT_E, 1), 3);      // not this driver's
+
+    // Interrupt changed to level: not a wake-up source any more.
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->ControlPin(1, ARM_GPIO_PIN_IRQ, ARM_GPIO_PIN_IRQ_LEVEL_HIGH), ARM_DRIVER_OK);
+    sim_reg_poke(SIM_BLOCK_LLWU, SIM_LLWU_PE(2), 0xFF);
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_LOW), ARM_DRIVER_OK);
+    TEST_EQUAL(llwu_field(ARM_GPIO_PORT_C, 1), 0);
+    driver->PowerControl(ARM_POWER_OFF);
+}
+
+static void edge(void* level)
+{
+    sim_pin_input(ARM_GPIO_PORT_C, (uint32_t)(uintptr_t)level >> 1, (uint32_t)(uintptr_t)level & 1);
+}
+
+#define EDGE(pin, level)    ((void*)(uintptr_t)(((pin) << 1) | (level)))
+
+// Edge to the signal callback, with LLS exit times of 1..5000 cycles.
+static void test_latency(void)
+{
+    uint64_t min = UINT64_MAX, max = 0, sum = 0;
+    const uint32_t RUNS = 64;
+
+    for (uint32_t run = 0; run < RUNS; run++)
+    {
+        start();
+        TEST_EQUAL(driver->PowerControl(ARM_POWER_LOW), ARM_DRIVER_OK);
+        const uint32_t exit_cycles = 1 + run * 78;
+        sim_wakeup_cycles = exit_cycles;
+        signalled = 0;
+
+        // An edge of a pin not routed to LLWU, then the wake-up edge.
+        const uint64_t t0 = sim_time() + 1000 + run;
+        sim_at(t0 - 500, edge, EDGE(3, 1));
+        sim_at(t0, edge, EDGE(1, 1));
+        TEST_CHECK(sim_deep_sleep());
+        TEST_EQUAL(signalled, 1u << 1);
+
+        const uint64_t latency = signal_time - t0;
+        TEST_CHECK(latency >= exit_cycles + sim_isr_entry);
+        TEST_CHECK(latency < exit_cycles + sim_isr_entry + 1000);
+        const uint64_t handler = latency - exit_cycles;
+        min = handler < min ? handler : min;
+        max = handler > max ? handler : max;
+        sum += handler;
+
+        // The port didn't latch the edge in LLS: no second event.
+        TEST_EQUAL(sim_reg(SIM_BLOCK_PORT(ARM_GPIO_PORT_C), SIM_PORT_ISFR), 0);
+        TEST_EQUAL(driver->PowerControl(ARM_POWER_FULL), ARM_DRIVER_OK);
+        driver->PowerControl(ARM_POWER_OFF);
+    }
+
+    printf("wake-up latency = LLS exit + %llu..%llu cycles (mean %llu): LLWU entry to signal callback\n",
+           (unsigned long long)min, (unsigned long long)max, (unsigned long long)(sum / RUNS));
+
+    // Nothing routed: the core sleeps through the edges.
+    start();
+    TEST_EQUAL(driver->ControlPin(1, ARM_GPIO_PIN_IRQ, ARM_GPIO_PIN_IRQ_NONE), ARM_DRIVER_OK);
+    TEST_EQUAL(driver->PowerControl(ARM_POWER_LOW), ARM_DRIVER_OK);
+    sim_at(sim_time() + 100, edge, EDGE(1, 1));
+    TEST_CHECK(!sim_deep_sleep());
+    driver->PowerControl(ARM_POWER_OFF);
+}
+
+int main(void)
+{
+    test_routing();
+    test_latency();
+    return TEST_RESULT();
+}
@@ -0,0 +1,257 @@
+#!/bin/sh
+#
+# Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Code size, stack and cycle report of the GPIO driver, checked against a budget.
+#
+#   DEVICE_INCLUDE=<dir of MK66F18.h> tools/gpio_budget.sh [--update] [budget] [compiler flags...]
+#
+# Compiles Driver/Driver_GPIO_NXP_K66.c with GNU Arm for Cortex-M4 (IAR
+# intrinsics from tools/iar_compat) and prints for every function:
+#   size     bytes of code
+#   stack    own frame (-fstack-usage)
+#   total    stack with the deepest chain of callees (-fcallgraph-info);
+#            an indirect call (signal callback) or a callee outside the file
+#            counts as CALLBACK_STACK bytes
+#   cycles   static estimate: every instruction once, calls counted as a branch;
+#            an upper bound for code without loops, '~' marks functions with a
+#            loop (estimate of one pass)
+#
+# Budget lines: function size stack total cycles [iterations] ('-' = no limit).
+# A function with a loop needs an iteration bound to have a cycle limit: the
+# estimate is then multiplied by it (every instruction run each iteration).
+# Exits with 1 if a limit is exceeded, a budgeted function is missing or a
+# cycle limit of a loop has no bound. Compiler flags select the configuration,
+# e.g. -DARM_GPIO_TRACE=1 (then use a budget for it).
+#
+# A budget with a '# TEMPLATE' line holds unmeasured limits: exceeded ones are
+# reported, the exit status is 0.
+#
+# --update writes the measured values into the limits of the budget ('-' and
+# the iteration bounds are kept) and drops the '# TEMPLATE' line; review the
+# change before committing it.
+#
+# Environment: CROSS (default arm-none-eabi-), OUT (default build/gpio_budget),
+# CALLBACK_STACK (default 64), ARCH_FLAGS (default Cortex-M4 flags) and
+# COMPAT_INCLUDE (default tools/iar_compat): the last two with CROSS= build
+# for the host, e.g. to test the script (tests/budget.sh).
+
+set -eu
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+CROSS=${CROSS-arm-none-eabi-}
+OUT=${OUT:-$ROOT/build/gpio_budget}
+CALLBACK_STACK=${CALLBACK_STACK:-64}
+ARCH_FLAGS=${ARCH_FLAGS-"-mcpu=cortex-m4 -mthumb -mfloat-abi=soft"}
+COMPAT_INCLUDE=${COMPAT_INCLUDE:-$ROOT/tools/iar_compat}
+
+UPDATE=0
+if [ "${1:-}" = "--update" ]; then
+    UPDATE=1
+    shift
+fi
+
+BUDGET=$ROOT/tools/gpio_budget.txt
+if [ $# -gt 0 ]; then
+    BUDGET=$1
+    shift
+fi
+
+: "${DEVICE_INCLUDE:?set DEVICE_INCLUDE to the directory of the device header (MK66F18.h)}"
+
+mkdir -p "$OUT"
+
+# shellcheck disable=SC2086
+"${CROSS}gcc" $ARCH_FLAGS -Os -std=gnu11 \
+    -ffunction-sections -fstack-usage -fcallgraph-info=su -Wall \
+    -I"$COMPAT_INCLUDE" -I"$ROOT/Driver" -I"$ROOT/Driver/Include" -I"$ROOT" -I"$DEVICE_INCLUDE" \
+    "$@" -c "$ROOT/Driver/Driver_GPIO_NXP_K66.c" -o "$OUT/driver.o"
+
+# name size
+"${CROSS}nm" -S -t d "$OUT/driver.o" |
+    awk '$3 ~ /^[Tt]$/ { printf "%s %d\n", $4, $2 }' > "$OUT/size.txt"
+
+# name stack total
+awk -v allowance="$CALLBACK_STACK" '
+    # Static functions are titled file:name, the label starts with the name.
+    /^node: / {
+        match($0, /title: "[^"]*"/)
+        fn = substr($0, RSTART + 8, RLENGTH - 9)
+        match($0, /label: "[^"\\]*/)
+        name[fn] = substr($0, RSTART + 8, RLENGTH - 8)
+        if (match($0, /\\n[0-9]+ bytes/))
+            own[fn] = substr($0, RSTART + 2, RLENGTH - 8) + 0
+        next
+    }
+    /^edge: / {
+        match($0, /sourcename: "[^"]*"/)
+        from = substr($0, RSTART + 13, RLENGTH - 14)
+        match($0, /targetname: "[^"]*"/)
+        calls[from] = calls[from] " " substr($0, RSTART + 13, RLENGTH - 14)
+        next
+    }
+    function total(fn,    n, i, callee, deepest, t) {
+        if (!(fn in own))
+            return allowance
+        if (fn in done)
+            return done[fn]
+        if (fn in visiting) {
+            printf "recursion through %s\n", fn > "/dev/stderr"
+            return 1000000
+        }
+        visiting[fn] = 1
+        deepest = 0
+        n = split(calls[fn], callee, " ")
+        for (i = 1; i <= n; i++) {
+            t = total(callee[i])
+            if (t > deepest)
+                deepest = t
+        }
+        delete visiting[fn]
+        return done[fn] = own[fn] + deepest
+    }
+    END {
+        for (fn in own)
+            printf "%s %d %d\n", name[fn], own[fn], total(fn)
+    }
+' "$OUT/driver.ci" > "$OUT/stack.txt"
+
+# name cycles loop
+# Cortex-M4: load/store 2, push/pop/ldm/stm 1 + registers, taken branch
+# or write to pc 1 + 3 (pipeline refill), divide up to 12, barrier 4.
+# A host build (x86-64) only counts instructions; its jumps are branches.
+"${CROSS}objdump" -d --no-show-raw-insn "$OUT/driver.o" | awk '
+    function hex(s,    i, v) {
+        v = 0
+        for (i = 1; i <= length(s); i++)
+            v = v * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+        return v
+    }
+    function flush() {
+        if (fn != "")
+            printf "%s %d %d\n", fn, cycles, loop
+    }
+    /^[0-9a-f]+ <.*>:$/ {
+        flush()
+        fn = $2; gsub(/[<>:]/, "", fn)
+        cycles = 0; loop = 0
+        next
+    }
+    fn != "" && /^ +[0-9a-f]+:\t/ {
+        n = split($0, f, "\t")
+        addr = f[1]; gsub(/[ :]/, "", addr)
+        if (n >= 3) {
+            op = f[2]; args = f[3]
+        }
+        else {
+            op = f[2]; args = ""
+            if (match(op, / +/)) {
+                args = substr(op, RSTART + RLENGTH); op = substr(op, 1, RSTART - 1)
+            }
+        }
+        sub(/\..*$/, "", op); gsub(/ /, "", op)
+
+        c = 1
+        if (op ~ /^(ldr|str|tbb|tbh)/)
+            c = (op ~ /^tb/) ? 5 : 2
+        else if (op ~ /^(push|pop|ldm|stm|vpush|vpop)/) {
+            c = 1 + split(args, r, ",")
+            if (args ~ /pc/)
+                c += 3
+        }
+        else if (op ~ /^(b|bl|blx|bx|cbz|cbnz)$/ || op ~ /^b(eq|ne|cs|cc|hs|lo|mi|pl|vs|vc|hi|ls|ge|lt|gt|le)$/ || op ~ /^j[a-z]+$/) {
+            c = 4
+            split(args, t, " ")
+            if (op !~ /^bl/ && t[1] ~ /^[0-9a-f]+$/ && hex(t[1]) <= hex(addr))
+                loop = 1
+        }
+        else if (op ~ /^[su]div$/)
+            c = 12
+        else if (op ~ /^(dsb|isb|dmb)$/)
+            c = 4
+        cycles += c
+    }
+    END { flush() }
+' > "$OUT/cycles.txt"
+
+awk -v budget="$BUDGET" -v update="$UPDATE" -v updated="$OUT/budget.txt" '
+    FILENAME ~ /size.txt$/   { size[$1] = $2; names[$1] = 1; next }
+    FILENAME ~ /stack.txt$/  { stack[$1] = $2; total[$1] = $3; next }
+    FILENAME ~ /cycles.txt$/ { cycles[$1] = $2; loop[$1] = $3; next }
+    function limit(old, value) {
+        return old == "-" ? "-" : value
+    }
+    END {
+        printf "%-40s %6s %6s %6s %7s\n", "function", "size", "stack", "total", "cycles"
+        for (fn in names)
+            printf "%-40s %6d %6s %6s %6d%s\n", fn, size[fn], (fn in stack) ? stack[fn] : "?", (fn in total) ? total[fn] : "?", cycles[fn], loop[fn] ? "~" : "" | "sort"
+        close("sort")
+
+        failed = 0
+        while ((getline line < budget) > 0) {
+            if (line ~ /^# TEMPLATE/) {
+                template = 1
+                continue
+            }
+            if (line ~ /^[ \t]*(#|$)/) {
+                if (update)
+                    print line > updated
+                continue
+            }
+            n = split(line, b, /[ \t]+/)
+            fn = b[1]
+            iterations = (n >= 6) ? b[6] : "-"
+            if (!(fn in names)) {
+                printf "BUDGET %s: not found\n", fn
+                failed = 1
+                if (update)
+                    print line > updated
+                continue
+            }
+            estimate = cycles[fn]
+            if (loop[fn] && b[5] != "-") {
+                if (iterations == "-") {
+                    printf "BUDGET %s: cycle limit of a loop without an iteration bound\n", fn
+                    failed = 1
+                }
+                else
+                    estimate = cycles[fn] * iterations
+            }
+            if (update) {
+                printf "%-32s%-8s%-8s%-8s%-8s%s\n", fn, limit(b[2], size[fn]), limit(b[3], stack[fn]),
+                       limit(b[4], total[fn]), limit(b[5], estimate), iterations > updated
+                continue
+            }
+            if (b[2] != "-" && size[fn] > b[2])     { printf "BUDGET %s: size %d > %d\n", fn, size[fn], b[2]; failed = 1 }
+            if (b[3] != "-" && stack[fn] > b[3])    { printf "BUDGET %s: stack %d > %d\n", fn, stack[fn], b[3]; failed = 1 }
+            if (b[4] != "-" && total[fn] > b[4])    { printf "BUDGET %s: total stack %d > %d\n", fn, total[fn], b[4]; failed = 1 }
+            if (b[5] != "-" && estimate > b[5])     { printf "BUDGET %s: cycles %d > %d\n", fn, estimate, b[5]; failed = 1 }
+        }
+        if (failed && template && !update) {
+            printf "BUDGET %s is a template: not enforced\n", budget
+            failed = 0
+        }
+        exit failed
+    }
+' "$OUT/size.txt" "$OUT/stack.txt" "$OUT/cycles.txt" || STATUS=$?
+
+if [ "$UPDATE" = 1 ]; then
+    cp "$OUT/budget.txt" "$BUDGET"
+    echo "updated $BUDGET"
+fi
+exit "${STATUS:-0}"
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host tool: interrupt load of the GPIO driver, simulated (host/gpio_des.h).
+//
+//   gpio_des [options] wave...
+//
+//   wave         PORT:PINS:HIGH:LOW[:JITTER], e.g. A:0xFF:900:900:50
+//                square waves on the pins of mask PINS, phases in cycles
+//   -t CYCLES    simulated time (default 180000000: 1 s at 180 MHz)
+//   -p PORT:N    NVIC priority of the port (default 8)
+//   -i PORT:MODE interrupt of the waved pins: rising, falling, both (default)
+//   -e CYCLES    callback cost per pin event (default 0)
+//   -h CYCLES    handler cost per call on top of the driver (default 0)
+//   -m           model handlers instead of the driver's (speed of the simulation)
+//   -o PORT      poll the port instead of its interrupt
+//   -P PERIOD[:PRIORITY[:COST]]
+//                polling timer: cycles between passes (default 1800), NVIC
+//                priority (default 8), cycles of a pass (default 0)
+//   -r FILE      record the port events into FILE (tools/gpio_replay.c)
+//
+// Prints per port edges, events delivered and lost, handler calls (polled:
+// passes with events) and edge to callback latency (p50, p99, p99.9, max), then time in handlers and the
+// simulation speed. Exits with 1 if an event was lost.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpio_des.h"
+#include "Driver_GPIO_NXP_K66_Record.h"
+
+#define RECORD_SIZE     (16u << 20)
+
+static GPIO_DES_PORT ports[ARM_GPIO_PORT_COUNT];
+static uint32_t      used;              // ports with a wave
+
+static int port_index(const char* arg, uint32_t* port)
+{
+    const char c = arg[0] & ~0x20;
+    if (c < 'A' || c >= 'A' + ARM_GPIO_PORT_COUNT || arg[1] != ':')
+        return 0;
+    *port = (uint32_t)(c - 'A');
+    return 1;
+}
+
+// Gap records of long runs: the record's deltas are 32-bit.
+static void record_tick(void* arg)
+{
+    ARM_GPIO_Record_Tick();
+    sim_at(sim_time() + (1u << 30), record_tick, NULL);
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-t cycles] [-p port:priority] [-i port:rising|falling|both]\n"
+                    "       [-e event cycles] [-h handler cycles] [-m] [-o port] [-P period[:priority[:cost]]]\n"
+                    "       [-r file] port:pins:high:low[:jitter]...\n", name);
+    exit(2);
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t cycles = 180000000u;
+    SIM_WAVE waves[64 * 32];
+    uint32_t wave_count = 0;
+    uint32_t event_cost = 0, handler_cost = 0, model = 0;
+    uint32_t poll_period = 1800, poll_priority = 8, poll_cost = 0, polled = 0;
+    const char* record = NULL;
+
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        ports[port].priority = 8;
+        ports[port].irq = ARM_GPIO_PIN_IRQ_BOTH;
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        uint32_t port;
+
+        if (!strcmp(arg, "-m"))
+        {
+            model = 1;
+            continue;
+        }
+        if (arg[0] == '-' && i + 1 >= argc)
+            usage(argv[0]);
+
+        if (!strcmp(arg, "-t"))
+            cycles = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(arg, "-e"))
+            event_cost = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(arg, "-r"))
+            record = argv[++i];
+        else if (!strcmp(arg, "-h"))
+            handler_cost = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(arg, "-o"))
+        {
+            const char c = argv[++i][0] & ~0x20;
+            if (c < 'A' || c >= 'A' + ARM_GPIO_PORT_COUNT || argv[i][1])
+                usage(argv[0]);
+            polled |= 1u << (c - 'A');
+        }
+        else if (!strcmp(arg, "-P"))
+        {
+            char* end;
+            poll_period = (uint32_t)strtoul(argv[++i], &end, 0);
+            if (*end == ':')
+                poll_priority = (uint32_t)strtoul(end + 1, &end, 0);
+            if (*end == ':')
+                poll_cost = (uint32_t)strtoul(end + 1, &end, 0);
+            if (*end || !poll_period)
+                usage(argv[0]);
+        }
+        else if (!strcmp(arg, "-p") && port_index(argv[i + 1], &port))
+            ports[port].priority = (uint32_t)strtoul(argv[++i] + 2, NULL, 0);
+        else if (!strcmp(arg, "-i") && port_index(argv[i + 1], &port))
+        {
+            const char* mode = argv[++i] + 2;
+            ports[port].irq = !strcmp(mode, "rising")  ? ARM_GPIO_PIN_IRQ_RISING
+                            : !strcmp(mode, "falling") ? ARM_GPIO_PIN_IRQ_FALLING
+                            : !strcmp(mode, "both")    ? ARM_GPIO_PIN_IRQ_BOTH : (usage(argv[0]), 0);
+        }
+        else if (arg[0] != '-' && port_index(arg, &port))
+        {
+            char* end;
+            const uint32_t pins   = (uint32_t)strtoul(arg + 2, &end, 0);
+            const uint32_t high   = (*end == ':') ? (uint32_t)strtoul(end + 1, &end, 0) : 0;
+            const uint32_t low    = (*end == ':') ? (uint32_t)strtoul(end + 1, &end, 0) : 0;
+            const uint32_t jitter = (*end == ':') ? (uint32_t)strtoul(end + 1, &end, 0) : 0;
+            if (*end || !high || !low || jitter >= high || jitter >= low)
+                usage(argv[0]);
+
+            for (uint32_t left = pins; left; left &= left - 1)
+            {
+                if (wave_count == sizeof(waves) / sizeof(waves[0]))
+                    usage(argv[0]);
+                // Pins of a port start one cycle apart.
+                const SIM_WAVE wave = { (uint8_t)port, (uint8_t)__builtin_ctz(left), high, low, jitter,
+                                        1000 + wave_count, cycles };
+                waves[wave_count++] = wave;
+            }
+            used |= 1u << port;
+        }
+        else
+            usage(argv[0]);
+    }
+    if (!wave_count)
+        usage(argv[0]);
+
+    gpio_des_reset();
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        if (!(used & (1u << port)))
+            continue;
+        ports[port].event_cost   = event_cost;
+        ports[port].handler_cost = handler_cost;
+        ports[port].model_handler = model;
+        ports[port].polled       = (polled >> port) & 1u;
+        if (gpio_des_port(port, &ports[port]) != ARM_DRIVER_OK)
+        {
+            fprintf(stderr, "port %c: invalid configuration\n", 'A' + port);
+            return 2;
+        }
+    }
+    if (polled & used)
+        gpio_des_poll(poll_period, poll_priority, poll_cost);
+    for (uint32_t n = 0; n < wave_count; n++)
+    {
+        if (gpio_des_wave(&waves[n]) != ARM_DRIVER_OK)
+        {
+            fprintf(stderr, "P%c%u: pin doesn't exist\n", 'A' + waves[n].port, waves[n].pin);
+            return 2;
+        }
+    }
+
+    uint8_t* const buffer = record ? malloc(RECORD_SIZE) : NULL;
+    if (buffer)
+    {
+        ARM_GPIO_Record_Start(buffer, RECORD_SIZE);
+        record_tick(NULL);
+    }
+
+    GPIO_DES_REPORT report;
+    gpio_des_run(cycles, &report);
+
+    if (buffer)
+    {
+        uint32_t dropped;
+        const uint32_t length = ARM_GPIO_Record_Stop(&dropped);
+        FILE* const file = fopen(record, "wb");
+        if (!file || fwrite(buffer, 1, length, file) != length || fclose(file))
+        {
+            fprintf(stderr, "%s: write failed\n", record);
+            return 2;
+        }
+        if (dropped)
+            fprintf(stderr, "record full: %u events dropped\n", dropped);
+        free(buffer);
+    }
+
+    gpio_des_print(stdout, &report, used);
+
+    uint64_t lost = 0;
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+        lost += report.port[port].edges.lost;
+
+    return lost ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host tool: replay a record of port events (Driver_GPIO_NXP_K66_Record.h)
+// into the simulated ports (host/gpio_des.h).
+//
+//   gpio_replay [options] record
+//
+//   record       port events, as ARM_GPIO_Record_Stop left them in the buffer
+//                (e.g. dumped from the target, or gpio_des -r)
+//   -s N         speedup: recorded time intervals divided by N (default 1)
+//   -p PORT:N    NVIC priority of the port (default 8)
+//   -i PORT:MODE interrupt of the recorded pins: rising, falling, both (default)
+//   -e CYCLES    callback cost per pin event (default 0)
+//   -h CYCLES    handler cost per call on top of the driver (default 0)
+//   -m           model handlers instead of the driver's
+//
+// Every recorded event becomes an edge on its pins at its (scaled) time; the
+// driver's handlers take them as on the part. Prints the gpio_des table of
+// the ports in the record. Exits with 1 if an event was lost: the handlers
+// didn't keep up with the record at this speed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpio_des.h"
+#include "Driver_GPIO_NXP_K66_Record.h"
+
+static GPIO_DES_PORT ports[ARM_GPIO_PORT_COUNT];
+
+static int port_index(const char* arg, uint32_t* port)
+{
+    const char c = arg[0] & ~0x20;
+    if (c < 'A' || c >= 'A' + ARM_GPIO_PORT_COUNT || arg[1] != ':')
+        return 0;
+    *port = (uint32_t)(c - 'A');
+    return 1;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-s speedup] [-p port:priority] [-i port:rising|falling|both]\n"
+                    "       [-e event cycles] [-h handler cycles] [-m] record\n", name);
+    exit(2);
+}
+
+static uint8_t* read_file(const char* name, uint32_t* length)
+{
+    FILE* const file = fopen(name, "rb");
+    if (!file)
+        return NULL;
+
+    uint8_t* data = NULL;
+    size_t size = 0, used = 0, n;
+    do
+    {
+        if (used == size)
+        {
+            size = size ? 2 * size : 65536;
+            data = realloc(data, size);
+        }
+        n = fread(data + used, 1, size - used, file);
+        used += n;
+    } while (n);
+    fclose(file);
+
+    *length = (uint32_t)used;
+    return data;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t speedup = 1;
+    uint32_t event_cost = 0, handler_cost = 0, model = 0;
+    const char* name = NULL;
+
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        ports[port].priority = 8;
+        ports[port].irq = ARM_GPIO_PIN_IRQ_BOTH;
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        uint32_t port;
+
+        if (!strcmp(arg, "-m"))
+        {
+            model = 1;
+            continue;
+        }
+        if (arg[0] == '-' && i + 1 >= argc)
+            usage(argv[0]);
+
+        if (!strcmp(arg, "-s"))
+            speedup = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(arg, "-e"))
+            event_cost = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(arg, "-h"))
+            handler_cost = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(arg, "-p") && port_index(argv[i + 1], &port))
+            ports[port].priority = (uint32_t)strtoul(argv[++i] + 2, NULL, 0);
+        else if (!strcmp(arg, "-i") && port_index(argv[i + 1], &port))
+        {
+            const char* mode = argv[++i] + 2;
+            ports[port].irq = !strcmp(mode, "rising")  ? ARM_GPIO_PIN_IRQ_RISING
+                            : !strcmp(mode, "falling") ? ARM_GPIO_PIN_IRQ_FALLING
+                            : !strcmp(mode, "both")    ? ARM_GPIO_PIN_IRQ_BOTH : (usage(argv[0]), 0);
+        }
+        else if (arg[0] != '-' && !name)
+            name = arg;
+        else
+            usage(argv[0]);
+    }
+    if (!name || !speedup)
+        usage(argv[0]);
+
+    uint32_t length;
+    uint8_t* const trace = read_file(name, &length);
+    if (!trace)
+    {
+        fprintf(stderr, "%s: can't read\n", name);
+        return 2;
+    }
+
+    // Ports of the record.
+    uint32_t used = 0;
+    for (uint32_t pos = 0; pos < length; )
+    {
+        ARM_GPIO_RECORD_EVENT event;
+        const uint32_t n = ARM_GPIO_Record_Decode(trace + pos, length - pos, &event);
+        if (!n || (event.port >= ARM_GPIO_PORT_COUNT && event.port != ARM_GPIO_RECORD_GAP))
+        {
+            fprintf(stderr, "%s: malformed record at byte %u\n", name, pos);
+            return 2;
+        }
+        if (event.port != ARM_GPIO_RECORD_GAP)
+            used |= 1u << event.port;
+        pos += n;
+    }
+
+    gpio_des_reset();
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+    {
+        if (!(used & (1u << port)))
+            continue;
+        ports[port].event_cost    = event_cost;
+        ports[port].handler_cost  = handler_cost;
+        ports[port].model_handler = model;
+        if (gpio_des_port(port, &ports[port]) != ARM_DRIVER_OK)
+        {
+            fprintf(stderr, "port %c: invalid configuration\n", 'A' + port);
+            return 2;
+        }
+    }
+
+    uint64_t end;
+    if (gpio_des_replay(trace, length, speedup, 1000, &end) != ARM_DRIVER_OK)
+    {
+        fprintf(stderr, "%s: pin of the record doesn't exist\n", name);
+        return 2;
+    }
+
+    // Time for the handlers of the last events.
+    GPIO_DES_REPORT report;
+    gpio_des_run(end + 100000 - sim_time(), &report);
+    gpio_des_print(stdout, &report, used);
+    free(trace);
+
+    uint64_t lost = 0;
+    for (uint32_t port = 0; port < ARM_GPIO_PORT_COUNT; port++)
+        lost += report.port[port].edges.lost;
+
+    return lost ? 1 : 0;
+}
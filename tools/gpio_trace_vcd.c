@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host tool: convert GPIO driver trace into VCD waveform.
+//
+//   cc -o gpio_trace_vcd tools/gpio_trace_vcd.c -IDriver
+//   gpio_trace_vcd trace.bin trace.vcd [core clock, Hz; default 180000000]
+//
+// trace.bin is the output of ARM_GPIO_Trace_Copy saved by the debugger
+// (little-endian records). For every port the VCD shows:
+//   PTx      output latch; bits never written are 'x'
+//   IRQx     ISFR of the port interrupt, for one cycle
+//   CTLx     last ControlPin: arg[15:0] << 16 | control << 8 | pin
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "Driver_GPIO_NXP_K66_Trace.h"
+
+#define PORTS   8
+
+typedef struct
+{
+    uint32_t    value;
+    uint32_t    known;      // bits of value, which were written
+} LATCH;
+
+static void put_vector(FILE* out, uint32_t value, uint32_t known, char id, uint32_t port)
+{
+    fputc('b', out);
+    for (int bit = 31; bit >= 0; bit--)
+        fputc(!(known & (1u << bit)) ? 'x' : (value & (1u << bit)) ? '1' : '0', out);
+    fprintf(out, " %c%u\n", id, port);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s trace.bin trace.vcd [core clock, Hz]\n", argv[0]);
+        return 2;
+    }
+
+    const uint64_t clock = (argc > 3) ? strtoull(argv[3], 0, 0) : 180000000u;
+    if (!clock)
+    {
+        fprintf(stderr, "invalid clock\n");
+        return 2;
+    }
+
+    FILE* in  = fopen(argv[1], "rb");
+    FILE* out = fopen(argv[2], "w");
+    if (!in || !out)
+    {
+        perror("open");
+        return 1;
+    }
+
+    fprintf(out, "$timescale 1 ns $end\n$scope module gpio $end\n");
+    for (uint32_t port = 0; port < PORTS; port++)
+    {
+        fprintf(out, "$var wire 32 P%u PT%c $end\n",   port, 'A' + port);
+        fprintf(out, "$var wire 32 I%u IRQ%c $end\n",  port, 'A' + port);
+        fprintf(out, "$var wire 32 C%u CTL%c $end\n",  port, 'A' + port);
+    }
+    fprintf(out, "$upscope $end\n$enddefinitions $end\n");
+
+    LATCH    latch[PORTS] = { { 0, 0 } };
+    uint32_t irq_pending  = 0;      // ports, which IRQ wire must return to 0
+    uint64_t time         = 0;      // cycles since the first record
+    uint64_t origin       = 0;      // time of the first record
+    uint64_t base         = 0;      // cycles of the current 2^24 epoch
+    uint32_t epoch        = 0;
+    uint32_t last_stamp   = 0;
+    int      first        = 1;
+    int      synced       = 0;      // a SYNC was seen: epoch is known
+    uint64_t written      = UINT64_MAX;
+    unsigned records      = 0;
+
+    uint8_t raw[8];
+    while (fread(raw, 1, sizeof(raw), in) == sizeof(raw))
+    {
+        ARM_GPIO_TRACE_RECORD record;
+        record.info = raw[0] | (raw[1] << 8) | (raw[2] << 16) | ((uint32_t)raw[3] << 24);
+        record.mask = raw[4] | (raw[5] << 8) | (raw[6] << 16) | ((uint32_t)raw[7] << 24);
+        records++;
+
+        const uint32_t stamp = ARM_GPIO_TRACE_STAMP(&record);
+        const uint32_t op    = ARM_GPIO_TRACE_OP(&record);
+        const uint32_t port  = ARM_GPIO_TRACE_PORT(&record);
+
+        // Time: epoch from SYNC records, 24-bit stamp in between. Before the
+        // first SYNC (the trace wrapped, its start is lost) the epoch isn't
+        // known: a stamp going back is one more epoch, and the first SYNC
+        // only sets the epoch. After it every epoch change has its SYNC.
+        if (op == ARM_GPIO_TRACE_SYNC && synced)
+            base += (uint64_t)(((record.mask >> 24) - epoch) & 0xFF) << 24;
+        else if (!synced && !first && stamp < last_stamp)
+            base += 1u << 24;
+        if (op == ARM_GPIO_TRACE_SYNC)
+        {
+            epoch  = record.mask >> 24;
+            synced = 1;
+        }
+        if (first)
+            origin = stamp;
+        last_stamp = stamp;
+        first      = 0;
+        time       = base + stamp - origin;
+
+        const uint64_t ns = time * 1000000000u / clock;
+        if (ns != written)
+        {
+            // IRQ pulses end one timestamp after they started.
+            if (irq_pending && written != UINT64_MAX)
+            {
+                fprintf(out, "#%llu\n", (unsigned long long)(written + 1 < ns ? written + 1 : ns));
+                for (uint32_t p = 0; p < PORTS; p++)
+                {
+                    if (irq_pending & (1u << p))
+                        put_vector(out, 0, UINT32_MAX, 'I', p);
+                }
+                irq_pending = 0;
+            }
+            fprintf(out, "#%llu\n", (unsigned long long)ns);
+            written = ns;
+        }
+
+        LATCH* l = &latch[port];
+        switch (op)
+        {
+            case ARM_GPIO_TRACE_SYNC:   continue;
+            case ARM_GPIO_TRACE_SET:    l->value |=  record.mask; l->known |= record.mask; break;
+            case ARM_GPIO_TRACE_CLEAR:  l->value &= ~record.mask; l->known |= record.mask; break;
+            case ARM_GPIO_TRACE_TOGGLE: l->value ^=  record.mask; break;
+            case ARM_GPIO_TRACE_WRITE:  l->value  =  record.mask; l->known  = UINT32_MAX;  break;
+
+            case ARM_GPIO_TRACE_CONTROL_PIN:
+                put_vector(out, record.mask, UINT32_MAX, 'C', port);
+                continue;
+
+            case ARM_GPIO_TRACE_IRQ:
+                put_vector(out, record.mask, UINT32_MAX, 'I', port);
+                irq_pending |= (1u << port);
+                continue;
+
+            default:
+                fprintf(stderr, "record %u: unknown operation %u\n", records, op);
+                continue;
+        }
+        put_vector(out, l->value, l->known, 'P', port);
+    }
+
+    fclose(in);
+    fclose(out);
+
+    fprintf(stderr, "%u records, %.6f s\n", records, (double)time / clock);
+    return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// IAR intrinsics used by the driver, for builds with GNU Arm (see tools/gpio_budget.sh).
+
+#ifndef IAR_COMPAT_INTRINSICS_H_
+#define IAR_COMPAT_INTRINSICS_H_
+
+#include <stdint.h>
+
+typedef uint32_t __istate_t;
+
+#define __STATIC_FORCEINLINE    static inline __attribute__((always_inline))
+
+__STATIC_FORCEINLINE __istate_t __get_interrupt_state(void)
+{
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask" : "=r" (primask));
+    return primask;
+}
+
+__STATIC_FORCEINLINE void __set_interrupt_state(__istate_t state)
+{
+    __asm volatile ("msr primask, %0" : : "r" (state) : "memory");
+}
+
+__STATIC_FORCEINLINE void __disable_interrupt(void) { __asm volatile ("cpsid i" : : : "memory"); }
+__STATIC_FORCEINLINE void __enable_interrupt(void)  { __asm volatile ("cpsie i" : : : "memory"); }
+
+__STATIC_FORCEINLINE void __DSB(void) { __asm volatile ("dsb 0xF" : : : "memory"); }
+__STATIC_FORCEINLINE void __ISB(void) { __asm volatile ("isb 0xF" : : : "memory"); }
+__STATIC_FORCEINLINE void __DMB(void) { __asm volatile ("dmb 0xF" : : : "memory"); }
+__STATIC_FORCEINLINE void __WFI(void) { __asm volatile ("wfi"); }
+__STATIC_FORCEINLINE void __NOP(void) { __asm volatile ("nop"); }
+
+__STATIC_FORCEINLINE unsigned long __CLZ(unsigned long value)
+{
+    uint32_t result;
+    __asm ("clz %0, %1" : "=r" (result) : "r" (value));
+    return result;
+}
+
+__STATIC_FORCEINLINE unsigned long __RBIT(unsigned long value)
+{
+    uint32_t result;
+    __asm ("rbit %0, %1" : "=r" (result) : "r" (value));
+    return result;
+}
+
+__STATIC_FORCEINLINE unsigned long __LDREX(unsigned long* address)
+{
+    uint32_t result;
+    __asm volatile ("ldrex %0, %1" : "=r" (result) : "Q" (*address));
+    return result;
+}
+
+__STATIC_FORCEINLINE unsigned long __STREX(unsigned long value, unsigned long* address)
+{
+    uint32_t result;
+    __asm volatile ("strex %0, %2, %1" : "=&r" (result), "=Q" (*address) : "r" (value));
+    return result;
+}
+
+__STATIC_FORCEINLINE void __CLREX(void) { __asm volatile ("clrex" : : : "memory"); }
+
+#endif /* IAR_COMPAT_INTRINSICS_H_ */